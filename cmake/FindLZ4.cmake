@@ -0,0 +1,51 @@
+# Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+# This file is part of Rozofs.
+#
+# Rozofs is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published
+# by the Free Software Foundation, version 2.
+#
+# Rozofs is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see
+# <http://www.gnu.org/licenses/>.
+
+# - Find lz4
+# Find the native LZ4 includes and library
+#
+#  LZ4_INCLUDE_DIR - where to find lz4.h, etc.
+#  LZ4_LIBRARIES   - List of libraries when using lz4.
+#  LZ4_FOUND       - True if lz4 found.
+
+FIND_PATH(LZ4_INCLUDE_DIR lz4.h
+  /usr/include
+)
+
+SET(LZ4_NAMES lz4)
+FIND_LIBRARY(LZ4_LIBRARY
+  NAMES ${LZ4_NAMES}
+  PATHS /usr/lib /usr/local/lib
+)
+
+IF(LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+  SET(LZ4_FOUND TRUE)
+  SET(LZ4_LIBRARIES ${LZ4_LIBRARY} )
+ELSE(LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+  SET(LZ4_FOUND FALSE)
+  SET(LZ4_LIBRARIES)
+ENDIF(LZ4_INCLUDE_DIR AND LZ4_LIBRARY)
+
+IF(NOT LZ4_FOUND)
+   IF(LZ4_FIND_REQUIRED)
+     MESSAGE(FATAL_ERROR "lz4 library and headers required.")
+   ENDIF(LZ4_FIND_REQUIRED)
+ENDIF(NOT LZ4_FOUND)
+
+MARK_AS_ADVANCED(
+  LZ4_LIBRARY
+  LZ4_INCLUDE_DIR
+)
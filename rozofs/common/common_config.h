@@ -91,6 +91,13 @@ typedef struct _common_config_t {
   int32_t     storio_dscp;
   // DSCP for exchanges from/to the EXPORTD.
   int32_t     export_dscp;
+  // Size in KB of the bulk receive ring of the RPC stream sockets. The
+  // available data is read in a single system call into that ring, from
+  // which the following RPC messages are then taken. 0 disables the ring.
+  int32_t     rpc_recv_ring_size;
+  // Minimum size in bytes of the RPC messages that are compressed on the
+  // connections where the compression is enabled.
+  int32_t     compress_threshold;
 
   /*
   ** export scope configuration parameters
@@ -151,6 +158,17 @@ typedef struct _common_config_t {
   int32_t     level2_cache_max_entries_kb;
   // Whether file locks must be persistent on exportd restart/switchover or not
   int32_t     persistent_file_locks;
+  // Memory budget of the exportd dirent cache in MB. When the memory used by the
+  // cached directory entries exceeds that budget, the less recently re-used directories
+  // are released. 0 means no budget (the cache is only bounded by its number of entries).
+  int32_t     export_dirent_cache_size;
+  // Number of entries of the exportd dirent write back cache (one entry per
+  // dirent file with pending writes). It takes effect on the next exportd restart.
+  int32_t     export_dirent_wbcache_entries;
+  // Period in seconds of the snapshot of the hot FIDs and directory roots of the
+  // exportd caches. At restart the exportd warms its caches up from that snapshot.
+  // 0 disables the snapshot.
+  int32_t     export_warmup_snapshot_period;
 
   /*
   ** client scope configuration parameters
@@ -174,6 +192,22 @@ typedef struct _common_config_t {
   int32_t     async_setattr;
   // statfs period in seconds. minimum is 0.
   int32_t     statfs_period;
+  // Policy used by the STORCLI to select the connection on which a request
+  // is sent to a multi-port STORIO.
+  // 0: round robin.
+  // 1: least outstanding requests, then lowest smoothed response time.
+  // 2: the least loaded of two randomly chosen connections.
+  int32_t     storio_lbg_policy;
+  // Whether the ROZOFSMOUNT requests the LZ4 compression of the RPC
+  // messages exchanged with the EXPORTD. To be set on remote site clients
+  // that reach the EXPORTD through a bandwidth limited link.
+  int32_t     export_compress;
+  // Whether the STORCLI requests the LZ4 compression of the RPC messages
+  // exchanged with the STORIO that are not on the local host.
+  int32_t     storio_compress;
+  // Whether the geo-replication client requests the LZ4 compression of the
+  // RPC messages exchanged with the EXPORTD.
+  int32_t     geo_compress;
 
   /*
   ** storage scope configuration parameters
@@ -247,6 +281,37 @@ typedef struct _common_config_t {
   int32_t     storio_fidctx_ctx;
   // Spare file restoring : Number of spare file context in 1K unit
   int32_t     spare_restore_spare_ctx;
+  // Whether the STORIO disk threads merge the pending contiguous write requests
+  // of a file into a single disk write.
+  int32_t     storio_write_coalescing;
+  // Memory budget in MB of the STORIO projection cache, that keeps the first
+  // projection blocks of the recently read files. 0 disables the cache.
+  int32_t     storio_prjcache_size;
+  // Direct I/O (O_DIRECT) mode of the STORIO on the bins files.
+  // 0: every I/O goes through the page cache.
+  // 1: the rebuild writes bypass the page cache.
+  // 2: every bins file read and write bypasses the page cache.
+  int32_t     storio_direct_io;
+  // Max number of files per second that a storaged remove thread deletes
+  // when processing the bulk remove requests of the exportd.
+  // 0 means no limit.
+  int32_t     remove_bulk_rate;
+  // Memory budget in MB of the STORIO header file cache, that keeps the
+  // content of the recently accessed header files. 0 disables the cache.
+  int32_t     storio_hdrcache_size;
+  // Max number of files a STORIO processes in parallel on a same device.
+  // When not 0, the files to process are queued per device and per priority
+  // class, so a slow device can not hold every disk thread. 0 disables the
+  // per device queues.
+  int32_t     storio_device_max_inflight;
+  // Weight of the foreground reads in the STORIO per device queues.
+  int32_t     storio_sched_read_weight;
+  // Weight of the foreground writes in the STORIO per device queues.
+  int32_t     storio_sched_write_weight;
+  // Weight of the repairs in the STORIO per device queues.
+  int32_t     storio_sched_repair_weight;
+  // Weight of the rebuilds in the STORIO per device queues.
+  int32_t     storio_sched_rebuild_weight;
 } common_config_t;
 
 extern common_config_t common_config;
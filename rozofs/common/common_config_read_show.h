@@ -238,6 +238,63 @@ static inline int common_config_generated_set(char * pChar, char *parameter, cha
   if (strcmp(parameter,"persistent_file_locks")==0) {
     COMMON_CONFIG_SET_BOOL(persistent_file_locks,value);
   }
+  if (strcmp(parameter,"export_dirent_cache_size")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(export_dirent_cache_size,value,0,(256*1024));
+  }
+  if (strcmp(parameter,"export_dirent_wbcache_entries")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(export_dirent_wbcache_entries,value,64,(1024*1024));
+  }
+  if (strcmp(parameter,"export_warmup_snapshot_period")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(export_warmup_snapshot_period,value,0,86400);
+  }
+  if (strcmp(parameter,"storio_write_coalescing")==0) {
+    COMMON_CONFIG_SET_BOOL(storio_write_coalescing,value);
+  }
+  if (strcmp(parameter,"storio_prjcache_size")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_prjcache_size,value,0,(64*1024));
+  }
+  if (strcmp(parameter,"storio_direct_io")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_direct_io,value,0,2);
+  }
+  if (strcmp(parameter,"remove_bulk_rate")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(remove_bulk_rate,value,0,100000);
+  }
+  if (strcmp(parameter,"storio_hdrcache_size")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_hdrcache_size,value,0,(16*1024));
+  }
+  if (strcmp(parameter,"storio_device_max_inflight")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_device_max_inflight,value,0,64);
+  }
+  if (strcmp(parameter,"storio_sched_read_weight")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_sched_read_weight,value,1,100);
+  }
+  if (strcmp(parameter,"storio_sched_write_weight")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_sched_write_weight,value,1,100);
+  }
+  if (strcmp(parameter,"storio_sched_repair_weight")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_sched_repair_weight,value,1,100);
+  }
+  if (strcmp(parameter,"storio_sched_rebuild_weight")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_sched_rebuild_weight,value,1,100);
+  }
+  if (strcmp(parameter,"rpc_recv_ring_size")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(rpc_recv_ring_size,value,0,1024);
+  }
+  if (strcmp(parameter,"storio_lbg_policy")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(storio_lbg_policy,value,0,2);
+  }
+  if (strcmp(parameter,"compress_threshold")==0) {
+    COMMON_CONFIG_SET_INT_MINMAX(compress_threshold,value,64,(64*1024));
+  }
+  if (strcmp(parameter,"export_compress")==0) {
+    COMMON_CONFIG_SET_BOOL(export_compress,value);
+  }
+  if (strcmp(parameter,"storio_compress")==0) {
+    COMMON_CONFIG_SET_BOOL(storio_compress,value);
+  }
+  if (strcmp(parameter,"geo_compress")==0) {
+    COMMON_CONFIG_SET_BOOL(geo_compress,value);
+  }
   pChar += rozofs_string_append(pChar,"No such parameter ");
   pChar += rozofs_string_append(pChar,parameter);
   pChar += rozofs_eol(pChar);\
@@ -324,6 +381,21 @@ char * show_common_config_module_global(char * pChar) {
   pChar += rozofs_string_append(pChar,"// DSCP for exchanges from/to the EXPORTD.\n");
   COMMON_CONFIG_SHOW_INT_OPT(export_dscp,34,"0:34");
   if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(rpc_recv_ring_size,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Size in KB of the bulk receive ring of the RPC stream sockets. The\n");
+  pChar += rozofs_string_append(pChar,"// available data is read in a single system call into that ring, from\n");
+  pChar += rozofs_string_append(pChar,"// which the following RPC messages are then taken. 0 disables the ring.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(rpc_recv_ring_size,0,"0:1024");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(compress_threshold,1024);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Minimum size in bytes of the RPC messages that are compressed on the\n");
+  pChar += rozofs_string_append(pChar,"// connections where the compression is enabled.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(compress_threshold,1024,"64:(64*1024)");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -489,6 +561,29 @@ char * show_common_config_module_export(char * pChar) {
   pChar += rozofs_string_append(pChar,"// Whether file locks must be persistent on exportd restart/switchover or not\n");
   COMMON_CONFIG_SHOW_BOOL(persistent_file_locks,False);
   if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(export_dirent_cache_size,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Memory budget of the exportd dirent cache in MB. When the memory used by the\n");
+  pChar += rozofs_string_append(pChar,"// cached directory entries exceeds that budget, the less recently re-used directories\n");
+  pChar += rozofs_string_append(pChar,"// are released. 0 means no budget (the cache is only bounded by its number of entries).\n");
+  COMMON_CONFIG_SHOW_INT_OPT(export_dirent_cache_size,0,"0:(256*1024)");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(export_dirent_wbcache_entries,4096);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Number of entries of the exportd dirent write back cache (one entry per\n");
+  pChar += rozofs_string_append(pChar,"// dirent file with pending writes). It takes effect on the next exportd restart.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(export_dirent_wbcache_entries,4096,"64:(1024*1024)");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(export_warmup_snapshot_period,300);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Period in seconds of the snapshot of the hot FIDs and directory roots of the\n");
+  pChar += rozofs_string_append(pChar,"// exportd caches. At restart the exportd warms its caches up from that snapshot.\n");
+  pChar += rozofs_string_append(pChar,"// 0 disables the snapshot.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(export_warmup_snapshot_period,300,"0:86400");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -557,6 +652,38 @@ char * show_common_config_module_client(char * pChar) {
   pChar += rozofs_string_append(pChar,"// statfs period in seconds. minimum is 0.\n");
   COMMON_CONFIG_SHOW_INT(statfs_period,10);
   if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_lbg_policy,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Policy used by the STORCLI to select the connection on which a request\n");
+  pChar += rozofs_string_append(pChar,"// is sent to a multi-port STORIO.\n");
+  pChar += rozofs_string_append(pChar,"// 0: round robin.\n");
+  pChar += rozofs_string_append(pChar,"// 1: least outstanding requests, then lowest smoothed response time.\n");
+  pChar += rozofs_string_append(pChar,"// 2: the least loaded of two randomly chosen connections.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_lbg_policy,0,"0:2");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(export_compress,False);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Whether the ROZOFSMOUNT requests the LZ4 compression of the RPC\n");
+  pChar += rozofs_string_append(pChar,"// messages exchanged with the EXPORTD. To be set on remote site clients\n");
+  pChar += rozofs_string_append(pChar,"// that reach the EXPORTD through a bandwidth limited link.\n");
+  COMMON_CONFIG_SHOW_BOOL(export_compress,False);
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(storio_compress,False);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Whether the STORCLI requests the LZ4 compression of the RPC messages\n");
+  pChar += rozofs_string_append(pChar,"// exchanged with the STORIO that are not on the local host.\n");
+  COMMON_CONFIG_SHOW_BOOL(storio_compress,False);
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(geo_compress,False);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Whether the geo-replication client requests the LZ4 compression of the\n");
+  pChar += rozofs_string_append(pChar,"// RPC messages exchanged with the EXPORTD.\n");
+  COMMON_CONFIG_SHOW_BOOL(geo_compress,False);
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -743,6 +870,77 @@ char * show_common_config_module_storage(char * pChar) {
   pChar += rozofs_string_append(pChar,"// Spare file restoring : Number of spare file context in 1K unit\n");
   COMMON_CONFIG_SHOW_INT(spare_restore_spare_ctx,16);
   if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(storio_write_coalescing,True);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Whether the STORIO disk threads merge the pending contiguous write requests\n");
+  pChar += rozofs_string_append(pChar,"// of a file into a single disk write.\n");
+  COMMON_CONFIG_SHOW_BOOL(storio_write_coalescing,True);
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_prjcache_size,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Memory budget in MB of the STORIO projection cache, that keeps the first\n");
+  pChar += rozofs_string_append(pChar,"// projection blocks of the recently read files. 0 disables the cache.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_prjcache_size,0,"0:(64*1024)");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_direct_io,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Direct I/O (O_DIRECT) mode of the STORIO on the bins files.\n");
+  pChar += rozofs_string_append(pChar,"// 0: every I/O goes through the page cache.\n");
+  pChar += rozofs_string_append(pChar,"// 1: the rebuild writes bypass the page cache.\n");
+  pChar += rozofs_string_append(pChar,"// 2: every bins file read and write bypasses the page cache.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_direct_io,0,"0:2");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(remove_bulk_rate,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Max number of files per second that a storaged remove thread deletes\n");
+  pChar += rozofs_string_append(pChar,"// when processing the bulk remove requests of the exportd.\n");
+  pChar += rozofs_string_append(pChar,"// 0 means no limit.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(remove_bulk_rate,0,"0:100000");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_hdrcache_size,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Memory budget in MB of the STORIO header file cache, that keeps the\n");
+  pChar += rozofs_string_append(pChar,"// content of the recently accessed header files. 0 disables the cache.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_hdrcache_size,0,"0:(16*1024)");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_device_max_inflight,0);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Max number of files a STORIO processes in parallel on a same device.\n");
+  pChar += rozofs_string_append(pChar,"// When not 0, the files to process are queued per device and per priority\n");
+  pChar += rozofs_string_append(pChar,"// class, so a slow device can not hold every disk thread. 0 disables the\n");
+  pChar += rozofs_string_append(pChar,"// per device queues.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_device_max_inflight,0,"0:64");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_read_weight,8);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Weight of the foreground reads in the STORIO per device queues.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_sched_read_weight,8,"1:100");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_write_weight,8);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Weight of the foreground writes in the STORIO per device queues.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_sched_write_weight,8,"1:100");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_repair_weight,2);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Weight of the repairs in the STORIO per device queues.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_sched_repair_weight,2,"1:100");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_rebuild_weight,1);
+  if (isDefaultValue==0) pChar += rozofs_string_set_bold(pChar);
+  pChar += rozofs_string_append(pChar,"// Weight of the rebuilds in the STORIO per device queues.\n");
+  COMMON_CONFIG_SHOW_INT_OPT(storio_sched_rebuild_weight,1,"1:100");
+  if (isDefaultValue==0) pChar += rozofs_string_set_default(pChar);
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -806,6 +1004,21 @@ char * save_common_config_module_global(char * pChar) {
     pChar += rozofs_string_append(pChar,"// DSCP for exchanges from/to the EXPORTD.\n");
     COMMON_CONFIG_SHOW_INT_OPT(export_dscp,34,"0:34");
   }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(rpc_recv_ring_size,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Size in KB of the bulk receive ring of the RPC stream sockets. The\n");
+    pChar += rozofs_string_append(pChar,"// available data is read in a single system call into that ring, from\n");
+    pChar += rozofs_string_append(pChar,"// which the following RPC messages are then taken. 0 disables the ring.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(rpc_recv_ring_size,0,"0:1024");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(compress_threshold,1024);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Minimum size in bytes of the RPC messages that are compressed on the\n");
+    pChar += rozofs_string_append(pChar,"// connections where the compression is enabled.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(compress_threshold,1024,"64:(64*1024)");
+  }
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -971,6 +1184,29 @@ char * save_common_config_module_export(char * pChar) {
     pChar += rozofs_string_append(pChar,"// Whether file locks must be persistent on exportd restart/switchover or not\n");
     COMMON_CONFIG_SHOW_BOOL(persistent_file_locks,False);
   }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(export_dirent_cache_size,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Memory budget of the exportd dirent cache in MB. When the memory used by the\n");
+    pChar += rozofs_string_append(pChar,"// cached directory entries exceeds that budget, the less recently re-used directories\n");
+    pChar += rozofs_string_append(pChar,"// are released. 0 means no budget (the cache is only bounded by its number of entries).\n");
+    COMMON_CONFIG_SHOW_INT_OPT(export_dirent_cache_size,0,"0:(256*1024)");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(export_dirent_wbcache_entries,4096);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Number of entries of the exportd dirent write back cache (one entry per\n");
+    pChar += rozofs_string_append(pChar,"// dirent file with pending writes). It takes effect on the next exportd restart.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(export_dirent_wbcache_entries,4096,"64:(1024*1024)");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(export_warmup_snapshot_period,300);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Period in seconds of the snapshot of the hot FIDs and directory roots of the\n");
+    pChar += rozofs_string_append(pChar,"// exportd caches. At restart the exportd warms its caches up from that snapshot.\n");
+    pChar += rozofs_string_append(pChar,"// 0 disables the snapshot.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(export_warmup_snapshot_period,300,"0:86400");
+  }
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -1039,6 +1275,38 @@ char * save_common_config_module_client(char * pChar) {
     pChar += rozofs_string_append(pChar,"// statfs period in seconds. minimum is 0.\n");
     COMMON_CONFIG_SHOW_INT(statfs_period,10);
   }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_lbg_policy,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Policy used by the STORCLI to select the connection on which a request\n");
+    pChar += rozofs_string_append(pChar,"// is sent to a multi-port STORIO.\n");
+    pChar += rozofs_string_append(pChar,"// 0: round robin.\n");
+    pChar += rozofs_string_append(pChar,"// 1: least outstanding requests, then lowest smoothed response time.\n");
+    pChar += rozofs_string_append(pChar,"// 2: the least loaded of two randomly chosen connections.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_lbg_policy,0,"0:2");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(export_compress,False);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Whether the ROZOFSMOUNT requests the LZ4 compression of the RPC\n");
+    pChar += rozofs_string_append(pChar,"// messages exchanged with the EXPORTD. To be set on remote site clients\n");
+    pChar += rozofs_string_append(pChar,"// that reach the EXPORTD through a bandwidth limited link.\n");
+    COMMON_CONFIG_SHOW_BOOL(export_compress,False);
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(storio_compress,False);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Whether the STORCLI requests the LZ4 compression of the RPC messages\n");
+    pChar += rozofs_string_append(pChar,"// exchanged with the STORIO that are not on the local host.\n");
+    COMMON_CONFIG_SHOW_BOOL(storio_compress,False);
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(geo_compress,False);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Whether the geo-replication client requests the LZ4 compression of the\n");
+    pChar += rozofs_string_append(pChar,"// RPC messages exchanged with the EXPORTD.\n");
+    COMMON_CONFIG_SHOW_BOOL(geo_compress,False);
+  }
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -1225,6 +1493,77 @@ char * save_common_config_module_storage(char * pChar) {
     pChar += rozofs_string_append(pChar,"// Spare file restoring : Number of spare file context in 1K unit\n");
     COMMON_CONFIG_SHOW_INT(spare_restore_spare_ctx,16);
   }
+
+  COMMON_CONFIG_IS_DEFAULT_BOOL(storio_write_coalescing,True);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Whether the STORIO disk threads merge the pending contiguous write requests\n");
+    pChar += rozofs_string_append(pChar,"// of a file into a single disk write.\n");
+    COMMON_CONFIG_SHOW_BOOL(storio_write_coalescing,True);
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_prjcache_size,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Memory budget in MB of the STORIO projection cache, that keeps the first\n");
+    pChar += rozofs_string_append(pChar,"// projection blocks of the recently read files. 0 disables the cache.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_prjcache_size,0,"0:(64*1024)");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_direct_io,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Direct I/O (O_DIRECT) mode of the STORIO on the bins files.\n");
+    pChar += rozofs_string_append(pChar,"// 0: every I/O goes through the page cache.\n");
+    pChar += rozofs_string_append(pChar,"// 1: the rebuild writes bypass the page cache.\n");
+    pChar += rozofs_string_append(pChar,"// 2: every bins file read and write bypasses the page cache.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_direct_io,0,"0:2");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(remove_bulk_rate,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Max number of files per second that a storaged remove thread deletes\n");
+    pChar += rozofs_string_append(pChar,"// when processing the bulk remove requests of the exportd.\n");
+    pChar += rozofs_string_append(pChar,"// 0 means no limit.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(remove_bulk_rate,0,"0:100000");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_hdrcache_size,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Memory budget in MB of the STORIO header file cache, that keeps the\n");
+    pChar += rozofs_string_append(pChar,"// content of the recently accessed header files. 0 disables the cache.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_hdrcache_size,0,"0:(16*1024)");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_device_max_inflight,0);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Max number of files a STORIO processes in parallel on a same device.\n");
+    pChar += rozofs_string_append(pChar,"// When not 0, the files to process are queued per device and per priority\n");
+    pChar += rozofs_string_append(pChar,"// class, so a slow device can not hold every disk thread. 0 disables the\n");
+    pChar += rozofs_string_append(pChar,"// per device queues.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_device_max_inflight,0,"0:64");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_read_weight,8);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Weight of the foreground reads in the STORIO per device queues.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_sched_read_weight,8,"1:100");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_write_weight,8);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Weight of the foreground writes in the STORIO per device queues.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_sched_write_weight,8,"1:100");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_repair_weight,2);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Weight of the repairs in the STORIO per device queues.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_sched_repair_weight,2,"1:100");
+  }
+
+  COMMON_CONFIG_IS_DEFAULT_INT(storio_sched_rebuild_weight,1);
+  if (isDefaultValue==0) {
+    pChar += rozofs_string_append(pChar,"// Weight of the rebuilds in the STORIO per device queues.\n");
+    COMMON_CONFIG_SHOW_INT_OPT(storio_sched_rebuild_weight,1,"1:100");
+  }
   return pChar;
 }
 /*____________________________________________________________________________________________
@@ -1545,6 +1884,13 @@ static inline void common_config_generated_read(char * fname) {
   COMMON_CONFIG_READ_INT_MINMAX(storio_dscp,46,0,46);
   // DSCP for exchanges from/to the EXPORTD. 
   COMMON_CONFIG_READ_INT_MINMAX(export_dscp,34,0,34);
+  // Size in KB of the bulk receive ring of the RPC stream sockets. The 
+  // available data is read in a single system call into that ring, from 
+  // which the following RPC messages are then taken. 0 disables the ring. 
+  COMMON_CONFIG_READ_INT_MINMAX(rpc_recv_ring_size,0,0,1024);
+  // Minimum size in bytes of the RPC messages that are compressed on the 
+  // connections where the compression is enabled. 
+  COMMON_CONFIG_READ_INT_MINMAX(compress_threshold,1024,64,(64*1024));
   /*
   ** export scope configuration parameters
   */
@@ -1603,6 +1949,17 @@ static inline void common_config_generated_read(char * fname) {
   COMMON_CONFIG_READ_INT_MINMAX(level2_cache_max_entries_kb,512,1,4096);
   // Whether file locks must be persistent on exportd restart/switchover or not 
   COMMON_CONFIG_READ_BOOL(persistent_file_locks,False);
+  // Memory budget of the exportd dirent cache in MB. When the memory used by the 
+  // cached directory entries exceeds that budget, the less recently re-used directories 
+  // are released. 0 means no budget (the cache is only bounded by its number of entries). 
+  COMMON_CONFIG_READ_INT_MINMAX(export_dirent_cache_size,0,0,(256*1024));
+  // Number of entries of the exportd dirent write back cache (one entry per 
+  // dirent file with pending writes). It takes effect on the next exportd restart. 
+  COMMON_CONFIG_READ_INT_MINMAX(export_dirent_wbcache_entries,4096,64,(1024*1024));
+  // Period in seconds of the snapshot of the hot FIDs and directory roots of the 
+  // exportd caches. At restart the exportd warms its caches up from that snapshot. 
+  // 0 disables the snapshot. 
+  COMMON_CONFIG_READ_INT_MINMAX(export_warmup_snapshot_period,300,0,86400);
   /*
   ** client scope configuration parameters
   */
@@ -1624,6 +1981,22 @@ static inline void common_config_generated_read(char * fname) {
   COMMON_CONFIG_READ_BOOL(async_setattr,False);
   // statfs period in seconds. minimum is 0. 
   COMMON_CONFIG_READ_INT(statfs_period,10);
+  // Policy used by the STORCLI to select the connection on which a request 
+  // is sent to a multi-port STORIO. 
+  // 0: round robin. 
+  // 1: least outstanding requests, then lowest smoothed response time. 
+  // 2: the least loaded of two randomly chosen connections. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_lbg_policy,0,0,2);
+  // Whether the ROZOFSMOUNT requests the LZ4 compression of the RPC 
+  // messages exchanged with the EXPORTD. To be set on remote site clients 
+  // that reach the EXPORTD through a bandwidth limited link. 
+  COMMON_CONFIG_READ_BOOL(export_compress,False);
+  // Whether the STORCLI requests the LZ4 compression of the RPC messages 
+  // exchanged with the STORIO that are not on the local host. 
+  COMMON_CONFIG_READ_BOOL(storio_compress,False);
+  // Whether the geo-replication client requests the LZ4 compression of the 
+  // RPC messages exchanged with the EXPORTD. 
+  COMMON_CONFIG_READ_BOOL(geo_compress,False);
   /*
   ** storage scope configuration parameters
   */
@@ -1695,6 +2068,37 @@ static inline void common_config_generated_read(char * fname) {
   COMMON_CONFIG_READ_INT(storio_fidctx_ctx,256);
   // Spare file restoring : Number of spare file context in 1K unit 
   COMMON_CONFIG_READ_INT(spare_restore_spare_ctx,16);
+  // Whether the STORIO disk threads merge the pending contiguous write requests 
+  // of a file into a single disk write. 
+  COMMON_CONFIG_READ_BOOL(storio_write_coalescing,True);
+  // Memory budget in MB of the STORIO projection cache, that keeps the first 
+  // projection blocks of the recently read files. 0 disables the cache. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_prjcache_size,0,0,(64*1024));
+  // Direct I/O (O_DIRECT) mode of the STORIO on the bins files. 
+  // 0: every I/O goes through the page cache. 
+  // 1: the rebuild writes bypass the page cache. 
+  // 2: every bins file read and write bypasses the page cache. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_direct_io,0,0,2);
+  // Max number of files per second that a storaged remove thread deletes 
+  // when processing the bulk remove requests of the exportd. 
+  // 0 means no limit. 
+  COMMON_CONFIG_READ_INT_MINMAX(remove_bulk_rate,0,0,100000);
+  // Memory budget in MB of the STORIO header file cache, that keeps the 
+  // content of the recently accessed header files. 0 disables the cache. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_hdrcache_size,0,0,(16*1024));
+  // Max number of files a STORIO processes in parallel on a same device. 
+  // When not 0, the files to process are queued per device and per priority 
+  // class, so a slow device can not hold every disk thread. 0 disables the 
+  // per device queues. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_device_max_inflight,0,0,64);
+  // Weight of the foreground reads in the STORIO per device queues. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_sched_read_weight,8,1,100);
+  // Weight of the foreground writes in the STORIO per device queues. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_sched_write_weight,8,1,100);
+  // Weight of the repairs in the STORIO per device queues. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_sched_repair_weight,2,1,100);
+  // Weight of the rebuilds in the STORIO per device queues. 
+  COMMON_CONFIG_READ_INT_MINMAX(storio_sched_rebuild_weight,1,1,100);
  
   config_destroy(&cfg);
 }
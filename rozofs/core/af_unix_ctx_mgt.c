@@ -32,6 +32,7 @@
 #include "uma_dbg_api.h"
 #include "af_unix_socket_generic.h"
 #include "af_unix_socket_generic_api.h"
+#include "af_unix_socket_compress.h"
 
 af_unix_ctx_generic_t *af_unix_context_freeListHead; /**< head of list of the free context  */
 af_unix_ctx_generic_t af_unix_context_activeListHead; /**< list of the active context     */
@@ -379,6 +380,11 @@ void af_unix_debug_show_one(char *pChar, af_unix_ctx_generic_t *sock_p) {
   pChar += sprintf(pChar, "    totalXmitSuccess   : %16llu\n", (unsigned long long int) stats_p->totalXmitSuccess);
   pChar += sprintf(pChar, "    totalXmitCongested : %16llu\n", (unsigned long long int) stats_p->totalXmitCongested);
   pChar += sprintf(pChar, "    totalXmitError     : %16llu\n", (unsigned long long int) stats_p->totalXmitError);
+  pChar += sprintf(pChar, "    totalXmitBatches   : %16llu (%llu msg/batch)\n", 
+                  (unsigned long long int) stats_p->totalXmitBatches,
+                  (stats_p->totalXmitBatches==0)?0:(unsigned long long int)(stats_p->totalXmitBatched/stats_p->totalXmitBatches));
+  pChar += sprintf(pChar, "    syscalls/100 msg   : %16llu\n", 
+                  (stats_p->totalXmitSuccess==0)?0:(unsigned long long int)((stats_p->totalXmitAttempts*100)/stats_p->totalXmitSuccess));
 
   /*
    ** xmit side
@@ -392,6 +398,28 @@ void af_unix_debug_show_one(char *pChar, af_unix_ctx_generic_t *sock_p) {
   pChar += sprintf(pChar, "    totalRecvError     : %16llu\n", (unsigned long long int) stats_p->totalRecvError);
   pChar += sprintf(pChar, "    totalRecvPartial   : %16llu\n", (unsigned long long int) stats_p->partialRecv);
   pChar += sprintf(pChar, "    totalRecvEmpty     : %16llu\n", (unsigned long long int) stats_p->emptyRecv);
+  if (sock_p->recv.ring != NULL) {
+    pChar += sprintf(pChar, "    totalRecvRing      : %16llu (%llu msg/recv)\n", 
+                    (unsigned long long int) stats_p->ringRecv,
+                    (stats_p->ringRecv==0)?0:(unsigned long long int)(stats_p->totalRecvSuccess/stats_p->ringRecv));
+    pChar += sprintf(pChar, "    totalRecvRingCopy  : %16llu bytes\n", 
+                    (unsigned long long int) stats_p->ringCopyBytes);
+  }
+  if ((sock_p->compress.requested) || (sock_p->compress.active) || (sock_p->compress.stats.fallbacks)) {
+    com_compress_stats_t *zstats_p = &sock_p->compress.stats;
+    pChar += sprintf(pChar, "   compression           : %s\n", sock_p->compress.active?"on":
+                     sock_p->compress.requested?"waiting for the peer":"not supported by the peer");
+    pChar += sprintf(pChar, "    compressFallback   : %16llu\n", 
+                    (unsigned long long int) zstats_p->fallbacks);
+    pChar += sprintf(pChar, "    compressXmit       : %16llu (%llu -> %llu bytes)\n", 
+                    (unsigned long long int) zstats_p->xmitRecords,
+                    (unsigned long long int) zstats_p->xmitInBytes,
+                    (unsigned long long int) zstats_p->xmitOutBytes);
+    pChar += sprintf(pChar, "    compressRecv       : %16llu (%llu -> %llu bytes)\n", 
+                    (unsigned long long int) zstats_p->recvRecords,
+                    (unsigned long long int) zstats_p->recvInBytes,
+                    (unsigned long long int) zstats_p->recvOutBytes);
+  }
 }
 ruc_obj_desc_t * next_display_af_unix_ctx = NULL;
 /*__________________________________________________________________________
@@ -531,6 +559,7 @@ void af_unix_debug_init() {
 
     uma_dbg_addTopicAndMan("tcp_info", af_inet_tcp_debug, af_inet_tcp_debug_show_man, 0);
     uma_dbg_addTopicAndMan("tcp_short", af_inet_tcp_short_debug, af_inet_tcp_short_debug_show_man, 0);
+    af_unix_compress_debug_init();
 
 }
 
@@ -721,6 +750,15 @@ void af_unix_ctxInit(af_unix_ctx_generic_t *p, uint8_t creation) {
     recv_p->nb2read = 0;
     recv_p->bufRefCurrent = NULL;
     recv_p->state = RECV_IDLE;
+    /*
+     ** the bulk receive ring is kept from a context use to the next one
+     */
+    if (creation) {
+      recv_p->ring = NULL;
+      recv_p->ring_size = 0;
+    }
+    recv_p->ring_rd = 0;
+    recv_p->ring_wr = 0;
     /*
      ** clear the rpc part of the stream receiver
      */
@@ -738,6 +776,20 @@ void af_unix_ctxInit(af_unix_ctx_generic_t *p, uint8_t creation) {
      */
     stats_p = &p->stats;
     memset(stats_p, 0, sizeof (rozofs_socket_stats_t));
+    /*
+     ** the compression arrays are kept from a context use to the next one
+     */
+    if (creation) {
+      p->compress.zxmit = NULL;
+      p->compress.zxmit_size = 0;
+      p->compress.zrecv = NULL;
+      p->compress.zrecv_size = 0;
+    }
+    p->compress.requested = 0;
+    p->compress.active = 0;
+    p->compress.xmit_current = 0;
+    p->compress.probing = 0;
+    memset(&p->compress.stats, 0, sizeof (com_compress_stats_t));
 
     p->cnx_supevision.u64 = 0;
     p->cnx_availability_state = AF_UNIX_CNX_AVAILABLE;
@@ -31,6 +31,7 @@
 #include "ruc_list.h"
 #include "af_unix_socket_generic.h"
 #include "af_unix_socket_generic_api.h"
+#include "af_unix_socket_compress.h"
 #include "af_inet_stream_api.h"
 
 /**
@@ -227,6 +228,10 @@ uint32_t af_unix_generic_cli_connectReply_CBK(void * socket_ctx_p,int socketId)
       */
       sock_p->xmit.state = XMIT_READY;
       sock_p->recv.state = RECV_IDLE;
+      /*
+      ** ask for the compression when requested
+      */
+      af_unix_compress_connected(sock_p);
       if (sock_p->userPollingCallBack)
       {
 	    sock_p->cnx_availability_state = AF_UNIX_CNX_UNAVAILABLE;
@@ -592,6 +597,15 @@ void af_unix_sock_stream_disconnect_internal(af_unix_ctx_generic_t *socket_p)
    com_xmit_template_t *xmit_p = &socket_p->xmit;
    int inuse;
    /*
+   ** drop what remains from that connection in the bulk receive ring
+   */
+   socket_p->recv.ring_rd = 0;
+   socket_p->recv.ring_wr = 0;
+   /*
+   ** the compression is negotiated again on the next connection
+   */
+   af_unix_compress_disconnected(socket_p);
+   /*
    ** set the path as unavailable and call any associated callback
    */
    if (socket_p->cnx_availability_state  != AF_UNIX_CNX_UNAVAILABLE)
@@ -0,0 +1,363 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <lz4.h>
+#include <rozofs/common/log.h>
+#include <rozofs/common/common_config.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include <rozofs/core/rozofs_string.h>
+
+#include "ruc_buffer_api.h"
+#include "af_unix_socket_compress.h"
+
+extern af_unix_ctx_generic_t af_unix_context_activeListHead;
+
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Make sure a scratch array is at least size bytes long
+
+  @param area: the array
+  @param area_size: its allocated size
+  @param size: the size required
+
+  @retval 0 on success
+  @retval -1 when out of memory
+*/
+static inline int af_unix_compress_reserve(char **area, uint32_t *area_size, uint32_t size)
+{
+  char *p;
+
+  if (*area_size >= size) return 0;
+  p = realloc(*area, size);
+  if (p == NULL) return -1;
+  *area      = p;
+  *area_size = size;
+  return 0;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Request or stop the compression on a client connection. Takes effect
+   on the next connection establishment
+
+  @param sock_p: the socket context
+  @param enable: 1 to request the compression, 0 to stop it
+*/
+void af_unix_compress_request(af_unix_ctx_generic_t *sock_p, int enable)
+{
+  sock_p->compress.requested = enable ? 1 : 0;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Called when a client connection comes up: sends the probe when the
+   compression is requested
+
+  @param sock_p: the socket context
+*/
+void af_unix_compress_connected(af_unix_ctx_generic_t *sock_p)
+{
+  uint32_t probe;
+  int      len;
+
+  sock_p->compress.active       = 0;
+  sock_p->compress.xmit_current = 0;
+  sock_p->compress.probing      = 0;
+  if (sock_p->compress.requested == 0) return;
+  if (sock_p->recv.rpc.receiver_active == 0) return;
+  /*
+  ** Nothing has been sent on that fresh connection yet, so the probe
+  ** goes directly to the socket ahead of the first rpc message
+  */
+  probe = htonl(AF_UNIX_RPC_LAST_RECORD | AF_UNIX_RPC_COMPRESSED);
+  if (af_unix_send_stream_generic(sock_p->socketRef,(char*)&probe,sizeof(probe),&len) != RUC_OK)
+  {
+    warning("%s: cannot send the compression probe",sock_p->nickname);
+    return;
+  }
+  sock_p->compress.probing = 1;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Called when a connection goes down.
+
+   A server that does not support the compression drops the connection on
+   the probe. So when a client connection goes down before the answer to
+   the probe, the compression is no longer requested on that connection
+   and the next connection comes up uncompressed.
+
+  @param sock_p: the socket context
+*/
+void af_unix_compress_disconnected(af_unix_ctx_generic_t *sock_p)
+{
+  if (sock_p->compress.probing)
+  {
+    warning("%s: connection lost before the answer to the compression probe, going on uncompressed",
+            sock_p->nickname);
+    sock_p->compress.requested = 0;
+    sock_p->compress.stats.fallbacks++;
+  }
+  sock_p->compress.probing      = 0;
+  sock_p->compress.active       = 0;
+  sock_p->compress.xmit_current = 0;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Compress the rpc message of a buffer to send in the zxmit array of
+   the socket
+
+  @param sock_p: the socket context
+  @param bufRef: the buffer to send
+
+  @retval the length to send from zxmit, 0 when the buffer must be sent as is
+*/
+int af_unix_compress_xmit(af_unix_ctx_generic_t *sock_p, void *bufRef)
+{
+  com_compress_template_t *z = &sock_p->compress;
+  uint8_t  *pbuf;
+  int       len;
+  int       clen;
+  uint32_t  word;
+  uint64_t  cycles;
+
+  len = (int)ruc_buf_getPayloadLen(bufRef);
+  if (len < common_config.compress_threshold) return 0;
+  /*
+  ** Only a message made of a single record is compressed
+  */
+  pbuf = (uint8_t*)ruc_buf_getPayload(bufRef);
+  memcpy(&word,pbuf,sizeof(word));
+  if (ntohl(word) != (AF_UNIX_RPC_LAST_RECORD | (len - 4))) return 0;
+
+  if (af_unix_compress_reserve(&z->zxmit,&z->zxmit_size,len) != 0) return 0;
+  /*
+  ** The compressed record must be shorter than the message
+  */
+  cycles = ruc_rdtsc();
+  clen = LZ4_compress_default((char*)pbuf+4, z->zxmit+AF_UNIX_RPC_ZHDR_SIZE,
+                              len-4, len-AF_UNIX_RPC_ZHDR_SIZE-1);
+  z->stats.xmitCycles += (ruc_rdtsc() - cycles);
+  if (clen <= 0)
+  {
+    z->stats.xmitSkipped++;
+    return 0;
+  }
+  word = htonl(AF_UNIX_RPC_LAST_RECORD | AF_UNIX_RPC_COMPRESSED | (clen + 4));
+  memcpy(z->zxmit,&word,sizeof(word));
+  word = htonl(len - 4);
+  memcpy(z->zxmit+4,&word,sizeof(word));
+
+  z->stats.xmitRecords++;
+  z->stats.xmitInBytes  += len;
+  z->stats.xmitOutBytes += clen + AF_UNIX_RPC_ZHDR_SIZE;
+  return clen + AF_UNIX_RPC_ZHDR_SIZE;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Process a received probe
+
+   On a client connection, this is the answer of the server: the
+   compression is agreed. On a server connection, the probe is sent back
+   to the client.
+
+  @param sock_p: the socket context
+
+  @retval 0 on success
+  @retval -1 when the probe can not be sent back
+*/
+static int af_unix_compress_recv_probe(af_unix_ctx_generic_t *sock_p)
+{
+  uint32_t probe;
+  int      len;
+
+  if (sock_p->compress.requested)
+  {
+    sock_p->compress.probing = 0;
+    sock_p->compress.active  = 1;
+    return 0;
+  }
+  /*
+  ** The client sends the probe before its first rpc message, so nothing
+  ** should be on the way to it yet
+  */
+  if (sock_p->compress.active) return 0;
+  if ((sock_p->xmit.bufRefCurrent != NULL) || (sock_p->xmit.state != XMIT_READY))
+  {
+    warning("%s: compression probe received while sending",sock_p->nickname);
+    return 0;
+  }
+  probe = htonl(AF_UNIX_RPC_LAST_RECORD | AF_UNIX_RPC_COMPRESSED);
+  if (af_unix_send_stream_generic(sock_p->socketRef,(char*)&probe,sizeof(probe),&len) != RUC_OK)
+  {
+    return -1;
+  }
+  sock_p->compress.active = 1;
+  return 0;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Start the reception of a compressed record, after its record mark
+
+  @param sock_p: the socket context
+  @param record_len: length of the record (without the flags)
+
+  @retval 0 on success: the receiver state is set accordingly
+  @retval -1 on a bad record: the connection must be closed
+*/
+int af_unix_compress_recv_start(af_unix_ctx_generic_t *sock_p, uint32_t record_len)
+{
+  com_recv_template_t *recv_p = &sock_p->recv;
+
+  if (record_len == 0)
+  {
+    recv_p->state = RECV_IDLE;
+    return af_unix_compress_recv_probe(sock_p);
+  }
+  if ((record_len <= 4) || (record_len > recv_p->rpc.max_receive_sz)) return -1;
+
+  if (af_unix_compress_reserve(&sock_p->compress.zrecv,&sock_p->compress.zrecv_size,record_len) != 0)
+  {
+    severe("%s: out of memory for a %u bytes compressed record",sock_p->nickname,record_len);
+    return -1;
+  }
+  recv_p->nbread  = 0;
+  recv_p->nb2read = record_len;
+  recv_p->state   = RECV_ZPAYLOAD;
+  return 0;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Decompress the received record in the buffer of the rpc message
+
+  @param sock_p: the socket context
+  @param dst: where to write the rpc message after its record mark
+  @param msg_len: length of the rpc message without its record mark
+  @param record_len: length of the received record
+
+  @retval 0 on success
+  @retval -1 when the record is corrupted
+*/
+int af_unix_compress_recv_decode(af_unix_ctx_generic_t *sock_p, uint8_t *dst,
+                                 uint32_t msg_len, uint32_t record_len)
+{
+  com_compress_template_t *z = &sock_p->compress;
+  uint64_t                 cycles;
+  int                      len;
+
+  cycles = ruc_rdtsc();
+  len = LZ4_decompress_safe(z->zrecv+4, (char*)dst, record_len-4, msg_len);
+  z->stats.recvCycles += (ruc_rdtsc() - cycles);
+  if ((len < 0) || ((uint32_t)len != msg_len))
+  {
+    z->stats.recvErrors++;
+    return -1;
+  }
+  z->stats.recvRecords++;
+  z->stats.recvInBytes  += record_len + 4;
+  z->stats.recvOutBytes += msg_len + 4;
+  return 0;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  rozodiag: display the compression of the connections
+*/
+static char * af_unix_compress_debug_ratio(char * p, uint64_t records, uint64_t before, uint64_t after, uint64_t cycles) {
+
+  p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, records);
+  p += rozofs_string_append(p, " | ");
+  p += rozofs_u64_padded_append(p, 5, rozofs_right_alignment, (before==0)?0:(after*100)/before);
+  p += rozofs_string_append(p, "% | ");
+  p += rozofs_u64_padded_append(p, 9, rozofs_right_alignment, (before==0)?0:(cycles*1024)/before);
+  p += rozofs_string_append(p, " | ");
+  return p;
+}
+static void af_unix_compress_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char                  * p = uma_dbg_get_buffer();
+  af_unix_ctx_generic_t * sock_p;
+  com_compress_stats_t  * st;
+  ruc_obj_desc_t        * pnext = NULL;
+  int                     doreset = 0;
+
+  if ((argv[1] != NULL) && (strcmp(argv[1],"reset")==0)) doreset = 1;
+
+  p += rozofs_string_append(p, "threshold ");
+  p += rozofs_u32_append(p, common_config.compress_threshold);
+  p += rozofs_string_append(p, " bytes - ratio is the size after compression - cost is in cpu cycles per KB before compression\n");
+  p += rozofs_string_append(p, "+--------------------------------+-------+------------+--------+-----------+------------+------------+--------+-----------+--------+----------+\n");
+  p += rozofs_string_append(p, "| connection                     | state |  xmit rec  | ratio  | cost/KB   |  skipped   |  recv rec  | ratio  | cost/KB   | errors | fallback |\n");
+  p += rozofs_string_append(p, "+--------------------------------+-------+------------+--------+-----------+------------+------------+--------+-----------+--------+----------+\n");
+
+  while ((sock_p = (af_unix_ctx_generic_t*) ruc_objGetNext(&af_unix_context_activeListHead.link,&pnext))
+          != (af_unix_ctx_generic_t*) NULL) {
+    st = &sock_p->compress.stats;
+
+    if ((sock_p->compress.requested == 0) && (sock_p->compress.active == 0)
+     && (st->xmitRecords == 0) && (st->recvRecords == 0) && (st->recvErrors == 0)
+     && (st->fallbacks == 0)) continue;
+
+    p += rozofs_string_append(p, "| ");
+    p += rozofs_string_padded_append(p, 30, rozofs_left_alignment, sock_p->nickname);
+    p += rozofs_string_append(p, " | ");
+    if (sock_p->compress.active)         p += rozofs_string_append(p, " on  ");
+    else if (sock_p->compress.requested) p += rozofs_string_append(p, "wait ");
+    else                                 p += rozofs_string_append(p, " off ");
+    p += rozofs_string_append(p, " | ");
+    p = af_unix_compress_debug_ratio(p, st->xmitRecords, st->xmitInBytes, st->xmitOutBytes, st->xmitCycles);
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->xmitSkipped);
+    p += rozofs_string_append(p, " | ");
+    p = af_unix_compress_debug_ratio(p, st->recvRecords, st->recvOutBytes, st->recvInBytes, st->recvCycles);
+    p += rozofs_u64_padded_append(p, 6, rozofs_right_alignment, st->recvErrors);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 8, rozofs_right_alignment, st->fallbacks);
+    p += rozofs_string_append(p, " |\n");
+
+    if (doreset) memset(st, 0, sizeof(com_compress_stats_t));
+  }
+  p += rozofs_string_append(p, "+--------------------------------+-------+------------+--------+-----------+------------+------------+--------+-----------+--------+----------+\n");
+  if (doreset) {
+    p += rozofs_string_append(p, "Reset Done\n");
+  }
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Register the "compress" rozodiag topic
+*/
+void af_unix_compress_debug_init() {
+  uma_dbg_addTopic_option("compress", af_unix_compress_debug, UMA_DBG_OPTION_RESET);
+}
@@ -0,0 +1,157 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+#ifndef AF_UNIX_SOCKET_COMPRESS_H
+#define AF_UNIX_SOCKET_COMPRESS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <stdint.h>
+#include "ruc_common.h"
+#include "af_unix_socket_generic.h"
+
+/*
+** LZ4 compression of the rpc records of a stream connection
+**
+** A compressed rpc message is sent as a single last record whose record
+** mark has also the AF_UNIX_RPC_COMPRESSED bit set. The record holds the
+** length of the rpc message before compression followed by the LZ4 block:
+**
+**   [ LAST|COMPRESSED|record length ][ message length ][ LZ4 block ]
+**
+** The compression is negotiated when a client connection comes up: a
+** client that asks for the compression sends an empty compressed record
+** (the probe) before anything else. The server sends the probe back and
+** both ends then compress the rpc messages that are longer than the
+** compress_threshold configuration parameter. A message that does not
+** get smaller is sent as is. The receiver rebuilds the uncompressed rpc
+** message before giving it to the application.
+**
+** A server that does not support the compression drops the connection on
+** the probe. When a client connection goes down before the answer to the
+** probe, the compression is no longer requested on that connection and
+** the client reconnects uncompressed. Such fallbacks are counted.
+*/
+#define AF_UNIX_RPC_LAST_RECORD   0x80000000  /**< last record of an rpc message       */
+#define AF_UNIX_RPC_COMPRESSED    0x40000000  /**< the record holds a compressed message */
+#define AF_UNIX_RPC_ZHDR_SIZE     8           /**< record mark + message length          */
+
+#ifdef ROZOFS_LZ4
+
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Request or stop the compression on a client connection. Takes effect
+   on the next connection establishment
+
+  @param sock_p: the socket context
+  @param enable: 1 to request the compression, 0 to stop it
+*/
+void af_unix_compress_request(af_unix_ctx_generic_t *sock_p, int enable);
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Called when a client connection comes up: sends the probe when the
+   compression is requested
+
+  @param sock_p: the socket context
+*/
+void af_unix_compress_connected(af_unix_ctx_generic_t *sock_p);
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Called when a connection goes down: stops requesting the compression
+   when the connection is lost before the answer to the probe
+
+  @param sock_p: the socket context
+*/
+void af_unix_compress_disconnected(af_unix_ctx_generic_t *sock_p);
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Compress the rpc message of a buffer to send in the zxmit array of
+   the socket
+
+  @param sock_p: the socket context
+  @param bufRef: the buffer to send
+
+  @retval the length to send from zxmit, 0 when the buffer must be sent as is
+*/
+int af_unix_compress_xmit(af_unix_ctx_generic_t *sock_p, void *bufRef);
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Start the reception of a compressed record, after its record mark
+
+  @param sock_p: the socket context
+  @param record_len: length of the record (without the flags)
+
+  @retval 0 on success: the receiver state is set accordingly
+  @retval -1 on a bad record: the connection must be closed
+*/
+int af_unix_compress_recv_start(af_unix_ctx_generic_t *sock_p, uint32_t record_len);
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Decompress the received record in the buffer of the rpc message
+
+  @param sock_p: the socket context
+  @param dst: where to write the rpc message after its record mark
+  @param msg_len: length of the rpc message without its record mark
+  @param record_len: length of the received record
+
+  @retval 0 on success
+  @retval -1 when the record is corrupted
+*/
+int af_unix_compress_recv_decode(af_unix_ctx_generic_t *sock_p, uint8_t *dst,
+                                 uint32_t msg_len, uint32_t record_len);
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Register the "compress" rozodiag topic
+*/
+void af_unix_compress_debug_init();
+
+#else
+/*
+** Built without LZ4: the compression is never requested, and a compressed
+** record (the probe of a client) is a bad record that drops the connection
+*/
+static inline void af_unix_compress_request(af_unix_ctx_generic_t *sock_p, int enable) {}
+static inline void af_unix_compress_connected(af_unix_ctx_generic_t *sock_p) {}
+static inline void af_unix_compress_disconnected(af_unix_ctx_generic_t *sock_p) {}
+static inline int  af_unix_compress_xmit(af_unix_ctx_generic_t *sock_p, void *bufRef) { return 0; }
+static inline int  af_unix_compress_recv_start(af_unix_ctx_generic_t *sock_p, uint32_t record_len) { return -1; }
+static inline int  af_unix_compress_recv_decode(af_unix_ctx_generic_t *sock_p, uint8_t *dst,
+                                                uint32_t msg_len, uint32_t record_len) { return -1; }
+static inline void af_unix_compress_debug_init() {}
+#endif
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -166,6 +166,8 @@ typedef enum _com_recv_state_e
      RECV_ALLOC_BUF,     /**< allocate buffer for receiving message: might remain in that state if there is none available */
      RECV_PAYLOAD,       /**< message payload reception */
      RECV_DEAD,         /**< receiver is dead because of a fatal error on socket or buffer allocation   */
+     RECV_ZPAYLOAD,     /**< reception of a compressed rpc record */
+     RECV_ZALLOC_BUF,   /**< allocate the buffer of a compressed rpc record before decompressing it */
 } com_recv_state_e;
 
 
@@ -186,6 +188,8 @@ typedef struct rozofs_socket_stats_t
    uint64_t totalXmitSuccess;   /**< total number of messages submitted with success  */
    uint64_t totalXmitCongested; /**< total number of messages submitted for with EWOULDBLOCK is returned  */
    uint64_t totalXmitError;     /**< total number of messages submitted with an error  */
+   uint64_t totalXmitBatches;   /**< total number of sendmsg gathering several messages  */
+   uint64_t totalXmitBatched;   /**< total number of messages gathered in these sendmsg  */
 
    /*
    ** xmit side
@@ -199,6 +203,8 @@ typedef struct rozofs_socket_stats_t
    uint64_t totalRecvError;     /**< total number of messages submitted with an error  */
    uint64_t partialRecv;     /**< total of partial receive  */
    uint64_t emptyRecv;        /**< total of empty receive  */
+   uint64_t ringRecv;         /**< total of receive in the bulk receive ring  */
+   uint64_t ringCopyBytes;    /**< bytes copied from the bulk receive ring  */
 } rozofs_socket_stats_t;
 
 #define AF_UNIX_CONGESTION_DEFAULT_THRESHOLD 2  /**< number of loop before restarting to send after
@@ -271,9 +277,50 @@ typedef struct _com_recv_template_t
   **  dedicated RPC parameters
   */
   com_rpc_recv_template_t rpc;    /**< just to address the case of the rpc reception with multiple records */
+  /*
+  ** bulk receive ring of the rpc stream receiver (see af_unix_socket_stream_recv.c)
+  */
+  char          *ring;              /**< allocated on first use when rpc_recv_ring_size is set */
+  uint32_t       ring_size;         /**< size of the ring                              */
+  uint32_t       ring_rd;           /**< offset of the first byte not yet consumed     */
+  uint32_t       ring_wr;           /**< offset following the last received byte      */
 
 } com_recv_template_t;
 
+/**
+* Statistics of the compression of the rpc records of a stream connection
+*/
+typedef struct _com_compress_stats_t
+{
+   uint64_t xmitRecords;   /**< records sent compressed                                */
+   uint64_t xmitSkipped;   /**< records over the threshold that did not get smaller    */
+   uint64_t xmitInBytes;   /**< bytes of the compressed records before compression     */
+   uint64_t xmitOutBytes;  /**< bytes sent for the compressed records                  */
+   uint64_t xmitCycles;    /**< cpu cycles spent in compression                        */
+   uint64_t recvRecords;   /**< compressed records received                            */
+   uint64_t recvInBytes;   /**< bytes received for the compressed records              */
+   uint64_t recvOutBytes;  /**< bytes of the compressed records after decompression    */
+   uint64_t recvCycles;    /**< cpu cycles spent in decompression                      */
+   uint64_t recvErrors;    /**< records that could not be decompressed                 */
+   uint64_t fallbacks;     /**< connections lost before the answer to the probe        */
+} com_compress_stats_t;
+
+/**
+* Compression context of a stream connection (see af_unix_socket_compress.c)
+*/
+typedef struct _com_compress_template_t
+{
+  uint8_t       requested;     /**< asserted on a client connection that asks for compression */
+  uint8_t       active;        /**< asserted once the compression is agreed with the peer     */
+  uint8_t       xmit_current;  /**< asserted when the current xmit buffer is sent from zxmit  */
+  uint8_t       probing;       /**< asserted while the client waits for the answer to the probe */
+  char         *zxmit;         /**< compressed copy of the current xmit buffer                */
+  uint32_t      zxmit_size;    /**< allocated size of zxmit                                   */
+  char         *zrecv;         /**< compressed record being received                          */
+  uint32_t      zrecv_size;    /**< allocated size of zrecv                                   */
+  com_compress_stats_t stats;
+} com_compress_template_t;
+
 #define ROZOFS_SOCK_EXTNAME_SIZE 64
 #define AF_UNIX_SOCKET_NAME_SIZE 64
 
@@ -345,6 +392,7 @@ typedef struct _af_unix_ctx_generic_t
   com_xmit_template_t   xmit;
   com_recv_template_t   recv;
   rozofs_socket_stats_t stats;
+  com_compress_template_t compress;   /**< compression of the rpc records */
   af_inet_check_cnx_t   cnx_supevision; /**< supervision context */
   uint8_t               cnx_availability_state;  /**< operational state of the connection */ 
   uint8_t               dscp;          /**< dscp of the TCP connection */ 
@@ -820,6 +868,8 @@ uint32_t af_unix_recv_rpc_stream_generic_cbk(void * socket_pointer,int socketId)
 *  Socket stream transmit prototypes
 */
 uint32_t af_unix_send_stream_generic(int fd,char *pMsg,int lgth,int *len_sent_p);
+struct iovec;
+uint32_t af_unix_send_stream_vector_generic(int fd,struct iovec *iov,int iovcnt,int lgth,int *len_sent_p);
 void af_unix_send_stream_fsm(af_unix_ctx_generic_t *socket_p,com_xmit_template_t *xmit_p);
 
 /*
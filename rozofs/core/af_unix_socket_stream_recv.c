@@ -16,8 +16,10 @@
   <http://www.gnu.org/licenses/>.
  */
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <netdb.h>
 #include <signal.h>
@@ -30,7 +32,9 @@
 #include "ruc_common.h"
 #include <sys/un.h>
 #include "af_unix_socket_generic_api.h"
+#include "af_unix_socket_compress.h"
 #include <rozofs/common/log.h>
+#include <rozofs/common/common_config.h>
 extern uint64_t af_unix_rcv_buffered;
 
 /*__________________________________________________________________________
@@ -140,6 +144,205 @@ uint32_t af_unix_recv_stream_sock_recv(af_unix_ctx_generic_t  *sock_p, void *buf
    }
    return RUC_DISC;
 }
+/**
+*  Internal API for reading data from an AF_UNIX sock_stream socket into a vector
+
+ @param sock_p: pointer to the socket context
+ @param iov : the receive vector
+ @param iovcnt : number of entries in the vector
+ @param len_read : pointer where the function will write the length that has been extracted from the socket
+
+ @retval RUC_OK: the whole vector has been filled
+ @retval RUC_WOULDBLOCK : the socket is empty, no data have be read
+ @retval RUC_PARTIAL: just a part of the vector has been filled
+ @retval RUC_DISC: an error has been encountered while read the socket
+ */
+static uint32_t af_unix_recv_stream_sock_recvv(af_unix_ctx_generic_t  *sock_p, struct iovec *iov,int iovcnt,int *len_read)
+{
+   ssize_t bytesRcvd;
+   ssize_t len = 0;
+   int     eintr_count = 0;
+   int     i;
+
+   for (i = 0; i < iovcnt; i++) len += iov[i].iov_len;
+
+   while(1)
+   {
+     af_unix_rcv_buffered+=1;
+     bytesRcvd = readv(sock_p->socketRef,iov,iovcnt);
+     if (bytesRcvd == 0)
+     {
+       /*
+       ** the other has closed the socket
+       */
+       *len_read = 0;
+       return RUC_DISC;
+     }
+     if (bytesRcvd > 0)
+     {
+       *len_read = (int)bytesRcvd;
+       if (bytesRcvd == len) return RUC_OK;
+       return RUC_PARTIAL;
+     }
+     switch (errno)
+     {
+       case EAGAIN:
+        return RUC_WOULDBLOCK;
+
+       case EINTR:
+         eintr_count++;
+         if (eintr_count < 3) continue;
+         warning("af_unix_recv_stream_sock_recvv :too many EINTR %d",eintr_count);
+         sock_p->stats.totalRecvError++;
+         return RUC_DISC;
+
+       case EBADF:
+       case EFAULT:
+       case EINVAL:
+         sock_p->stats.totalRecvError++;
+         return RUC_DISC;
+         		
+       default:
+	 if ((errno!=ECONNRESET) || (af_unix_socket_log_remote_disconnection)) {
+           warning("af_unix_recv_stream_sock_recvv %s",strerror(errno));
+	 }  
+         sock_p->stats.totalRecvError++;
+         return RUC_DISC;
+     }
+   }
+   return RUC_DISC;
+}
+/*
+**__________________________________________________________________________
+** Bulk receive ring of the rpc stream receiver
+**
+** When rpc_recv_ring_size is set, the rpc stream receiver reads as much
+** as the socket holds into a per connection ring, and then takes the
+** record headers and the payloads of the following rpc messages from
+** that ring without any system call.
+**
+** When the ring is empty, the record header is read alone, so that
+** the payload is read straight into its receive buffer, and whatever
+** follows it on the socket goes into the ring by the same readv(). So
+** the payload of a big message (i.e. the bins of a write) lands directly
+** in the receive buffer that is handed to the application, and only the
+** bytes that were already in the ring are copied.
+**
+** The receiver processes every message that is in the ring before
+** leaving, whatever its credit, since the socket controller only
+** calls it back when the socket has some more data.
+**__________________________________________________________________________
+*/
+/**
+*  Allocate the ring of a receiver on its first use
+
+ @param recv_p: the receiver
+ */
+static inline void af_unix_recv_ring_alloc(com_recv_template_t *recv_p)
+{
+  if (recv_p->ring != NULL) return;
+  if (common_config.rpc_recv_ring_size == 0) return;
+
+  recv_p->ring = malloc(common_config.rpc_recv_ring_size*1024);
+  if (recv_p->ring == NULL) return;
+  recv_p->ring_size = common_config.rpc_recv_ring_size*1024;
+  recv_p->ring_rd   = 0;
+  recv_p->ring_wr   = 0;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Read data from a stream socket through the ring of its receiver
+
+ @param sock_p: pointer to the socket context
+ @param buf : pointer to the receive buffer
+ @param len : len to read
+ @param fill_ring : when the ring is empty, 1 to fill it with what follows the requested length
+ @param len_read : pointer where the function will write the length that has been read
+
+ @retval RUC_OK: the requested length has been read
+ @retval RUC_WOULDBLOCK : the socket and the ring are empty, no data have be read
+ @retval RUC_PARTIAL: just a part of the requested data have been read
+ @retval RUC_DISC: an error has been encountered while read the socket
+ */
+static inline uint32_t af_unix_recv_ring_recv(af_unix_ctx_generic_t  *sock_p, void *buf,int len,int fill_ring,int *len_read)
+{
+  com_recv_template_t *recv_p = &sock_p->recv;
+  uint32_t             status;
+  int                  avail;
+  struct iovec         iov[2];
+
+  if (recv_p->ring == NULL)
+  {
+    return af_unix_recv_stream_sock_recv(sock_p,buf,len,0,len_read);
+  }
+
+  avail = recv_p->ring_wr - recv_p->ring_rd;
+  if (avail == 0)
+  {
+    recv_p->ring_rd = 0;
+    recv_p->ring_wr = 0;
+    if (fill_ring == 0)
+    {
+      return af_unix_recv_stream_sock_recv(sock_p,buf,len,0,len_read);
+    }
+    /*
+    ** Read the expected bytes in place and fill the ring with what follows
+    */
+    iov[0].iov_base = buf;
+    iov[0].iov_len  = len;
+    iov[1].iov_base = recv_p->ring;
+    iov[1].iov_len  = recv_p->ring_size;
+    status = af_unix_recv_stream_sock_recvv(sock_p,iov,2,&avail);
+    if ((status != RUC_OK) && (status != RUC_PARTIAL))
+    {
+      *len_read = 0;
+      return status;
+    }
+    if (avail <= len)
+    {
+      *len_read = avail;
+      if (avail == len) return RUC_OK;
+      return RUC_PARTIAL;
+    }
+    sock_p->stats.ringRecv++;
+    recv_p->ring_wr = avail - len;
+    *len_read = len;
+    return RUC_OK;
+  }
+
+  if (avail > len) avail = len;
+  memcpy(buf,recv_p->ring+recv_p->ring_rd,avail);
+  sock_p->stats.ringCopyBytes += avail;
+  recv_p->ring_rd += avail;
+  *len_read = avail;
+  if (avail == len) return RUC_OK;
+  return RUC_PARTIAL;
+}
+
+
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Close a connection on which a bad rpc record has been received
+
+ @param sock_p: pointer to the socket context
+ */
+static inline void af_unix_recv_rpc_bad_record(af_unix_ctx_generic_t  *sock_p)
+{
+  /*
+  ** general disconnection: purge the xmit side
+  */
+  af_unix_sock_stream_disconnect_internal(sock_p);
+  sock_p->recv.state = RECV_DEAD;
+  sock_p->stats.totalRecvBadHeader++;
+  /*
+  ** the record is wrong, we have no choice we need to close the connection
+  */
+  (sock_p->userDiscCallBack)(sock_p->userRef,sock_p->index,NULL,errno);
+}
 
 
 /**
@@ -451,8 +654,9 @@ uint32_t af_unix_recv_rpc_stream_generic_cbk(void * socket_pointer,int socketId)
   recv_p = &sock_p->recv;
   recv_credit = recv_p->recv_credit_conf;
   rpc = &recv_p->rpc;
+  af_unix_recv_ring_alloc(recv_p);
 
-  while(recv_credit != 0)
+  while((recv_credit != 0) || (recv_p->ring_rd != recv_p->ring_wr))
   {
     switch (recv_p->state)
     {
@@ -480,8 +684,8 @@ uint32_t af_unix_recv_rpc_stream_generic_cbk(void * socket_pointer,int socketId)
         ** attempt to receive the full header to figure out what kind of receive buffer
         ** Must be allocated
         */
-        status = af_unix_recv_stream_sock_recv(sock_p,recv_p->buffer_header+recv_p->nbread,
-                                               recv_p->nb2read- recv_p->nbread ,0,&len_read);
+        status = af_unix_recv_ring_recv(sock_p,recv_p->buffer_header+recv_p->nbread,
+                                        recv_p->nb2read- recv_p->nbread,0,&len_read);
         switch(status)
         {
           case RUC_OK:
@@ -593,6 +797,18 @@ uint32_t af_unix_recv_rpc_stream_generic_cbk(void * socket_pointer,int socketId)
         */
         record_len_p = (uint32_t *)recv_p->buffer_header;    
         rpc->record_len = ntohl(*record_len_p);
+        if ((rpc->record_len & (AF_UNIX_RPC_LAST_RECORD|AF_UNIX_RPC_COMPRESSED)) == (AF_UNIX_RPC_LAST_RECORD|AF_UNIX_RPC_COMPRESSED))
+        {
+          /*
+          ** compressed rpc message (see af_unix_socket_compress.c)
+          */
+          if (af_unix_compress_recv_start(sock_p,rpc->record_len & ~(AF_UNIX_RPC_LAST_RECORD|AF_UNIX_RPC_COMPRESSED)) != 0)
+          {
+            af_unix_recv_rpc_bad_record(sock_p);
+            return TRUE;
+          }
+          break;
+        }
         if (rpc->record_len & (~0x7fffffff)) rpc->last_record = 1;
         rpc->record_len  &= 0x7fffffff;
         /*
@@ -638,10 +854,13 @@ uint32_t af_unix_recv_rpc_stream_generic_cbk(void * socket_pointer,int socketId)
         if (buf_recv_p == NULL)
         {
           /*
-          ** the receiver is out of buffer-> leave the message in the receiver queue and exit
+          ** the receiver is out of buffer-> leave the message in the receiver queue and exit.
+          ** When the ring already holds the message the socket may not be readable
+          ** any more: ask the socket controller to call the receiver again
           */
           sock_p->stats.totalRecvOutoFBuf++;
           recv_p->state = RECV_ALLOC_BUF;
+          if (recv_p->ring_rd != recv_p->ring_wr) ruc_sockCtrl_set_rcv_pending(sock_p->socketRef);
           return TRUE;
         }
         /*
@@ -677,8 +896,8 @@ uint32_t af_unix_recv_rpc_stream_generic_cbk(void * socket_pointer,int socketId)
         ** Must be allocated
         */
         payload_p = (uint8_t*)ruc_buf_getPayload(recv_p->bufRefCurrent);
-        status = af_unix_recv_stream_sock_recv(sock_p,payload_p+rpc->in_wr_offset+recv_p->nbread,
-                                               recv_p->nb2read- recv_p->nbread ,0,&len_read);
+        status = af_unix_recv_ring_recv(sock_p,payload_p+rpc->in_wr_offset+recv_p->nbread,
+                                        recv_p->nb2read- recv_p->nbread,1,&len_read);
         switch(status)
         {
           case RUC_OK:
@@ -766,6 +985,85 @@ uint32_t af_unix_recv_rpc_stream_generic_cbk(void * socket_pointer,int socketId)
         break;
       /*
       **_________________________________________________________________
+      ** reception of a compressed record
+      **_________________________________________________________________
+      */
+      case RECV_ZPAYLOAD:
+        status = af_unix_recv_ring_recv(sock_p,sock_p->compress.zrecv+recv_p->nbread,
+                                        recv_p->nb2read- recv_p->nbread,1,&len_read);
+        switch(status)
+        {
+          case RUC_OK:
+           sock_p->stats.totalRecvBytes += len_read;
+           recv_p->nbread += len_read;
+           recv_p->state = RECV_ZALLOC_BUF;
+           break;
+
+          case RUC_WOULDBLOCK:
+	   sock_p->stats.emptyRecv++;
+           return TRUE;
+
+          case RUC_PARTIAL:
+	  sock_p->stats.partialRecv++;
+          sock_p->stats.totalRecvBytes += len_read;
+          recv_p->nbread += len_read;
+          break;
+
+          case RUC_DISC:
+          default:
+          af_unix_sock_stream_disconnect_internal(sock_p);
+          recv_p->state = RECV_DEAD;
+          (sock_p->userDiscCallBack)(sock_p->userRef,sock_p->index,NULL,errno);
+          return TRUE;
+        }
+        break;
+
+      /*
+      **_________________________________________________________________
+      ** allocate the receive buffer of a compressed record and
+      ** decompress the record in it
+      **_________________________________________________________________
+      */
+      case RECV_ZALLOC_BUF:
+        record_len_p = (uint32_t *)sock_p->compress.zrecv;
+        payloadLen = ntohl(*record_len_p);
+        if (payloadLen > (rpc->max_receive_sz - recv_p->headerSize))
+        {
+          af_unix_recv_rpc_bad_record(sock_p);
+          return TRUE;
+        }
+        full_msg_len = payloadLen + recv_p->headerSize;
+        buf_recv_p = (sock_p->userRcvAllocBufCallBack)(sock_p->userRef,sock_p->index,full_msg_len);
+        if (buf_recv_p == NULL)
+        {
+          /*
+          ** the receiver is out of buffer-> keep the record and exit. The record
+          ** has already been read from the socket: ask the socket controller
+          ** to call the receiver again
+          */
+          sock_p->stats.totalRecvOutoFBuf++;
+          ruc_sockCtrl_set_rcv_pending(sock_p->socketRef);
+          return TRUE;
+        }
+        payload_p = (uint8_t*)ruc_buf_getPayload(buf_recv_p);
+        if (af_unix_compress_recv_decode(sock_p,payload_p+recv_p->headerSize,payloadLen,recv_p->nbread) != 0)
+        {
+          ruc_buf_freeBuffer(buf_recv_p);
+          af_unix_recv_rpc_bad_record(sock_p);
+          return TRUE;
+        }
+        ruc_sockCtrl_speculative_scheduler_decrement(sock_p->connectionId);
+        sock_p->stats.totalRecvSuccess++;
+        ruc_buf_setPayloadLen(buf_recv_p,(uint32_t)full_msg_len);
+        record_len_p = (uint32_t *)payload_p;
+        *record_len_p = htonl(payloadLen | AF_UNIX_RPC_LAST_RECORD);
+        (sock_p->userRcvCallBack)(sock_p->userRef,sock_p->index,buf_recv_p);
+        recv_p->state = RECV_IDLE;
+        recv_credit--;
+        break;
+
+      /*
+      **_________________________________________________________________
       ** Dead state of the receiver
       **_________________________________________________________________
       */
@@ -16,6 +16,7 @@
   <http://www.gnu.org/licenses/>.
  */
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <fcntl.h>
@@ -24,6 +25,7 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <unistd.h>
+#include <sys/uio.h>
 #include "uma_tcp.h"
 
 #include <rozofs/common/types.h>
@@ -31,8 +33,16 @@
 
 #include "ruc_common.h"
 #include "af_unix_socket_generic.h"
+#include "af_unix_socket_compress.h"
 #include "socketCtrl.h"
 
+/*
+** When the transmitter drains its pending queue, the buffers that wait
+** in the queue are gathered behind the current one into a single
+** sendmsg(), up to these limits
+*/
+#define AF_UNIX_XMIT_BATCH_MAX       64
+#define AF_UNIX_XMIT_BATCH_BYTES     (1024*1024)
 
 
  /*
@@ -108,6 +118,103 @@ uint32_t af_unix_send_stream_generic(int fd,char *pMsg,int lgth,int *len_sent_p)
   }
   return RUC_DISC;
  }
+ /*
+**__________________________________________________________________________
+*/
+/**
+ Send a set of buffers to a destination stream socket in a single system call
+
+
+  @param fd : source socket
+  @param iov: the buffers to send
+  @param iovcnt: number of buffers
+  @param lgth : total length to send
+  @param len_sent_p : contains the effective length
+
+@retval RUC_OK : every buffer sent
+@retval RUC_PARTIAL : buffers partially sent
+@retval RUC_WOULDBLOCK : congested (not sent)
+@retval RUC_DISC : bad destination
+**
+**--------------------------------------------
+*/
+uint32_t af_unix_send_stream_vector_generic(int fd,struct iovec *iov,int iovcnt,int lgth,int *len_sent_p)
+{
+  struct msghdr           msg;
+  int                     ret;
+
+  memset(&msg,0,sizeof(msg));
+  msg.msg_iov    = iov;
+  msg.msg_iovlen = iovcnt;
+
+  *len_sent_p = 0;
+  ret=sendmsg(fd,&msg,0);
+  if (ret == 0)
+  {
+     /*
+     ** the other end is probably dead
+     */
+     return RUC_DISC;
+  }
+  if (ret > 0)
+  {
+     *len_sent_p = ret;
+     if (ret == lgth) return RUC_OK;
+     return RUC_PARTIAL;
+  }
+  if (errno==EWOULDBLOCK)
+  {
+    /*
+    ** congestion detected: nothing has been sent
+    */
+    return RUC_WOULDBLOCK;
+  }
+  return RUC_DISC;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Gather the remaining part of the current buffer and the buffers that
+*  follow it in the pending queue of the transmitter
+
+  @param xmit_p : transmitter context
+  @param iov: where to gather the buffers
+  @param lgth_p : where to return the total length to send
+
+  @retval the number of gathered buffers
+*/
+static inline int af_unix_send_stream_gather(com_xmit_template_t *xmit_p,struct iovec *iov,int *lgth_p)
+{
+  ruc_obj_desc_t * pnext = NULL;
+  ruc_obj_desc_t * bufRef;
+  int              iovcnt;
+  int              lgth;
+  int              len;
+
+  iov[0].iov_base = (char *)ruc_buf_getPayload(xmit_p->bufRefCurrent) + xmit_p->nbWrite;
+  iov[0].iov_len  = xmit_p->nb2Write - xmit_p->nbWrite;
+  lgth            = iov[0].iov_len;
+  iovcnt          = 1;
+
+  while (iovcnt < AF_UNIX_XMIT_BATCH_MAX)
+  {
+    bufRef = ruc_objGetNext(&xmit_p->xmitList[0],&pnext);
+    if (bufRef == NULL) break;
+    /*
+    ** Only ready buffers can be gathered, not the transmit requests
+    */
+    if (bufRef->usrEvtCode != UMA_XMIT_TYPE_BUFFER) break;
+    len = ruc_buf_getPayloadLen(bufRef);
+    if ((lgth + len) > AF_UNIX_XMIT_BATCH_BYTES) break;
+    iov[iovcnt].iov_base = ruc_buf_getPayload(bufRef);
+    iov[iovcnt].iov_len  = len;
+    lgth += len;
+    iovcnt++;
+  }
+  *lgth_p = lgth;
+  return iovcnt;
+}
 
 
 
@@ -122,6 +229,11 @@ void af_unix_send_stream_fsm(af_unix_ctx_generic_t *socket_p,com_xmit_template_t
   int inuse;
   uint64_t cycles_before;
   uint64_t cycles_after;
+  struct iovec iov[AF_UNIX_XMIT_BATCH_MAX];
+  int iovcnt;
+  int lgth;
+  int sent_ahead = 0;  /**< bytes of the next pending buffers already sent by a sendmsg */
+  int zlen;
 
   while(1)
   {
@@ -141,6 +253,20 @@ void af_unix_send_stream_fsm(af_unix_ctx_generic_t *socket_p,com_xmit_template_t
       {
          write_len  = (int)ruc_buf_getPayloadLen(xmit_p->bufRefCurrent);
          /*
+         ** When the compression is agreed with the peer, the buffer may be
+         ** sent from its compressed copy
+         */
+         socket_p->compress.xmit_current = 0;
+         if (socket_p->compress.active)
+         {
+           zlen = af_unix_compress_xmit(socket_p,xmit_p->bufRefCurrent);
+           if (zlen != 0)
+           {
+             write_len = zlen;
+             socket_p->compress.xmit_current = 1;
+           }
+         }
+         /*
          ** Get the reference of the destination socket (name) from the ruc_buffer)
          */
          xmit_p->nbWrite  = 0;
@@ -158,16 +284,57 @@ void af_unix_send_stream_fsm(af_unix_ctx_generic_t *socket_p,com_xmit_template_t
 
       case XMIT_IN_PRG:
 
-        /*
-        ** Check if there is a current buffer to send
-        */
-        socket_p->stats.totalXmitAttempts++;
-        socket_p->stats.totalXmitAttemptsCycles++;
-        pbuf = (char *)ruc_buf_getPayload(xmit_p->bufRefCurrent);
-        cycles_before = ruc_rdtsc();
-        ret  = af_unix_send_stream_generic(socket_p->socketRef,pbuf+xmit_p->nbWrite,xmit_p->nb2Write - xmit_p->nbWrite, &write_len);
-        cycles_after = ruc_rdtsc();
-        socket_p->stats.totalXmitCycles+= (cycles_after - cycles_before);
+        if (sent_ahead != 0)
+        {
+          /*
+          ** That buffer has already been sent, fully or partially, by the
+          ** previous sendmsg
+          */
+          write_len = xmit_p->nb2Write - xmit_p->nbWrite;
+          if (write_len > sent_ahead) write_len = sent_ahead;
+          sent_ahead -= write_len;
+          ret = ((xmit_p->nbWrite + write_len) == xmit_p->nb2Write) ? RUC_OK : RUC_PARTIAL;
+        }
+        else
+        {
+          /*
+          ** Check if there is a current buffer to send
+          */
+          socket_p->stats.totalXmitAttempts++;
+          socket_p->stats.totalXmitAttemptsCycles++;
+          iovcnt = 1;
+          /*
+          ** The pending buffers are not gathered when they may be compressed
+          */
+          if ((socket_p->compress.active == 0) && (!ruc_objIsEmptyList(&xmit_p->xmitList[0])))
+          {
+            iovcnt = af_unix_send_stream_gather(xmit_p,iov,&lgth);
+          }
+          cycles_before = ruc_rdtsc();
+          if (iovcnt == 1)
+          {
+            if (socket_p->compress.xmit_current) pbuf = socket_p->compress.zxmit;
+            else                                 pbuf = (char *)ruc_buf_getPayload(xmit_p->bufRefCurrent);
+            ret  = af_unix_send_stream_generic(socket_p->socketRef,pbuf+xmit_p->nbWrite,xmit_p->nb2Write - xmit_p->nbWrite, &write_len);
+          }
+          else
+          {
+            ret  = af_unix_send_stream_vector_generic(socket_p->socketRef,iov,iovcnt,lgth,&write_len);
+            socket_p->stats.totalXmitBatches++;
+            socket_p->stats.totalXmitBatched += iovcnt;
+            /*
+            ** The current buffer is sent, and the next ones partially or totally
+            */
+            if ((ret == RUC_OK)||((ret == RUC_PARTIAL) && (write_len >= (int)iov[0].iov_len)))
+            {
+              sent_ahead = write_len - iov[0].iov_len;
+              write_len  = iov[0].iov_len;
+              ret        = RUC_OK;
+            }
+          }
+          cycles_after = ruc_rdtsc();
+          socket_p->stats.totalXmitCycles+= (cycles_after - cycles_before);
+        }
         
         switch (ret)
         {
@@ -222,6 +389,7 @@ void af_unix_send_stream_fsm(af_unix_ctx_generic_t *socket_p,com_xmit_template_t
           xmit_p->bufRefCurrent = NULL;
           xmit_p->nbWrite  = 0;
           xmit_p->nb2Write = 0;
+          socket_p->compress.xmit_current = 0;
           socket_p->stats.totalXmitSuccess++;
           socket_p->stats.totalXmitBytes += write_len;
           xmit_p->state = XMIT_CHECK_XMITQ;
@@ -262,6 +430,7 @@ void af_unix_send_stream_fsm(af_unix_ctx_generic_t *socket_p,com_xmit_template_t
             fatal("Inuse is negative %d",inuse);
           }
           socket_p->stats.totalXmitError++;
+          socket_p->compress.xmit_current = 0;
           if (socket_p->userDiscCallBack != NULL)
           {
             void *bufref = xmit_p->bufRefCurrent;
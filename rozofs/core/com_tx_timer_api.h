@@ -20,6 +20,7 @@
 
 #include "ruc_list.h"
 #include "ruc_timer_api.h"
+#include "ruc_timer_wheel.h"
 
 /*
 ** there is one timer slot per timr type
@@ -37,22 +38,21 @@
          /* charging timer types  */
          /*----------------------*/
 
-typedef void (*com_tx_tmr_callBack_t)(void*) ; /* call back type */
+typedef ruc_wheel_callBack_t com_tx_tmr_callBack_t ; /* call back type */
 
 
          /*----------------------*/
          /* Timer cell structure */
          /*----------------------*/
 
-typedef struct _com_tx_tmr_cell_t {
-    ruc_obj_desc_t         listHead;    /* header used by list service for queing */
-    uint32_t                 date_s;      /* time out date in system milliseconds */
-    uint32_t                 delay;      /* delay requested in ms      */
-    com_tx_tmr_callBack_t p_callBack;  /* call back to be used at time out */
-    void                 *cBParam;     /* parameter to be provided at time out */
-} com_tx_tmr_cell_t;
+/*
+** The timers are queued in a hierarchical timing wheel
+** (see ruc_timer_wheel.h). The cell must be initialized
+** with ruc_listEltInit() before the first start.
+*/
+typedef ruc_wheel_cell_t com_tx_tmr_cell_t;
 
-#define com_tx_tmr_CELL_LGTH		sizeof (struct com_tx_tmr_cell_t)
+#define com_tx_tmr_CELL_LGTH		sizeof (com_tx_tmr_cell_t)
 
 
 /*--------------------------------------------------------------------------*/
@@ -62,9 +62,9 @@ typedef struct _com_tx_tmr_cell_t {
 
 
 /*
-**  IN : tmr_slot : index of the timer slot.
+**  IN : tmr_slot : index of the timer slot (only checked).
 **       p_refTim   : reference of the timer cell to use
-**       date_s     : requested time out date, in seconds
+**       date_s     : requested time out delay, in ms
 **       p_callBack : client call back to call at time out
 **       cBParam    : client parameter to provide at time out
 **
@@ -85,8 +85,8 @@ extern uint32_t com_tx_tmr_stop (com_tx_tmr_cell_t *p_refTim);
 
 
 /*
-**  IN : period_ms : period between two queue sequence reading in ms
-**       credit    : pdp credit processing number
+**  IN : period_ms : tick of the timing wheel in ms
+**       credit    : not used. Every expired timer is processed at each tick
 **
 **  OUT : OK/NOK
 */
@@ -305,6 +305,10 @@ int expgw_export_lbg_initialize(expgw_exportd_ctx_t *exportclt ,unsigned long pr
                                                   lbg_size,&af_inet_exportd_conf,0);
     if (exportclt->export_lbg_id >= 0)
     {
+      /*
+      ** Compress the rpc messages toward the exportd when configured
+      */
+      if (common_config.export_compress) north_lbg_set_compression(exportclt->export_lbg_id,1);
       /*
       ** the timer is started only to address the case of a dynamic port
       */
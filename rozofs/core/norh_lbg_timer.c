@@ -31,9 +31,6 @@
 #include "north_lbg_timer_api.h"
 #include "north_lbg_timer.h"
 
-#define NORTH_LBG_TIMER_MAX_DATE 0xFFFFFFFF
-
-
 /*
 **   G L O B A L    D A T A
 */
@@ -44,36 +41,17 @@
 
 north_lbg_tmr_var_t north_lbg_tmr={FALSE};
 
-#define MILLISECLONG(time) (((unsigned long long)time.tv_sec * 1000000 + time.tv_usec)/1000)
-
 
 /************************/
 /* internal functions   */
 /************************/
 
-uint32_t north_lbg_time()
-{
-  struct timeval       timeDay;
-  unsigned long long mylonglong;
-  uint32_t  mylong;
-
-  gettimeofday(&timeDay,(struct timezone *)0);
-  mylonglong = MILLISECLONG(timeDay);
-  /*
-  ** put the limit to 2 minutes
-  */
-  mylong = (uint32_t) mylonglong;
-  mylong &= NORTH_LBG_TIMER_MAX_DATE;
-
-  return (uint32_t) mylong;
-}
-
 /*----------------------------------------------
 **  north_lbg_tmr_periodic
 **----------------------------------------------
 **
-**  It perform the processing of a limited number
-**  of queued elements
+**  It moves the timing wheel up to the current
+**  time and processes every expired timer
 **
 **  IN : not significant
 **
@@ -81,126 +59,9 @@ uint32_t north_lbg_time()
 **
 **-----------------------------------------------
 */
-void north_lbg_tmr_processSlot(ruc_obj_desc_t* pTmrQueue) ;
-
 void north_lbg_tmr_periodic(void *ns)
 {
-
-//  printf("north_lbg_tmr_periodic Ticker!\n");
-  int i;
-
-  for ( i = 0; i < NORTH_LBG_TMR_SLOT_MAX; i++)
-  {
-     north_lbg_tmr_processSlot(&north_lbg_tmr.queue[i]);
-  }
-
-}
-
-/*----------------------------------------------
-**  north_lbg_tmr_processSlot
-**----------------------------------------------
-**
-**  It performs
-**
-**
-**  IN :
-**
-**  OUT : none
-**
-**-----------------------------------------------
-*/
-void north_lbg_tmr_processSlot(ruc_obj_desc_t* pTmrQueue)
-{
-   int32_t credit;
-   //int32_t delay_s;
-   north_lbg_tmr_cell_t * p_refTim;
-   uint32_t cur_date_s;
-   uint8_t  expired = FALSE;
-
-    /*
-    ** processing credit and date initialization
-    */
-    credit     = north_lbg_tmr.credit;
-    cur_date_s = north_lbg_time();
-
-    /*
-    ** process elements while there is still credit,
-    ** and while time-out date is passed,
-    ** and while there are still some elements
-    */
-
-    while (
-           ((p_refTim=(north_lbg_tmr_cell_t *)ruc_objGetFirst(pTmrQueue)) !=
-                    (north_lbg_tmr_cell_t *)NULL)
-            && (credit > 0)
-          ) {
-        /*
-        ** evaluate delay up to time out.
-        ** if time out not yet passed, stop read queue
-        */
-	expired = FALSE;
-	while (1)
-	{
-	  if (cur_date_s > p_refTim->date_s)
-	  {
-	    /*
-	    ** it is possible that the counter has wrapped
-	    */
-	    if ((NORTH_LBG_TIMER_MAX_DATE - cur_date_s + p_refTim->date_s) < p_refTim->delay)
-	    {
-	      /*
-	      ** nothing to do
-	      */
-
-	      break;
-	    }
-	    expired = TRUE;
-	    break;
-	  }
-	  if (cur_date_s == p_refTim->date_s)
-	  {
-	    expired = TRUE;
-	    break;
-	  }
-	  if (cur_date_s < p_refTim->date_s)
-	  {
-	    /*
-	    ** no expiration but look at the delay request since
-	    ** if somebody has changed the data we can be out of
-	    ** sync
-	    */
-	    if ((p_refTim->date_s - cur_date_s) > p_refTim->delay)
-	    {
-	       /*
-	       ** readjust the expiration date
-	       */
-	       p_refTim->date_s = cur_date_s + p_refTim->delay;
-	    }
-	  }
-	  break;
-	}
-	if (!expired)
-	{
-	  /*
-	  ** not expiration leaves the loop
-	  */
-	  return;
-	}
-
-        /*
-        ** timer cell dequeing from its current queue
-        */
-        ruc_objRemove((ruc_obj_desc_t *)p_refTim);
-	/*
-	** call the time-out function
-	*/
-        (*(p_refTim->p_callBack))(p_refTim->cBParam);
-
-        credit--;
-
-    }
-
-    return;
+  ruc_wheel_run(&north_lbg_tmr.wheel);
 }
 
 
@@ -216,8 +77,9 @@ void north_lbg_tmr_processSlot(ruc_obj_desc_t* pTmrQueue)
 **
 **  charging timer service starting request
 **
-**  IN : p_refTim   : reference of the timer cell to use
-**       date_s     : requested time out date, in seconds
+**  IN : tmr_slot   : index of the timer slot (only checked)
+**       p_refTim   : reference of the timer cell to use
+**       date_s     : requested time out delay, in ms
 **       p_callBack : client call back to call at time out
 **       cBParam    : client parameter to provide at time out
 **
@@ -232,37 +94,15 @@ uint32_t north_lbg_tmr_start (uint8_t   tmr_slot,
                         void *cBParam
 			)
 {
-     uint32_t ret;
-
      if (tmr_slot >= NORTH_LBG_TMR_SLOT_MAX)
      {
         severe( "north_lbg_tmr_start : slot out of range : %d ",tmr_slot );
 	return RUC_NOK;
      }
     /*
-    ** timer cell dequeing from its current queue
-    ** This dequeing is always attempted, even if not queued
-    ** As the list primitive is protected, no initial check
-    ** need to be done
-    */
-    ruc_objRemove((ruc_obj_desc_t *)p_refTim);
-
-    /*
-    ** initialize context
+    ** (re)queue the timer cell in the wheel
     */
-    p_refTim->date_s = date_s + north_lbg_time();
-    p_refTim->date_s &= NORTH_LBG_TIMER_MAX_DATE;
-    p_refTim->delay = date_s;
-
-    p_refTim->p_callBack = p_callBack;
-    p_refTim->cBParam = cBParam;
-
-
-    ret=ruc_objInsertTail(&north_lbg_tmr.queue[tmr_slot],(ruc_obj_desc_t*)p_refTim);
-    if(ret!=RUC_OK){
-        severe( "Pb while inserting cell in queue, ret=%u", ret );
-        return(RUC_NOK);
-    }
+    ruc_wheel_start_ms(&north_lbg_tmr.wheel,p_refTim,date_s,p_callBack,cBParam);
     return(RUC_OK);
 }
 
@@ -286,7 +126,7 @@ uint32_t north_lbg_tmr_stop (north_lbg_tmr_cell_t *p_refTim){
     /*
     ** dequeue the timer cell
     */
-    ruc_objRemove((ruc_obj_desc_t *)p_refTim);
+    ruc_wheel_stop(&north_lbg_tmr.wheel,p_refTim);
 
     return(RUC_OK);
 }
@@ -298,8 +138,8 @@ uint32_t north_lbg_tmr_stop (north_lbg_tmr_cell_t *p_refTim){
 **
 **   charging timer service initialisation request
 **
-**  IN : period_ms : period between two queue sequence reading in ms
-**       credit    : pdp credit processing number
+**  IN : period_ms : tick of the timing wheel in ms
+**       credit    : not used. Every expired timer is processed at each tick
 **
 **  OUT : OK/NOK
 **
@@ -309,8 +149,6 @@ int north_lbg_tmr_init(uint32_t period_ms,
                     uint32_t credit)
 {
 
-    int i;
-
     /**************************/
     /* configuration variable */
     /* initialization         */
@@ -328,7 +166,7 @@ int north_lbg_tmr_init(uint32_t period_ms,
     }
 
     /*
-    ** Number of pdp context processed at each look up;
+    ** Number of pdp context processed at each look up (not used)
     */
     if (credit!=0){
         north_lbg_tmr.credit=credit;
@@ -344,11 +182,10 @@ int north_lbg_tmr_init(uint32_t period_ms,
 
 
     /*
-    **  queue initialization
+    **  timing wheel initialization
     */
-    for (i = 0; i < NORTH_LBG_TMR_SLOT_MAX; i++)
-    {
-      ruc_listHdrInit(&north_lbg_tmr.queue[i]);
+    if (ruc_wheel_init(&north_lbg_tmr.wheel,"north_lbg",north_lbg_tmr.period_ms) != RUC_OK){
+        return(RUC_NOK);
     }
 
     /*
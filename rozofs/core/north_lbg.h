@@ -60,6 +60,17 @@ typedef enum _north_lbg_entry_state_e
 
 #define NORTH_LBG_MAX_RETRY 3  /**< max number of time that we can reselet a target */
 
+/**
+* Policy used to select the entry on which a message is sent
+*/
+typedef enum _north_lbg_policy_e
+{
+   NORTH_LBG_POLICY_RR = 0,   /**< round robin                                    */
+   NORTH_LBG_POLICY_LOR,      /**< least outstanding requests, then lowest latency */
+   NORTH_LBG_POLICY_P2C,      /**< best of two randomly chosen entries            */
+   NORTH_LBG_POLICY_MAX
+} north_lbg_policy_e;
+
 #define NORTH_LBG_MICROLONG(time) ((unsigned long long)time.tv_sec * 1000000 + time.tv_usec)
 
 #define NORTH_LBG_START_PROF(buffer)\
@@ -120,6 +131,12 @@ typedef struct _north_lbg_entry_ctx_t
   void              *parent;       /**< pointer to the parent load balancer context    */
   north_lbg_tmr_cell_t  rpc_guard_timer;   /**< guard timer associated with a pending connect */
   ruc_obj_desc_t xmitList;       /**< link list of the xmit buffer that have been sent on that interface  */
+  /*
+  ** load of the entry
+  */
+  uint32_t          inflight;      /**< number of messages sent and not yet released   */
+  uint32_t          load_epoch;    /**< incremented each time the load is reset        */
+  uint64_t          ewma_latency_us; /**< smoothed response time in us                 */
 
 } north_lbg_entry_ctx_t;
 
@@ -162,6 +179,9 @@ typedef struct _north_lbg_ctx_t
   int                        active_standby_mode;   /**< Set when LBG is in active/standby mode */
   int                        active_lbg_entry;      /**< -1 no entry available/ >=0: index on the active tcp connection */
   int                        local; /**< 1 when the destination is local. 0 else */
+  int                        policy; /**< entry selection policy: see north_lbg_policy_e */
+  uint32_t                   p2c_seed; /**< random seed of the NORTH_LBG_POLICY_P2C policy */
+  int                        compress; /**< 1 when the compression is requested on the connections */
 } north_lbg_ctx_t;
 
 /*
@@ -173,6 +193,7 @@ void north_lbg_rechain_when_lbg_gets_down(int idx);
 * Prototypes
 */
 char * lbg_north_state2String (int x);
+char * north_lbg_policy2String(int policy);
 void north_lbg_debug_show(char *argv[],uint32_t tcpRef, void *bufRef);
 void north_lbg_debug(char * argv[], uint32_t tcpRef, void *bufRef);
 void north_lbg_debug_init();
@@ -269,6 +290,21 @@ static inline int north_lbg_eval_global_state(north_lbg_ctx_t *lbg_p)
 }
 
 
+/*__________________________________________________________________________
+*/
+/**
+*  Reset the load of an entry. Called when the entry goes down, since
+*  the pending messages will never be responded on that connection.
+*  The releases of the messages sent before are then ignored
+*  (see north_lbg_entry_account_release())
+
+@param entry_p : pointer to the entry
+*/
+static inline void north_lbg_entry_reset_load(north_lbg_entry_ctx_t *entry_p)
+{
+   entry_p->inflight  = 0;
+   entry_p->load_epoch++;
+}
 /*__________________________________________________________________________
 */
 /**
@@ -313,6 +349,7 @@ static inline void north_lbg_entry_state_change(north_lbg_entry_ctx_t *entry_p,i
        lbg_p->active_lbg_entry = -1;
      }
      north_lbg_clear_bit(entry_p->index,lbg_p->entry_bitmap_state);
+     north_lbg_entry_reset_load(entry_p);
      state = north_lbg_eval_global_state(lbg_p);
      if (lbg_p->state != state)
      {
@@ -322,6 +359,121 @@ static inline void north_lbg_entry_state_change(north_lbg_entry_ctx_t *entry_p,i
   }
 }
 
+/*__________________________________________________________________________
+*/
+/**
+*  Tell whether an entry of a load balancing group can be used for sending
+
+@param lbg_p : pointer to load balancing group
+@param idx : index of the entry
+
+@retval 1 : the entry is usable
+@retval 0 : the entry is down or unavailable
+*/
+static inline int north_lbg_is_valid_entry(north_lbg_ctx_t *lbg_p, int idx)
+{
+   if (north_lbg_test_bit(idx,lbg_p->entry_bitmap_state) == 0) return 0;
+   /*
+   ** where there is a supervision callback associated with the lbg need to check the 
+   ** availability of the connection
+   */
+   if (lbg_p->userPollingCallBack != NULL) 
+   {
+     af_unix_ctx_generic_t *this = af_unix_getObjCtx_p(lbg_p->entry_tb[idx].sock_ctx_ref);
+     if (this->cnx_availability_state == AF_UNIX_CNX_UNAVAILABLE) return 0;
+   } 
+   return 1;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  Load of an entry: the number of pending messages weighted by the
+*  smoothed response time. An entry with no latency sample yet counts
+*  as a 1 us one, so it gets tried.
+
+@param entry_p : pointer to the entry
+
+@retval the load of the entry
+*/
+static inline uint64_t north_lbg_entry_load(north_lbg_entry_ctx_t *entry_p)
+{
+   uint64_t lat = entry_p->ewma_latency_us;
+   if (lat == 0) lat = 1;
+   return ((uint64_t)entry_p->inflight+1) * lat;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  That function returns the index of the least loaded active entry
+   according to the policy of the load balancing group.
+   
+   NORTH_LBG_POLICY_LOR: the entry with the least pending messages, the
+   lowest latency in case of equality. The scan starts at the round robin
+   index so that the idle entries are equally used.
+   NORTH_LBG_POLICY_P2C: the least loaded of two randomly chosen entries.
+
+@param lbg_p : pointer to load balancing group
+
+@retval -1 : not entry available
+@retval <>-1 index of the entry that will be used for sending the message
+*/
+static inline int north_lbg_get_least_loaded_entry(north_lbg_ctx_t *lbg_p)
+{
+  int valid[NORTH__LBG_MAX_ENTRY];
+  int nb_valid = 0;
+  int idx;
+  int i;
+  int best;
+  int start_idx;
+  
+  start_idx = (lbg_p->next_global_entry_idx_p != NULL) ? *lbg_p->next_global_entry_idx_p : lbg_p->next_entry_idx;
+  for (i = 0; i < lbg_p->nb_entries_conf; i++)
+  {
+    idx = (start_idx + i) % lbg_p->nb_entries_conf;
+    if (north_lbg_is_valid_entry(lbg_p,idx)) valid[nb_valid++] = idx;
+  }
+  if (nb_valid == 0) return -1;
+  
+  best = valid[0];
+  if (lbg_p->policy == NORTH_LBG_POLICY_P2C)
+  {
+    if (nb_valid > 1)
+    {
+      int first  = rand_r(&lbg_p->p2c_seed) % nb_valid;
+      int second = rand_r(&lbg_p->p2c_seed) % (nb_valid-1);
+      int other;
+      if (second >= first) second++;
+      best  = valid[first];
+      other = valid[second];
+      if (north_lbg_entry_load(&lbg_p->entry_tb[other]) < north_lbg_entry_load(&lbg_p->entry_tb[best])) best = other;
+    }
+  }
+  else
+  {
+    for (i = 1; i < nb_valid; i++)
+    {
+      north_lbg_entry_ctx_t *cur_p  = &lbg_p->entry_tb[valid[i]];
+      north_lbg_entry_ctx_t *best_p = &lbg_p->entry_tb[best];
+      if ((cur_p->inflight < best_p->inflight) 
+       || ((cur_p->inflight == best_p->inflight) && (cur_p->ewma_latency_us < best_p->ewma_latency_us)))
+      {
+        best = valid[i];
+      }
+    }
+  }
+  /*
+  ** move the round robin index, so that the equally loaded entries are used in turn
+  */
+  if (lbg_p->next_global_entry_idx_p != NULL)
+  {
+    * lbg_p->next_global_entry_idx_p = best+1;
+  }
+  else 
+  {
+    lbg_p->next_entry_idx = best+1;
+  }  
+  return best;
+}
 /*__________________________________________________________________________
 */
 /**
@@ -337,6 +489,13 @@ static inline int north_lbg_get_next_valid_entry(north_lbg_ctx_t *lbg_p)
   int start_idx;
   int check_idx;
 
+  /*
+  ** load aware selection when the destination is remote
+  */
+  if ((lbg_p->policy != NORTH_LBG_POLICY_RR) && (lbg_p->local == 0))
+  {
+    return north_lbg_get_least_loaded_entry(lbg_p);
+  }
      /*
    ** Get next enry either from value saved in this context or
    ** from value common to several lbg
@@ -352,27 +511,11 @@ static inline int north_lbg_get_next_valid_entry(north_lbg_ctx_t *lbg_p)
   for (start_idx = 0; start_idx < lbg_p->nb_entries_conf; start_idx++)
   {
      if (check_idx >= lbg_p->nb_entries_conf) check_idx = 0;
-     if (north_lbg_test_bit(check_idx,lbg_p->entry_bitmap_state) == 0)
+     if (north_lbg_is_valid_entry(lbg_p,check_idx) == 0)
      {
        check_idx +=1;
        continue;
      }
-     /*
-     ** where there is a supervision callback associated with the lbg need to check the 
-     ** availability of the connection
-     */
-     if (lbg_p->userPollingCallBack != NULL) 
-     {
-       /*
-       ** Get the available stat eof the connection
-       */
-       af_unix_ctx_generic_t *this = af_unix_getObjCtx_p(lbg_p->entry_tb[check_idx].sock_ctx_ref);
-       if (this->cnx_availability_state == AF_UNIX_CNX_UNAVAILABLE) 
-       {
-         check_idx +=1;
-         continue;         
-       }             
-     }    
 
      /*
      ** update for the next run when externbal line is used
@@ -326,6 +326,78 @@ void north_lbg_set_active_entry(int  lbg_idx, int sock_idx_in_lbg);
 /*__________________________________________________________________________
 */
 /**
+*  Set the entry selection policy of a lbg
+
+  @param lbg_idx : reference of the load balancing group
+  @param policy : see north_lbg_policy_e
+
+  @retval 0 : success
+  @retval -1 : error
+*/
+int north_lbg_set_policy(int  lbg_idx, int policy);
+/*__________________________________________________________________________
+*/
+/**
+*  Get the entry selection policy of a lbg
+
+  @param lbg_idx : reference of the load balancing group
+
+  @retval the policy (see north_lbg_policy_e)
+*/
+int north_lbg_get_policy(int  lbg_idx);
+/*__________________________________________________________________________
+*/
+/**
+*  Callback called for each message about to be sent on an entry of a lbg,
+   so that the owner of the message releases it later on with
+   north_lbg_entry_account_release()
+
+  @param buf_p : the message
+  @param lbg_idx : reference of the load balancing group
+  @param entry_idx : index of the entry the message is sent on
+  @param epoch : load epoch of the entry
+
+  @retval 0 : the message will be released by its owner
+  @retval -1 : the message is not known by the owner: it is not counted
+*/
+typedef int (*north_lbg_xmit_accounting_cbk_t)(void *buf_p, uint32_t lbg_idx, uint32_t entry_idx, uint32_t epoch);
+/*__________________________________________________________________________
+*/
+/**
+*  Register the callback called for each message sent on an entry
+
+  @param cbk: the callback
+*/
+void north_lbg_set_xmit_accounting_cbk(north_lbg_xmit_accounting_cbk_t cbk);
+/*__________________________________________________________________________
+*/
+/**
+*  Release a message sent on an entry of a load balancing group: it has
+*  been responded, it has timed out or it has been aborted
+
+  @param lbg_idx: reference of the load balancing group
+  @param entry_idx: index of the entry the message has been sent on
+  @param epoch: load epoch of the entry when the message has been sent
+  @param latency_us: response time of the message, 0 when not responded
+*/
+void north_lbg_entry_account_release(uint32_t lbg_idx, uint32_t entry_idx, uint32_t epoch, uint64_t latency_us);
+/*__________________________________________________________________________
+*/
+/**
+*  Request the compression of the rpc messages on the connections of a lbg
+   (see af_unix_socket_compress.c). Takes effect on the next establishment
+   of each connection, so it should be called just after the lbg creation
+
+  @param lbg_idx : reference of the load balancing group
+  @param enable : 1 to request the compression, 0 to stop it
+
+  @retval 0 : success
+  @retval -1 : error
+*/
+int north_lbg_set_compression(int  lbg_idx, int enable);
+/*__________________________________________________________________________
+*/
+/**
 *  Get the IP@ of active entry of the lbg
 
   @param lbg_idx : reference of the load balancing group
@@ -38,12 +38,10 @@
 typedef struct _north_lbg_tmr_var_t {
  /* configuration variables */
     uint32_t         trace;
-    uint32_t         period_ms;                      /* period between two lookup */
-                                                   /* to the to queue           */
-    uint32_t         credit;                         /* nb of element processed   */
-                                                   /* at each look up           */
+    uint32_t         period_ms;                      /* tick of the timing wheel  */
+    uint32_t         credit;                         /* not used                  */
  /* working variables */
-    ruc_obj_desc_t queue[NORTH_LBG_TMR_SLOT_MAX];	   /* queue                     */
+    ruc_wheel_t      wheel;                          /* timing wheel              */
     struct timer_cell * p_periodic_timCell;        /* periodic timer cell       */
 } north_lbg_tmr_var_t;
 
@@ -20,6 +20,7 @@
 
 #include "ruc_list.h"
 #include "ruc_timer_api.h"
+#include "ruc_timer_wheel.h"
 
 /*
 ** there is one timer slot per timr type
@@ -33,22 +34,21 @@
          /* charging timer types  */
          /*----------------------*/
 
-typedef void (*north_lbg_tmr_callBack_t)(void*) ; /* call back type */
+typedef ruc_wheel_callBack_t north_lbg_tmr_callBack_t ; /* call back type */
 
 
          /*----------------------*/
          /* Timer cell structure */
          /*----------------------*/
 
-typedef struct _north_lbg_tmr_cell_t {
-    ruc_obj_desc_t         listHead;    /* header used by list service for queing */
-    uint32_t                 date_s;      /* time out date in system milliseconds */
-    uint32_t                 delay;      /* delay requested in ms      */
-    north_lbg_tmr_callBack_t p_callBack;  /* call back to be used at time out */
-    void                 *cBParam;     /* parameter to be provided at time out */
-} north_lbg_tmr_cell_t;
+/*
+** The timers are queued in a hierarchical timing wheel
+** (see ruc_timer_wheel.h). The cell must be initialized
+** with ruc_listEltInit() before the first start.
+*/
+typedef ruc_wheel_cell_t north_lbg_tmr_cell_t;
 
-#define north_lbg_tmr_CELL_LGTH		sizeof (struct north_lbg_tmr_cell_t)
+#define north_lbg_tmr_CELL_LGTH		sizeof (north_lbg_tmr_cell_t)
 
 
 /*--------------------------------------------------------------------------*/
@@ -58,9 +58,9 @@ typedef struct _north_lbg_tmr_cell_t {
 
 
 /*
-**  IN : tmr_slot : index of the timer slot.
+**  IN : tmr_slot : index of the timer slot (only checked).
 **       p_refTim   : reference of the timer cell to use
-**       date_s     : requested time out date, in seconds
+**       date_s     : requested time out delay, in ms
 **       p_callBack : client call back to call at time out
 **       cBParam    : client parameter to provide at time out
 **
@@ -81,8 +81,8 @@ extern uint32_t north_lbg_tmr_stop (north_lbg_tmr_cell_t *p_refTim);
 
 
 /*
-**  IN : period_ms : period between two queue sequence reading in ms
-**       credit    : pdp credit processing number
+**  IN : period_ms : tick of the timing wheel in ms
+**       credit    : not used. Every expired timer is processed at each tick
 **
 **  OUT : OK/NOK
 */
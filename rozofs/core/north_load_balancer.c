@@ -94,6 +94,8 @@ void north_lbg_debug_show(char * argv[],uint32_t tcpRef, void *bufRef) {
             pChar += sprintf(pChar, "NAME: %-34s %s\n", lbg_p->name, lbg_north_state2String(state));
 	    pChar += sprintf(pChar, "      %-25s: %d - active entry %d\n", "active/standby", lbg_p->active_standby_mode, lbg_p->active_lbg_entry);
             pChar += sprintf(pChar, "      %-25s: %s\n", "local/remote",lbg_p->local?"local":"remote");	    
+            pChar += sprintf(pChar, "      %-25s: %s\n", "policy",north_lbg_policy2String(lbg_p->policy));	    
+            pChar += sprintf(pChar, "      %-25s: %s\n", "compression",lbg_p->compress?"requested":"off");	    
             pChar += sprintf(pChar, "      size                     : %12u\n", lbg_p->nb_entries_conf);
             pChar += sprintf(pChar, "      total Up/Down Transitions: %12llu\n", (unsigned long long int) lbg_p->stats.totalUpDownTransition);
             north_lbg_entry_ctx_t *entry_p = lbg_p->entry_tb;
@@ -108,6 +110,8 @@ void north_lbg_debug_show(char * argv[],uint32_t tcpRef, void *bufRef) {
                 pChar += sprintf(pChar, "       Cnx  Attempts            : %12llu\n", (unsigned long long int) entry_p->stats.totalConnectAttempts);
                 pChar += sprintf(pChar, "       Xmit messages            : %12llu\n", (unsigned long long int) entry_p->stats.totalXmit);
                 pChar += sprintf(pChar, "       Recv messages            : %12llu\n", (unsigned long long int) entry_p->stats.totalRecv);
+                pChar += sprintf(pChar, "       In flight                : %12u\n", entry_p->inflight);
+                pChar += sprintf(pChar, "       Latency (smoothed)       : %12llu us\n", (unsigned long long int) entry_p->ewma_latency_us);
                 pChar += sprintf(pChar, "       Xmit Perf. (count/time)  : %"PRIu64" / %"PRIu64" us / cumul %"PRIu64" us\n",
                         stats_p->timestampCount,
                         stats_p->timestampCount ? stats_p->timestampElasped / stats_p->timestampCount : 0,
@@ -141,8 +145,8 @@ void north_lbg_entries_debug_show(uint32_t tcpRef, void *bufRef) {
         north_lbg_ctx_t *lbg_p;
         ruc_obj_desc_t *pnext;
         int i;
-        pChar += sprintf(pChar, "  LBG Name                | lbg_id | idx  | sock |    state   | rdy |    Queue  | Cnx Attpts | Xmit Attpts | Recv count  |   Recv-Q  |   Send-Q  |\n");
-        pChar += sprintf(pChar, "--------------------------+--------+------+------+------------+-----+-----------+------------+-------------+-------------+-----------+-----------+\n");
+        pChar += sprintf(pChar, "  LBG Name                | lbg_id | idx  | sock |    state   | rdy |    Queue  | Cnx Attpts | Xmit Attpts | Recv count  |   Recv-Q  |   Send-Q  | pol | inflight | latency us |\n");
+        pChar += sprintf(pChar, "--------------------------+--------+------+------+------------+-----+-----------+------------+-------------+-------------+-----------+-----------+-----+----------+------------+\n");
         pnext = (ruc_obj_desc_t*) NULL;
         while ((lbg_p = (north_lbg_ctx_t*) ruc_objGetNext((ruc_obj_desc_t*) & north_lbg_context_activeListHead,
                 &pnext))
@@ -189,7 +193,10 @@ void north_lbg_entries_debug_show(uint32_t tcpRef, void *bufRef) {
 		  ioctl(sock_p->socketRef,SIOCOUTQ,&siocoutq_value);
 		}
                 pChar += sprintf(pChar, "  %8d |",  siocinq_value);
-                pChar += sprintf(pChar, "  %8d |\n",siocoutq_value);
+                pChar += sprintf(pChar, "  %8d |",siocoutq_value);
+                pChar += sprintf(pChar, " %s |", north_lbg_policy2String(lbg_p->policy));
+                pChar += sprintf(pChar, " %8u |", entry_p->inflight);
+                pChar += sprintf(pChar, " %10llu |\n", (unsigned long long int) entry_p->ewma_latency_us);
             }
 
 
@@ -356,6 +363,8 @@ void north_lbg_entry_init(void *parent, north_lbg_entry_ctx_t *entry_p, uint32_t
     entry_p->parent = parent;
     ruc_listEltInit((ruc_obj_desc_t *) & entry_p->rpc_guard_timer);
     ruc_listHdrInit((ruc_obj_desc_t *) & entry_p->xmitList);
+    north_lbg_entry_reset_load(entry_p);
+    entry_p->ewma_latency_us = 0;
 
 }
 /*
@@ -391,6 +400,9 @@ void north_lbg_ctxInit(north_lbg_ctx_t *p, uint8_t creation) {
     p->active_lbg_entry = -1;
     p->active_standby_mode = 0;
     p->local = 0;
+    p->policy = NORTH_LBG_POLICY_RR;
+    p->p2c_seed = 0;
+    p->compress = 0;
 
     /*
      ** clear the state bitmap
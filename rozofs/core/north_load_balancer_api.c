@@ -39,6 +39,8 @@
 #include "af_inet_stream_api.h"
 #include <rozofs/rozofs_timer_conf.h>
 #include "ruc_traffic_shaping.h"
+#include "ruc_sockCtl_api.h"
+#include "af_unix_socket_compress.h"
 
 
 void north_lbg_entry_start_timer(north_lbg_entry_ctx_t *entry_p,uint32_t time_ms) ;
@@ -46,6 +48,21 @@ void north_lbg_entry_timeout_CBK (void *opaque);
 void north_lbg_entry_stop_timer(north_lbg_entry_ctx_t *pObj);
 int north_lbg_attach_app_sup_cbk_on_entries(north_lbg_ctx_t  *lbg_p);
 
+/*__________________________________________________________________________
+*/
+/**
+*  Policy names as displayed
+*/
+char * north_lbg_policy2String(int policy)
+{
+   switch (policy)
+   {
+     case NORTH_LBG_POLICY_RR:  return "rr ";
+     case NORTH_LBG_POLICY_LOR: return "lor";
+     case NORTH_LBG_POLICY_P2C: return "p2c";
+     default:                   return "???";
+   }
+}
 /*__________________________________________________________________________
 */
 /**
@@ -119,6 +136,76 @@ char *north_lbg_display_lbg_state(char * pchar,int lbg_id)
 }
 
 
+/*
+** Callback of the owner of the messages (the transaction engine) that
+** keeps track of the entry each message is sent on
+*/
+north_lbg_xmit_accounting_cbk_t north_lbg_xmit_accounting_cbk = NULL;
+/*__________________________________________________________________________
+*/
+/**
+*  Register the callback called for each message sent on an entry
+
+  @param cbk: the callback
+*/
+void north_lbg_set_xmit_accounting_cbk(north_lbg_xmit_accounting_cbk_t cbk)
+{
+   north_lbg_xmit_accounting_cbk = cbk;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  Account a message about to be sent on an entry of a load balancing
+*  group. The message is only counted when its owner takes care of
+*  releasing it (see north_lbg_entry_account_release()). This must be
+*  done before sending, since the buffer may be released once sent.
+
+  @param lbg_p: pointer to the load balancing group
+  @param entry_p: pointer to the load balancer entry
+  @param buf_p: the message to send
+*/
+static inline void north_lbg_entry_account_xmit(north_lbg_ctx_t *lbg_p, north_lbg_entry_ctx_t *entry_p, void *buf_p)
+{
+   if (north_lbg_xmit_accounting_cbk == NULL) return;
+   if ((*north_lbg_xmit_accounting_cbk)(buf_p,lbg_p->index,entry_p->index,entry_p->load_epoch) != 0) return;
+   entry_p->inflight++;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  Release a message sent on an entry of a load balancing group: it has
+*  been responded, it has timed out or it has been aborted. On a response
+*  the smoothed response time of the entry is updated (gain 1/8)
+
+  @param lbg_idx: reference of the load balancing group
+  @param entry_idx: index of the entry the message has been sent on
+  @param epoch: load epoch of the entry when the message has been sent
+  @param latency_us: response time of the message, 0 when not responded
+*/
+void north_lbg_entry_account_release(uint32_t lbg_idx, uint32_t entry_idx, uint32_t epoch, uint64_t latency_us)
+{
+   north_lbg_ctx_t       *lbg_p;
+   north_lbg_entry_ctx_t *entry_p;
+
+   lbg_p = north_lbg_getObjCtx_p(lbg_idx);
+   if (lbg_p == NULL) return;
+   if (entry_idx >= lbg_p->nb_entries_conf) return;
+   entry_p = &lbg_p->entry_tb[entry_idx];
+   /*
+   ** the load has been reset since the message was sent
+   */
+   if (entry_p->load_epoch != epoch) return;
+   if (entry_p->inflight != 0) entry_p->inflight--;
+
+   if (latency_us == 0) return;
+   if (entry_p->ewma_latency_us == 0) 
+   {
+     entry_p->ewma_latency_us = latency_us;
+     return;
+   }
+   entry_p->ewma_latency_us = (int64_t)entry_p->ewma_latency_us + (((int64_t)latency_us - (int64_t)entry_p->ewma_latency_us) / 8);
+}
+
 /*__________________________________________________________________________
 */
 /**
@@ -148,6 +235,7 @@ void north_lbg_poll_xmit_queue(north_lbg_ctx_t  *lbg_p, north_lbg_entry_ctx_t  *
    {         
      ruc_objRemove((ruc_obj_desc_t*)buf_p);
      lbg_p->stats.xmitQueuelen--;
+     north_lbg_entry_account_xmit(lbg_p,entry_p,buf_p);
      ret = af_unix_generic_send_stream_with_idx(entry_p->sock_ctx_ref,buf_p);  
      if (ret ==  0)
      {
@@ -1433,6 +1521,7 @@ reloop:
   ** That's fine, get the pointer to the entry in order to get its socket context reference
   */
   north_lbg_entry_ctx_t  *entry_p = &lbg_p->entry_tb[entry_idx];
+  north_lbg_entry_account_xmit(lbg_p,entry_p,buf_p);
   NORTH_LBG_START_PROF((&entry_p->stats));
   ret = af_unix_generic_send_stream_with_idx(entry_p->sock_ctx_ref,buf_p); 
   NORTH_LBG_STOP_PROF((&entry_p->stats));
@@ -1498,6 +1587,7 @@ reloop:
   ** That's fine, get the pointer to the entry in order to get its socket context reference
   */
   north_lbg_entry_ctx_t  *entry_p = &lbg_p->entry_tb[entry_idx];
+  north_lbg_entry_account_xmit(lbg_p,entry_p,buf_p);
   NORTH_LBG_START_PROF((&entry_p->stats));
   ret = af_unix_generic_send_stream_with_idx(entry_p->sock_ctx_ref,buf_p); 
   NORTH_LBG_STOP_PROF((&entry_p->stats));
@@ -1761,3 +1851,98 @@ uint32_t north_lbg_get_remote_ip_address(int  lbg_idx)
   }
   return 0;
 }
+/*__________________________________________________________________________
+*/
+/**
+*  Set the entry selection policy of a lbg
+
+  @param lbg_idx : reference of the load balancing group
+  @param policy : see north_lbg_policy_e
+
+  @retval 0 : success
+  @retval -1 : error
+*/
+int north_lbg_set_policy(int  lbg_idx, int policy)
+{
+  north_lbg_ctx_t  *lbg_p;
+  
+  lbg_p = north_lbg_getObjCtx_p(lbg_idx);
+  if (lbg_p == NULL) 
+  {
+    warning("north_lbg_set_policy: no such instance %d ",lbg_idx);
+    return -1;
+  }
+  if ((policy < 0) || (policy >= NORTH_LBG_POLICY_MAX))
+  {
+    warning("north_lbg_set_policy: lbg %d unexpected policy %d ",lbg_idx,policy);
+    return -1;
+  }
+  lbg_p->policy   = policy;
+  lbg_p->p2c_seed = lbg_idx;
+  return 0;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  Get the entry selection policy of a lbg
+
+  @param lbg_idx : reference of the load balancing group
+
+  @retval the policy (see north_lbg_policy_e)
+*/
+int north_lbg_get_policy(int  lbg_idx)
+{
+  north_lbg_ctx_t  *lbg_p;
+  
+  lbg_p = north_lbg_getObjCtx_p(lbg_idx);
+  if (lbg_p == NULL) 
+  {
+    return NORTH_LBG_POLICY_RR;
+  }
+  return lbg_p->policy;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  Request the compression of the rpc messages on the connections of a lbg
+   (see af_unix_socket_compress.c). Takes effect on the next establishment
+   of each connection, so it should be called just after the lbg creation
+
+  @param lbg_idx : reference of the load balancing group
+  @param enable : 1 to request the compression, 0 to stop it
+
+  @retval 0 : success
+  @retval -1 : error
+*/
+int north_lbg_set_compression(int  lbg_idx, int enable)
+{
+  north_lbg_ctx_t       *lbg_p;
+  north_lbg_entry_ctx_t *entry_p;
+  af_unix_ctx_generic_t *sock_p;
+  int                    i;
+  
+  lbg_p = north_lbg_getObjCtx_p(lbg_idx);
+  if (lbg_p == NULL) 
+  {
+    warning("north_lbg_set_compression: no such instance %d ",lbg_idx);
+    return -1;
+  }
+#ifndef ROZOFS_LZ4
+  if (enable)
+  {
+    warning("north_lbg_set_compression: RozoFS is built without LZ4, compression ignored on lbg %d",lbg_idx);
+    return -1;
+  }
+#endif
+  lbg_p->compress = enable ? 1 : 0;
+  
+  entry_p = lbg_p->entry_tb;
+  for (i = 0; i < lbg_p->nb_entries_conf ; i++,entry_p++)
+  {
+    if (entry_p->sock_ctx_ref < 0) continue;
+    sock_p = af_unix_getObjCtx_p(entry_p->sock_ctx_ref);
+    if (sock_p == NULL) continue;
+    af_unix_compress_request(sock_p,lbg_p->compress);
+  }
+  return 0;
+}
@@ -15,6 +15,17 @@
   along with this program.  If not, see
   <http://www.gnu.org/licenses/>.
  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/sysmacros.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ifaddrs.h>
 #include <numa.h>
 #include "rozofs_numa.h"
 #include <rozofs/common/common_config.h>
@@ -99,3 +110,94 @@ void rozofs_numa_allocate_node(int instance, char * criteria)
      info("rozofs_numa_allocate_node(%d,%s): pined on node %d", instance, criteria, bit);
    }
 } 
+/**
+*  Read a numa_node file of the sysfs
+
+   @param path: the sysfs file path
+
+   @retval the node number
+   @retval -1 when unknown
+*/
+static int rozofs_numa_read_sysfs_node(char * path) {
+  FILE * f;
+  int    node = -1;
+  
+  f = fopen(path,"r");
+  if (f == NULL) return -1;
+  if (fscanf(f,"%d",&node) != 1) node = -1;
+  fclose(f);
+  /*
+  ** -1 is returned by the kernel on non NUMA platforms
+  */
+  if (node >= numa_num_configured_nodes()) node = -1;
+  return node;
+}
+/**
+*  Get the NUMA node the block device holding a path is attached to
+
+   @param path: a file or directory path
+
+   @retval the node number
+   @retval -1 when unknown
+*/
+int rozofs_numa_node_of_path(char * path) {
+  struct stat st;
+  char        sysfs[128];
+  char        devpath[PATH_MAX];
+  char      * pChar;
+  int         node;
+
+  if (numa_available() < 0) return -1;
+  if (stat(path, &st) < 0) return -1;
+  
+  /*
+  ** Resolve the sysfs device path of the block device, and walk up
+  ** to the first parent device that tells its node (NVMe controller,
+  ** PCI device...)
+  */
+  sprintf(sysfs,"/sys/dev/block/%u:%u", major(st.st_dev), minor(st.st_dev));
+  if (realpath(sysfs, devpath) == NULL) return -1;
+  
+  while (1) {
+    pChar = strrchr(devpath,'/');
+    if ((pChar == NULL) || (pChar == devpath)) break;
+    if (strlen(devpath) + strlen("/numa_node") < sizeof(devpath)) {
+      strcat(devpath,"/numa_node");
+      node = rozofs_numa_read_sysfs_node(devpath);
+      if (node >= 0) return node;
+    }  
+    *pChar = 0;
+    if (strcmp(devpath,"/sys/devices") == 0) break;
+  }
+  return -1;
+}
+/**
+*  Get the NUMA node the network interface owning an IP address is 
+*  attached to
+
+   @param ipv4: the IP address in host order
+
+   @retval the node number
+   @retval -1 when unknown
+*/
+int rozofs_numa_node_of_ipv4(uint32_t ipv4) {
+  struct ifaddrs * ifa_list;
+  struct ifaddrs * ifa;
+  char             sysfs[128];
+  int              node = -1;
+  
+  if (numa_available() < 0) return -1;
+  if (ipv4 == INADDR_ANY) return -1;
+  if (getifaddrs(&ifa_list) < 0) return -1;
+  
+  for (ifa = ifa_list; ifa != NULL; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == NULL) continue;
+    if (ifa->ifa_addr->sa_family != AF_INET) continue;
+    if (ntohl(((struct sockaddr_in *)ifa->ifa_addr)->sin_addr.s_addr) != ipv4) continue;
+    snprintf(sysfs,sizeof(sysfs),"/sys/class/net/%s/device/numa_node", ifa->ifa_name);
+    node = rozofs_numa_read_sysfs_node(sysfs);
+    break;
+  }
+  freeifaddrs(ifa_list);
+  return node;
+}
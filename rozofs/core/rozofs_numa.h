@@ -17,6 +17,7 @@
  */
  #ifndef ROZOFS_NUMA_H
  #define ROZOFS_NUMA_H
+#include <stdint.h>
 #include <numa.h>
 /**
 *  case of NUMA: allocate the running node according to the
@@ -26,5 +27,24 @@
    @param criteria: the criteria that leaded to the instance choice
 */
 void rozofs_numa_allocate_node(int instance, char * criteria);
+/**
+*  Get the NUMA node the block device holding a path is attached to
+
+   @param path: a file or directory path
+
+   @retval the node number
+   @retval -1 when unknown
+*/
+int rozofs_numa_node_of_path(char * path);
+/**
+*  Get the NUMA node the network interface owning an IP address is 
+*  attached to
+
+   @param ipv4: the IP address in host order
+
+   @retval the node number
+   @retval -1 when unknown
+*/
+int rozofs_numa_node_of_ipv4(uint32_t ipv4);
 
 #endif
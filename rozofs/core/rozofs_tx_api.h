@@ -234,6 +234,62 @@ void rozofs_tx_stop_timer(rozofs_tx_ctx_t *pObj);
 */
 void rozofs_tx_start_timer(rozofs_tx_ctx_t *tx_p,uint32_t time_ms) ;
 
+/*
+** Round trip time estimation per load balancing group
+**
+** The RTT of the requests which guard timer is started with
+** rozofs_tx_start_timer_lbg() is measured, and a smoothed RTT and
+** RTT variance are computed per lbg the way TCP does (RFC 6298).
+** When the RPC_RTO_MIN timer is not 0, the guard timer of these
+** requests is srtt + 4 * rttvar, doubled on each consecutive
+** time-out, and bounded by RPC_RTO_MIN and the configured timer.
+** RPC_RTO_MIN is 0 by default: the configured timer is used, since a
+** storio may take several seconds to answer under a heavy disk load.
+** It should only be set to a floor well above the disk response time.
+*/
+#define ROZOFS_TX_RTT_MAX_LBG      1024
+#define ROZOFS_TX_RTT_NO_LBG       ((uint32_t)-1)
+#define ROZOFS_TX_RTT_MAX_BACKOFF  6
+
+typedef struct _rozofs_tx_rtt_t
+{
+  uint32_t  srtt_us;     /**< smoothed round trip time in us        */
+  uint32_t  rttvar_us;   /**< round trip time variance in us        */
+  uint32_t  last_us;     /**< last measured round trip time in us   */
+  uint32_t  max_us;      /**< max measured round trip time in us    */
+  uint32_t  backoff;     /**< number of consecutive time-outs       */
+  uint32_t  rto_ms;      /**< last computed time-out in ms          */
+  uint64_t  samples;     /**< number of measures                    */
+  uint64_t  timeouts;    /**< number of time-outs                   */
+} rozofs_tx_rtt_t;
+
+/*
+**____________________________________________________
+*/
+/**
+*  Get the guard timer to use for a request sent on a lbg
+
+  @param lbg_id : reference of the load balancing group
+  @param max_ms : configured time-out in ms
+  
+  @retval the time-out in ms
+*/
+uint32_t rozofs_tx_rto_ms(uint32_t lbg_id, uint32_t max_ms);
+
+/*
+**____________________________________________________
+*/
+/*
+  start the guard timer associated with a transaction sent on a lbg
+  and measure its round trip time
+
+@param     : tx_p : pointer to the transaction context
+@param     : lbg_id : reference of the load balancing group
+@param     : time_sec : configured time-out in seconds
+@retval   : none
+*/
+void rozofs_tx_start_timer_lbg(rozofs_tx_ctx_t *tx_p, uint32_t lbg_id, uint32_t time_sec);
+
 /*
    rozofs_tx_module_init
 
@@ -156,6 +156,12 @@ typedef struct _rozofs_tx_ctx_p_t
     sys_recv_pf_t  recv_cbk;   /**< receive callback */
     void *user_param;         /**< user param to provide upon reception */
     com_tx_tmr_cell_t  rpc_guard_timer;   /**< guard timer associated with the transaction */
+    uint32_t           rtt_lbg_id;        /**< lbg which RTT is measured, ROZOFS_TX_RTT_NO_LBG when none */
+    uint64_t           rtt_start_us;      /**< time the request has been sent in us */
+    uint32_t           load_lbg_id;       /**< lbg the request is counted on, ROZOFS_TX_RTT_NO_LBG when none */
+    uint32_t           load_entry_idx;    /**< entry of the lbg the request has been sent on */
+    uint32_t           load_epoch;        /**< load epoch of that entry */
+    uint64_t           load_start_us;     /**< time the request has been sent on that entry in us */
       /* FSM */
 //    uma_fsm_t    sys_tx_fsm;         /**< active fsm for the current transaction  */
     
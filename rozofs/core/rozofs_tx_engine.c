@@ -27,6 +27,8 @@
 #include "rozofs_tx_api.h"
 #include "uma_dbg_api.h"
 #include "ruc_buffer_debug.h"
+#include <rozofs/rozofs_timer_conf.h>
+#include "north_lbg_api.h"
 
 rozofs_tx_ctx_t *rozofs_tx_context_freeListHead; /**< head of list of the free context  */
 rozofs_tx_ctx_t rozofs_tx_context_activeListHead; /**< list of the active context     */
@@ -37,6 +39,7 @@ rozofs_tx_ctx_t *rozofs_tx_context_pfirst; /**< pointer to the first context of
 uint32_t rozofs_tx_global_transaction_id = 0;
 
 uint64_t rozofs_tx_stats[ROZOFS_TX_COUNTER_MAX];
+rozofs_tx_rtt_t rozofs_tx_rtt[ROZOFS_TX_RTT_MAX_LBG]; /**< RTT estimation per lbg */
 /**
  * Buffers information
  */
@@ -55,6 +58,8 @@ void *rozofs_tx_pool[_ROZOFS_TX_MAX_POOL];
 #define MICROLONG(time) ((unsigned long long)time.tv_sec * 1000000 + time.tv_usec)
 #define ROZOFS_TX_DEBUG_TOPIC      "trx"
 #define ROZOFS_TX_DEBUG_TOPIC2      "tx_test"
+#define ROZOFS_TX_RTT_DEBUG_TOPIC   "txRtt"
+#define ROZOFS_TX_TMR_TICK_MS       100 /**< tick of the guard timers */
 
 /*__________________________________________________________________________
   Trace level debug function
@@ -116,8 +121,40 @@ void rozofs_tx_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
   - 
   RETURN: none
   ==========================================================================*/
+void rozofs_tx_rtt_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
+    char *pChar = uma_dbg_get_buffer();
+    rozofs_tx_rtt_t *rtt;
+    uint32_t lbg_id;
+    int doreset = 0;
+
+    if ((argv[1] != NULL) && (strcmp(argv[1], "reset") == 0)) doreset = 1;
+
+    pChar += sprintf(pChar, "adaptive time-out : %s (RPC_RTO_MIN %u ms)\n",
+            ROZOFS_TMR_GET(TMR_RPC_RTO_MIN) ? "enabled" : "disabled", ROZOFS_TMR_GET(TMR_RPC_RTO_MIN));
+    pChar += sprintf(pChar, "+------+------------+----------+----------+----------+----------+---------+---------+------------+\n");
+    pChar += sprintf(pChar, "| lbg  |  samples   | srtt us  |rttvar us | last us  |  max us  | rto ms  | backoff |  timeouts  |\n");
+    pChar += sprintf(pChar, "+------+------------+----------+----------+----------+----------+---------+---------+------------+\n");
+    for (lbg_id = 0; lbg_id < ROZOFS_TX_RTT_MAX_LBG; lbg_id++) {
+        rtt = &rozofs_tx_rtt[lbg_id];
+        if ((rtt->samples == 0) && (rtt->timeouts == 0)) continue;
+        pChar += sprintf(pChar, "| %4u | %10llu | %8u | %8u | %8u | %8u | %7u | %7u | %10llu |\n",
+                lbg_id, (unsigned long long) rtt->samples,
+                rtt->srtt_us, rtt->rttvar_us, rtt->last_us, rtt->max_us,
+                rtt->rto_ms, rtt->backoff, (unsigned long long) rtt->timeouts);
+        if (doreset) {
+            rtt->samples = 0;
+            rtt->timeouts = 0;
+            rtt->max_us = 0;
+        }
+    }
+    pChar += sprintf(pChar, "+------+------------+----------+----------+----------+----------+---------+---------+------------+\n");
+    if (doreset) pChar += sprintf(pChar, "Reset Done\n");
+    uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+
 void rozofs_tx_debug_init() {
     uma_dbg_addTopic(ROZOFS_TX_DEBUG_TOPIC, rozofs_tx_debug);
+    uma_dbg_addTopic_option(ROZOFS_TX_RTT_DEBUG_TOPIC, rozofs_tx_rtt_debug, UMA_DBG_OPTION_RESET);
 }
 
 
@@ -262,6 +299,8 @@ void rozofs_tx_ctxInit(rozofs_tx_ctx_t *p, uint8_t creation) {
      ** timer cell
      */
     ruc_listEltInit((ruc_obj_desc_t *) & p->rpc_guard_timer);
+    p->rtt_lbg_id = ROZOFS_TX_RTT_NO_LBG;
+    p->load_lbg_id = ROZOFS_TX_RTT_NO_LBG;
     /*
     ** load balancing context init
     */
@@ -364,6 +403,29 @@ uint32_t rozofs_tx_createIndex(uint32_t transaction_id) {
 }
 
 
+/*
+ **____________________________________________________
+ */
+
+/*
+    Release the request of a transaction from the load of the lbg entry
+    it has been sent on
+
+@param     :  tx_p : pointer to the transaction context
+@param     :  replied : 1 when the reply has been received
+ */
+static inline void rozofs_tx_load_release(rozofs_tx_ctx_t *tx_p, int replied) {
+    uint64_t latency_us = 0;
+
+    if (tx_p->load_lbg_id == ROZOFS_TX_RTT_NO_LBG) return;
+    if (replied) {
+        latency_us = rozofs_get_ticker_us() - tx_p->load_start_us;
+        if (latency_us == 0) latency_us = 1;
+    }
+    north_lbg_entry_account_release(tx_p->load_lbg_id, tx_p->load_entry_idx, tx_p->load_epoch, latency_us);
+    tx_p->load_lbg_id = ROZOFS_TX_RTT_NO_LBG;
+}
+
 /*
  **____________________________________________________
  */
@@ -407,6 +469,14 @@ uint32_t rozofs_tx_free_from_idx(uint32_t transaction_id) {
      ** remove it from the active list
      */
     ruc_objRemove((ruc_obj_desc_t*) p);
+    /*
+     ** stop the guard timer if still running
+     */
+    rozofs_tx_stop_timer(p);
+    /*
+     ** the request is no more pending on the lbg entry it has been sent on
+     */
+    rozofs_tx_load_release(p, 0);
     /*
      ** release the receive buffer is still in the context
      */
@@ -483,6 +553,114 @@ uint32_t rozofs_tx_free_from_ptr(rozofs_tx_ctx_t *p) {
 
 
 
+/*
+ **____________________________________________________
+ */
+
+/*
+    Update the RTT estimation of a lbg with the RTT of a transaction
+    which reply has been received
+
+@param     :  tx_p : pointer to the transaction context
+ */
+static inline void rozofs_tx_rtt_sample(rozofs_tx_ctx_t *tx_p) {
+    rozofs_tx_rtt_t *rtt;
+    uint64_t now;
+    uint32_t sample;
+    uint32_t delta;
+
+    if (tx_p->rtt_lbg_id >= ROZOFS_TX_RTT_MAX_LBG) return;
+    rtt = &rozofs_tx_rtt[tx_p->rtt_lbg_id];
+    tx_p->rtt_lbg_id = ROZOFS_TX_RTT_NO_LBG;
+
+    now = rozofs_get_ticker_us();
+    if (now < tx_p->rtt_start_us) return;
+    sample = now - tx_p->rtt_start_us;
+    if (sample == 0) sample = 1;
+
+    if (rtt->srtt_us == 0) {
+        /*
+         ** first measure
+         */
+        rtt->srtt_us = sample;
+        rtt->rttvar_us = sample / 2;
+    } else {
+        /*
+         ** rttvar = 3/4 rttvar + 1/4 |srtt - sample|
+         ** srtt   = 7/8 srtt + 1/8 sample
+         */
+        delta = (rtt->srtt_us > sample) ? (rtt->srtt_us - sample) : (sample - rtt->srtt_us);
+        rtt->rttvar_us = rtt->rttvar_us - (rtt->rttvar_us >> 2) + (delta >> 2);
+        rtt->srtt_us = rtt->srtt_us - (rtt->srtt_us >> 3) + (sample >> 3);
+    }
+    rtt->last_us = sample;
+    if (sample > rtt->max_us) rtt->max_us = sample;
+    rtt->backoff = 0;
+    rtt->samples++;
+}
+
+/*
+ **____________________________________________________
+ */
+
+/*
+    Back off the time-out of a lbg on a transaction time-out
+
+@param     :  tx_p : pointer to the transaction context
+ */
+static inline void rozofs_tx_rtt_timeout(rozofs_tx_ctx_t *tx_p) {
+    rozofs_tx_rtt_t *rtt;
+
+    if (tx_p->rtt_lbg_id >= ROZOFS_TX_RTT_MAX_LBG) return;
+    rtt = &rozofs_tx_rtt[tx_p->rtt_lbg_id];
+    tx_p->rtt_lbg_id = ROZOFS_TX_RTT_NO_LBG;
+
+    if (rtt->backoff < ROZOFS_TX_RTT_MAX_BACKOFF) rtt->backoff++;
+    rtt->timeouts++;
+}
+
+/*
+ **____________________________________________________
+ */
+
+/**
+*  Get the guard timer to use for a request sent on a lbg
+
+  The time-out is srtt + 4 * rttvar (at least the com_tx timer tick),
+  doubled on each consecutive time-out. It is bounded by the RPC_RTO_MIN
+  timer and by the configured time-out. The configured time-out is used
+  when RPC_RTO_MIN is 0 or when the lbg RTT is not known yet.
+
+  @param lbg_id : reference of the load balancing group
+  @param max_ms : configured time-out in ms
+  
+  @retval the time-out in ms
+*/
+uint32_t rozofs_tx_rto_ms(uint32_t lbg_id, uint32_t max_ms) {
+    rozofs_tx_rtt_t *rtt;
+    uint32_t min_ms;
+    uint64_t var_us;
+    uint64_t rto_ms;
+
+    min_ms = ROZOFS_TMR_GET(TMR_RPC_RTO_MIN);
+    if ((min_ms == 0) || (lbg_id >= ROZOFS_TX_RTT_MAX_LBG)) return max_ms;
+
+    rtt = &rozofs_tx_rtt[lbg_id];
+    if (rtt->samples == 0) {
+        rtt->rto_ms = max_ms;
+        return max_ms;
+    }
+
+    var_us = 4 * (uint64_t) rtt->rttvar_us;
+    if (var_us < (ROZOFS_TX_TMR_TICK_MS * 1000)) var_us = ROZOFS_TX_TMR_TICK_MS * 1000;
+    rto_ms = ((rtt->srtt_us + var_us + 999) / 1000) << rtt->backoff;
+
+    if (rto_ms < min_ms) rto_ms = min_ms;
+    if (rto_ms > max_ms) rto_ms = max_ms;
+    rtt->rto_ms = rto_ms;
+    return rto_ms;
+}
+
 /*
  **____________________________________________________
  */
@@ -528,6 +706,8 @@ void rozofs_tx_timeout_CBK(void *opaque) {
      ** Update global statistics
      */
     TX_STATS(ROZOFS_TX_TIMEOUT);
+    rozofs_tx_rtt_timeout(pObj);
+    rozofs_tx_load_release(pObj, 0);
     (*(pObj->recv_cbk))(pObj, pObj->user_param);
 }
 
@@ -589,6 +769,38 @@ void rozofs_tx_start_timer(rozofs_tx_ctx_t *tx_p, uint32_t time_ms) {
 
 }
 
+/*
+ **____________________________________________________
+ */
+
+/*
+  start the guard timer associated with a transaction sent on a lbg
+  and measure its round trip time
+
+@param     : tx_p : pointer to the transaction context
+@param     : lbg_id : reference of the load balancing group
+@param     : time_sec : configured time-out in seconds
+@retval   : none
+ */
+void rozofs_tx_start_timer_lbg(rozofs_tx_ctx_t *tx_p, uint32_t lbg_id, uint32_t time_sec) {
+    /*
+     ** the context may have been released already (see rozofs_tx_start_timer)
+     */
+    if (tx_p->free == TRUE) {
+        return;
+    }
+    tx_p->rtt_lbg_id = lbg_id;
+    tx_p->rtt_start_us = rozofs_get_ticker_us();
+
+    tx_p->rpc_guard_timer_flg = FALSE;
+    com_tx_tmr_stop(&tx_p->rpc_guard_timer);
+    com_tx_tmr_start(COM_TX_TMR_SLOT0,
+            &tx_p->rpc_guard_timer,
+            rozofs_tx_rto_ms(lbg_id, time_sec * 1000),
+            rozofs_tx_timeout_CBK,
+            (void*) tx_p);
+}
+
 /*
  **____________________________________________________
  */
@@ -753,6 +965,11 @@ void rozofs_tx_recv_rpc_cbk(void *userRef, uint32_t lbg_id, void *recv_buf) {
      ** according to the message opcode
      */
     rozofs_tx_stop_timer(this);
+    /*
+     ** update the RTT estimation of the lbg
+     */
+    rozofs_tx_rtt_sample(this);
+    rozofs_tx_load_release(this, 1);
     /*
      ** remove the reference of the xmit buffer if that one has been saved in the transaction context
      */
@@ -844,6 +1061,7 @@ void rozofs_tx_xmit_abort_rpc_cbk(void *userRef, uint32_t lbg_id, void *xmit_buf
      ** update xmit  stats
      */
     TX_STATS(ROZOFS_TX_SEND_ERROR);
+    rozofs_tx_load_release(this, 0);
     /*
      ** set the status and errno to 0
      */
@@ -917,6 +1135,44 @@ uint32_t rozofs_tx_get_rpc_msg_len_cbk(char *hdr_p) {
 }
 
 
+/*
+ **____________________________________________________
+ */
+
+/**
+ * Lbg xmit accounting callback: called by a lbg for each message about to
+   be sent on one of its entries. The entry is recorded in the transaction
+   context of the request, so that the request is released from the load
+   of the entry on its reply, time-out, abort or on the transaction release.
+ 
+  @param xmit_buf: pointer to the xmit buffer that contains the RPC request
+  @param lbg_id: reference of the load balancing group
+  @param entry_idx: index of the entry the request is sent on
+  @param epoch: load epoch of the entry
+  
+  @retval 0 when the request belongs to a transaction
+  @retval -1 otherwise
+ */
+static int rozofs_tx_lbg_xmit_accounting_cbk(void *xmit_buf, uint32_t lbg_id, uint32_t entry_idx, uint32_t epoch) {
+    rozofs_rpc_common_t *com_hdr_p;
+    rozofs_tx_ctx_t *this;
+    uint32_t xid;
+
+    com_hdr_p = (rozofs_rpc_common_t*) ruc_buf_getPayload(xmit_buf);
+    xid = ntohl(com_hdr_p->xid);
+    this = rozofs_tx_getObjCtx_p(rozofs_tx_get_tx_idx_from_xid(xid));
+    if ((this == NULL) || (this->free == TRUE) || (this->xid != xid)) return -1;
+    /*
+     ** the request may be sent again on another entry
+     */
+    rozofs_tx_load_release(this, 0);
+    this->load_lbg_id = lbg_id;
+    this->load_entry_idx = entry_idx;
+    this->load_epoch = epoch;
+    this->load_start_us = rozofs_get_ticker_us();
+    return 0;
+}
+
 /*
  **____________________________________________________
  */
@@ -1027,12 +1283,16 @@ uint32_t rozofs_tx_module_init(uint32_t transaction_count,
     /*
      ** Initialize the RESUME and SUSPEND timer module: 100 ms
      */
-    com_tx_tmr_init(100, 15);
+    com_tx_tmr_init(ROZOFS_TX_TMR_TICK_MS, 15);
     /*
      ** Clear the statistics counter
      */
     memset(rozofs_tx_stats, 0, sizeof (uint64_t) * ROZOFS_TX_COUNTER_MAX);
     rozofs_tx_debug_init();
+    /*
+     ** keep track of the lbg entry each request is sent on
+     */
+    north_lbg_set_xmit_accounting_cbk(rozofs_tx_lbg_xmit_accounting_cbk);
     while (1) {
         rozofs_tx_pool[_ROZOFS_TX_SMALL_TX_POOL] = ruc_buf_poolCreate(rozofs_small_tx_xmit_count, rozofs_small_tx_xmit_size);
         if (rozofs_tx_pool[_ROZOFS_TX_SMALL_TX_POOL] == NULL) {
@@ -80,6 +80,7 @@ void * ruc_buf_poolCreate_shared(uint32_t nbBuf, uint32_t bufsize, key_t key/*,r
      return NULL;
    }
    poolRef->type = BUF_POOL_HEAD;
+   poolRef->opaque_ref = NULL;
    /*
    **  create the usrData part
    */
@@ -31,6 +31,7 @@
 #include "ruc_list.h"
 #include "ruc_buffer_api.h"
 #include "ruc_trace_api.h"
+#include "ruc_buffer_mag.h"
 
 #define ROZOFS_HUGE_PAGE_SIZE  (2UL*1024*1024)
 
@@ -146,6 +147,7 @@ static inline void * ruc_buf_poolCreate(uint32_t nbBuf,uint32_t bufsize)
      return NULL;
    }
    poolRef->type = BUF_POOL_HEAD;
+   poolRef->opaque_ref = NULL; /* magazines (see ruc_buffer_mag.h) */
    /*
    **  create the usrData part
    */
@@ -291,6 +293,10 @@ static inline uint32_t ruc_buf_isPoolEmpty(void * poolRef)
     RUC_WARNING(p->type);
     return TRUE;
   }
+  if ((p->opaque_ref != NULL) && (((ruc_buf_mag_pool_t*)p->opaque_ref)->full_buffers != 0))
+  {
+    return FALSE;
+  }
   return (ruc_objIsEmptyList((ruc_obj_desc_t*)p));
 }
 
@@ -329,6 +335,15 @@ static inline void * ruc_buf_getBuffer(void * poolRef)
 
   p = (ruc_buf_t*)poolRef;
   pelem = (ruc_buf_t*)ruc_objGetFirst((ruc_obj_desc_t*)p);
+  /*
+  ** When the free list is empty, take back the buffers freed by the other
+  ** threads in their magazines
+  */
+  if ((pelem == (ruc_buf_t* )NULL) && (p->opaque_ref != NULL)
+   && (ruc_buf_mag_reclaim((ruc_buf_mag_pool_t*)p->opaque_ref) != 0))
+  {
+    pelem = (ruc_buf_t*)ruc_objGetFirst((ruc_obj_desc_t*)p);
+  }
   if (pelem == (ruc_buf_t* )NULL)
   {
     RUC_BUF_TRC("buf_getBuffer_NULL",poolRef,-1,-1,-1);
@@ -446,6 +461,14 @@ static inline uint32_t ruc_buf_freeBuffer_internal(char * file, int line, void *
   **update the current number of buffer in the buffer pool
   */
    phead->usrLen++;
+  /*
+  ** keep some full magazines in the depot for the other threads
+  */
+  if (phead->opaque_ref != NULL) 
+  {
+    ruc_buf_mag_pool_t * mp = (ruc_buf_mag_pool_t*)phead->opaque_ref;
+    if (mp->full_count < mp->low_mags) ruc_buf_mag_refill(mp);
+  }
 
   return RUC_OK;
 }
@@ -635,6 +658,13 @@ static inline uint32_t ruc_buf_getFreeBufferCount(void * poolRef)
     return 0;
   }
 #endif
+  /*
+  ** the buffers in the depot of the magazines are free too
+  */
+  if (p->opaque_ref != NULL) 
+  {
+    return(p->usrLen + ((ruc_buf_mag_pool_t*)p->opaque_ref)->full_buffers);
+  }
   return(p->usrLen);
 }
 /*
@@ -0,0 +1,513 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <rozofs/common/log.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include <rozofs/core/rozofs_string.h>
+
+#include "ruc_buffer_api.h"
+#include "ruc_buffer_mag.h"
+
+/*
+** Table of the pools with magazines for rozodiag
+*/
+static ruc_buf_mag_pool_t * ruc_buf_mag_table[RUC_BUF_MAG_MAX_POOLS];
+static uint32_t             ruc_buf_mag_nb = 0;
+/*
+** Thread index of the calling thread, and system thread id of each index
+*/
+static __thread int         ruc_buf_mag_thread_idx = -1;
+static uint32_t             ruc_buf_mag_thread_nb = 0;
+static pid_t                ruc_buf_mag_thread_tid[RUC_BUF_MAG_MAX_THREADS];
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Get the magazine thread index of the calling thread
+
+   @retval the thread index, or -1 when there are too many threads
+*/
+static inline int ruc_buf_mag_get_thread_idx() {
+  uint32_t idx;
+
+  if (ruc_buf_mag_thread_idx >= 0) return ruc_buf_mag_thread_idx;
+
+  idx = __sync_fetch_and_add(&ruc_buf_mag_thread_nb, 1);
+  if (idx >= RUC_BUF_MAG_MAX_THREADS) {
+    __sync_fetch_and_sub(&ruc_buf_mag_thread_nb, 1);
+    return -1;
+  }
+  ruc_buf_mag_thread_tid[idx] = syscall(SYS_gettid);
+  ruc_buf_mag_thread_idx = idx;
+  return idx;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Push a magazine on a depot stack
+
+   The head of a stack holds a tag that changes on every update, so a
+   magazine popped and pushed back meanwhile makes the CAS fail (ABA).
+
+   @param mp: the magazines of the pool
+   @param head: the depot stack
+   @param m: the magazine
+*/
+static inline void ruc_buf_mag_push(ruc_buf_mag_pool_t * mp, volatile uint64_t * head, ruc_buf_mag_t * m) {
+  uint64_t old;
+  uint64_t new;
+  uint32_t idx = (m - mp->mags) + 1;
+
+  do {
+    old     = *head;
+    m->next = (uint32_t) old;
+    new     = (((old >> 32) + 1) << 32) | idx;
+  } while (!__sync_bool_compare_and_swap(head, old, new));
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Pop a magazine from a depot stack
+
+   @param mp: the magazines of the pool
+   @param head: the depot stack
+
+   @retval the magazine or NULL when the stack is empty
+*/
+static inline ruc_buf_mag_t * ruc_buf_mag_pop(ruc_buf_mag_pool_t * mp, volatile uint64_t * head) {
+  uint64_t        old;
+  uint64_t        new;
+  uint32_t        idx;
+  ruc_buf_mag_t * m;
+
+  do {
+    old = *head;
+    idx = (uint32_t) old;
+    if (idx == 0) return NULL;
+    m   = &mp->mags[idx-1];
+    new = (((old >> 32) + 1) << 32) | m->next;
+  } while (!__sync_bool_compare_and_swap(head, old, new));
+  return m;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Push a magazine on the full stack of the depot
+
+   @param mp: the magazines of the pool
+   @param m: the magazine
+*/
+static inline void ruc_buf_mag_push_full(ruc_buf_mag_pool_t * mp, ruc_buf_mag_t * m) {
+  uint32_t count = m->count;
+
+  ruc_buf_mag_push(mp, &mp->full_head, m);
+  __sync_fetch_and_add(&mp->full_count, 1);
+  __sync_fetch_and_add(&mp->full_buffers, count);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Pop a magazine from the full stack of the depot
+
+   @param mp: the magazines of the pool
+
+   @retval the magazine or NULL when there is none
+*/
+static inline ruc_buf_mag_t * ruc_buf_mag_pop_full(ruc_buf_mag_pool_t * mp) {
+  ruc_buf_mag_t * m;
+
+  m = ruc_buf_mag_pop(mp, &mp->full_head);
+  if (m == NULL) return NULL;
+  __sync_fetch_and_sub(&mp->full_count, 1);
+  __sync_fetch_and_sub(&mp->full_buffers, m->count);
+  return m;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Owner side: take back the buffers of a full magazine in the free list
+
+   @param mp: the magazines of the pool
+
+   @retval the number of buffers taken back
+*/
+uint32_t ruc_buf_mag_reclaim(ruc_buf_mag_pool_t * mp) {
+  ruc_buf_mag_t * m;
+  uint32_t        count;
+  uint32_t        i;
+
+  m = ruc_buf_mag_pop_full(mp);
+  if (m == NULL) return 0;
+
+  count = m->count;
+  for (i = 0; i < count; i++) {
+    ruc_objInsert((ruc_obj_desc_t*)mp->pool, (ruc_obj_desc_t*)m->buf[i]);
+  }
+  mp->pool->usrLen += count;
+  m->count = 0;
+  ruc_buf_mag_push(mp, &mp->empty_head, m);
+  mp->reclaimed++;
+  return count;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Owner side: fill a magazine from the free list for the workers. The
+*  owner keeps at least 2 magazines worth of buffers for itself
+
+   @param mp: the magazines of the pool
+*/
+void ruc_buf_mag_refill(ruc_buf_mag_pool_t * mp) {
+  ruc_buf_mag_t * m;
+  ruc_buf_t     * pelem;
+
+  if (mp->pool->usrLen <= (2*RUC_BUF_MAG_SIZE)) return;
+
+  m = ruc_buf_mag_pop(mp, &mp->empty_head);
+  if (m == NULL) return;
+
+  while (m->count < RUC_BUF_MAG_SIZE) {
+    pelem = (ruc_buf_t*)ruc_objGetFirst((ruc_obj_desc_t*)mp->pool);
+    if (pelem == NULL) break;
+    ruc_objRemove((ruc_obj_desc_t*)pelem);
+    mp->pool->usrLen--;
+    m->buf[m->count++] = pelem;
+  }
+  if (m->count == 0) {
+    ruc_buf_mag_push(mp, &mp->empty_head, m);
+    return;
+  }
+  ruc_buf_mag_push_full(mp, m);
+  mp->refilled++;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Get a buffer from a pool with magazines
+
+   @param poolRef: the buffer pool
+   @param wait_ms: how long to retry when the pool is exhausted
+
+   @retval the buffer or NULL when the pool is exhausted
+*/
+void * ruc_buf_mag_get(void * poolRef, uint32_t wait_ms) {
+  ruc_buf_t          * pool = (ruc_buf_t*)poolRef;
+  ruc_buf_mag_pool_t * mp   = (ruc_buf_mag_pool_t*)pool->opaque_ref;
+  ruc_buf_mag_t      * m;
+  ruc_buf_mag_t      * full;
+  ruc_buf_t          * pelem;
+  uint32_t             waited = 0;
+  int                  idx;
+
+  if (mp == NULL) {
+    severe("ruc_buf_mag_get no magazine on pool %p",pool);
+    return NULL;
+  }
+  idx = ruc_buf_mag_get_thread_idx();
+  if (idx < 0) {
+    severe("ruc_buf_mag_get %s too many threads",mp->name);
+    return NULL;
+  }
+  if (idx == mp->owner) return ruc_buf_getBuffer(poolRef);
+
+  while (1) {
+
+    m = mp->loaded[idx];
+    if ((m != NULL) && (m->count != 0)) break;
+    /*
+    ** Exchange the empty magazine for a full one
+    */
+    full = ruc_buf_mag_pop_full(mp);
+    if (full != NULL) {
+      if (m != NULL) ruc_buf_mag_push(mp, &mp->empty_head, m);
+      mp->loaded[idx] = full;
+      mp->stats[idx].depot_get++;
+      continue;
+    }
+    /*
+    ** The pool is exhausted: give the other threads some time to free
+    ** buffers before failing
+    */
+    if (waited >= wait_ms) {
+      mp->stats[idx].exhausted++;
+      return NULL;
+    }
+    mp->stats[idx].waits++;
+    usleep(1000);
+    waited++;
+  }
+
+  pelem = m->buf[--m->count];
+  pelem->state         = BUF_ALLOC;
+  pelem->usrLen        = 0;
+  pelem->retry_counter = 0;
+  pelem->opaque_ref    = NULL;
+  pelem->inuse         = 1;
+  pelem->callBackFct   = (ruc_pf_buf_t)NULL;
+  pelem->callBackParam = NULL;
+  mp->stats[idx].get++;
+  return pelem;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Free a buffer of a pool with magazines
+
+   @param bufRef: the buffer
+
+   @retval RUC_OK when the buffer is freed
+   @retval RUC_NOK when the buffer must be freed by the owner
+*/
+uint32_t ruc_buf_mag_free(void * bufRef) {
+  ruc_buf_t          * pelem = (ruc_buf_t*)bufRef;
+  ruc_buf_t          * phead;
+  ruc_buf_mag_pool_t * mp;
+  ruc_buf_mag_t      * m;
+  int                  idx;
+
+  if (pelem->type != BUF_ELEM) return RUC_NOK;
+  phead = (ruc_buf_t*)ruc_objGetHead((ruc_obj_desc_t*)pelem);
+  if (phead == NULL) return RUC_NOK;
+  mp = (ruc_buf_mag_pool_t*)phead->opaque_ref;
+  if (mp == NULL) return RUC_NOK;
+
+  idx = ruc_buf_mag_get_thread_idx();
+  if (idx < 0) return RUC_NOK;
+  if (idx == mp->owner) return ruc_buf_freeBuffer(bufRef);
+  /*
+  ** The release callback and the other users of the buffer are
+  ** handled by the owner
+  */
+  if ((pelem->inuse > 1) || (pelem->callBackFct != NULL) || (pelem->state != BUF_ALLOC)) {
+    mp->stats[idx].rejected++;
+    return RUC_NOK;
+  }
+
+  m = mp->loaded[idx];
+  if ((m == NULL) || (m->count == RUC_BUF_MAG_SIZE)) {
+    /*
+    ** There is always an empty magazine, since every other magazine
+    ** holds at least a buffer or is loaded by a thread
+    */
+    ruc_buf_mag_t * empty = ruc_buf_mag_pop(mp, &mp->empty_head);
+    if (empty == NULL) {
+      mp->stats[idx].rejected++;
+      return RUC_NOK;
+    }
+    if (m != NULL) {
+      ruc_buf_mag_push_full(mp, m);
+      mp->stats[idx].depot_put++;
+    }
+    m = empty;
+    mp->loaded[idx] = m;
+  }
+  pelem->inuse = 0;
+  pelem->state = BUF_FREE;
+  m->buf[m->count++] = pelem;
+  mp->stats[idx].put++;
+  return RUC_OK;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Push the loaded magazine of the calling thread to the depot
+
+   @param poolRef: the buffer pool
+*/
+void ruc_buf_mag_flush(void * poolRef) {
+  ruc_buf_t          * pool = (ruc_buf_t*)poolRef;
+  ruc_buf_mag_pool_t * mp   = (ruc_buf_mag_pool_t*)pool->opaque_ref;
+  ruc_buf_mag_t      * m;
+  int                  idx;
+
+  if (mp == NULL) return;
+  idx = ruc_buf_mag_get_thread_idx();
+  if ((idx < 0) || (idx == mp->owner)) return;
+
+  m = mp->loaded[idx];
+  if ((m == NULL) || (m->count == 0)) return;
+  mp->loaded[idx] = NULL;
+  ruc_buf_mag_push_full(mp, m);
+  mp->stats[idx].depot_put++;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  rozodiag: display the magazines of every pool
+*/
+static void ruc_buf_mag_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char               * p = uma_dbg_get_buffer();
+  ruc_buf_mag_pool_t * mp;
+  uint32_t             pool_idx;
+  int                  idx;
+  int                  doreset = 0;
+
+  if ((argv[1] != NULL) && (strcmp(argv[1],"reset")==0)) doreset = 1;
+
+  for (pool_idx = 0; pool_idx < ruc_buf_mag_nb; pool_idx++) {
+    mp = ruc_buf_mag_table[pool_idx];
+    if (mp == NULL) continue;
+
+    p += rozofs_string_append(p, mp->name);
+    p += rozofs_string_append(p, " : free list ");
+    p += rozofs_u32_append(p, mp->pool->usrLen);
+    p += rozofs_string_append(p, "/");
+    p += rozofs_u32_append(p, mp->pool->bufCount);
+    p += rozofs_string_append(p, " - depot ");
+    p += rozofs_u32_append(p, mp->full_count);
+    p += rozofs_string_append(p, " magazines ");
+    p += rozofs_u32_append(p, mp->full_buffers);
+    p += rozofs_string_append(p, " buffers - reclaimed ");
+    p += rozofs_u64_append(p, mp->reclaimed);
+    p += rozofs_string_append(p, " refilled ");
+    p += rozofs_u64_append(p, mp->refilled);
+    p += rozofs_eol(p);
+
+    p += rozofs_string_append(p, "+--------+--------+--------+------------+------------+------------+------------+------------+------------+------------+\n");
+    p += rozofs_string_append(p, "| thread | loaded |  role  |    get     |    put     | depot get  | depot put  |   waits    | exhausted  |  rejected  |\n");
+    p += rozofs_string_append(p, "+--------+--------+--------+------------+------------+------------+------------+------------+------------+------------+\n");
+    for (idx = 0; idx < RUC_BUF_MAG_MAX_THREADS; idx++) {
+      ruc_buf_mag_thread_stats_t * st = &mp->stats[idx];
+
+      if ((idx != mp->owner) && (mp->loaded[idx] == NULL)
+       && (st->get == 0) && (st->put == 0) && (st->exhausted == 0) && (st->rejected == 0)) continue;
+
+      p += rozofs_string_append(p, "| ");
+      p += rozofs_u32_padded_append(p, 6, rozofs_right_alignment, ruc_buf_mag_thread_tid[idx]);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u32_padded_append(p, 6, rozofs_right_alignment, mp->loaded[idx] ? mp->loaded[idx]->count : 0);
+      p += rozofs_string_append(p, (idx == mp->owner) ? " | owner  | " : " | worker | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->get);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->put);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->depot_get);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->depot_put);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->waits);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->exhausted);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, st->rejected);
+      p += rozofs_string_append(p, " |\n");
+    }
+    p += rozofs_string_append(p, "+--------+--------+--------+------------+------------+------------+------------+------------+------------+------------+\n");
+
+    if (doreset) {
+      memset(mp->stats, 0, sizeof(mp->stats));
+      mp->reclaimed = 0;
+      mp->refilled  = 0;
+    }
+  }
+  if (doreset) {
+    p += rozofs_string_append(p, "Reset Done\n");
+  }
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Enable the magazines on a buffer pool
+
+   @param poolRef: the buffer pool
+   @param name: name of the pool for rozodiag
+   @param low_mags: number of full magazines the owner keeps in the depot
+
+   @retval RUC_OK on success
+   @retval RUC_NOK on error
+*/
+uint32_t ruc_buf_mag_enable(void * poolRef, char * name, uint32_t low_mags) {
+  ruc_buf_t          * pool = (ruc_buf_t*)poolRef;
+  ruc_buf_mag_pool_t * mp;
+  uint32_t             idx;
+
+  if ((pool == NULL) || (pool->type != BUF_POOL_HEAD)) {
+    severe("ruc_buf_mag_enable(%s) not a buffer pool",name);
+    return RUC_NOK;
+  }
+  if (pool->opaque_ref != NULL) return RUC_OK;
+
+  mp = malloc(sizeof(ruc_buf_mag_pool_t));
+  if (mp == NULL) {
+    severe("ruc_buf_mag_enable(%s) out of memory",name);
+    return RUC_NOK;
+  }
+  memset(mp, 0, sizeof(ruc_buf_mag_pool_t));
+  mp->name     = name;
+  mp->pool     = pool;
+  mp->low_mags = low_mags;
+  mp->owner    = ruc_buf_mag_get_thread_idx();
+  if (mp->owner < 0) {
+    severe("ruc_buf_mag_enable(%s) too many threads",name);
+    free(mp);
+    return RUC_NOK;
+  }
+  /*
+  ** Every magazine but the loaded ones holds at least a buffer, so that
+  ** many magazines never run out
+  */
+  mp->nb_mags = pool->bufCount + RUC_BUF_MAG_MAX_THREADS;
+  mp->mags    = malloc(mp->nb_mags * sizeof(ruc_buf_mag_t));
+  if (mp->mags == NULL) {
+    severe("ruc_buf_mag_enable(%s) out of memory %u magazines",name,mp->nb_mags);
+    free(mp);
+    return RUC_NOK;
+  }
+  memset(mp->mags, 0, mp->nb_mags * sizeof(ruc_buf_mag_t));
+  for (idx = 0; idx < mp->nb_mags; idx++) {
+    ruc_buf_mag_push(mp, &mp->empty_head, &mp->mags[idx]);
+  }
+  for (idx = 0; idx < low_mags; idx++) {
+    ruc_buf_mag_refill(mp);
+  }
+  pool->opaque_ref = mp;
+
+  /*
+  ** Register the pool for rozodiag
+  */
+  idx = __sync_fetch_and_add(&ruc_buf_mag_nb, 1);
+  if (idx >= RUC_BUF_MAG_MAX_POOLS) {
+    __sync_fetch_and_sub(&ruc_buf_mag_nb, 1);
+    warning("ruc_buf_mag_enable(%s) too many pools for rozodiag",name);
+    return RUC_OK;
+  }
+  ruc_buf_mag_table[idx] = mp;
+
+  if (idx == 0) {
+    uma_dbg_addTopic_option("buffer_mag", ruc_buf_mag_debug, UMA_DBG_OPTION_RESET);
+  }
+  return RUC_OK;
+}
@@ -0,0 +1,179 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+#ifndef RUC_BUFFER_MAG_H
+#define RUC_BUFFER_MAG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <stdint.h>
+#include "ruc_common.h"
+#include "ruc_buffer.h"
+
+/*
+** Per thread magazines of a ruc buffer pool
+**
+** A ruc buffer pool belongs to the thread that creates it (the owner):
+** only that thread may touch the free list of the pool. Once the
+** magazines are enabled on a pool, the other threads (the workers) can
+** also get and free buffers of that pool without any message to the
+** owner.
+**
+** A magazine is an array of up to RUC_BUF_MAG_SIZE free buffers. Every
+** worker has one loaded magazine per pool, on which it gets and frees
+** buffers without any synchronization. The magazines are exchanged
+** between the threads through a lock-free depot: a stack of full
+** magazines and a stack of empty ones.
+**
+** - a worker that frees a buffer in a full magazine pushes it on the
+**   full stack and loads an empty one,
+** - a worker that has an empty magazine loads one from the full stack,
+** - the owner takes the buffers of a full magazine back in the free list
+**   when the free list gets empty,
+** - the owner fills magazines from its free list when there are less
+**   than low_mags full magazines in the depot.
+**
+** A worker that finds no buffer retries for a while before reporting
+** the exhaustion, leaving time for the other threads to free some.
+*/
+#define RUC_BUF_MAG_SIZE          16   /**< max number of buffers in a magazine   */
+#define RUC_BUF_MAG_MAX_THREADS   32   /**< max number of threads using magazines */
+#define RUC_BUF_MAG_MAX_POOLS     16   /**< max number of pools with magazines    */
+
+typedef struct _ruc_buf_mag_t
+{
+   uint32_t     next;                      /**< index+1 of the next magazine in a depot stack */
+   uint32_t     count;                     /**< number of buffers in the magazine             */
+   ruc_buf_t  * buf[RUC_BUF_MAG_SIZE];     /**< the free buffers                              */
+} ruc_buf_mag_t;
+
+typedef struct _ruc_buf_mag_thread_stats_t
+{
+   uint64_t     get;        /**< buffers got from the loaded magazine            */
+   uint64_t     put;        /**< buffers freed in the loaded magazine            */
+   uint64_t     depot_get;  /**< full magazines loaded from the depot            */
+   uint64_t     depot_put;  /**< magazines pushed to the depot                   */
+   uint64_t     waits;      /**< retries while the pool was exhausted            */
+   uint64_t     exhausted;  /**< allocations failed after the retries            */
+   uint64_t     rejected;   /**< frees sent back to the owner (in use, callback) */
+} ruc_buf_mag_thread_stats_t;
+
+typedef struct _ruc_buf_mag_pool_t
+{
+   char                 * name;          /**< name of the pool                               */
+   ruc_buf_t            * pool;          /**< the ruc buffer pool                            */
+   int                    owner;         /**< thread index of the owner of the pool          */
+   uint32_t               low_mags;      /**< full magazines the owner keeps in the depot    */
+   uint32_t               nb_mags;       /**< number of magazines                            */
+   ruc_buf_mag_t        * mags;          /**< the magazines                                  */
+   volatile uint64_t      full_head;     /**< tag<<32 | index+1 of the top full magazine     */
+   volatile uint64_t      empty_head;    /**< tag<<32 | index+1 of the top empty magazine    */
+   volatile uint32_t      full_count;    /**< number of magazines in the full stack          */
+   volatile uint32_t      full_buffers;  /**< number of buffers in the full stack            */
+   uint64_t               reclaimed;     /**< magazines taken back by the owner              */
+   uint64_t               refilled;      /**< magazines filled by the owner                  */
+   ruc_buf_mag_t        * loaded[RUC_BUF_MAG_MAX_THREADS]; /**< loaded magazine per thread   */
+   ruc_buf_mag_thread_stats_t stats[RUC_BUF_MAG_MAX_THREADS];
+} ruc_buf_mag_pool_t;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Enable the magazines on a buffer pool. To be called by the owner of
+*  the pool
+
+   @param poolRef: the buffer pool
+   @param name: name of the pool for rozodiag
+   @param low_mags: number of full magazines the owner keeps in the depot
+                    for the workers. 0 when the workers only free buffers
+
+   @retval RUC_OK on success
+   @retval RUC_NOK on error
+*/
+uint32_t ruc_buf_mag_enable(void * poolRef, char * name, uint32_t low_mags);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Get a buffer from a pool with magazines
+*
+*  When called by the owner, this is ruc_buf_getBuffer()
+
+   @param poolRef: the buffer pool
+   @param wait_ms: how long to retry when the pool is exhausted
+
+   @retval the buffer or NULL when the pool is exhausted
+*/
+void * ruc_buf_mag_get(void * poolRef, uint32_t wait_ms);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Free a buffer of a pool with magazines
+*
+*  When called by the owner, this is ruc_buf_freeBuffer(). A worker can
+*  not free a buffer that is still in use by somebody else or that has
+*  a release callback: the buffer must then be given back to the owner.
+
+   @param bufRef: the buffer
+
+   @retval RUC_OK when the buffer is freed
+   @retval RUC_NOK when the buffer must be freed by the owner
+*/
+uint32_t ruc_buf_mag_free(void * bufRef);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Push the loaded magazine of the calling thread to the depot, so that
+*  its buffers can be used by the owner. To be called by a worker before
+*  it gets idle
+
+   @param poolRef: the buffer pool
+*/
+void ruc_buf_mag_flush(void * poolRef);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Owner side: called by ruc_buf_getBuffer() when the free list is empty.
+*  Takes back the buffers of a full magazine in the free list
+
+   @param mp: the magazines of the pool
+
+   @retval the number of buffers taken back
+*/
+uint32_t ruc_buf_mag_reclaim(ruc_buf_mag_pool_t * mp);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Owner side: called by ruc_buf_freeBuffer() when the depot runs short
+*  of full magazines. Fills one magazine from the free list
+
+   @param mp: the magazines of the pool
+*/
+void ruc_buf_mag_refill(ruc_buf_mag_pool_t * mp);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -147,6 +147,20 @@ static inline void ruc_sockCtrl_attach_applicative_poller(ruc_scheduler_t callba
   @param int fd : file descriptor to clear
 */
 void ruc_sockCtrl_clear_rcv_bit(int fd);
+/**
+* Tell the socket controller that the receiver of a socket has left received
+  data in user space: the receiver is called again on the next loop even
+  though the socket is not readable
+
+  @param int fd : file descriptor of the socket
+*/
+void ruc_sockCtrl_set_rcv_pending(int fd);
+/**
+* clear the pending receive bit of a socket
+
+  @param int fd : file descriptor of the socket
+*/
+void ruc_sockCtrl_clear_rcv_pending(int fd);
  /*
  **_______________________________________________________________
  */
@@ -51,20 +51,12 @@ static TICK_TAB_DESCRIPTOR_S  rcvTick ;    /* tick mgt inside application */
 #ifdef FALCON_SIMU
 TIMER_MODE_SOCKET_E    SOCKET_MODE ;
 #endif
-static struct  timer_head  * p_timer_slot;	/* timer slot table */
-static uint	timer_slot_size;	        /* size of the timer slot table */
-static uint	timer_slot_size_mask;	        /* size -1 */
-static uint	timer_slot_size_2n;	        /* size in 2^n */
+static ruc_wheel_t	ruc_timer_wheel;	        /* timing wheel */
 static uint	timer_system_tick;		/* value of the system tick */
 static uint	ruc_timer_modulo;		/* for periodic timer       */
 
-			/* Current hand clock position */
-
-static uint 	timer_x_hand_clock;	       	/* hand clock value */
-
 struct timer_cell 	 *rucTmr_curCellToDelete = P_NIL;
 struct timer_cell 	 *rucTmr_curCellProcess = P_NIL;
-struct timer_cell 	 *rucTmr_p_cell_new = P_NIL;
 
 
 
@@ -78,6 +70,7 @@ struct timer_cell 	 *rucTmr_p_cell_new = P_NIL;
 
 static void timer_insert (struct timer_cell  *p_cell, 
 		   ulong to_val);
+static void timer_expired (void * param);
 
 
 
@@ -151,9 +144,7 @@ Return value
 
 Common constants and declarations : l2team-timer.h
 
-Common objects	: timer_head[] table containing the thread top pointer
-		  timer_x_hand_clock containing the current position of the
-		    hand clock (index of timer_head[]).
+Common objects	: ruc_timer_wheel is the timing wheel.
 
 
 *--------------------------------------------------------------------------*/
@@ -161,36 +152,18 @@ Common objects	: timer_head[] table containing the thread top pointer
 void  ruc_timer_init (TIMER_TICK_VALUE_E timer_application_tick,
 		      TIMER_SLOT_SIZE_E timer_slot_size1)
 {
-  int i = 1 ;
-  ulong timer_2n ;
                /* Timer cell initialization */
         ruc_timer_modulo 		        = 0;  /* for periodic timer only */
-        timer_x_hand_clock                      = 0;
-        timer_slot_size                         = timer_slot_size1;
-        timer_slot_size_mask                    = timer_slot_size - 1;
 	
         timer_system_tick     = timer_application_tick;
 
-	timer_2n = timer_slot_size ;
-	if (timer_2n== 0)
-	  {
-	    printf( "\n init timer error : timer_slot_size = 0)  \n");
-	    return;
-	  }
-	while (((timer_2n = (timer_2n >> 1)) &1) !=1)
-	  {
-	    i++ ;
-	  }
-        timer_slot_size_2n    = i ;
-
-
-        if ((p_timer_slot = (struct timer_head *)malloc (
-			   	(timer_slot_size * sizeof (struct timer_head)))) == P_NIL) {
-                printf( "\n timer init error : malloc \n");
+        /*
+        ** timer_slot_size1 is not used any more: the timing wheel
+        ** has a fixed number of slots per level
+        */
+        if (ruc_wheel_init(&ruc_timer_wheel,"ruc_timer",timer_system_tick) != RUC_OK) {
+                printf( "\n timer init error : wheel \n");
         }
-	memset((char*)p_timer_slot,0,(size_t)(timer_slot_size * sizeof (struct timer_head)));
-
-
 }
 
 
@@ -273,8 +246,7 @@ struct timer_cell *ruc_timer_alloc (
 	Cell_snap_id 	= snap_id;	/* SNAP ID */
 
 
-	Cell_next	= Cell_prior = P_NIL;	/* pointers to NIL */
-	Cell_x_head	= X_NIL;	       /* index to NIL */
+	ruc_listEltInit(&Cell_wheel.link);	/* not queued */
 
 	return (( struct timer_cell *)p_cell);	/* return timer ID (address of the cell) */
 
@@ -333,9 +305,7 @@ Return value    void
 
 Common constants and declarations : l2team-timer.h
 
-Common objects	: timer_head[] table containing the thread top pointer
-		  timer_x_hand_clock containing the current position of the
-		    hand clock (index of timer_head[]).
+Common objects	: ruc_timer_wheel is the timing wheel.
 
 *--------------------------------------------------------------------------*/
 void ruc_timer_start (struct timer_cell  *p_cell, /* timer ID = address of the cell */
@@ -352,14 +322,6 @@ void ruc_timer_start (struct timer_cell  *p_cell, /* timer ID = address of the c
 
 	Lock_timer_data ();
 
-	/* If already linked --> stop timer */
-
-	if (Cell_x_head != X_NIL) {
-		Unlock_timer_data 	();
-		ruc_timer_stop	    	(p_cell);
-		Lock_timer_data		();
-	}
-
        	Cell_period_flag = TIMER_OFF;		 /* Set one shot timer */
        	Cell_to_val	 = to_val;   /* save time-out value  */
 	Cell_p_fct	 = p_fct;
@@ -384,37 +346,9 @@ void ruc_timer_stop (struct timer_cell  *p_cell)	/* timer ID = address of the ce
 
 	Lock_timer_data ();
 
-       	/* Is the cell in a thread ? */
-
-       	if (Cell_x_head == X_NIL) {
-	       	Unlock_timer_data ();
-	       	return;
-		}
-
-       	/* Yes - remove from the thread */
-        /*
-        ** take care of the case of the stop timer of
-        ** the next cellule used by timer_process
-        */
-        if (rucTmr_p_cell_new == p_cell)
-        { 
-          rucTmr_p_cell_new = Cell_next;
-        }
-
-	if (Cell_next != P_NIL) {
-		Prior (Cell_next) = Cell_prior;
-		}
+       	/* Remove the cell from the wheel when running */
 
-	if (Cell_prior != P_NIL) {
-		Next (Cell_prior) = Cell_next;
-		} else {
-	       	Head_first (Cell_x_head) = Cell_next;
-		}
-
-	/* Reset the cell pointers */
-
-	Cell_next 	= Cell_prior = P_NIL;
-	Cell_x_head = X_NIL;
+	ruc_wheel_stop (&ruc_timer_wheel, &Cell_wheel);
 
 	/* Unlock the shared data */
 	Unlock_timer_data ();
@@ -452,14 +386,6 @@ Common objects	:
 
 	Lock_timer_data ();
 
-	/* If already linked --> stop timer */
-
-	if (Cell_x_head != X_NIL) {
-		Unlock_timer_data 	();
-		ruc_timer_stop	    	(p_cell);
-		Lock_timer_data		();
-	}
-
        	Cell_period_flag = TIMER_ON;		 /* Set periodic timer flag */
        	Cell_to_val	 = to_val;   /* save time-out value for next starting */
 	Cell_p_fct	 = p_fct;
@@ -483,7 +409,7 @@ Common objects	:
 /*--------------------------------------------------------------------------*
 					 F U N C T I O N   H E A D E R
 
-Name            timer_insert - inserts a cell into the timer threads.
+Name            timer_insert - inserts a cell into the timing wheel.
 
 Usage           timer_insert (uint8_t  *timer_id, timer_val_t to_val);
 
@@ -495,9 +421,7 @@ functions		called by timer_start() and
 
 Common constants and declarations : l2team-timer.h
 
-Common objects	: - timer_head[] table containing the thread top pointer
-		  - timer_x_hand_clock contains the current position of the
-		    hand clock (index of timer_head[]).
+Common objects	: ruc_timer_wheel is the timing wheel.
 
 
 *--------------------------------------------------------------------------*/
@@ -506,52 +430,75 @@ static void timer_insert (struct timer_cell  *p_cell, /* address of the cell */
 		   ulong to_val)/* time-out value */
    
 {
-	ulong delta;
-	ulong nb;
-#if 0
-    printf ("!! timer_insert to_val=%d\n",(int)to_val);
-#endif
-
-		/* Evaluate the delta in timer_system_tick unit  */
-          delta  = ((ulong)to_val / (ulong)timer_system_tick) ;
-       
-        if (delta == 0)
-          delta = 1;
+	/* 
+	** Evaluate the delta in timer_system_tick unit. The wheel
+	** starts (or restarts) the cell, a delta of 0 meaning 1 tick
+	*/
+	ruc_wheel_start (&ruc_timer_wheel, &Cell_wheel,
+			 (ulong)to_val / (ulong)timer_system_tick,
+			 timer_expired, p_cell);
+}
 
-	if (delta > timer_slot_size) {
-		 /*
-		       	'delta' is beyond the nb of slots :
-		       	Chain the cell in the slot given by modulo timer_slot_size ,
-		       	and add in cell nb of
-	       	*/
-		Cell_x_head = (timer_x_hand_clock + ( delta & (timer_slot_size_mask)));
-		nb = (delta >> timer_slot_size_2n) ; /*  modulo #  */
+/*--------------------------------------------------------------------------*
+					 F U N C T I O N   H E A D E R
 
-	} else {
-	        Cell_x_head = (timer_x_hand_clock  + delta) ;
-		nb = 0 ;
-	}
-	Cell_x_head &= timer_slot_size_mask ;
-	Cell_to_mod_nb	= nb;   /* update modulo nb */
+Name            timer_expired - call back of the timing wheel when a timer
+				cell expires.
 
-	/* Insert the cell into the top of the thread */
+Usage           void timer_expired (void * param);
 
-	Cell_next	= Head_first (Cell_x_head);
-	Cell_prior	= P_NIL;
+Return value    void
 
-	if (Head_first (Cell_x_head) != P_NIL) {
-		Prior (Head_first (Cell_x_head)) = (struct timer_cell  *)p_cell;
-	}
+Related
+functions		called by ruc_wheel_advance() from timer_process()
 
-	Head_first (Cell_x_head) = (struct timer_cell  *)p_cell;
+*--------------------------------------------------------------------------*/
 
+static void timer_expired (void * param)
+{
+    struct timer_cell 	 *  p_cell = (struct timer_cell *) param;
+
+    /*
+    ** save the current cellule since
+    ** application may try to release it
+    */
+    rucTmr_curCellProcess = p_cell;
+    rucTmr_curCellToDelete = P_NIL;
+
+    /*
+    **   call the user function  
+    */
+    (*Cell_p_fct) (Cell_fct_param);
+
+    /*
+    ** looks if the cellule has to be
+    ** deleted
+    */
+    if (rucTmr_curCellToDelete != P_NIL)
+    {
+      /*
+      ** the application has requested
+      ** to delete the current cellule
+      */
+      free(rucTmr_curCellProcess);
+      rucTmr_curCellToDelete = P_NIL;
+    }
+    else if ((Cell_period_flag == TIMER_ON) && (!ruc_wheel_is_running(&Cell_wheel)))
+    {
+      /* restart the timer	*/
+      timer_insert (p_cell, Cell_to_val);
+    }
+    /*
+    ** update for the next attempt
+    */
+    rucTmr_curCellProcess = P_NIL;
 }
 
 /*--------------------------------------------------------------------------*
 					 F U N C T I O N   H E A D E R
 
-Name            timer_process - implements the cyclic process which increments
-				the current hand clock position by one and processes the
+Name            timer_process - implements the cyclic process which moves
+				the timing wheel by one tick and processes the
 				pending time_out.
 
 Usage           void timer_process (void);
@@ -561,28 +508,13 @@ functions usage
 
 Return value    void
 
-Common objects	: timer_head[] table contains the thread top pointer.
-
-		  timer_x_hand_clock contains the current position of the
-		  hand clock (index of timer_head[]).
-
-		  timer_last_time_clock contains the system clock time of the last
-		  delay expiration.
+Common objects	: ruc_timer_wheel is the timing wheel.
 
 
 *--------------------------------------------------------------------------*/
 
 void ruc_timer_process ()     
 {
-    /* local variable definition */
-
-    struct timer_cell 	 *  p_cell;   	/* temporary timer cell pointer */
-
-    
-	/* Lock the shared data */
-/*
-    printf ("!! timer_process timer_x_hand_clock=%d\n",timer_x_hand_clock);
-*/
 	Lock_timer_data ();
 
         /*
@@ -593,136 +525,8 @@ void ruc_timer_process ()
         */
       	rucTmr_curCellToDelete = P_NIL;
         rucTmr_curCellProcess = P_NIL;
-        rucTmr_p_cell_new = P_NIL;
-
-	
-	if (++timer_x_hand_clock == timer_slot_size) 
-        {
-	    timer_x_hand_clock = 0;
-	}
-#if 0
-
-    printf ("!! timer_process timer_x_hand_clock=%d\n",timer_x_hand_clock);
-#endif
 
+	ruc_wheel_advance (&ruc_timer_wheel, ruc_timer_wheel.cur_tick+1);
 
-	/* Any cell linked to the current slot ? */
-
-	if ((p_cell = Head_first (timer_x_hand_clock)) != P_NIL) 
-        {
-
-	    /* The slot is not empty */
-#if 0
-	    
-	    /* Reset the head of thread */
-	    
-	    Head_first (timer_x_hand_clock) = P_NIL;
-#endif
-	    
-       	    /* Scan the cell thread */
-	    
-	    while (p_cell != P_NIL) 
-            {
-	      rucTmr_p_cell_new = Cell_next;
-#if 0
-              printf("pfirst 0x%x p_cell: %x pnext: 0x%x pprev: 0x%x nb = %d\n",Head_first (timer_x_hand_clock),p_cell,p_cell->p_next,p_cell->p_prior,p_cell->to_mod_nb);
-#endif
-		
-	      if (Cell_to_mod_nb== 0) 
-              {    
-		/* 
-                ** This timer will expire during the current tick
-                */
-                /* 
-                ** call the timer_stop function in order
-                ** to take care of the prior pointer.
-                ** If the prior field of the next
-                ** timer cellule. In fact, if the next
-                ** timer cellule is released furing the
-                ** same tick processing, it will update the
-                ** link fields (pnext and prior) of the 
-                ** current cellule of timer_process
-                */
-                ruc_timer_stop(p_cell);
-
-                /*
-                ** save the current cellule since
-                ** application may try to release it
-                */
-      	        rucTmr_curCellProcess = p_cell;
-      	        rucTmr_curCellToDelete = P_NIL;
-
-		/*
-	        **   call the user function  
-	        */
-		(*Cell_p_fct) (Cell_fct_param);
-
-                /*
-                ** looks if the cellule has to be
-                ** deleted
-                */
-                if (rucTmr_curCellToDelete != P_NIL)
-                {
-                  /*
-                  ** the application has requested
-                  ** to delete the current cellule
-                  */
-
-                   free(rucTmr_curCellProcess);
-                   rucTmr_curCellToDelete = P_NIL;
-                 }
-                 else
-                 {
-		   if (Cell_period_flag == TIMER_ON) 
-		   {
-	             /* restart the timer	*/
-		     /* Re-insert the timer cell into the timer thread. */
-		     timer_insert (p_cell, Cell_to_val);
-			
-		   } 
-                 }
-                 /*
-                 ** update for the next attempt
-                 */
-                 rucTmr_curCellProcess = P_NIL;
-		    
-	      }
-	      else
-	      {
-		Cell_to_mod_nb--;
-#if 0
-	    	/* 
-                ** Insert the cell into the top of the thread 
-                */
-	        Cell_next	= Head_first (Cell_x_head);
-		Cell_prior	= P_NIL;
-
-		if (Head_first (Cell_x_head) != P_NIL) 
-                {
-		  Prior (Head_first (Cell_x_head)) = (struct timer_cell  *)p_cell;
-		}
-		Head_first (Cell_x_head) = (struct timer_cell  *)p_cell;
-#endif
-
-	      }
-		
-              /* Next cell */
-		
-              p_cell = rucTmr_p_cell_new;
-		
-	    } /* While p cell != P_NIL */
-	    
-	}
- 
-        else 
-        {
-	    
-	  /* 
-          ** The slot is empty : nothing to do
-          */
-	  	    
-	}
-        rucTmr_p_cell_new = P_NIL;
 	Unlock_timer_data ();   
 }
-
@@ -22,6 +22,7 @@
 #include <rozofs/common/types.h>
 
 #include "ruc_timer_api.h"
+#include "ruc_timer_wheel.h"
 
 /*******************************************************************/
 /*     TICK event mgt STRUCTURE                                    */
@@ -64,6 +65,36 @@ typedef struct _TICK_TAB_DESCRIPTOR_S {
 	(rcvTick.reading_index != rcvTick.writing_index)
 
 
+/*******************************************************************/
+/*     Timer cell structure                                        */
+/*******************************************************************/
+
+struct timer_cell {
+     ruc_wheel_cell_t  wheel_cell;     /* cell queued in the timing wheel */
+     int		period_flag;    /* ON if the timer is periodic */
+     void (*p_fct_api) (void);       /* pointer to the application API */
+     void (*p_fct) (void * param);       /* pointer to the user function called
+					   periodically at timer expiration */
+     void *        fct_param;    /* parameter passed to the called function */
+     uint8_t      app_id;       /* network access identifier */
+     uint8_t      snap_id;      /* service access point identifier */
+     timer_val_t to_val;	      /* saved time-out value */
+};
+
+#define TIMER_CELL_LGTH		sizeof (struct timer_cell)
+
+			/* Access to timer cell value using p_cell pointer */
+
+#define Cell_wheel	    ((struct timer_cell  *)p_cell) -> wheel_cell
+#define Cell_period_flag    ((struct timer_cell  *)p_cell) -> period_flag
+#define Cell_app_id	    ((struct timer_cell  *)p_cell) -> app_id
+#define Cell_snap_id	    ((struct timer_cell  *)p_cell) -> snap_id
+#define Cell_p_fct	    ((struct timer_cell  *)p_cell) -> p_fct
+#define Cell_p_fct_api	    ((struct timer_cell  *)p_cell) -> p_fct_api
+#define Cell_fct_param	    ((struct timer_cell  *)p_cell) -> fct_param
+#define Cell_to_val	    ((struct timer_cell  *)p_cell) -> to_val
+
+
 #endif
 
 /*------------------------------- End Of File---------------------------------*/
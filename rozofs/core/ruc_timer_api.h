@@ -176,51 +176,10 @@ struct timer_event{
 				/* Timer cell structure */
 				/*----------------------*/
 
-struct timer_cell {
-     struct timer_cell  *p_next;    	/* pointer to next cell */
-     struct timer_cell  *p_prior;	/* pointer to prior cell */
-     unsigned int 	 to_mod_nb;    /* modulo nb when the time-out will fail */
-     unsigned int 	 x_timer_head;	/* index in the timer_head table */
-     int		period_flag;    /* ON if the timer is periodic */
-  void (*p_fct_api) (void);       /* pointer to the application API */
-// 64BITS     void (*p_fct) (int param);       /* pointer to the user function called
-     void (*p_fct) (void * param);       /* pointer to the user function called
-					   periodically at timer expiration */
-// 64BITS     int        fct_param;    /* parameter passed to the called function */
-     void *        fct_param;    /* parameter passed to the called function */
-    uint8_t      app_id;       /* network access identifier */
-     uint8_t      snap_id;      /* service access point identifier */
-    timer_val_t to_val;	      /* saved time-out value */
-};
-
-#define TIMER_CELL_LGTH		sizeof (struct timer_cell)
-
-			/* Access to timer cell value using p_cell pointer */
-
-#define Cell_next	    ((struct timer_cell  *)p_cell) -> p_next
-#define Cell_prior	    ((struct timer_cell  *)p_cell) -> p_prior
-#define Cell_to_mod_nb      ((struct timer_cell  *)p_cell) -> to_mod_nb
-#define Cell_x_head	    ((struct timer_cell  *)p_cell) -> x_timer_head
-#define Cell_period_flag    ((struct timer_cell  *)p_cell) -> period_flag
-#define Cell_app_id	    ((struct timer_cell  *)p_cell) -> app_id
-#define Cell_snap_id	    ((struct timer_cell  *)p_cell) -> snap_id
-#define Cell_p_fct	    ((struct timer_cell  *)p_cell) -> p_fct
-#define Cell_p_fct_api	    ((struct timer_cell  *)p_cell) -> p_fct_api
-#define Cell_fct_param	    ((struct timer_cell  *)p_cell) -> fct_param
-#define Cell_to_val	    ((struct timer_cell  *)p_cell) -> to_val
-
-				/*----------------------*/
-				/* Timer slot structure */
-				/*----------------------*/
-
-struct timer_head {
-	 struct timer_cell *p_first;      /* pointer to the first timer cell */
-};
-
-			/* Access to the thread header values using an index */
-
-#define Head_first(x)		p_timer_slot[x].p_first
-#define Head_a_cell(x)		(struct timer_cell  *)p_timer_slot[x]
+/*
+** The timer cell is private to ruc_timer.c (see ruc_timer.h)
+*/
+struct timer_cell;
 
 
 /*--------------------------------------------------------------------------*/
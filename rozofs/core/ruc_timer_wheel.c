@@ -0,0 +1,330 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <rozofs/common/log.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include <rozofs/core/rozofs_string.h>
+
+#include "ruc_timer_wheel.h"
+
+/*
+** Table of the wheels for rozodiag
+*/
+static ruc_wheel_t * ruc_wheel_table[RUC_WHEEL_MAX_INSTANCES];
+static uint32_t      ruc_wheel_nb = 0;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Queue a timer cell in the slot matching its expiration tick
+
+   The level is the highest group of RUC_WHEEL_SLOT_BITS bits where the
+   expiration tick differs from the current tick, so the slot is always
+   reached before the upper level wraps.
+
+   @param w: the wheel
+   @param cell: the timer cell
+*/
+static inline void ruc_wheel_insert(ruc_wheel_t * w, ruc_wheel_cell_t * cell) {
+  uint64_t diff  = cell->expire ^ w->cur_tick;
+  int      level = 0;
+
+  while (((diff >>= RUC_WHEEL_SLOT_BITS) != 0) && (level < (RUC_WHEEL_LEVELS-1))) {
+    level++;
+  }
+  ruc_objInsertTail(&w->slot[level][(cell->expire >> (level*RUC_WHEEL_SLOT_BITS)) & RUC_WHEEL_SLOT_MASK],
+                    &cell->link);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Move the timers of an upper level slot down to the lower levels
+
+   @param w: the wheel
+   @param head: the slot to cascade
+*/
+static inline void ruc_wheel_cascade(ruc_wheel_t * w, ruc_obj_desc_t * head) {
+  ruc_wheel_cell_t * cell;
+
+  while ((cell = (ruc_wheel_cell_t*) ruc_objGetFirst(head)) != NULL) {
+    ruc_objRemove(&cell->link);
+    ruc_wheel_insert(w, cell);
+    w->stats.cascaded++;
+  }
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Start or restart a timer for a number of ticks
+
+   @param w: the wheel
+   @param cell: the timer cell
+   @param ticks: delay in ticks. 0 is handled as 1
+   @param p_callBack: call back to call at time out
+   @param cBParam: parameter of the call back
+*/
+void ruc_wheel_start(ruc_wheel_t * w, ruc_wheel_cell_t * cell, uint64_t ticks,
+                     ruc_wheel_callBack_t p_callBack, void * cBParam) {
+
+  if (ruc_wheel_is_running(cell)) {
+    ruc_objRemove(&cell->link);
+  }
+  else {
+    w->count++;
+    if (w->count > w->max_count) w->max_count = w->count;
+  }
+
+  if (ticks == 0) ticks = 1;
+  if (ticks > RUC_WHEEL_MAX_TICKS) {
+    ticks = RUC_WHEEL_MAX_TICKS;
+    w->stats.truncated++;
+  }
+
+  cell->expire     = w->cur_tick + ticks;
+  cell->p_callBack = p_callBack;
+  cell->cBParam    = cBParam;
+  ruc_wheel_insert(w, cell);
+  w->stats.started++;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Start or restart a timer for a delay in ms on a wheel driven by the time
+
+   The delay is counted from the current time, not from the last
+   processed tick, and is rounded up to the next tick.
+
+   @param w: the wheel
+   @param cell: the timer cell
+   @param delay_ms: delay in ms
+   @param p_callBack: call back to call at time out
+   @param cBParam: parameter of the call back
+*/
+void ruc_wheel_start_ms(ruc_wheel_t * w, ruc_wheel_cell_t * cell, uint64_t delay_ms,
+                        ruc_wheel_callBack_t p_callBack, void * cBParam) {
+  uint64_t now;
+  uint64_t ticks;
+
+  now   = (ruc_wheel_clock_ms() - w->base_ms) / w->tick_ms;
+  ticks = (delay_ms + w->tick_ms - 1) / w->tick_ms;
+  if (now > w->cur_tick) ticks += now - w->cur_tick;
+  ruc_wheel_start(w, cell, ticks, p_callBack, cBParam);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Stop a timer. Nothing is done when the timer is not running
+
+   @param w: the wheel
+   @param cell: the timer cell
+*/
+void ruc_wheel_stop(ruc_wheel_t * w, ruc_wheel_cell_t * cell) {
+
+  if (!ruc_wheel_is_running(cell)) return;
+
+  ruc_objRemove(&cell->link);
+  w->count--;
+  w->stats.stopped++;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Move the wheel up to a given tick and expire the timers on the way
+
+   At each tick the whole level 0 slot is moved to the expired list
+   before the call backs are called, so a call back may start or stop
+   any timer, including the ones of the same batch.
+
+   @param w: the wheel
+   @param tick: tick to reach
+*/
+void ruc_wheel_advance(ruc_wheel_t * w, uint64_t tick) {
+  ruc_wheel_cell_t * cell;
+  ruc_obj_desc_t   * head;
+  uint64_t           batch;
+  uint64_t           late;
+  int                level;
+
+  while (w->cur_tick < tick) {
+
+    /*
+    ** No timer running: jump directly to the requested tick
+    */
+    if (w->count == 0) {
+      w->cur_tick = tick;
+      return;
+    }
+
+    w->cur_tick++;
+
+    /*
+    ** Cascade the upper levels which range starts at this tick,
+    ** from the highest one down
+    */
+    for (level = RUC_WHEEL_LEVELS-1; level > 0; level--) {
+      if (w->cur_tick & ((1ULL<<(level*RUC_WHEEL_SLOT_BITS))-1)) continue;
+      ruc_wheel_cascade(w, &w->slot[level][(w->cur_tick >> (level*RUC_WHEEL_SLOT_BITS)) & RUC_WHEEL_SLOT_MASK]);
+    }
+
+    head = &w->slot[0][w->cur_tick & RUC_WHEEL_SLOT_MASK];
+    if (ruc_objIsEmptyList(head)) continue;
+
+    ruc_listMoveTail(head, &w->expired);
+
+    batch = 0;
+    while ((cell = (ruc_wheel_cell_t*) ruc_objGetFirst(&w->expired)) != NULL) {
+      ruc_objRemove(&cell->link);
+      w->count--;
+      batch++;
+
+      late = tick - cell->expire;
+      w->stats.late_sum += late;
+      if (late > w->stats.late_max) w->stats.late_max = late;
+
+      (*(cell->p_callBack))(cell->cBParam);
+    }
+    w->stats.expired += batch;
+    if (batch > w->stats.max_batch) w->stats.max_batch = batch;
+  }
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  rozodiag topic displaying the wheels
+*/
+static void ruc_wheel_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char        * p = uma_dbg_get_buffer();
+  ruc_wheel_t * w;
+  uint32_t      idx;
+  int           doreset = 0;
+
+  if ((argv[1] != NULL) && (strcmp(argv[1],"reset")==0)) doreset = 1;
+
+  p += rozofs_string_append(p, "+-----------------+------+------------+------------+------------+------------+------------+------------+------------+---------+---------+\n");
+  p += rozofs_string_append(p, "|      wheel      | tick |  running   | max running|  started   |  stopped   |  expired   |  cascaded  |  max batch | avg late| max late|\n");
+  p += rozofs_string_append(p, "|                 |  ms  |            |            |            |            |            |            |            |   ms    |   ms    |\n");
+  p += rozofs_string_append(p, "+-----------------+------+------------+------------+------------+------------+------------+------------+------------+---------+---------+\n");
+
+  for (idx = 0; idx < ruc_wheel_nb; idx++) {
+    w = ruc_wheel_table[idx];
+    if (w == NULL) continue;
+
+    p += rozofs_string_append(p, "| ");
+    p += rozofs_string_padded_append(p, 15, rozofs_left_alignment, w->name);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u32_padded_append(p, 4, rozofs_right_alignment, w->tick_ms);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, w->count);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, w->max_count);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, w->stats.started);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, w->stats.stopped);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, w->stats.expired);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, w->stats.cascaded);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, w->stats.max_batch);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 7, rozofs_right_alignment,
+                                  w->stats.expired ? (w->stats.late_sum*w->tick_ms)/w->stats.expired : 0);
+    p += rozofs_string_append(p, " | ");
+    p += rozofs_u64_padded_append(p, 7, rozofs_right_alignment, w->stats.late_max*w->tick_ms);
+    p += rozofs_string_append(p, " |\n");
+    if (w->stats.truncated) {
+      p += rozofs_string_append(p, "|   truncated delays ");
+      p += rozofs_u64_append(p, w->stats.truncated);
+      p += rozofs_eol(p);
+    }
+
+    if (doreset) {
+      memset(&w->stats, 0, sizeof(w->stats));
+      w->max_count = w->count;
+    }
+  }
+  p += rozofs_string_append(p, "+-----------------+------+------------+------------+------------+------------+------------+------------+------------+---------+---------+\n");
+  if (doreset) {
+    p += rozofs_string_append(p, "Reset Done\n");
+  }
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Initialize a wheel and register it for rozodiag
+
+   @param w: the wheel
+   @param name: name of the wheel
+   @param tick_ms: tick duration in ms
+
+   @retval RUC_OK on success
+   @retval RUC_NOK on error
+*/
+uint32_t ruc_wheel_init(ruc_wheel_t * w, char * name, uint32_t tick_ms) {
+  uint32_t idx;
+  int      level;
+  int      slot;
+
+  if (tick_ms == 0) {
+    severe("ruc_wheel_init(%s) tick 0 ms",name);
+    return RUC_NOK;
+  }
+
+  memset(w, 0, sizeof(ruc_wheel_t));
+  strncpy(w->name, name, sizeof(w->name)-1);
+  w->tick_ms = tick_ms;
+  w->base_ms = ruc_wheel_clock_ms();
+
+  ruc_listHdrInit(&w->expired);
+  for (level = 0; level < RUC_WHEEL_LEVELS; level++) {
+    for (slot = 0; slot < RUC_WHEEL_SLOTS; slot++) {
+      ruc_listHdrInit(&w->slot[level][slot]);
+    }
+  }
+
+  /*
+  ** Register the wheel once
+  */
+  for (idx = 0; idx < ruc_wheel_nb; idx++) {
+    if (ruc_wheel_table[idx] == w) return RUC_OK;
+  }
+  idx = __sync_fetch_and_add(&ruc_wheel_nb, 1);
+  if (idx >= RUC_WHEEL_MAX_INSTANCES) {
+    __sync_fetch_and_sub(&ruc_wheel_nb, 1);
+    warning("ruc_wheel_init(%s) too many wheels for rozodiag",name);
+    return RUC_OK;
+  }
+  ruc_wheel_table[idx] = w;
+
+  if (idx == 0) {
+    uma_dbg_addTopic_option("timerWheel", ruc_wheel_debug, UMA_DBG_OPTION_RESET);
+  }
+  return RUC_OK;
+}
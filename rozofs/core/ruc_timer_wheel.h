@@ -0,0 +1,194 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+#ifndef RUC_TIMER_WHEEL_H
+#define RUC_TIMER_WHEEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <stdint.h>
+#include <time.h>
+#include "ruc_common.h"
+#include "ruc_list.h"
+
+/*
+** Hierarchical timing wheel
+**
+** A wheel has RUC_WHEEL_LEVELS levels of RUC_WHEEL_SLOTS slots. A level
+** 0 slot holds the timers expiring at one given tick, a slot of level n
+** the timers expiring within a range of RUC_WHEEL_SLOTS^n ticks. When
+** the clock enters a new range, the matching slot of the upper level is
+** cascaded down. Starting, stopping and expiring a timer are O(1), and
+** every timer of a tick is expired in one batch.
+**
+** A wheel has no lock: it must only be used by the thread that owns it.
+** Every wheel is registered in a table displayed by the "timerWheel"
+** rozodiag topic.
+*/
+#define RUC_WHEEL_LEVELS         4
+#define RUC_WHEEL_SLOT_BITS      6
+#define RUC_WHEEL_SLOTS          (1<<RUC_WHEEL_SLOT_BITS)
+#define RUC_WHEEL_SLOT_MASK      (RUC_WHEEL_SLOTS-1)
+/*
+** Longest delay in ticks. Longer delays are truncated
+*/
+#define RUC_WHEEL_MAX_TICKS      ((uint64_t)RUC_WHEEL_SLOT_MASK<<(RUC_WHEEL_SLOT_BITS*(RUC_WHEEL_LEVELS-1)))
+#define RUC_WHEEL_MAX_INSTANCES  32
+
+typedef void (*ruc_wheel_callBack_t)(void*) ; /* call back type */
+
+/*
+** Timer cell. The link must be initialized with ruc_listEltInit()
+** before the first start
+*/
+typedef struct _ruc_wheel_cell_t {
+    ruc_obj_desc_t        link;        /**< header used by list service for queuing */
+    uint64_t              expire;      /**< tick of the time out                    */
+    ruc_wheel_callBack_t  p_callBack;  /**< call back to be used at time out        */
+    void                 *cBParam;     /**< parameter to be provided at time out    */
+} ruc_wheel_cell_t;
+
+typedef struct _ruc_wheel_stats_t {
+    uint64_t  started;       /**< number of timer starts                      */
+    uint64_t  stopped;       /**< number of running timers stopped            */
+    uint64_t  expired;       /**< number of expired timers                    */
+    uint64_t  truncated;     /**< number of delays truncated to the max       */
+    uint64_t  cascaded;      /**< number of timers moved down one level       */
+    uint64_t  max_batch;     /**< max number of timers expired in one tick    */
+    uint64_t  late_sum;      /**< cumulated expiration latency in ticks       */
+    uint64_t  late_max;      /**< max expiration latency in ticks             */
+} ruc_wheel_stats_t;
+
+typedef struct _ruc_wheel_t {
+    char               name[16];      /**< name displayed by rozodiag            */
+    uint32_t           tick_ms;       /**< tick duration in ms                   */
+    uint64_t           base_ms;       /**< clock in ms at tick 0                 */
+    uint64_t           cur_tick;      /**< last processed tick                   */
+    uint64_t           count;         /**< number of running timers              */
+    uint64_t           max_count;     /**< max number of running timers          */
+    ruc_wheel_stats_t  stats;
+    ruc_obj_desc_t     expired;       /**< timers of the tick being expired      */
+    ruc_obj_desc_t     slot[RUC_WHEEL_LEVELS][RUC_WHEEL_SLOTS];
+} ruc_wheel_t;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Monotonic clock in ms used by the wheels driven by the time
+*/
+static inline uint64_t ruc_wheel_clock_ms() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Tell whether a timer cell is running
+
+   @param cell: the timer cell
+
+   @retval TRUE when the cell is queued in a wheel
+*/
+static inline int ruc_wheel_is_running(ruc_wheel_cell_t * cell) {
+  return (cell->link.ps != &cell->link);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Initialize a wheel and register it for rozodiag
+
+   @param w: the wheel
+   @param name: name of the wheel
+   @param tick_ms: tick duration in ms
+
+   @retval RUC_OK on success
+   @retval RUC_NOK on error
+*/
+uint32_t ruc_wheel_init(ruc_wheel_t * w, char * name, uint32_t tick_ms);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Start or restart a timer for a number of ticks
+
+   @param w: the wheel
+   @param cell: the timer cell
+   @param ticks: delay in ticks. 0 is handled as 1
+   @param p_callBack: call back to call at time out
+   @param cBParam: parameter of the call back
+*/
+void ruc_wheel_start(ruc_wheel_t * w, ruc_wheel_cell_t * cell, uint64_t ticks,
+                     ruc_wheel_callBack_t p_callBack, void * cBParam);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Start or restart a timer for a delay in ms on a wheel driven by the
+*  time (see ruc_wheel_run())
+
+   @param w: the wheel
+   @param cell: the timer cell
+   @param delay_ms: delay in ms
+   @param p_callBack: call back to call at time out
+   @param cBParam: parameter of the call back
+*/
+void ruc_wheel_start_ms(ruc_wheel_t * w, ruc_wheel_cell_t * cell, uint64_t delay_ms,
+                        ruc_wheel_callBack_t p_callBack, void * cBParam);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Stop a timer. Nothing is done when the timer is not running
+
+   @param w: the wheel
+   @param cell: the timer cell
+*/
+void ruc_wheel_stop(ruc_wheel_t * w, ruc_wheel_cell_t * cell);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Move the wheel up to a given tick and expire the timers on the way
+
+   @param w: the wheel
+   @param tick: tick to reach
+*/
+void ruc_wheel_advance(ruc_wheel_t * w, uint64_t tick);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Move a wheel driven by the time up to the current tick
+
+   @param w: the wheel
+*/
+static inline void ruc_wheel_run(ruc_wheel_t * w) {
+  ruc_wheel_advance(w, (ruc_wheel_clock_ms() - w->base_ms) / w->tick_ms);
+}
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
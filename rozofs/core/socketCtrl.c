@@ -70,6 +70,13 @@ rozo_fd_set  rucRdFdSet;
 rozo_fd_set  rucWrFdSet;   
 rozo_fd_set  rucRdFdSetUnconditional;
 rozo_fd_set  rucWrFdSetCongested;
+/*
+** sockets whose receiver left already received data in user space (ring
+** or record being rebuilt) because it was out of buffer: the socket is no
+** longer readable, so the receiver is called again on each loop
+*/
+rozo_fd_set  rucRdFdSetPending;
+int          ruc_sockCtrl_pending_count = 0;
 
 /*
 **  gloabl data used in the loops that polls the bitfields
@@ -930,6 +937,7 @@ uint32_t ruc_sockctl_disconnect(void * connectionId)
      FD_CLR(p->socketId,&rucWrFdSet);
      FD_CLR(p->socketId,&rucRdFdSetUnconditional);
      FD_CLR(p->socketId,&rucWrFdSetCongested);
+     ruc_sockCtrl_clear_rcv_pending(p->socketId);
 
      ruc_sockCtrl_remove_socket(socket_recv_table,socket_recv_count,p->socketId);
      ruc_sockCtrl_remove_socket(socket_xmit_table,socket_xmit_count,p->socketId);
@@ -1586,12 +1594,78 @@ uint64_t rozofs_ticker_seconds = 0;  /**< ticker in second ->see gettimeofday */
 **____________________________________________________________________________
 */
 /**
+*  Count the receivers that have data pending in user space and that are
+   ready to receive, as the receive set is built: a receiver that is out
+   of buffer is not ready, and the main loop must then not spin on it
+
+   @retval the number of pending receivers that are ready
+*/
+static int ruc_sockCtrl_pending_ready()
+{
+  int            fd;
+  int            count = 0;
+  int            ready = 0;
+  ruc_sockObj_t *p;
+
+  for (fd = 0; (fd <= ruc_max_curr_socket) && (count < ruc_sockCtrl_pending_count); fd++)
+  {
+    if (!FD_ISSET(fd,&rucRdFdSetPending)) continue;
+    count++;
+    p = socket_ctx_table[fd];
+    if (p == NULL) 
+    {
+      ready++;
+      continue;
+    }
+    if ((*((p->callBack)->isRcvReadyFunc))(p->objRef,p->socketId) == TRUE) ready++;
+  }
+  return ready;
+}
+/*
+**____________________________________________________________________________
+*/
+/**
+*  Call again the ready receivers of the sockets that have received data
+   pending in user space. The pending bit is cleared before the call: the
+   receiver sets it again when it is still out of buffer. The receivers
+   that are not ready keep their pending bit
+*/
+static void ruc_sockCtrl_run_pending()
+{
+  int            fd;
+  int            count = 0;
+  int            table[ROZO_FD_SETSIZE];
+  ruc_sockObj_t *p;
+
+  for (fd = 0; (fd <= ruc_max_curr_socket) && (count < ruc_sockCtrl_pending_count); fd++)
+  {
+    if (FD_ISSET(fd,&rucRdFdSetPending)) table[count++] = fd;
+  }
+  for (fd = 0; fd < count; fd++)
+  {
+    p = socket_ctx_table[table[fd]];
+    if (p == NULL) 
+    {
+      ruc_sockCtrl_clear_rcv_pending(table[fd]);
+      continue;
+    }
+    if ((*((p->callBack)->isRcvReadyFunc))(p->objRef,p->socketId) != TRUE) continue;
+    ruc_sockCtrl_clear_rcv_pending(table[fd]);
+    (*((p->callBack)->msgInFunc))(p->objRef,p->socketId);
+  }
+}
+/*
+**____________________________________________________________________________
+*/
+/**
 *  Main loop
 */
 void ruc_sockCtrl_selectWait()
 {
     int     nbrSelect;    /* nbr of events detected by select function */
     struct timeval     timeDay;
+    struct timeval     noWait;
+    int                pending_ready;
     unsigned long long timeBefore, timeAfter;
 //    uint64_t cycles_before;
 //    uint64_t cycles_after;
@@ -1629,8 +1703,16 @@ void ruc_sockCtrl_selectWait()
       /*
       ** wait for event 
       */	  
+      /*
+      ** do not block when some ready receivers have data pending in user space
+      */
+      noWait.tv_sec  = 0;
+      noWait.tv_usec = 0;
+      pending_ready  = 0;
+      if (ruc_sockCtrl_pending_count != 0) pending_ready = ruc_sockCtrl_pending_ready();
       if((nbrSelect=select(ruc_max_curr_socket+1,(fd_set *)&rucRdFdSet,
-                                                 (fd_set *)&rucWrFdSet,NULL, NULL)) == 0)
+                                                 (fd_set *)&rucWrFdSet,NULL,
+                           (pending_ready==0)?NULL:&noWait)) == 0)
       {
 	/*
 	** udpate time after select
@@ -1673,6 +1755,10 @@ void ruc_sockCtrl_selectWait()
         rozofs_ticker_seconds = timeDay.tv_sec;
       }
       /*
+      ** receivers that have data pending in user space
+      */
+      if (ruc_sockCtrl_pending_count != 0) ruc_sockCtrl_run_pending();
+      /*
       ** socket polling (former receive ready callback)
       */
       if (timeAfter > (ruc_sockCtrl_lastTimeScheduler+ruc_sockCtrl_poll_period))
@@ -1699,3 +1785,35 @@ void ruc_sockCtrl_clear_rcv_bit(int fd)
   if (fd < 0) return;
   FD_CLR(fd,&rucRdFdSet);
 }
+/*
+**____________________________________________________________________________
+*/
+/**
+* Tell the socket controller that the receiver of a socket has left received
+  data in user space: the receiver is called again on the next loop even
+  though the socket is not readable
+
+  @param int fd : file descriptor of the socket
+*/
+void ruc_sockCtrl_set_rcv_pending(int fd)
+{
+  if (fd < 0) return;
+  if (FD_ISSET(fd,&rucRdFdSetPending)) return;
+  FD_SET(fd,&rucRdFdSetPending);
+  ruc_sockCtrl_pending_count++;
+}
+/*
+**____________________________________________________________________________
+*/
+/**
+* clear the pending receive bit of a socket
+
+  @param int fd : file descriptor of the socket
+*/
+void ruc_sockCtrl_clear_rcv_pending(int fd)
+{
+  if (fd < 0) return;
+  if (!FD_ISSET(fd,&rucRdFdSetPending)) return;
+  FD_CLR(fd,&rucRdFdSetPending);
+  ruc_sockCtrl_pending_count--;
+}
@@ -86,6 +86,10 @@ void rozofs_tmr_init_configuration()
   ** ENOENT cache
   */
   DEF_TMR(FUSE_ENOENT_CACHE_MS,0,30000,2000,TMR_MS);          /**< target of symbolic link cache timeout in rozofsmount default 1000 ms )*/
+  /*
+  ** adaptive RPC time-out (see rozofs_tx_rto_ms())
+  */
+  DEF_TMR(RPC_RTO_MIN,0,60000,0,TMR_MS);             /**< min adaptive RPC time-out, 0 disables it default 0 (disabled) */
 
 }
 /*__________________________________________________________________________
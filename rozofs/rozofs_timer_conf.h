@@ -85,6 +85,10 @@ typedef enum
   ** ENOENT cache 
   */
   TMR_FUSE_ENOENT_CACHE_MS,      /**< Caching ENOENT */
+  /*
+  ** adaptive RPC time-out
+  */
+  TMR_RPC_RTO_MIN,               /**< min adaptive RPC time-out, 0 disables it   default 0 (disabled) */
 
   TMR_MAX_ENTRY
 
@@ -699,6 +699,13 @@ struct epgw_write_block_arg_t {
 };
 typedef struct epgw_write_block_arg_t epgw_write_block_arg_t;
 
+struct epgw_write_block2_arg_t {
+	struct ep_gateway_t hdr;
+	ep_write_block_arg_t arg_gw;
+	uint16_t degraded;
+};
+typedef struct epgw_write_block2_arg_t epgw_write_block2_arg_t;
+
 struct ep_read_t {
 	struct {
 		u_int dist_len;
@@ -1068,6 +1075,9 @@ extern  epgw_readdir2_ret_t * ep_readdir2_1_svc(epgw_readdir_arg_t *, struct svc
 #define EP_POLL_OWNER_LOCK 38
 extern  epgw_lock_ret_t * ep_poll_owner_lock_1(epgw_lock_arg_t *, CLIENT *);
 extern  epgw_lock_ret_t * ep_poll_owner_lock_1_svc(epgw_lock_arg_t *, struct svc_req *);
+#define EP_WRITE_BLOCK2 39
+extern  epgw_mattr_ret_t * ep_write_block2_1(epgw_write_block2_arg_t *, CLIENT *);
+extern  epgw_mattr_ret_t * ep_write_block2_1_svc(epgw_write_block2_arg_t *, struct svc_req *);
 extern int export_program_1_freeresult (SVCXPRT *, xdrproc_t, caddr_t);
 
 #else /* K&R C */
@@ -1182,6 +1192,9 @@ extern  epgw_readdir2_ret_t * ep_readdir2_1_svc();
 #define EP_POLL_OWNER_LOCK 38
 extern  epgw_lock_ret_t * ep_poll_owner_lock_1();
 extern  epgw_lock_ret_t * ep_poll_owner_lock_1_svc();
+#define EP_WRITE_BLOCK2 39
+extern  epgw_mattr_ret_t * ep_write_block2_1();
+extern  epgw_mattr_ret_t * ep_write_block2_1_svc();
 extern int export_program_1_freeresult ();
 #endif /* K&R C */
 
@@ -1284,6 +1297,7 @@ extern  bool_t xdr_ep_io_arg_t (XDR *, ep_io_arg_t*);
 extern  bool_t xdr_epgw_io_arg_t (XDR *, epgw_io_arg_t*);
 extern  bool_t xdr_ep_write_block_arg_t (XDR *, ep_write_block_arg_t*);
 extern  bool_t xdr_epgw_write_block_arg_t (XDR *, epgw_write_block_arg_t*);
+extern  bool_t xdr_epgw_write_block2_arg_t (XDR *, epgw_write_block2_arg_t*);
 extern  bool_t xdr_ep_read_t (XDR *, ep_read_t*);
 extern  bool_t xdr_ep_read_block_ret_t (XDR *, ep_read_block_ret_t*);
 extern  bool_t xdr_epgw_read_block_ret_t (XDR *, epgw_read_block_ret_t*);
@@ -1414,6 +1428,7 @@ extern bool_t xdr_ep_io_arg_t ();
 extern bool_t xdr_epgw_io_arg_t ();
 extern bool_t xdr_ep_write_block_arg_t ();
 extern bool_t xdr_epgw_write_block_arg_t ();
+extern bool_t xdr_epgw_write_block2_arg_t ();
 extern bool_t xdr_ep_read_t ();
 extern bool_t xdr_ep_read_block_ret_t ();
 extern bool_t xdr_epgw_read_block_ret_t ();
@@ -625,6 +625,13 @@ struct  epgw_write_block_arg_t
   ep_write_block_arg_t    arg_gw;
 };
 
+struct  epgw_write_block2_arg_t 
+{
+  struct ep_gateway_t hdr;
+  ep_write_block_arg_t    arg_gw;
+  uint16_t                degraded; /* positions in the distribution of the storages that missed the write */
+};
+
 struct ep_read_t {
     uint16_t    dist<>;
     int64_t     length;
@@ -943,6 +950,9 @@ program EXPORT_PROGRAM {
         epgw_lock_ret_t
         EP_POLL_OWNER_LOCK(epgw_lock_arg_t)         = 38;      
 
+        epgw_mattr_ret_t
+        EP_WRITE_BLOCK2(epgw_write_block2_arg_t)    = 39;
+
 	
     } = 1;
 } = 0x20000001;
@@ -565,3 +565,18 @@ ep_poll_owner_lock_1(epgw_lock_arg_t *argp, CLIENT *clnt)
 	}
 	return (&clnt_res);
 }
+
+epgw_mattr_ret_t *
+ep_write_block2_1(epgw_write_block2_arg_t *argp, CLIENT *clnt)
+{
+	static epgw_mattr_ret_t clnt_res;
+
+	memset((char *)&clnt_res, 0, sizeof(clnt_res));
+	if (clnt_call (clnt, EP_WRITE_BLOCK2,
+		(xdrproc_t) xdr_epgw_write_block2_arg_t, (caddr_t) argp,
+		(xdrproc_t) xdr_epgw_mattr_ret_t, (caddr_t) &clnt_res,
+		TIMEOUT) != RPC_SUCCESS) {
+		return (NULL);
+	}
+	return (&clnt_res);
+}
@@ -57,6 +57,7 @@ export_program_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		epgw_getxattr_arg_t ep_getxattr_raw_1_arg;
 		epgw_readdir_arg_t ep_readdir2_1_arg;
 		epgw_lock_arg_t ep_poll_owner_lock_1_arg;
+		epgw_write_block2_arg_t ep_write_block2_1_arg;
 	} argument;
 	char *result;
 	xdrproc_t _xdr_argument, _xdr_result;
@@ -285,6 +286,12 @@ export_program_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		local = (char *(*)(char *, struct svc_req *)) ep_poll_owner_lock_1_svc;
 		break;
 
+	case EP_WRITE_BLOCK2:
+		_xdr_argument = (xdrproc_t) xdr_epgw_write_block2_arg_t;
+		_xdr_result = (xdrproc_t) xdr_epgw_mattr_ret_t;
+		local = (char *(*)(char *, struct svc_req *)) ep_write_block2_1_svc;
+		break;
+
 	default:
 		svcerr_noproc (transp);
 		return;
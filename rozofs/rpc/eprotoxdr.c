@@ -1501,6 +1501,20 @@ xdr_epgw_write_block_arg_t (XDR *xdrs, epgw_write_block_arg_t *objp)
 	return TRUE;
 }
 
+bool_t
+xdr_epgw_write_block2_arg_t (XDR *xdrs, epgw_write_block2_arg_t *objp)
+{
+	//register int32_t *buf;
+
+	 if (!xdr_ep_gateway_t (xdrs, &objp->hdr))
+		 return FALSE;
+	 if (!xdr_ep_write_block_arg_t (xdrs, &objp->arg_gw))
+		 return FALSE;
+	 if (!xdr_uint16_t (xdrs, &objp->degraded))
+		 return FALSE;
+	return TRUE;
+}
+
 bool_t
 xdr_ep_read_t (XDR *xdrs, ep_read_t *objp)
 {
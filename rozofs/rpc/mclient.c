@@ -141,6 +141,49 @@ out:
 }
 
 
+/*_________________________________________________________________
+** Ask to a logical storage to remove a set of files 
+** 
+** @param  clt     The client toward the storaged
+** @param  args    The cid, sid and the files to remove
+** @param  failed  Returned bitmap of the entries that could not be removed
+**
+** @retval 0 on success
+** @retval -1 on error. errno is EOPNOTSUPP when the storaged does not 
+**            support the bulk remove
+*/
+int mstoraged_client_remove_bulk(mstorage_client_t * clt, mp_remove_bulk_arg_t * args, uint64_t * failed) {
+  int                    status = -1;
+  mp_remove_bulk_ret_t * ret    = 0;
+
+  if (!(clt->rpcclt.client)) {
+    errno = EPROTO;
+    goto out;
+  }
+  
+  if (!(ret = mp_remove_bulk_1(args, clt->rpcclt.client))) {
+    struct rpc_err err;
+    clnt_geterr(clt->rpcclt.client, &err);
+    errno = (err.re_status == RPC_PROCUNAVAIL) ? EOPNOTSUPP : EPROTO;
+    goto out;
+  }
+  
+  if (ret->status != MP_SUCCESS) {
+    errno = ret->mp_remove_bulk_ret_t_u.error;
+    /*
+    ** An older storaged rejects the unknown procedure with EPROTO
+    */
+    if (errno == EPROTO) errno = EOPNOTSUPP;
+    goto out;
+  }
+  *failed = ret->mp_remove_bulk_ret_t_u.failed;
+  status = 0;
+out:
+  if (ret) {
+    xdr_free((xdrproc_t) xdr_mp_remove_bulk_ret_t, (char *) ret);
+  }  
+  return status;
+}
 /*_________________________________________________________________
 ** Ask to a logical storage to get the number of blocks of file 
   The purpose of that service is to address the case of the thin provisioning
@@ -140,6 +140,8 @@ typedef struct mstorage_client_t {
     list_t      list;
     /* Status of the storaged *. 0 unreachable / 1 reachable */
     int         status;
+    /* Whether the storaged does not support MP_REMOVE_BULK */
+    int         no_bulk;
     /* host name comprising '/' */ 
     char        name[ROZOFS_HOSTNAME_MAX];
  
@@ -358,6 +360,18 @@ static inline mstorage_client_t * mstoraged_lookup_cnx(list_t * cnx, cid_t cid,
 ** @retval         The total number of names found in host (at least 1)
 */
 int mstoraged_client_remove2(mstorage_client_t * clt, cid_t cid, sid_t sid, fid_t fid,uint8_t spare);
+/*_________________________________________________________________
+** Ask to a logical storage to remove a set of files 
+** 
+** @param  clt     The client toward the storaged
+** @param  args    The cid, sid and the files to remove
+** @param  failed  Returned bitmap of the entries that could not be removed
+**
+** @retval 0 on success
+** @retval -1 on error. errno is EOPNOTSUPP when the storaged does not 
+**            support the bulk remove
+*/
+int mstoraged_client_remove_bulk(mstorage_client_t * clt, mp_remove_bulk_arg_t * args, uint64_t * failed);
 
 /*_________________________________________________________________
 ** Ask to a logical storage its devices statistics
@@ -45,6 +45,30 @@ struct mp_remove_arg_t {
 	mp_uuid_t fid;
 };
 typedef struct mp_remove_arg_t mp_remove_arg_t;
+#define MP_REMOVE_BULK_MAX 64
+
+struct mp_remove_bulk_entry_t {
+	uint8_t spare;
+	mp_uuid_t fid;
+};
+typedef struct mp_remove_bulk_entry_t mp_remove_bulk_entry_t;
+
+struct mp_remove_bulk_arg_t {
+	uint16_t cid;
+	uint8_t sid;
+	uint32_t nb;
+	mp_remove_bulk_entry_t entries[MP_REMOVE_BULK_MAX];
+};
+typedef struct mp_remove_bulk_arg_t mp_remove_bulk_arg_t;
+
+struct mp_remove_bulk_ret_t {
+	mp_status_t status;
+	union {
+		uint64_t failed;
+		int error;
+	} mp_remove_bulk_ret_t_u;
+};
+typedef struct mp_remove_bulk_ret_t mp_remove_bulk_ret_t;
 
 struct mp_stat_arg_t {
 	uint16_t cid;
@@ -184,6 +208,9 @@ extern  mp_status_ret_t * mp_remove2_1_svc(mp_remove2_arg_t *, struct svc_req *)
 #define MP_SIZE 6
 extern  mp_size_ret_t * mp_size_1(mp_size_arg_t *, CLIENT *);
 extern  mp_size_ret_t * mp_size_1_svc(mp_size_arg_t *, struct svc_req *);
+#define MP_REMOVE_BULK 7
+extern  mp_remove_bulk_ret_t * mp_remove_bulk_1(mp_remove_bulk_arg_t *, CLIENT *);
+extern  mp_remove_bulk_ret_t * mp_remove_bulk_1_svc(mp_remove_bulk_arg_t *, struct svc_req *);
 extern int monitor_program_1_freeresult (SVCXPRT *, xdrproc_t, caddr_t);
 
 #else /* K&R C */
@@ -208,6 +235,9 @@ extern  mp_status_ret_t * mp_remove2_1_svc();
 #define MP_SIZE 6
 extern  mp_size_ret_t * mp_size_1();
 extern  mp_size_ret_t * mp_size_1_svc();
+#define MP_REMOVE_BULK 7
+extern  mp_remove_bulk_ret_t * mp_remove_bulk_1();
+extern  mp_remove_bulk_ret_t * mp_remove_bulk_1_svc();
 extern int monitor_program_1_freeresult ();
 #endif /* K&R C */
 
@@ -219,6 +249,9 @@ extern  bool_t xdr_mp_status_t (XDR *, mp_status_t*);
 extern  bool_t xdr_mp_status_ret_t (XDR *, mp_status_ret_t*);
 extern  bool_t xdr_mp_remove2_arg_t (XDR *, mp_remove2_arg_t*);
 extern  bool_t xdr_mp_remove_arg_t (XDR *, mp_remove_arg_t*);
+extern  bool_t xdr_mp_remove_bulk_entry_t (XDR *, mp_remove_bulk_entry_t*);
+extern  bool_t xdr_mp_remove_bulk_arg_t (XDR *, mp_remove_bulk_arg_t*);
+extern  bool_t xdr_mp_remove_bulk_ret_t (XDR *, mp_remove_bulk_ret_t*);
 extern  bool_t xdr_mp_stat_arg_t (XDR *, mp_stat_arg_t*);
 extern  bool_t xdr_mp_sstat_t (XDR *, mp_sstat_t*);
 extern  bool_t xdr_mp_size_rsp_t (XDR *, mp_size_rsp_t*);
@@ -241,6 +274,9 @@ extern bool_t xdr_mp_status_t ();
 extern bool_t xdr_mp_status_ret_t ();
 extern bool_t xdr_mp_remove2_arg_t ();
 extern bool_t xdr_mp_remove_arg_t ();
+extern bool_t xdr_mp_remove_bulk_entry_t ();
+extern bool_t xdr_mp_remove_bulk_arg_t ();
+extern bool_t xdr_mp_remove_bulk_ret_t ();
 extern bool_t xdr_mp_stat_arg_t ();
 extern bool_t xdr_mp_sstat_t ();
 extern bool_t xdr_mp_size_rsp_t ();
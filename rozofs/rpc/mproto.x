@@ -43,6 +43,26 @@ struct mp_remove_arg_t {
     mp_uuid_t   fid;
 };
 
+const MP_REMOVE_BULK_MAX = 64;
+
+struct mp_remove_bulk_entry_t {
+    uint8_t     spare;
+    mp_uuid_t   fid;
+};
+
+struct mp_remove_bulk_arg_t {
+    uint16_t                cid;
+    uint8_t                 sid;
+    uint32_t                nb;
+    mp_remove_bulk_entry_t  entries[MP_REMOVE_BULK_MAX];
+};
+
+union mp_remove_bulk_ret_t switch (mp_status_t status) {
+    case MP_SUCCESS:    uint64_t    failed;
+    case MP_FAILURE:    int         error;
+    default:            void;
+};
+
 struct mp_stat_arg_t {
     uint16_t    cid;
     uint8_t     sid;
@@ -157,5 +177,8 @@ program MONITOR_PROGRAM {
 	mp_size_ret_t
         MP_SIZE(mp_size_arg_t)                          = 6;
 
+        mp_remove_bulk_ret_t
+        MP_REMOVE_BULK(mp_remove_bulk_arg_t)            = 7;
+
     }=1;
 } = 0x20000003;
@@ -26,6 +26,7 @@ monitor_program_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		mp_list_bins_files_arg_t mp_list_bins_files_1_arg;
 		mp_remove2_arg_t mp_remove2_1_arg;
 		mp_size_arg_t mp_size_1_arg;
+		mp_remove_bulk_arg_t mp_remove_bulk_1_arg;
 	} argument;
 	char *result;
 	xdrproc_t _xdr_argument, _xdr_result;
@@ -74,6 +75,12 @@ monitor_program_1(struct svc_req *rqstp, register SVCXPRT *transp)
 		local = (char *(*)(char *, struct svc_req *)) mp_size_1_svc;
 		break;
 
+	case MP_REMOVE_BULK:
+		_xdr_argument = (xdrproc_t) xdr_mp_remove_bulk_arg_t;
+		_xdr_result = (xdrproc_t) xdr_mp_remove_bulk_ret_t;
+		local = (char *(*)(char *, struct svc_req *)) mp_remove_bulk_1_svc;
+		break;
+
 	default:
 		svcerr_noproc (transp);
 		return;
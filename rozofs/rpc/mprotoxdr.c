@@ -75,6 +75,57 @@ xdr_mp_remove_arg_t (XDR *xdrs, mp_remove_arg_t *objp)
 	return TRUE;
 }
 
+bool_t
+xdr_mp_remove_bulk_entry_t (XDR *xdrs, mp_remove_bulk_entry_t *objp)
+{
+	//register int32_t *buf;
+
+	 if (!xdr_uint8_t (xdrs, &objp->spare))
+		 return FALSE;
+	 if (!xdr_mp_uuid_t (xdrs, objp->fid))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_mp_remove_bulk_arg_t (XDR *xdrs, mp_remove_bulk_arg_t *objp)
+{
+	//register int32_t *buf;
+
+	 if (!xdr_uint16_t (xdrs, &objp->cid))
+		 return FALSE;
+	 if (!xdr_uint8_t (xdrs, &objp->sid))
+		 return FALSE;
+	 if (!xdr_uint32_t (xdrs, &objp->nb))
+		 return FALSE;
+	 if (!xdr_vector (xdrs, (char *)objp->entries, MP_REMOVE_BULK_MAX,
+		sizeof (mp_remove_bulk_entry_t), (xdrproc_t) xdr_mp_remove_bulk_entry_t))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_mp_remove_bulk_ret_t (XDR *xdrs, mp_remove_bulk_ret_t *objp)
+{
+	//register int32_t *buf;
+
+	 if (!xdr_mp_status_t (xdrs, &objp->status))
+		 return FALSE;
+	switch (objp->status) {
+	case MP_SUCCESS:
+		 if (!xdr_uint64_t (xdrs, &objp->mp_remove_bulk_ret_t_u.failed))
+			 return FALSE;
+		break;
+	case MP_FAILURE:
+		 if (!xdr_int (xdrs, &objp->mp_remove_bulk_ret_t_u.error))
+			 return FALSE;
+		break;
+	default:
+		break;
+	}
+	return TRUE;
+}
+
 bool_t
 xdr_mp_stat_arg_t (XDR *xdrs, mp_stat_arg_t *objp)
 {
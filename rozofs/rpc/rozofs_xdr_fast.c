@@ -0,0 +1,227 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <rozofs/rpc/rozofs_xdr_fast.h>
+
+/*
+** Size of an XDR unit, and encoded sizes of the arguments
+*/
+#define XDR_UNIT_SZ   4
+
+#define SP_READ_ARG_XDR_SZ       ((5 + ROZOFS_SAFE_MAX_RPC + ROZOFS_UUID_SIZE_RPC + 2 + 1) * XDR_UNIT_SZ)
+#define SP_WRITE_ARG_XDR_SZ      ((6 + ROZOFS_SAFE_MAX_RPC + ROZOFS_UUID_SIZE_RPC + 1 + 2 + 3) * XDR_UNIT_SZ)
+#define STORCLI_READ_ARG_XDR_SZ  ((5 + ROZOFS_SAFE_MAX + ROZOFS_UUID_SIZE + 1 + 2 + 1) * XDR_UNIT_SZ)
+#define STORCLI_WRITE_ARG_XDR_SZ ((5 + ROZOFS_SAFE_MAX + ROZOFS_UUID_SIZE + 2 + 1) * XDR_UNIT_SZ)
+
+/*
+** Encoding/decoding of one field in the in place buffer.
+** The small integers take a whole XDR unit and are truncated on decoding,
+** as xdr_uint8_t, xdr_uint16_t and xdr_u_char do.
+*/
+#define XDR_FAST_PUT32(buf,v)  IXDR_PUT_U_INT32(buf,(uint32_t)(v))
+#define XDR_FAST_PUT64(buf,v)  {XDR_FAST_PUT32(buf,(v)>>32); XDR_FAST_PUT32(buf,(v)&0xFFFFFFFF);}
+
+#define XDR_FAST_GET32(buf,v)  (v) = IXDR_GET_U_INT32(buf)
+#define XDR_FAST_GET64(buf,v)  {(v) = ((uint64_t)IXDR_GET_U_INT32(buf))<<32; (v) |= IXDR_GET_U_INT32(buf);}
+
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Encode/decode the arguments of a SP_READ request
+
+  @param xdrs: the XDR stream
+  @param objp: the arguments
+
+  @retval TRUE on success, FALSE otherwise
+*/
+bool_t rozofs_xdr_fast_sp_read_arg_t(XDR *xdrs, sp_read_arg_t *objp) {
+  int32_t * buf;
+  int       i;
+
+  if (xdrs->x_op == XDR_FREE) return TRUE;
+
+  buf = XDR_INLINE(xdrs, SP_READ_ARG_XDR_SZ);
+  if (buf == NULL) return xdr_sp_read_arg_t(xdrs, objp);
+
+  if (xdrs->x_op == XDR_ENCODE) {
+    XDR_FAST_PUT32(buf,objp->cid);
+    XDR_FAST_PUT32(buf,objp->sid);
+    XDR_FAST_PUT32(buf,objp->layout);
+    XDR_FAST_PUT32(buf,objp->bsize);
+    XDR_FAST_PUT32(buf,objp->spare);
+    for (i=0; i < ROZOFS_SAFE_MAX_RPC; i++) XDR_FAST_PUT32(buf,objp->dist_set[i]);
+    for (i=0; i < ROZOFS_UUID_SIZE_RPC; i++) XDR_FAST_PUT32(buf,objp->fid[i]);
+    XDR_FAST_PUT64(buf,objp->bid);
+    XDR_FAST_PUT32(buf,objp->nb_proj);
+    return TRUE;
+  }
+
+  XDR_FAST_GET32(buf,objp->cid);
+  XDR_FAST_GET32(buf,objp->sid);
+  XDR_FAST_GET32(buf,objp->layout);
+  XDR_FAST_GET32(buf,objp->bsize);
+  XDR_FAST_GET32(buf,objp->spare);
+  for (i=0; i < ROZOFS_SAFE_MAX_RPC; i++) XDR_FAST_GET32(buf,objp->dist_set[i]);
+  for (i=0; i < ROZOFS_UUID_SIZE_RPC; i++) XDR_FAST_GET32(buf,objp->fid[i]);
+  XDR_FAST_GET64(buf,objp->bid);
+  XDR_FAST_GET32(buf,objp->nb_proj);
+  return TRUE;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Encode/decode the arguments of a SP_WRITE request, the bins excepted
+
+  @param xdrs: the XDR stream
+  @param objp: the arguments
+
+  @retval TRUE on success, FALSE otherwise
+*/
+bool_t rozofs_xdr_fast_sp_write_arg_no_bins_t(XDR *xdrs, sp_write_arg_no_bins_t *objp) {
+  int32_t * buf;
+  int       i;
+
+  if (xdrs->x_op == XDR_FREE) return TRUE;
+
+  buf = XDR_INLINE(xdrs, SP_WRITE_ARG_XDR_SZ);
+  if (buf == NULL) return xdr_sp_write_arg_no_bins_t(xdrs, objp);
+
+  if (xdrs->x_op == XDR_ENCODE) {
+    XDR_FAST_PUT32(buf,objp->cid);
+    XDR_FAST_PUT32(buf,objp->sid);
+    XDR_FAST_PUT32(buf,objp->layout);
+    XDR_FAST_PUT32(buf,objp->spare);
+    XDR_FAST_PUT32(buf,objp->rebuild_ref);
+    XDR_FAST_PUT32(buf,objp->alignment1);
+    for (i=0; i < ROZOFS_SAFE_MAX_RPC; i++) XDR_FAST_PUT32(buf,objp->dist_set[i]);
+    for (i=0; i < ROZOFS_UUID_SIZE_RPC; i++) XDR_FAST_PUT32(buf,objp->fid[i]);
+    XDR_FAST_PUT32(buf,objp->proj_id);
+    XDR_FAST_PUT64(buf,objp->bid);
+    XDR_FAST_PUT32(buf,objp->nb_proj);
+    XDR_FAST_PUT32(buf,objp->bsize);
+    XDR_FAST_PUT32(buf,objp->len);
+    return TRUE;
+  }
+
+  XDR_FAST_GET32(buf,objp->cid);
+  XDR_FAST_GET32(buf,objp->sid);
+  XDR_FAST_GET32(buf,objp->layout);
+  XDR_FAST_GET32(buf,objp->spare);
+  XDR_FAST_GET32(buf,objp->rebuild_ref);
+  XDR_FAST_GET32(buf,objp->alignment1);
+  for (i=0; i < ROZOFS_SAFE_MAX_RPC; i++) XDR_FAST_GET32(buf,objp->dist_set[i]);
+  for (i=0; i < ROZOFS_UUID_SIZE_RPC; i++) XDR_FAST_GET32(buf,objp->fid[i]);
+  XDR_FAST_GET32(buf,objp->proj_id);
+  XDR_FAST_GET64(buf,objp->bid);
+  XDR_FAST_GET32(buf,objp->nb_proj);
+  XDR_FAST_GET32(buf,objp->bsize);
+  XDR_FAST_GET32(buf,objp->len);
+  return TRUE;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Encode/decode the arguments of a STORCLI_READ request
+
+  @param xdrs: the XDR stream
+  @param objp: the arguments
+
+  @retval TRUE on success, FALSE otherwise
+*/
+bool_t rozofs_xdr_fast_storcli_read_arg_t(XDR *xdrs, storcli_read_arg_t *objp) {
+  int32_t * buf;
+  int       i;
+
+  if (xdrs->x_op == XDR_FREE) return TRUE;
+
+  buf = XDR_INLINE(xdrs, STORCLI_READ_ARG_XDR_SZ);
+  if (buf == NULL) return xdr_storcli_read_arg_t(xdrs, objp);
+
+  if (xdrs->x_op == XDR_ENCODE) {
+    XDR_FAST_PUT32(buf,objp->cid);
+    XDR_FAST_PUT32(buf,objp->sid);
+    XDR_FAST_PUT32(buf,objp->layout);
+    XDR_FAST_PUT32(buf,objp->spare);
+    XDR_FAST_PUT32(buf,objp->bsize);
+    for (i=0; i < ROZOFS_SAFE_MAX; i++) XDR_FAST_PUT32(buf,objp->dist_set[i]);
+    for (i=0; i < ROZOFS_UUID_SIZE; i++) XDR_FAST_PUT32(buf,objp->fid[i]);
+    XDR_FAST_PUT32(buf,objp->proj_id);
+    XDR_FAST_PUT64(buf,objp->bid);
+    XDR_FAST_PUT32(buf,objp->nb_proj);
+    return TRUE;
+  }
+
+  XDR_FAST_GET32(buf,objp->cid);
+  XDR_FAST_GET32(buf,objp->sid);
+  XDR_FAST_GET32(buf,objp->layout);
+  XDR_FAST_GET32(buf,objp->spare);
+  XDR_FAST_GET32(buf,objp->bsize);
+  for (i=0; i < ROZOFS_SAFE_MAX; i++) XDR_FAST_GET32(buf,objp->dist_set[i]);
+  for (i=0; i < ROZOFS_UUID_SIZE; i++) XDR_FAST_GET32(buf,objp->fid[i]);
+  XDR_FAST_GET32(buf,objp->proj_id);
+  XDR_FAST_GET64(buf,objp->bid);
+  XDR_FAST_GET32(buf,objp->nb_proj);
+  return TRUE;
+}
+/*
+**__________________________________________________________________________
+*/
+/**
+*  Encode/decode the arguments of a STORCLI_WRITE request, the data excepted
+
+  @param xdrs: the XDR stream
+  @param objp: the arguments
+
+  @retval TRUE on success, FALSE otherwise
+*/
+bool_t rozofs_xdr_fast_storcli_write_arg_no_data_t(XDR *xdrs, storcli_write_arg_no_data_t *objp) {
+  int32_t * buf;
+  int       i;
+
+  if (xdrs->x_op == XDR_FREE) return TRUE;
+
+  buf = XDR_INLINE(xdrs, STORCLI_WRITE_ARG_XDR_SZ);
+  if (buf == NULL) return xdr_storcli_write_arg_no_data_t(xdrs, objp);
+
+  if (xdrs->x_op == XDR_ENCODE) {
+    XDR_FAST_PUT32(buf,objp->cid);
+    XDR_FAST_PUT32(buf,objp->sid);
+    XDR_FAST_PUT32(buf,objp->flags);
+    XDR_FAST_PUT32(buf,objp->layout);
+    XDR_FAST_PUT32(buf,objp->bsize);
+    for (i=0; i < ROZOFS_SAFE_MAX; i++) XDR_FAST_PUT32(buf,objp->dist_set[i]);
+    for (i=0; i < ROZOFS_UUID_SIZE; i++) XDR_FAST_PUT32(buf,objp->fid[i]);
+    XDR_FAST_PUT64(buf,objp->off);
+    XDR_FAST_PUT32(buf,objp->len);
+    return TRUE;
+  }
+
+  XDR_FAST_GET32(buf,objp->cid);
+  XDR_FAST_GET32(buf,objp->sid);
+  XDR_FAST_GET32(buf,objp->flags);
+  XDR_FAST_GET32(buf,objp->layout);
+  XDR_FAST_GET32(buf,objp->bsize);
+  for (i=0; i < ROZOFS_SAFE_MAX; i++) XDR_FAST_GET32(buf,objp->dist_set[i]);
+  for (i=0; i < ROZOFS_UUID_SIZE; i++) XDR_FAST_GET32(buf,objp->fid[i]);
+  XDR_FAST_GET64(buf,objp->off);
+  XDR_FAST_GET32(buf,objp->len);
+  return TRUE;
+}
@@ -0,0 +1,56 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ROZOFS_XDR_FAST_H
+#define ROZOFS_XDR_FAST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <rpc/rpc.h>
+#include <rozofs/rozofs.h>
+#include <rozofs/rpc/sproto.h>
+#include <rozofs/rpc/storcli_proto.h>
+
+/*
+** Hand written XDR codecs of the arguments of the read and write
+** requests, which are the most frequent messages between rozofsmount,
+** storcli and storio.
+**
+** These arguments only have fixed size fields, so their whole encoding
+** is got at once from the XDR stream with XDR_INLINE, and the fields
+** are then read or written in place, without one XDR call per field
+** (the dist_set and FID of the storcli arguments cost one call per
+** byte in the rpcgen codecs). The wire format is exactly the one of
+** the rpcgen codecs, to which they fall back when the stream can not
+** provide the room in place (i.e. record streams, unaligned buffers).
+**
+** They have the xdrproc_t prototype, so that they can replace the
+** rpcgen codecs anywhere.
+*/
+bool_t rozofs_xdr_fast_sp_read_arg_t(XDR *xdrs, sp_read_arg_t *objp);
+bool_t rozofs_xdr_fast_sp_write_arg_no_bins_t(XDR *xdrs, sp_write_arg_no_bins_t *objp);
+bool_t rozofs_xdr_fast_storcli_read_arg_t(XDR *xdrs, storcli_read_arg_t *objp);
+bool_t rozofs_xdr_fast_storcli_write_arg_no_data_t(XDR *xdrs, storcli_write_arg_no_data_t *objp);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -74,6 +74,7 @@ struct stcpp_profiler_t {
 	uint64_t resize_prj[2];
 	uint64_t resize_prj_err[2];
 	uint16_t io_process_ports[32];
+	uint64_t write_degraded[2];
 };
 typedef struct stcpp_profiler_t stcpp_profiler_t;
 
@@ -79,6 +79,7 @@ struct stcpp_profiler_t {
     uint64_t    resize_prj[2];    
     uint64_t    resize_prj_err[2];    
     uint16_t    io_process_ports[32];
+    uint64_t    write_degraded[2];
 };
 
 union stcpp_profiler_ret_t switch (stcpp_status_t status) {
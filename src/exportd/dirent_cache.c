@@ -84,6 +84,9 @@ uint32_t dirent_skip_16_cnt = 0;
 
 uint64_t malloc_size = 0;
 uint32_t malloc_size_tb[DIRENT_MEM_MAX_IDX];
+uint64_t dirent_slab_arena_size = 0;
+uint64_t dirent_large_size = 0;
+dirent_slab_class_t dirent_slab_class_tb[DIRENT_SLAB_MAX_CLASS];
 
 uint64_t dirent_coll_stats_tb[DIRENT_COLL_STAT_MAX_IDX];
 uint64_t dirent_coll_stats_cumul_lookups;
@@ -163,6 +166,156 @@ void dirent_cache_initialize(dirent_cache_t *cache) {
 }
 #endif
 
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Allocate a new slab for a class and put it in the list of the slabs of
+ *  the class that have free blocks. The first block of the slab holds its
+ *  descriptor.
+
+ @param cls : slab class (block size is (cls+1)*DIRENT_MEM_BLOCK_SZ)
+
+ @retval 0 on success
+ @retval -1 out of memory
+ */
+int dirent_slab_grow(int cls) {
+    dirent_slab_class_t *class_p = &dirent_slab_class_tb[cls];
+    uint32_t block_sz = (cls + 1) * DIRENT_MEM_BLOCK_SZ;
+    uint32_t nb_blocks = DIRENT_SLAB_SIZE / block_sz;
+    dirent_slab_t *slab_p;
+    uint64_t *block_p;
+    int i;
+
+    if (class_p->partial.next == NULL) list_init(&class_p->partial);
+
+    slab_p = memalign(DIRENT_SLAB_SIZE, DIRENT_SLAB_SIZE);
+    if (slab_p == NULL) {
+        return -1;
+    }
+    slab_p->free_p = NULL;
+    slab_p->inuse = 0;
+    slab_p->cls = cls;
+    /*
+     ** chain the blocks of the slab in its free list, but the first one
+     */
+    for (i = nb_blocks - 1; i >= 1; i--) {
+        block_p = (uint64_t*) ((uint8_t*) slab_p + i * block_sz);
+        block_p[0] = (uint64_t) (uintptr_t) slab_p->free_p;
+        slab_p->free_p = block_p;
+    }
+    list_init(&slab_p->link);
+    list_push_front(&class_p->partial, &slab_p->link);
+    class_p->free_count += nb_blocks - 1;
+    class_p->slab_count++;
+    dirent_slab_arena_size += DIRENT_SLAB_SIZE;
+    return 0;
+}
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Give back to the system a slab which blocks are all free, so that the
+ *  memory footprint of the dirent cache follows the evictions. The slab is
+ *  kept when it is the only one of its class that has free blocks, not to
+ *  allocate and release a slab on each allocation and release of a block.
+
+ @param slab_p : the slab
+ */
+void dirent_slab_release(dirent_slab_t *slab_p) {
+    dirent_slab_class_t *class_p = &dirent_slab_class_tb[slab_p->cls];
+    uint32_t nb_blocks = DIRENT_SLAB_SIZE / ((slab_p->cls + 1) * DIRENT_MEM_BLOCK_SZ) - 1;
+
+    if (class_p->free_count <= nb_blocks) return;
+
+    list_remove(&slab_p->link);
+    class_p->free_count -= nb_blocks;
+    class_p->slab_count--;
+    dirent_slab_arena_size -= DIRENT_SLAB_SIZE;
+    free(slab_p);
+}
+
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Compute the memory used by the arrays referenced through a table of indirect
+ *  pointers (name chunk arrays or collision dirent cache entries)
+
+ @param p : pointer to the table of virtual pointers of the level
+ @param template_p : description of the indirection levels
+ @param level : current indirection level
+ @param coll : assert to 1 when the leaves are collision dirent cache entries
+
+ @retval memory size in bytes
+ */
+static uint64_t dirent_cache_indirect_mem_size(mdirent_cache_ptr_t *p,
+        mdirent_indirect_ptr_template_t *template_p, int level, int coll) {
+    uint64_t size = 0;
+    void *mem_p;
+    int i;
+
+    for (i = 0; i < (1 << template_p->level[level]); i++) {
+        mem_p = DIRENT_VIRT_TO_PHY(p[i]);
+        if (mem_p == NULL)
+            continue;
+        if (level == (template_p->levels - 1)) {
+            /*
+             ** leaf of the tree
+             */
+            if (coll)
+                size += dirent_cache_entry_mem_size((mdirents_cache_entry_t*) mem_p);
+            else
+                size += dirent_mem_block_size(mem_p);
+            continue;
+        }
+        size += dirent_mem_block_size(mem_p);
+        size += dirent_cache_indirect_mem_size((mdirent_cache_ptr_t*) mem_p,
+                template_p, level + 1, coll);
+    }
+    return size;
+}
+
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Compute the memory used by a dirent cache entry including the memory of
+ *  its collision dirent cache entries
+
+ @param dirent_entry_p : pointer to the dirent cache entry
+
+ @retval memory size in bytes
+ */
+uint64_t dirent_cache_entry_mem_size(mdirents_cache_entry_t *dirent_entry_p) {
+    uint64_t size;
+    void *mem_p;
+    int i;
+
+    size = dirent_mem_block_size(dirent_entry_p);
+    size += dirent_mem_block_size(dirent_entry_p->bucket_safe_bitmap_p);
+    mem_p = DIRENT_VIRT_TO_PHY(dirent_entry_p->sect0_p);
+    size += dirent_mem_block_size(mem_p);
+    mem_p = DIRENT_VIRT_TO_PHY(dirent_entry_p->coll_bitmap_hash_full_p);
+    size += dirent_mem_block_size(mem_p);
+    mem_p = DIRENT_VIRT_TO_PHY(dirent_entry_p->name_bitmap_p);
+    size += dirent_mem_block_size(mem_p);
+
+    for (i = 0; i < MDIRENTS_HASH_TB_CACHE_MAX_IDX; i++) {
+        mem_p = DIRENT_VIRT_TO_PHY(dirent_entry_p->hash_tbl_p[i]);
+        size += dirent_mem_block_size(mem_p);
+    }
+    for (i = 0; i < MDIRENTS_HASH_CACHE_MAX_IDX; i++) {
+        mem_p = DIRENT_VIRT_TO_PHY(dirent_entry_p->hash_entry_p[i]);
+        size += dirent_mem_block_size(mem_p);
+    }
+    size += dirent_cache_indirect_mem_size(dirent_entry_p->name_entry_lvl0_p,
+            &mdirent_cache_name_ptr_distrib, 0, 0);
+    size += dirent_cache_indirect_mem_size(dirent_entry_p->dirent_coll_lvl0_p,
+            &mdirent_cache_indirect_coll_distrib, 0, 1);
+    return size;
+}
+
 /*
  **______________________________________________________________________________
  */
@@ -1661,7 +1814,7 @@ mdirents_cache_entry_t * read_mdirents_file(int dirfd,
 	** File is empty. Let's remove it to avoid log overflow.
 	*/
         if (ret == 0) {
-	  close(fd);
+	  DIRENT_CLOSE(fd);
 	  fd = -1;
 	  unlinkat(dirfd, path_p,0);
 	}
@@ -2017,7 +2170,7 @@ mdirents_cache_entry_t * read_mdirents_file(int dirfd,
 #endif    
 out: 
     if (fd != -1)
-        close(fd);
+        DIRENT_CLOSE(fd);
     if (dirent_file_p != NULL )
         DIRENT_FREE(dirent_file_p);
     return dirent_p;
@@ -2030,7 +2183,7 @@ error:
     if (dirent_file_p != NULL )
         DIRENT_FREE(dirent_file_p);
     if (fd != -1)
-        close(fd);
+        DIRENT_CLOSE(fd);
     return NULL ;
 }
 
@@ -2667,13 +2820,13 @@ int dirent_read_name_array_from_disk(int dirfd,
      ** that's OK
      */
     if (fd != -1)
-        close(fd);
+        DIRENT_CLOSE(fd);
     return 0;
 
 error: 
     DIRENT_ROOT_SET_READ_ONLY();
     if (fd != -1)
-        close(fd);
+        DIRENT_CLOSE(fd);
     return -1;
 }
 
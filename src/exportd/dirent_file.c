@@ -26,6 +26,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <unistd.h>
+#include <time.h>
 #include <uuid/uuid.h>
 
 #include <rozofs/rozofs.h>
@@ -54,6 +55,18 @@
    - 64K buckets\n
    - Each bucket supports up to 256 collisions entries\n
 
+   The eviction of the level 0 cache is bounded by a number of entries and by an optional
+   memory budget (export_dirent_cache_size in rozofs.conf). It relies on a cold and a hot list:\n
+   - a new entry is inserted at the head of the cold list\n
+   - an entry that is accessed again after its correlated period (DIRENT_CACHE_CORRELATED_PERIOD)
+     is marked as referenced. The burst of accesses of a readdir or of a scan does not mark it.\n
+   - the eviction scans the tail of the cold list: a referenced entry is promoted in the hot list,
+     the others are released.\n
+   - the hot list is limited to DIRENT_CACHE_HOT_RATIO percent of the entries: the non referenced
+     entries of its tail are demoted in the cold list.\n
+   So a one time scan of the tree (i.e a find) only recycles the cold list and does not flush the
+   working set of the hot directories.\n
+
    For an application standpoint, it is possible to enable/disable the Level 0 cache. \n
 
    Here is an example of the output of the level 0 cache statistics:\n
@@ -75,6 +88,10 @@ collisions Max level0/level1 1/0
 #define DIRENT_BUCKET_NB_ENTRY_PER_ARRAY  32 /**< number of dirent_cache_bucket_entry_t strcuture per memory array */
 #define DIRENT_BUCKET_ENTRY_MAX_ARRAY (DIRENT_BUCKET_MAX_COLLISIONS/DIRENT_BUCKET_NB_ENTRY_PER_ARRAY)
 
+#define DIRENT_CACHE_CORRELATED_PERIOD  2   /**< accesses within that period (in seconds) do not mark an entry as referenced */
+#define DIRENT_CACHE_HOT_RATIO          75  /**< max percentage of the entries that can be in the hot list */
+#define DIRENT_CACHE_MAX_EVICT_PER_INSERT 64 /**< max number of entries released upon the insertion of a new entry */
+
 typedef struct _dirent_cache_bucket_entry_t {
     uint16_t hash_value_table[DIRENT_BUCKET_NB_ENTRY_PER_ARRAY]; /**< table of the hash value applied to the parent_fid and index */
     void *entry_ptr_table[DIRENT_BUCKET_NB_ENTRY_PER_ARRAY]; /**< table of the dirent cache entries: used for doing the exact match */
@@ -93,7 +110,12 @@ typedef struct _dirent_cache_bucket_t {
 typedef struct _dirent_cache_main_t {
     uint32_t max; /**< maximum number of entries in the cache */
     uint32_t size; /**< current number of entries in the cache */
-    list_t global_lru_link; /**< entries cached: used for LRU           */
+    uint32_t hot_count; /**< current number of entries in the hot list */
+    uint64_t mem_max; /**< memory budget in bytes (0: no budget) */
+    uint64_t access_count; /**< logical clock incremented on each insertion and hit */
+    uint64_t request_stamp; /**< value of the logical clock at the beginning of the on-going request */
+    list_t global_lru_link; /**< cold entries: new or demoted entries */
+    list_t hot_lru_link; /**< hot entries: entries that have been re-used */
     dirent_cache_bucket_t *htable; /**< pointer to the bucket array of the cache */
 } dirent_cache_main_t;
 
@@ -113,6 +135,9 @@ uint64_t dirent_bucket_cache_lru_counter_global = 0;
 uint64_t dirent_bucket_cache_lru_counter_coll = 0;
 uint64_t dirent_bucket_cache_lru_global_error = 0;
 uint64_t dirent_bucket_cache_lru_coll_error = 0;
+uint64_t dirent_bucket_cache_lru_counter_mem = 0; /**< entries released because of the memory budget */
+uint64_t dirent_bucket_cache_promote_counter = 0; /**< entries promoted from cold to hot list */
+uint64_t dirent_bucket_cache_demote_counter = 0; /**< entries demoted from hot to cold list */
 uint64_t dirent_bucket_cache_collision_level0_counter = 0;
 int dirent_bucket_cache_max_level0_collisions = 0; /**< max number of collision at level 0  */
 int dirent_bucket_cache_max_level1_collisions = 0; /**< max number of collision at level 1  */
@@ -191,7 +216,11 @@ void dirent_cache_level0_initialize() {
     dirent_cache_main_t *cache = &dirent_cache_level0;
     cache->max = DIRENT_BUCKET_MAX_ROOT_DIRENT;
     cache->size = 0;
+    cache->hot_count = 0;
+    cache->access_count = 0;
+    cache->request_stamp = 0;
     list_init(&cache->global_lru_link);
+    list_init(&cache->hot_lru_link);
     /*
      ** Allocate the memory to handle the buckets
      */
@@ -214,6 +243,192 @@ void dirent_cache_level0_initialize() {
     dirent_buckect_cache_initialized = 1;
 }
 
+/*
+ **______________________________________________________________________________
+ */
+
+/**
+ *  Set the memory budget of the level 0 dirent cache
+
+ @param size : memory budget in bytes (0: no budget, only the number of entries is bounded)
+
+ @retval none
+ */
+void dirent_cache_level0_set_memory_budget(uint64_t size) {
+    dirent_cache_level0.mem_max = size;
+}
+
+/*
+ **______________________________________________________________________________
+ */
+
+/**
+ *  Start a new directory request: the entries accessed from now on are pinned
+ *  in the level 0 cache until the beginning of the next request, since the
+ *  request may still use them while inserting other entries
+
+ @retval none
+ */
+void dirent_cache_level0_request_start() {
+    dirent_cache_level0.request_stamp = dirent_cache_level0.access_count;
+}
+
+/*
+ **______________________________________________________________________________
+ */
+
+/**
+ *  Update the eviction context of an entry upon an access: the entry is moved
+ *  at the head of its list and it is marked as referenced when the access is not
+ *  correlated with the previous one
+
+   @param cache : pointer to the main cache structure
+   @param entry_p : pointer to the accessed entry
+   @param insert : assert to 1 when the entry is inserted in the cache
+
+   @retval none
+ */
+static inline void dirent_cache_level0_access(dirent_cache_main_t *cache, mdirents_cache_entry_t *entry_p, int insert) {
+    uint32_t now = (uint32_t) time(NULL);
+
+    cache->access_count++;
+    if (insert) {
+        entry_p->cache_hot = 0;
+        entry_p->cache_referenced = 0;
+        list_push_front(&cache->global_lru_link, &entry_p->cache_link);
+    } else {
+        if ((now - entry_p->cache_access_time) > DIRENT_CACHE_CORRELATED_PERIOD) {
+            entry_p->cache_referenced = 1;
+        }
+        list_remove(&entry_p->cache_link);
+        list_push_front(entry_p->cache_hot ? &cache->hot_lru_link : &cache->global_lru_link, &entry_p->cache_link);
+    }
+    entry_p->cache_access_time = now;
+    entry_p->cache_access_stamp = cache->access_count;
+}
+
+/*
+ **______________________________________________________________________________
+ */
+
+/**
+ *  Select the entry to release from the level 0 cache.
+ *  The hot list is first trimmed to its share of the cache, then the cold list is
+ *  scanned from its tail: the referenced entries get promoted in the hot list.
+ *  The entries that have been accessed by the on-going request are never selected.
+
+   @param cache : pointer to the main cache structure
+
+   @retval <>NULL: pointer to the entry to release
+   @retval NULL: no entry can be released
+ */
+static mdirents_cache_entry_t *dirent_cache_level0_select_victim(dirent_cache_main_t *cache) {
+    mdirents_cache_entry_t *entry_p;
+    uint32_t loop = 0;
+    uint32_t loop_max = 2 * cache->size + 1;
+
+    /*
+    ** demote the tail of the hot list when it exceeds its share
+    */
+    while ((cache->hot_count * 100 > cache->size * DIRENT_CACHE_HOT_RATIO) && (loop++ < loop_max)) {
+        entry_p = list_entry(cache->hot_lru_link.prev, mdirents_cache_entry_t, cache_link);
+        list_remove(&entry_p->cache_link);
+        if (entry_p->cache_referenced) {
+            /*
+            ** second chance
+            */
+            entry_p->cache_referenced = 0;
+            list_push_front(&cache->hot_lru_link, &entry_p->cache_link);
+            continue;
+        }
+        entry_p->cache_hot = 0;
+        cache->hot_count--;
+        dirent_bucket_cache_demote_counter++;
+        list_push_front(&cache->global_lru_link, &entry_p->cache_link);
+    }
+    /*
+    ** scan the cold list
+    */
+    loop = 0;
+    while ((!list_empty(&cache->global_lru_link)) && (loop++ < loop_max)) {
+        entry_p = list_entry(cache->global_lru_link.prev, mdirents_cache_entry_t, cache_link);
+        if (entry_p->cache_referenced) {
+            /*
+            ** promote the entry in the hot list
+            */
+            list_remove(&entry_p->cache_link);
+            entry_p->cache_referenced = 0;
+            entry_p->cache_hot = 1;
+            cache->hot_count++;
+            dirent_bucket_cache_promote_counter++;
+            list_push_front(&cache->hot_lru_link, &entry_p->cache_link);
+            continue;
+        }
+        if (entry_p->cache_access_stamp > cache->request_stamp) {
+            /*
+            ** in use by the current request
+            */
+            break;
+        }
+        return entry_p;
+    }
+    /*
+    ** nothing in the cold list: take the oldest entry of the hot list
+    */
+    if (list_empty(&cache->hot_lru_link)) return NULL;
+    entry_p = list_entry(cache->hot_lru_link.prev, mdirents_cache_entry_t, cache_link);
+    if (entry_p->cache_access_stamp > cache->request_stamp) return NULL;
+    return entry_p;
+}
+
+/*
+ **______________________________________________________________________________
+ */
+
+/**
+ *  Release entries from the level 0 cache until it is back within its limits
+ *  (number of entries and memory budget)
+
+   @param cache : pointer to the main cache structure
+
+   @retval 0 -> success
+   @retval -1 -> failure on entry removal
+ */
+static int dirent_cache_level0_evict(dirent_cache_main_t *cache) {
+    mdirents_cache_entry_t *cache_entry_lru_p;
+    int mem_full;
+    int count = 0;
+    int ret;
+
+    while (count < DIRENT_CACHE_MAX_EVICT_PER_INSERT) {
+        mem_full = ((cache->mem_max != 0) && (DIRENT_MALLOC_GET_CURRENT_SIZE() > cache->mem_max));
+        if (cache->size < cache->max) {
+            if (mem_full == 0) break;
+        }
+        else mem_full = 0;
+
+        cache_entry_lru_p = dirent_cache_level0_select_victim(cache);
+        if (cache_entry_lru_p == NULL) break;
+        ret = dirent_cache_bucket_remove_entry(cache, cache_entry_lru_p->key.dir_fid, cache_entry_lru_p->key.dirent_root_idx);
+        if (ret == -1) {
+            /*
+            ** not really normal
+            */
+            dirent_bucket_cache_lru_global_error++;
+            severe("Debug fail to Remove %p index %d ", cache_entry_lru_p, -1);
+            return -1;
+        }
+        /*
+        ** release the memory allocated for storing the dirent file
+        */
+        if (mem_full) dirent_bucket_cache_lru_counter_mem++;
+        else dirent_bucket_cache_lru_counter_global++;
+        dirent_cache_release_entry(cache_entry_lru_p);
+        count++;
+    }
+    return 0;
+}
+
 /**
  *  Insert a root dirent file reference in the cache
  *  Note : the bitmap is aligned on a 8 byte boundary, so we can perform
@@ -255,28 +470,9 @@ int dirent_cache_bucket_insert_entry(dirent_cache_main_t *cache, fid_t fid, uint
     hash_bucket_entry = (uint16_t) (hash_value & 0xffff);
     
     /*
-    ** LRU handling: check for cache full condition: release one entry from the global link
+    ** eviction handling: check for cache full condition (entries or memory budget)
     */
-    if (cache->size >= cache->max)
-    {
-      int ret;
-      mdirents_cache_entry_t *cache_entry_lru_p = list_entry(cache->global_lru_link.prev, mdirents_cache_entry_t, cache_link);
-      ret = dirent_cache_bucket_remove_entry(cache,cache_entry_lru_p->key.dir_fid,cache_entry_lru_p->key.dirent_root_idx);
-      if (ret == -1) 
-      {
-        /*
-        ** not really normal
-        */
-        dirent_bucket_cache_lru_global_error++;
-        severe("Debug fail to Remove %p index %d ",cache_entry_lru_p,-1 );
-        return -1;      
-      }
-      /*
-      ** release the memory allocated for storing the dirent file
-      */
-      dirent_bucket_cache_lru_counter_global++;
-      dirent_cache_release_entry(cache_entry_lru_p);
-    }
+    if (dirent_cache_level0_evict(cache) < 0) return -1;
     /*
      ** set the pointer to the bucket and load up the pointer to the bitmap
      */
@@ -346,7 +542,7 @@ reloop:
         */
         {
           mdirents_cache_entry_t *dirent_cache_p = (mdirents_cache_entry_t*)entry;
-          list_push_front(&cache->global_lru_link, &dirent_cache_p->cache_link);
+          dirent_cache_level0_access(cache, dirent_cache_p, 1);
           list_push_front(&bucket_p->bucket_lru_link, &dirent_cache_p->coll_link);
           cache->size++;
         }
@@ -502,9 +698,8 @@ mdirents_cache_entry_t *dirent_cache_bucket_search_entry(dirent_cache_main_t *ca
         ** do the job for LRU
         */
         {
-          list_remove(&cache_entry_p->cache_link);
+          dirent_cache_level0_access(cache, cache_entry_p, 0);
           list_remove(&cache_entry_p->coll_link);
-          list_push_front(&cache->global_lru_link, &cache_entry_p->cache_link);
           list_push_front(&bucket_p->bucket_lru_link, &cache_entry_p->coll_link);
         }
         return cache_entry_p;
@@ -629,6 +824,8 @@ int dirent_cache_bucket_remove_entry(dirent_cache_main_t *cache, fid_t fid, uint
           list_remove(&cache_entry_p->cache_link);
           list_remove(&cache_entry_p->coll_link);          
           cache->size--;
+          if (cache_entry_p->cache_hot) cache->hot_count--;
+          cache_entry_p->cache_hot = 0;
         }
         /*
          **________________________________________________
@@ -747,6 +944,13 @@ dirent_range_t dirent_range_table[] = {
 
 mdirents_cache_entry_t * dirent_get_root_entry_from_cache(fid_t fid, int root_idx) {
     if (dirent_bucket_cache_enable == 0) return NULL;
+    /*
+    ** the cached entries grow while files are inserted: enforce the memory budget
+    ** before serving a new request
+    */
+    if ((dirent_cache_level0.mem_max != 0) && (DIRENT_MALLOC_GET_CURRENT_SIZE() > dirent_cache_level0.mem_max)) {
+        dirent_cache_level0_evict(&dirent_cache_level0);
+    }
     return dirent_cache_bucket_search_entry(&dirent_cache_level0, fid, (uint16_t) root_idx);
 }
 
@@ -772,6 +976,172 @@ int dirent_remove_root_entry_from_cache(fid_t fid, int root_idx) {
     return dirent_cache_bucket_remove_entry(&dirent_cache_level0, fid, (uint16_t) root_idx);
 }
 
+/*
+ **______________________________________________________________________________
+ */
+/**
+*  READDIR CURSOR CACHE
+
+   A readdir chunk is computed from the cookie returned by the previous chunk.
+   The result of a chunk (fuse dirent buffer, next cookie and eof) is kept
+   in a small cache indexed by the (directory fid, cookie) pair, so that
+   clients listing the same directory share the walk of the root and collision
+   dirent files instead of repeating it for each of them.
+   All the cursors of a directory are hashed in the same bucket; they are
+   dropped as soon as an entry is inserted in or removed from the directory.
+   The first chunk (".", ".." and trash entries) is never cached since it depends
+   on the attributes of the directory.
+*/
+#define DIRENT_READDIR_CURSOR_BUCKETS 64  /**< number of hash buckets       */
+#define DIRENT_READDIR_CURSOR_MAX     128 /**< max number of cached cursors */
+
+typedef struct _dirent_readdir_cursor_t {
+    list_t   bucket_link;  /**< link in the fid bucket            */
+    list_t   lru_link;     /**< link in the global LRU            */
+    fid_t    fid;          /**< fid of the directory              */
+    int      deleted_dir;  /**< 1 when listing a deleted directory */
+    uint64_t cookie_in;    /**< cookie of the chunk               */
+    uint64_t cookie_out;   /**< cookie returned with the chunk    */
+    uint8_t  eof;          /**< end of directory reached          */
+    int      len;          /**< length of the chunk               */
+    char    *buf;          /**< fuse dirents of the chunk         */
+} dirent_readdir_cursor_t;
+
+typedef struct _dirent_readdir_cursor_main_t {
+    int      init_done;
+    uint32_t size;                                      /**< current number of cursors */
+    uint64_t mem_size;                                  /**< memory used by the chunks */
+    list_t   lru_link;                                  /**< LRU of the cursors        */
+    list_t   bucket[DIRENT_READDIR_CURSOR_BUCKETS];     /**< cursors per directory     */
+} dirent_readdir_cursor_main_t;
+
+dirent_readdir_cursor_main_t dirent_readdir_cursor;
+
+uint64_t dirent_readdir_cursor_hit_counter = 0;
+uint64_t dirent_readdir_cursor_miss_counter = 0;
+uint64_t dirent_readdir_cursor_evict_counter = 0;
+uint64_t dirent_readdir_cursor_invalidate_counter = 0;
+
+static inline list_t *dirent_readdir_cursor_bucket(fid_t fid) {
+    uint16_t index = 0;
+    uint32_t hash_value;
+    int i;
+
+    if (dirent_readdir_cursor.init_done == 0) {
+        list_init(&dirent_readdir_cursor.lru_link);
+        for (i = 0; i < DIRENT_READDIR_CURSOR_BUCKETS; i++) list_init(&dirent_readdir_cursor.bucket[i]);
+        dirent_readdir_cursor.init_done = 1;
+    }
+    hash_value = dirent_cache_bucket_hash_fnv(0, fid, &index);
+    return &dirent_readdir_cursor.bucket[hash_value % DIRENT_READDIR_CURSOR_BUCKETS];
+}
+
+static void dirent_readdir_cursor_release(dirent_readdir_cursor_t *cursor_p) {
+    list_remove(&cursor_p->bucket_link);
+    list_remove(&cursor_p->lru_link);
+    dirent_readdir_cursor.size--;
+    dirent_readdir_cursor.mem_size -= cursor_p->len;
+    if (cursor_p->buf != NULL) xfree(cursor_p->buf);
+    xfree(cursor_p);
+}
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Drop all the readdir cursors of a directory
+
+ @param fid : fid of the directory (delete pending bit cleared)
+ */
+void dirent_readdir_cursor_invalidate(fid_t fid) {
+    list_t *bucket_p;
+    list_t *p, *q;
+    dirent_readdir_cursor_t *cursor_p;
+
+    bucket_p = dirent_readdir_cursor_bucket(fid);
+    list_for_each_forward_safe(p, q, bucket_p) {
+        cursor_p = list_entry(p, dirent_readdir_cursor_t, bucket_link);
+        if (uuid_compare(fid, cursor_p->fid) != 0) continue;
+        dirent_readdir_cursor_release(cursor_p);
+        dirent_readdir_cursor_invalidate_counter++;
+    }
+}
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Search for the chunk of a directory starting at a given cookie
+
+ @param fid : fid of the directory (delete pending bit cleared)
+ @param deleted_dir : 1 when the deleted entries of the directory are listed
+ @param cookie : cookie of the chunk
+
+ @retval <>NULL: pointer to the cursor
+ @retval NULL: not found
+ */
+static dirent_readdir_cursor_t *dirent_readdir_cursor_search(fid_t fid, int deleted_dir, uint64_t cookie) {
+    list_t *bucket_p;
+    list_t *p;
+    dirent_readdir_cursor_t *cursor_p;
+
+    bucket_p = dirent_readdir_cursor_bucket(fid);
+    list_for_each_forward(p, bucket_p) {
+        cursor_p = list_entry(p, dirent_readdir_cursor_t, bucket_link);
+        if (cursor_p->cookie_in != cookie) continue;
+        if (cursor_p->deleted_dir != deleted_dir) continue;
+        if (uuid_compare(fid, cursor_p->fid) != 0) continue;
+        list_remove(&cursor_p->lru_link);
+        list_push_front(&dirent_readdir_cursor.lru_link, &cursor_p->lru_link);
+        dirent_readdir_cursor_hit_counter++;
+        return cursor_p;
+    }
+    dirent_readdir_cursor_miss_counter++;
+    return NULL;
+}
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Keep the result of a readdir chunk in the cursor cache
+
+ @param fid : fid of the directory (delete pending bit cleared)
+ @param deleted_dir : 1 when the deleted entries of the directory are listed
+ @param cookie_in : cookie of the chunk
+ @param cookie_out : cookie returned with the chunk
+ @param eof : end of directory indicator returned with the chunk
+ @param buf : fuse dirents of the chunk
+ @param len : length of the chunk
+ */
+static void dirent_readdir_cursor_store(fid_t fid, int deleted_dir, uint64_t cookie_in,
+                                        uint64_t cookie_out, uint8_t eof, char *buf, int len) {
+    list_t *bucket_p;
+    dirent_readdir_cursor_t *cursor_p;
+
+    bucket_p = dirent_readdir_cursor_bucket(fid);
+    while (dirent_readdir_cursor.size >= DIRENT_READDIR_CURSOR_MAX) {
+        cursor_p = list_entry(dirent_readdir_cursor.lru_link.prev, dirent_readdir_cursor_t, lru_link);
+        dirent_readdir_cursor_release(cursor_p);
+        dirent_readdir_cursor_evict_counter++;
+    }
+    cursor_p = xmalloc(sizeof (dirent_readdir_cursor_t));
+    cursor_p->buf = NULL;
+    if (len > 0) {
+        cursor_p->buf = xmalloc(len);
+        memcpy(cursor_p->buf, buf, len);
+    }
+    memcpy(cursor_p->fid, fid, sizeof (fid_t));
+    cursor_p->deleted_dir = deleted_dir;
+    cursor_p->cookie_in = cookie_in;
+    cursor_p->cookie_out = cookie_out;
+    cursor_p->eof = eof;
+    cursor_p->len = len;
+    list_init(&cursor_p->bucket_link);
+    list_init(&cursor_p->lru_link);
+    list_push_front(bucket_p, &cursor_p->bucket_link);
+    list_push_front(&dirent_readdir_cursor.lru_link, &cursor_p->lru_link);
+    dirent_readdir_cursor.size++;
+    dirent_readdir_cursor.mem_size += len;
+}
+
 /*
  ** Print the dirent cache bucket statistics
  */
@@ -783,6 +1153,12 @@ char* dirent_cache_display(char *pChar) {
     
     pChar+=sprintf(pChar,"Malloc size (MB/B)             : %llu/%llu\n",(long long unsigned int)malloc_size/(1024*1024), 
                    (long long unsigned int)malloc_size);    
+    pChar+=sprintf(pChar,"Memory budget (MB)             : %llu%s\n",(long long unsigned int)dirent_cache_level0.mem_max/(1024*1024),
+                   (dirent_cache_level0.mem_max == 0)?" (no budget)":"");
+    pChar+=sprintf(pChar,"Slab arena/large blocks (MB)   : %llu/%llu\n",(long long unsigned int)dirent_slab_arena_size/(1024*1024),
+                   (long long unsigned int)dirent_large_size/(1024*1024));
+    pChar+=sprintf(pChar,"Entries (cur/max/hot)          : %u/%u/%u\n",
+                   dirent_cache_level0.size,dirent_cache_level0.max,dirent_cache_level0.hot_count);
     pChar+=sprintf(pChar,"Level 0 cache state            : %s\n", (dirent_bucket_cache_enable == 0) ? "Disabled" : "Enabled");
     pChar+=sprintf(pChar,"Number of entries level 0      : %u\n", dirent_bucket_cache_append_counter);
     pChar+=sprintf(pChar,"hit/miss                       : %llu/%llu\n", 
@@ -798,8 +1174,22 @@ char* dirent_cache_display(char *pChar) {
     pChar+=sprintf(pChar,"coll cpt   (ok/err)            : %llu/%llu\n", 
                   (long long unsigned int) dirent_bucket_cache_lru_counter_coll,
                   (long long unsigned int) dirent_bucket_cache_lru_coll_error);
+    pChar+=sprintf(pChar,"memory budget cpt              : %llu\n", 
+                  (long long unsigned int) dirent_bucket_cache_lru_counter_mem);
+    pChar+=sprintf(pChar,"promote/demote cpt             : %llu/%llu\n", 
+                  (long long unsigned int) dirent_bucket_cache_promote_counter,
+                  (long long unsigned int) dirent_bucket_cache_demote_counter);
     pChar+=sprintf(pChar,"collisions Max level0/level1   : %u/%u\n", 
                    dirent_bucket_cache_max_level0_collisions, dirent_bucket_cache_max_level1_collisions);
+    pChar+=sprintf(pChar,"Readdir cursors (cur/max/KB)   : %u/%u/%llu\n",
+                   dirent_readdir_cursor.size,DIRENT_READDIR_CURSOR_MAX,
+                   (long long unsigned int)dirent_readdir_cursor.mem_size/1024);
+    pChar+=sprintf(pChar,"Readdir cursors hit/miss       : %llu/%llu\n",
+                  (long long unsigned int) dirent_readdir_cursor_hit_counter,
+                  (long long unsigned int) dirent_readdir_cursor_miss_counter);
+    pChar+=sprintf(pChar,"Readdir cursors evict/inval    : %llu/%llu\n",
+                  (long long unsigned int) dirent_readdir_cursor_evict_counter,
+                  (long long unsigned int) dirent_readdir_cursor_invalidate_counter);
 
     pChar+=sprintf(pChar,"Name chunk size                : %u\n",(unsigned int)MDIRENTS_NAME_CHUNK_SZ);
     pChar+=sprintf(pChar,"Name chunk max                 : %u\n",(unsigned int)MDIRENTS_NAME_CHUNK_MAX);
@@ -845,6 +1235,99 @@ char* dirent_cache_display(char *pChar) {
     return pChar;
 }
 
+/*
+ **______________________________________________________________________________
+ */
+typedef struct _dirent_cache_dir_mem_t {
+    fid_t fid; /**< fid of the directory */
+    uint32_t root_count; /**< number of root dirent files in cache */
+    uint64_t size; /**< memory used by the root dirent files and their collision files */
+} dirent_cache_dir_mem_t;
+
+static int dirent_cache_dir_mem_fid_cmp(const void *a, const void *b) {
+    return uuid_compare(((dirent_cache_dir_mem_t*) a)->fid, ((dirent_cache_dir_mem_t*) b)->fid);
+}
+
+static int dirent_cache_dir_mem_size_cmp(const void *a, const void *b) {
+    uint64_t sa = ((dirent_cache_dir_mem_t*) a)->size;
+    uint64_t sb = ((dirent_cache_dir_mem_t*) b)->size;
+    if (sa == sb) return 0;
+    return (sa < sb) ? 1 : -1;
+}
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Display the memory used in the level 0 cache per directory
+
+ @param pChar : output buffer
+ @param fid : fid of the directory to display or NULL for the directories that use the more memory
+ @param count : max number of directories to display
+
+ @retval pointer to the end of the output
+ */
+char *dirent_cache_display_mem_per_dir(char *pChar, fid_t fid, int count) {
+    dirent_cache_main_t *cache = &dirent_cache_level0;
+    dirent_cache_dir_mem_t *tab_p;
+    mdirents_cache_entry_t *entry_p;
+    list_t *head_p[2] = {&cache->global_lru_link, &cache->hot_lru_link};
+    list_t *p;
+    int nb = 0;
+    int nb_dir = 0;
+    int i;
+    char fid_str[40];
+
+    if (cache->size == 0) {
+        pChar += sprintf(pChar, "dirent cache is empty\n");
+        return pChar;
+    }
+    tab_p = xmalloc(sizeof(dirent_cache_dir_mem_t) * cache->size);
+    if (tab_p == NULL) {
+        pChar += sprintf(pChar, "out of memory\n");
+        return pChar;
+    }
+    for (i = 0; i < 2; i++) {
+        list_for_each_forward(p, head_p[i]) {
+            if (nb >= cache->size) break;
+            entry_p = list_entry(p, mdirents_cache_entry_t, cache_link);
+            if ((fid != NULL) && (uuid_compare(fid, entry_p->key.dir_fid) != 0)) continue;
+            memcpy(tab_p[nb].fid, entry_p->key.dir_fid, sizeof(fid_t));
+            tab_p[nb].root_count = 1;
+            tab_p[nb].size = dirent_cache_entry_mem_size(entry_p);
+            nb++;
+        }
+    }
+    /*
+    ** aggregate the root dirent files of the same directory
+    */
+    if (nb != 0) {
+        qsort(tab_p, nb, sizeof(dirent_cache_dir_mem_t), dirent_cache_dir_mem_fid_cmp);
+        for (i = 1; i < nb; i++) {
+            if (uuid_compare(tab_p[i].fid, tab_p[nb_dir].fid) == 0) {
+                tab_p[nb_dir].root_count++;
+                tab_p[nb_dir].size += tab_p[i].size;
+                continue;
+            }
+            nb_dir++;
+            tab_p[nb_dir] = tab_p[i];
+        }
+        nb_dir++;
+        qsort(tab_p, nb_dir, sizeof(dirent_cache_dir_mem_t), dirent_cache_dir_mem_size_cmp);
+    }
+    pChar += sprintf(pChar, "--------------------------------------+-------+-------------+\n");
+    pChar += sprintf(pChar, " directory                            | roots | memory (KB) |\n");
+    pChar += sprintf(pChar, "--------------------------------------+-------+-------------+\n");
+    for (i = 0; (i < nb_dir) && (i < count); i++) {
+        rozofs_uuid_unparse(tab_p[i].fid, fid_str);
+        pChar += sprintf(pChar, " %-36s | %5u | %11llu |\n", fid_str, tab_p[i].root_count,
+                (long long unsigned int) tab_p[i].size / 1024);
+    }
+    pChar += sprintf(pChar, "--------------------------------------+-------+-------------+\n");
+    pChar += sprintf(pChar, "%d directories in cache\n", nb_dir);
+    free(tab_p);
+    return pChar;
+}
+
 void dirent_cache_bucket_print_stats()
 {
    char buffer[1024];
@@ -876,6 +1359,83 @@ int dirent_put_root_entry_to_cache(fid_t fid, int root_idx, mdirents_cache_entry
     return dirent_cache_bucket_insert_entry(&dirent_cache_level0, fid, (uint16_t) root_idx, (void*) root_p);
 }
 
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Walk the root dirent files of the level 0 cache: hot entries first, then
+ *  the cold ones, most recently used first within each list
+
+ @param cbk : callback called for each root dirent file (return != 0 to stop the walk)
+ @param param : opaque parameter given to the callback
+
+ @retval number of root dirent files walked through
+ */
+int dirent_cache_level0_foreach(int (*cbk)(fid_t fid, int root_idx, void *param), void *param) {
+    dirent_cache_main_t *cache = &dirent_cache_level0;
+    mdirents_cache_entry_t *entry_p;
+    list_t *list_tab[2];
+    list_t *p;
+    int count = 0;
+    int i;
+
+    if (dirent_bucket_cache_enable == 0) return 0;
+    list_tab[0] = &cache->hot_lru_link;
+    list_tab[1] = &cache->global_lru_link;
+    for (i = 0; i < 2; i++) {
+        list_for_each_forward(p, list_tab[i]) {
+            entry_p = list_entry(p, mdirents_cache_entry_t, cache_link);
+            count++;
+            if ((*cbk)(entry_p->key.dir_fid, entry_p->key.dirent_root_idx, param) != 0) return count;
+        }
+    }
+    return count;
+}
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Load a root dirent file in the level 0 cache if it is not already there
+
+ @param root_idx_bitmap_p : pointer to the root idx bitmap of the directory
+ @param dir_fd : file descriptor of the directory
+ @param fid_parent : fid of the directory
+ @param root_idx : index of the root dirent file
+
+ @retval 1 : the root dirent file has been read and inserted in the cache
+ @retval 0 : already in the cache or the root dirent file does not exist
+ @retval -1 : error
+ */
+int dirent_cache_prefetch_root_entry(void *root_idx_bitmap_p, int dir_fd, fid_t fid_parent, int root_idx) {
+    mdirents_header_new_t dirent_hdr;
+    mdirents_cache_entry_t *root_entry_p;
+
+    if (dirent_bucket_cache_enable == 0) return 0;
+    dirent_cache_level0_request_start();
+    dirent_set_root_idx_bitmap_ptr(root_idx_bitmap_p);
+    if (dirent_check_root_idx_bit(root_idx) == 0) return 0;
+    if (dirent_get_root_entry_from_cache(fid_parent, root_idx) != NULL) return 0;
+
+    DIRENT_ROOT_SET_READ_WRITE();
+    dirent_hdr.type = MDIRENT_CACHE_FILE_TYPE;
+    dirent_hdr.level_index = 0;
+    dirent_hdr.dirent_idx[0] = root_idx;
+    dirent_hdr.dirent_idx[1] = 0;
+    root_entry_p = read_mdirents_file(dir_fd, &dirent_hdr, fid_parent);
+    if (root_entry_p == NULL) return (DIRENT_ROOT_IS_READ_ONLY()) ? -1 : 0;
+    if (DIRENT_ROOT_IS_READ_ONLY()) {
+        dirent_cache_release_entry(root_entry_p);
+        return -1;
+    }
+    memcpy(root_entry_p->key.dir_fid, fid_parent, sizeof (fid_t));
+    root_entry_p->key.dirent_root_idx = root_idx;
+    if (dirent_put_root_entry_to_cache(fid_parent, root_idx, root_entry_p) != 0) {
+        dirent_cache_release_entry(root_entry_p);
+        return -1;
+    }
+    return 1;
+}
+
 int dirent_append_entry = 0;
 int dirent_update_entry = 0;
 
@@ -952,12 +1512,17 @@ int put_mdirentry(void *root_idx_bitmap_p,int dirfd, fid_t fid_parent_in, char *
     *mask = -1; /* unknown mask */
     
     START_PROFILING(put_mdirentry);
+    dirent_cache_level0_request_start();
     /*
     ** deassert de delete pending bit of the parent
     */
     memcpy(fid_parent,fid_parent_in,sizeof(fid_t));
     exp_metadata_inode_del_deassert(fid_parent);
     rozofs_inode_set_dir(fid_parent);
+    /*
+    ** the content of the directory changes: drop its readdir cursors
+    */
+    dirent_readdir_cursor_invalidate(fid_parent);
     
     if (fid_name_info_p != NULL)
     {
@@ -1306,6 +1871,7 @@ int get_mdirentry(void *root_idx_bitmap_p,int dirfd, fid_t fid_parent_in, char *
   fid_t fid_parent;
 
   START_PROFILING(get_mdirentry);
+  dirent_cache_level0_request_start();
   *mask_ret = 0;
 
   /*
@@ -1577,12 +2143,17 @@ int del_mdirentry(void *root_idx_bitmap_p,int dirfd, fid_t fid_parent_in, char *
   int ret;
   fid_t fid_parent;
   START_PROFILING(del_mdirentry);
+  dirent_cache_level0_request_start();
   /*
   ** deassert de delete pending bit of the parent
   */
   memcpy(fid_parent,fid_parent_in,sizeof(fid_t));
   exp_metadata_inode_del_deassert(fid_parent);
   rozofs_inode_set_dir(fid_parent);
+  /*
+  ** the content of the directory changes: drop its readdir cursors
+  */
+  dirent_readdir_cursor_invalidate(fid_parent);
 
   if (mask != 0)
   {
@@ -2032,6 +2603,7 @@ int list_mdirentries(void *root_idx_bitmap_p,int dir_fd, fid_t fid_parent_in, ch
     fid_t fid_parent;
 
     START_PROFILING(list_mdirentries);
+    dirent_cache_level0_request_start();
     /*
     ** check if the delete pending flag is asserted on the parent directory
     */
@@ -2480,7 +3052,7 @@ get_next_collidx:
 #define ROZOFS_READDIR_MAX_BYTES (64*1024-4096)
 #define MAX_DIR_ENTRIES_VERS2 (128+64)
 
-int list_mdirentries2(void *root_idx_bitmap_p,int dir_fd, fid_t fid_parent_in, char *buf_readdir_in, uint64_t *cookie, uint8_t * eof,ext_mattr_t *parent) {
+static int list_mdirentries2_internal(void *root_idx_bitmap_p,int dir_fd, fid_t fid_parent_in, char *buf_readdir_in, uint64_t *cookie, uint8_t * eof,ext_mattr_t *parent) {
     int root_idx = 0;
     int cached = 0;
     dirent_list_cookie_t dirent_cookie;
@@ -3053,3 +3625,71 @@ get_next_collidx:
     STOP_PROFILING(list_mdirentries);
     return  (int)(buf_readdir_p -buf_readdir_in);;
 }
+
+/*
+ **______________________________________________________________________________
+ */
+/**
+ * API for listing the entries of a directory (version2)
+ *
+ * The chunks following the first one are served from the readdir cursor cache
+ * when another client (or a retry) already asked for the same cookie.
+ *
+ * @param root_idx_bitmap_p: pointer to the root idx bitmap of the directory
+ * @param dir_fd: file descriptor of the parent directory
+ * @param fid_parent_in: fid of the directory
+ * @param buf_readdir_in: output buffer (fuse dirents)
+ * @param cookie: cookie of the chunk in, cookie of the next chunk out
+ * @param eof: set to 1 when the end of the directory is reached
+ * @param parent: attributes of the directory
+ *
+ * @retval length of the data written in buf_readdir_in
+ */
+int list_mdirentries2(void *root_idx_bitmap_p,int dir_fd, fid_t fid_parent_in, char *buf_readdir_in, uint64_t *cookie, uint8_t * eof,ext_mattr_t *parent) {
+    dirent_list_cookie_t dirent_cookie;
+    dirent_readdir_cursor_t *cursor_p;
+    uint64_t cookie_in;
+    fid_t fid_parent;
+    int deleted_dir;
+    int len;
+
+    dirent_cache_level0_request_start();
+    dirent_cookie.val64 = *cookie;
+    /*
+    ** the first chunk depends on the attributes of the directory: not cached
+    */
+    if ((dirent_bucket_cache_enable == 0) ||
+        ((dirent_cookie.s.index_level == 0) && (dirent_cookie.s.root_idx == 0) &&
+         (dirent_cookie.s.coll_idx == 0) && (dirent_cookie.s.hash_entry_idx == 0)))
+    {
+      return list_mdirentries2_internal(root_idx_bitmap_p,dir_fd,fid_parent_in,buf_readdir_in,cookie,eof,parent);
+    }
+    deleted_dir = 0;
+    if (exp_metadata_inode_is_del_pending(fid_parent_in) ||  exp_metadata_inode_is_del_pending(parent->s.attrs.fid))
+    {
+       deleted_dir = 1;
+    }
+    memcpy(fid_parent,fid_parent_in,sizeof(fid_t));
+    exp_metadata_inode_del_deassert(fid_parent);
+    rozofs_inode_set_dir(fid_parent);
+
+    cookie_in = *cookie;
+    cursor_p = dirent_readdir_cursor_search(fid_parent,deleted_dir,cookie_in);
+    if (cursor_p != NULL)
+    {
+      dirent_readdir_stats_call_count++;
+      if (cursor_p->len > 0) memcpy(buf_readdir_in,cursor_p->buf,cursor_p->len);
+      *cookie = cursor_p->cookie_out;
+      *eof = cursor_p->eof;
+      return cursor_p->len;
+    }
+    len = list_mdirentries2_internal(root_idx_bitmap_p,dir_fd,fid_parent_in,buf_readdir_in,cookie,eof,parent);
+    /*
+    ** do not keep a chunk built while a dirent file could not be read
+    */
+    if ((len >= 0) && (!DIRENT_ROOT_IS_READ_ONLY()))
+    {
+      dirent_readdir_cursor_store(fid_parent,deleted_dir,cookie_in,*cookie,*eof,buf_readdir_in,len);
+    }
+    return len;
+}
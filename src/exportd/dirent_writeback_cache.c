@@ -26,6 +26,8 @@
 #include <errno.h>
 #include <limits.h>
 #include <unistd.h>
+#include <sys/uio.h>
+#include <sys/time.h>
 #include <uuid/uuid.h>
 
 #include <rozofs/rozofs.h>
@@ -43,6 +45,7 @@
 ** pointer to the dirent write back cache
 */
 dirent_writeback_entry_t   *dirent_writeback_cache_p = NULL;
+int dirent_wbcache_entry_count = DIRENT_CACHE_MAX_ENTRY; /**< number of entries of the write back cache */
 int dirent_writeback_cache_initialized = 0;
 int dirent_writeback_cache_enable = 0;
 uint64_t dirent_wbcache_hit_counter = 0;
@@ -54,6 +57,13 @@ uint64_t dirent_wbcache_flush_counter = 0;
 uint64_t dirent_wbcache_invalidate_counter = 0;
 uint64_t dirent_wb_total_chunk_write_cpt = 0;
 uint64_t dirent_wb_total_chunk_write_only_cpt = 0;
+uint64_t dirent_wbcache_read_hit_counter = 0;   /**< reads served from the pending writes of the cache */
+uint64_t dirent_wbcache_read_flush_counter = 0; /**< reads that required a flush of the cache entry */
+uint64_t dirent_wb_flush_segment_count = 0;     /**< number of header/chunks flushed on disk */
+uint64_t dirent_wb_flush_syscall_count = 0;     /**< number of pwritev() issued for flushing them */
+uint64_t dirent_wb_flush_count = 0;             /**< number of cache entry flushes */
+uint64_t dirent_wb_flush_time_us = 0;           /**< cumulated flush time */
+uint64_t dirent_wb_flush_max_time_us = 0;       /**< longest flush */
 
 int dirent_wbcache_thread_period_count;
 uint64_t dirent_wbcache_poll_stats[2];
@@ -104,6 +114,11 @@ char * show_wbcache_thread_stats_display(char *pChar)
 
      pChar += sprintf(pChar," - chunk flush count :%llu/%llu\n",
               (long long unsigned int)dirent_wb_write_chunk_count, (long long unsigned int)dirent_wb_total_chunk_write_only_cpt);
+     pChar += sprintf(pChar," - flush segments    :%llu in %llu writes\n",
+              (long long unsigned int)dirent_wb_flush_segment_count, (long long unsigned int)dirent_wb_flush_syscall_count);
+     pChar += sprintf(pChar," - flush latency (us):%llu avg/%llu max\n",
+              (long long unsigned int)(dirent_wb_flush_count?dirent_wb_flush_time_us/dirent_wb_flush_count:0),
+              (long long unsigned int)dirent_wb_flush_max_time_us);
 
      /*
      ** read and clear counters update
@@ -158,7 +173,7 @@ static inline int dirent_wbcache_get_index(void *fid,char *path)
         h = (h * 16777619)^ *d;
 
     }
-    return (int)(h%DIRENT_CACHE_MAX_ENTRY);
+    return (int)(h%dirent_wbcache_entry_count);
 }
 /*
 **_______________________________________________________________
@@ -173,11 +188,7 @@ static inline int dirent_wbcache_get_index(void *fid,char *path)
 */ 
 static inline int dirent_wbcache_check_write_pending(dirent_writeback_entry_t  *cache_p)
 {
-   int i;
-   for (i = 0; i < DIRENT_CACHE_MAX_CHUNK; i++)
-   {
-      if (cache_p->chunk[i].wr_cpt != 0) return 1;
-   }
+   if (cache_p->dirty_bitmap != 0) return 1;
    return 0;
  }
 /*
@@ -244,6 +255,105 @@ void show_wbcache_thread(char * argv[], uint32_t tcpRef, void *bufRef) {
 }
 
 
+/*
+ *_______________________________________________________________________
+ */
+/**
+* write on disk the pending writes of a cache entry (header and chunks)
+
+  The dirty segments are sorted by offset and the contiguous ones are
+  written with a single pwritev().
+  The lock of the entry is already taken (or not needed) when calling that service
+  
+  @param fd: file descriptor of the dirent file
+  @param cache_p: pointer to the cache entry
+  
+  @retval 0 on success
+  @retval -1 on error
+*/
+static int dirent_wbcache_flush_segments(int fd,dirent_writeback_entry_t  *cache_p)
+{
+  struct iovec  iov[DIRENT_CACHE_MAX_CHUNK+1];
+  off_t         seg_off[DIRENT_CACHE_MAX_CHUNK+1];
+  int           seg_idx[DIRENT_CACHE_MAX_CHUNK+1]; /**< -1: header, else chunk index */
+  dirent_chunk_cache_t *chunk_p;
+  struct timeval tv;
+  uint64_t       tic,toc;
+  int nb_seg = 0;
+  int first,last;
+  int i,j;
+  size_t len;
+  
+  gettimeofday(&tv,(struct timezone *)0);
+  tic = MICROLONG(tv);
+  /*
+  ** build the list of the dirty segments sorted by offset
+  */
+  if (cache_p->wr_cpt != 0)
+  {
+    iov[0].iov_base = cache_p->dirent_header;
+    iov[0].iov_len  = cache_p->size;
+    seg_off[0] = 0;
+    seg_idx[0] = -1;
+    nb_seg = 1;
+  }
+  else
+  {
+    dirent_wb_total_chunk_write_only_cpt++;   
+  }
+  chunk_p = &cache_p->chunk[0];
+  for (i = 0; i < DIRENT_CACHE_MAX_CHUNK; i++,chunk_p++)
+  {
+    if ((cache_p->dirty_bitmap & (1<<i)) == 0) continue;
+    for (j = nb_seg; (j > 0) && (seg_off[j-1] > chunk_p->off); j--)
+    {
+      iov[j] = iov[j-1];
+      seg_off[j] = seg_off[j-1];
+      seg_idx[j] = seg_idx[j-1];
+    }
+    iov[j].iov_base = chunk_p->chunk_p;
+    iov[j].iov_len  = chunk_p->size;
+    seg_off[j] = chunk_p->off;
+    seg_idx[j] = i;
+    nb_seg++;
+  }
+  /*
+  ** write the contiguous segments together
+  */
+  for (first = 0; first < nb_seg; first = last)
+  {
+    len = iov[first].iov_len;
+    for (last = first+1; last < nb_seg; last++)
+    {
+      if (seg_off[last] != seg_off[last-1]+iov[last-1].iov_len) break;
+      len += iov[last].iov_len;
+    }
+    if (pwritev(fd,&iov[first],last-first,seg_off[first]) != len)
+    {
+      severe("bad write returned value for %s (len %d): error %s",cache_p->pathname,(int)len,strerror(errno));
+      return -1;
+    }
+    for (i = first; i < last; i++)
+    {
+      if (seg_idx[i] < 0) cache_p->wr_cpt = 0;
+      else
+      {
+        cache_p->chunk[seg_idx[i]].wr_cpt = 0;
+        cache_p->dirty_bitmap &= ~(1<<seg_idx[i]);
+      }
+    }
+    dirent_wb_cache_th_write_bytes_count+= len;
+    dirent_wb_write_th_count+= last-first;
+    dirent_wb_flush_segment_count+= last-first;
+    dirent_wb_flush_syscall_count++;
+  }
+  gettimeofday(&tv,(struct timezone *)0);
+  toc = MICROLONG(tv);
+  dirent_wb_flush_count++;
+  dirent_wb_flush_time_us += (toc-tic);
+  if ((toc-tic) > dirent_wb_flush_max_time_us) dirent_wb_flush_max_time_us = toc-tic;
+  return 0;
+}
 /*
  *_______________________________________________________________________
  */
@@ -290,43 +400,14 @@ int dirent_wbcache_diskflush(dirent_writeback_entry_t  *cache_p)
      goto error;  
   } 
   /*
-  ** goto the entry and find out the section to write on disk
+  ** write the header and the dirty chunks
   */
-   if (cache_p->wr_cpt != 0)
-   {
-     if (pwrite(fd, cache_p->dirent_header, cache_p->size, 0) != cache_p->size) 
-     {
-       severe("bad write returned value for %s (len %d): error %s",cache_p->pathname,cache_p->size,strerror(errno));
-       goto error;        
-     } 
-     dirent_wb_cache_th_write_bytes_count+= cache_p->size;
-     dirent_wb_write_th_count++;
-   }
-   else
-   {
-      dirent_wb_total_chunk_write_only_cpt++;   
-   }
-   /*
-   ** go through the chunk
-   */
-   chunk_p = &cache_p->chunk[0];
-   for (i = 0; i < DIRENT_CACHE_MAX_CHUNK; i++,chunk_p++)
-   {
-      if (chunk_p->wr_cpt == 0) continue;
-      if (pwrite(fd, chunk_p->chunk_p, chunk_p->size, chunk_p->off) != chunk_p->size) 
-      {
-	severe("bad write returned value for %s (len %d): error %s",cache_p->pathname,chunk_p->size,strerror(errno));
-	goto error;        
-      }       
-      chunk_p->wr_cpt = 0; 
-      dirent_wb_cache_th_write_bytes_count+= chunk_p->size;
-      dirent_wb_write_th_count++;
-   }
-   /*
-   ** clear the header write pointer here to avoid race condition with check for flush
-   */
-   cache_p->wr_cpt = 0;
-   status = 0;
+  if (dirent_wbcache_flush_segments(fd,cache_p) < 0) goto error;
+  /*
+  ** clear the header write pointer here to avoid race condition with check for flush
+  */
+  cache_p->wr_cpt = 0;
+  status = 0;
 
 out:
   if(fd != -1) close(fd);
@@ -343,6 +424,7 @@ error:
   */
    chunk_p = &cache_p->chunk[0];
    for (i = 0; i < DIRENT_CACHE_MAX_CHUNK; i++,chunk_p++) chunk_p->wr_cpt = 0; 
+   cache_p->dirty_bitmap = 0;
    cache_p->wr_cpt = 0;
    goto out;
 }
@@ -375,7 +457,7 @@ static void *dirent_wbcache_thread(void *v) {
 	{
           START_PROFILING_TH(dirent_wbcache_poll_stats);
           cache_p = &dirent_writeback_cache_p[0];
-          for (i = 0; i < DIRENT_CACHE_MAX_ENTRY;i++,cache_p++)
+          for (i = 0; i < dirent_wbcache_entry_count;i++,cache_p++)
 	  {
 	     if (cache_p->state == 0) continue;
 	     if ((cache_p->wr_cpt == 0)
@@ -475,6 +557,7 @@ int dirent_wbcache_check_invalidate_on_unlink(int eid,char *pathname,int root_id
    }
    chunk_p = &cache_p->chunk[0];
    for (i = 0; i < DIRENT_CACHE_MAX_CHUNK; i++,chunk_p++) chunk_p->wr_cpt = 0;
+   cache_p->dirty_bitmap = 0;
    /*
    ** clear the header write pointer here to avoid race condition with check for flush
    */
@@ -491,6 +574,181 @@ int dirent_wbcache_check_invalidate_on_unlink(int eid,char *pathname,int root_id
 
 }
 
+/**
+*____________________________________________________________
+*/
+/**
+*  open a dirent file for reading: when the file has some pending writes
+   in the write back cache the reads are served from the cache instead of
+   flushing the entry on disk first
+
+   @param eid : export identifier
+   @param pathname : local pathname of the dirent file
+   @param dir_fid : fid of the directory
+   @param flags : opening flags
+   @param mode : mode
+   
+   @retval >= 0 : file descriptor (DIRENT_WBCACHE_RD_FD_MASK set when read through the cache)
+   @retval < 0 : error see errno for details
+*/
+int dirent_wbcache_open_read(int eid,char *pathname,fid_t dir_fid,int flags,mode_t mode)
+{
+   dirent_writeback_entry_t  *cache_p;
+   char path[PATH_MAX];
+   int fd;
+   int i;
+
+   mdirent_resolve_path(dir_fid,pathname,path);
+   i = dirent_wbcache_get_index(dir_fid,pathname);
+   cache_p = &dirent_writeback_cache_p[i];
+   if ((cache_p->state == 0) 
+       || ((cache_p->wr_cpt == 0)&&(dirent_wbcache_check_write_pending(cache_p) == 0))) goto regular;
+   /*
+   ** the entry is busy : check if it matches
+   */
+   if (eid != cache_p->eid) goto regular;
+   if (strcmp(pathname,cache_p->pathname)!=0) goto regular;   
+   if (memcmp(dir_fid, cache_p->dir_fid, sizeof (fid_t))!=0)  goto regular;  
+   if (cache_p->rd_busy != 0)
+   {
+     /*
+     ** the entry is already read through the cache: flush it on disk
+     ** before reading the file the regular way
+     */
+     dirent_wbcache_diskflush(cache_p);
+     dirent_wbcache_flush_counter++;
+     goto regular;
+   }
+   /*
+   ** it matches: the file might not exist yet on disk when its header
+   ** has never been flushed
+   */
+   fd = open(path,flags,mode);
+   if (fd < 0)
+   {
+     if ((errno != ENOENT) || (cache_p->wr_cpt == 0)) return -1;
+   }
+   cache_p->rd_fd   = fd;
+   cache_p->rd_busy = 1;
+   return (i | DIRENT_WBCACHE_RD_FD_MASK);
+
+regular:
+   return open(path,flags,mode);
+}
+/**
+*____________________________________________________________
+*/
+/**
+*  read a dirent file through the write back cache
+
+   The read is served from the header or from a dirty chunk of the cache
+   entry when one of them contains the whole requested range. When none
+   of the pending writes overlaps the range, the read is done on disk.
+   Otherwise the entry is flushed before reading on disk.
+
+   @param idx : index of the cache entry
+   @param buf: buffer to fill
+   @param count : length to read
+   @param offset: offset within the file
+   
+   @retval >= 0 : number of bytes read
+   @retval < 0 : error see errno for details
+*/
+ssize_t dirent_wbcache_read(int idx,void *buf,size_t count,off_t offset)
+{
+   dirent_writeback_entry_t  *cache_p;
+   dirent_chunk_cache_t       *chunk_p;
+   char path[PATH_MAX];
+   int overlap = 0;
+   int found = 0;
+   int i;
+
+   if ((idx < 0) || (idx >= dirent_wbcache_entry_count))
+   {
+     errno = EBADF;
+     return -1;
+   }
+   cache_p = &dirent_writeback_cache_p[idx];
+   if ((errno = pthread_rwlock_rdlock(&cache_p->lock)) != 0) {
+       severe("can't lock writeback cache entry: %s", strerror(errno));
+       return -1;
+   }
+   /*
+   ** the header is always written at offset 0
+   */
+   if ((cache_p->wr_cpt != 0) && (offset < cache_p->size))
+   {
+     if (offset+count <= cache_p->size)
+     {
+       memcpy(buf,cache_p->dirent_header+offset,count);
+       found = 1;
+     }
+     overlap = 1;
+   }
+   chunk_p = &cache_p->chunk[0];
+   for (i = 0; (found == 0) && (i < DIRENT_CACHE_MAX_CHUNK); i++,chunk_p++)
+   {
+     if ((cache_p->dirty_bitmap & (1<<i)) == 0) continue;
+     if ((offset+count <= chunk_p->off) || (offset >= chunk_p->off+chunk_p->size)) continue;
+     if ((offset >= chunk_p->off) && (offset+count <= chunk_p->off+chunk_p->size))
+     {
+       memcpy(buf,chunk_p->chunk_p+(offset-chunk_p->off),count);
+       found = 1;
+     }
+     overlap = 1;
+   }
+   if ((errno = pthread_rwlock_unlock(&cache_p->lock)) != 0) {
+       severe("can't unlock writeback cache entry: %s", strerror(errno));
+   }
+   if (found)
+   {
+     dirent_wbcache_read_hit_counter++;
+     return count;
+   }
+   /*
+   ** the pending writes only cover a part of the range or the file
+   ** is not yet on disk: flush the entry before reading
+   */
+   if ((overlap) || (cache_p->rd_fd == -1))
+   {
+     dirent_wbcache_diskflush(cache_p);
+     dirent_wbcache_read_flush_counter++;
+     if (cache_p->rd_fd == -1)
+     {
+       mdirent_resolve_path(cache_p->dir_fid,(char*)cache_p->pathname,path);
+       cache_p->rd_fd = open(path,O_RDONLY | O_NOATIME);
+       if (cache_p->rd_fd == -1) return -1;
+     }
+   }
+   return pread(cache_p->rd_fd,buf,count,offset);
+}
+/**
+*____________________________________________________________
+*/
+/**
+*  end of a read through the write back cache
+
+   @param idx : index of the cache entry
+   
+   @retval 0 on success
+   @retval < 0 : error see errno for details
+*/
+int dirent_wbcache_close_read(int idx)
+{
+   dirent_writeback_entry_t  *cache_p;
+
+   if ((idx < 0) || (idx >= dirent_wbcache_entry_count))
+   {
+     errno = EBADF;
+     return -1;
+   }
+   cache_p = &dirent_writeback_cache_p[idx];
+   if (cache_p->rd_fd != -1) close(cache_p->rd_fd);
+   cache_p->rd_fd   = -1;
+   cache_p->rd_busy = 0;
+   return 0;
+}
+
 /**
 *____________________________________________________________
 */
@@ -598,6 +856,7 @@ int dirent_wbcache_chunk_diskflush(dirent_writeback_entry_t  *cache_p)
   }       
 //      info("FDL write chunk%d  %s offset %llu len %u",i,cache_p->pathname,chunk_p->off,chunk_p->size);
   chunk_p->wr_cpt = 0;      
+  cache_p->dirty_bitmap &= ~1;
   dirent_wb_cache_th_write_bytes_count+= chunk_p->size;
   dirent_wb_write_chunk_count++;
   status = 0;
@@ -639,7 +898,7 @@ int dirent_wbcache_write(int fd,void *buf,size_t count,off_t offset)
      errno = EBADF;
      return -1;
   }
-  if (fd >= DIRENT_CACHE_MAX_ENTRY)
+  if (fd >= dirent_wbcache_entry_count)
   {
     errno = EBADF;
     return -1;
@@ -657,10 +916,13 @@ int dirent_wbcache_write(int fd,void *buf,size_t count,off_t offset)
      /*
      ** header of the dirent file
      */
-     if (cache_p->dirent_header == NULL)
+     if ((cache_p->dirent_header == NULL) || (cache_p->header_alloc_size < count))
      {
+        if (cache_p->dirent_header != NULL) free(cache_p->dirent_header);
+        cache_p->header_alloc_size = 0;
         cache_p->dirent_header = malloc(count);
 	if (cache_p->dirent_header == NULL) goto error;
+        cache_p->header_alloc_size = count;
      } 
 //     info("FDL header cache %s : offset %llu size %u",cache_p->pathname,offset,count);
      dirent_wb_cache_write_bytes_count+=count;
@@ -695,6 +957,7 @@ int dirent_wbcache_write(int fd,void *buf,size_t count,off_t offset)
         dirent_wb_write_count++;
         chunk_p[i].size = count;
         chunk_p[i].wr_cpt+=1;
+        cache_p->dirty_bitmap |= (1<<i);
 
 	goto out;      
      }
@@ -721,6 +984,7 @@ reloop:
     chunk_p[free_chunk].size = count;
     dirent_wb_write_count++;
     chunk_p[free_chunk].wr_cpt+=1;
+    cache_p->dirty_bitmap |= (1<<free_chunk);
     goto out;     
   }
   /*
@@ -765,7 +1029,7 @@ int dirent_wbcache_close(int fd)
      errno = EBADF;
      return -1;
   }
-  if (fd >= DIRENT_CACHE_MAX_ENTRY)
+  if (fd >= dirent_wbcache_entry_count)
   {
     errno = EBADF;
     return -1;
@@ -798,8 +1062,6 @@ int dirent_wbcache_diskflush_best_effort(dirent_writeback_entry_t  *cache_p)
 {
   int fd = -1;
   int flag = O_WRONLY | O_CREAT | O_NOATIME;
-  dirent_chunk_cache_t *chunk_p;
-  int i;
   int status = -1;
   char path[PATH_MAX];
 
@@ -820,35 +1082,12 @@ int dirent_wbcache_diskflush_best_effort(dirent_writeback_entry_t  *cache_p)
      goto error;  
   } 
   /*
-  ** goto the entry and find out the section to write on disk
+  ** write the header and the dirty chunks
+  */
+  if (dirent_wbcache_flush_segments(fd,cache_p) < 0) goto error;
+  /*
+  ** clear the header write pointer here to avoid race condition with check for flush
   */
-  if (cache_p->wr_cpt != 0)
-  {
-     if (pwrite(fd, cache_p->dirent_header, cache_p->size, 0) != cache_p->size) 
-     {
-       goto error;        
-     } 
-     dirent_wb_cache_th_write_bytes_count+= cache_p->size;
-     dirent_wb_write_th_count++;
-   }
-   /*
-   ** go through the chunk
-   */
-   chunk_p = &cache_p->chunk[0];
-   for (i = 0; i < DIRENT_CACHE_MAX_CHUNK; i++,chunk_p++)
-   {
-      if (chunk_p->wr_cpt == 0) continue;
-      if (pwrite(fd, chunk_p->chunk_p, chunk_p->size, chunk_p->off) != chunk_p->size) 
-      {
-	goto error;        
-      }       
-      chunk_p->wr_cpt = 0; 
-      dirent_wb_cache_th_write_bytes_count+= chunk_p->size;
-      dirent_wb_write_th_count++;
-   }
-   /*
-   ** clear the header write pointer here to avoid race condition with check for flush
-   */
    cache_p->wr_cpt = 0;
    status = 0;
 
@@ -871,7 +1110,7 @@ void dirent_wbcache_flush_on_stop()
   if (dirent_writeback_cache_initialized==0) return ;
 
    cache_p = &dirent_writeback_cache_p[0];
-   for (i = 0; i < DIRENT_CACHE_MAX_ENTRY;i++,cache_p++)
+   for (i = 0; i < dirent_wbcache_entry_count;i++,cache_p++)
    {
       if (cache_p->state == 0) continue;
       if ((cache_p->wr_cpt == 0)
@@ -897,16 +1136,21 @@ int dirent_wbcache_init()
   int i;
 
   if (dirent_writeback_cache_initialized) return 0;
-  dirent_writeback_cache_p = malloc(sizeof(dirent_writeback_entry_t)*DIRENT_CACHE_MAX_ENTRY);
+  if ((dirent_wbcache_entry_count <= 0) || (dirent_wbcache_entry_count > DIRENT_CACHE_MAX_ENTRY_LIMIT))
+  {
+     dirent_wbcache_entry_count = DIRENT_CACHE_MAX_ENTRY;
+  }
+  dirent_writeback_cache_p = malloc(sizeof(dirent_writeback_entry_t)*dirent_wbcache_entry_count);
   if (dirent_writeback_cache_p == NULL)
   {
      fatal("Out of memory");
   }
-  memset(dirent_writeback_cache_p,0,sizeof(dirent_writeback_entry_t)*DIRENT_CACHE_MAX_ENTRY);
+  memset(dirent_writeback_cache_p,0,sizeof(dirent_writeback_entry_t)*dirent_wbcache_entry_count);
 
-  for (i = 0; i < DIRENT_CACHE_MAX_ENTRY; i++) 
+  for (i = 0; i < dirent_wbcache_entry_count; i++) 
   {
     dirent_writeback_cache_p[i].fd = -1;
+    dirent_writeback_cache_p[i].rd_fd = -1;
     if (pthread_rwlock_init(&dirent_writeback_cache_p[i].lock, NULL) != 0) {
         return -1;
     }    
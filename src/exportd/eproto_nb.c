@@ -1526,6 +1526,59 @@ void ep_write_block_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p) {
 			   arg->hdr.gateway_rank,
 			   arg->arg_gw.geo_wr_start,
 			   arg->arg_gw.geo_wr_end,
+			   0,
+                           (struct inode_internal_t *) & ret.status_gw.ep_mattr_ret_t_u.attrs) < 0)
+        goto error;
+    ret.hdr.eid = arg->arg_gw.eid ;  
+    ret.status_gw.status   = EP_SUCCESS;
+    ret.free_quota = exportd_get_free_quota(exp);
+    goto out;
+error:
+    ret.hdr.eid = arg->arg_gw.eid ;  
+    ret.status_gw.status = EP_FAILURE;
+    ret.status_gw.ep_mattr_ret_t_u.error = errno;
+out:
+    EXPORTS_SEND_REPLY(req_ctx_p);
+    STOP_PROFILING(ep_write_block);
+    return ;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*   exportd write_block2: update the size and date of a file, and log the
+    write for the storages that have missed it
+
+    @param args : fid of the file, offset and length written, storages
+                  that have missed the write
+    
+    @retval: EP_SUCCESS :attributes of the updated file
+    @retval: EP_FAILURE :error code associated with the operation (errno)
+*/
+void ep_write_block2_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p) {
+    static epgw_mattr_ret_t ret;
+    epgw_write_block2_arg_t * arg = (epgw_write_block2_arg_t*)pt;
+    export_t *exp;
+    DEBUG_FUNCTION;
+
+    // Set profiler export index
+    export_profiler_eid = arg->arg_gw.eid;
+
+    START_PROFILING_IO(ep_write_block, arg->arg_gw.length);
+
+    ret.parent_attr.status = EP_EMPTY;
+
+    if (!(exp = exports_lookup_export(arg->arg_gw.eid)))
+        goto error;
+    if (export_write_block(exp,(unsigned char *) arg->arg_gw.fid, 
+                           arg->arg_gw.bid, arg->arg_gw.nrb, 
+			   arg->arg_gw.dist,
+                           arg->arg_gw.offset, 
+			   arg->arg_gw.length,
+			   arg->hdr.gateway_rank,
+			   arg->arg_gw.geo_wr_start,
+			   arg->arg_gw.geo_wr_end,
+			   arg->degraded,
                            (struct inode_internal_t *) & ret.status_gw.ep_mattr_ret_t_u.attrs) < 0)
         goto error;
     ret.hdr.eid = arg->arg_gw.eid ;  
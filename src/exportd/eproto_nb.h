@@ -57,6 +57,7 @@ void ep_readdir_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 void ep_readdir2_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 void ep_read_block_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 void ep_write_block_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
+void ep_write_block2_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 void ep_setxattr_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 void ep_getxattr_1_svc_nb(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 void ep_removexattr_1_svc_nb( void * pt, rozorpc_srv_ctx_t *req_ctx_p);
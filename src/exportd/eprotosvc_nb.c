@@ -236,6 +236,13 @@ void expnb_req_rcv_cbk(void *userRef,uint32_t  socket_ctx_idx, void *recv_buf)
 	     size = sizeof(epgw_write_block_arg_t);
 	     break;
 
+     case EP_WRITE_BLOCK2:
+	     rozorpc_srv_ctx_p->arg_decoder = (xdrproc_t) xdr_epgw_write_block2_arg_t;
+	     rozorpc_srv_ctx_p->xdr_result = (xdrproc_t) xdr_epgw_mattr_ret_t;
+	     local =  ep_write_block2_1_svc_nb;
+	     size = sizeof(epgw_write_block2_arg_t);
+	     break;
+
      case EP_LINK:
 	     rozorpc_srv_ctx_p->arg_decoder = (xdrproc_t) xdr_epgw_link_arg_t;
 	     rozorpc_srv_ctx_p->xdr_result = (xdrproc_t) xdr_epgw_mattr_ret_t;
@@ -51,6 +51,7 @@
 #define TRASH_DNAME "trash"
 #define FSTAT_FNAME "fstat"
 #define CONST_FNAME "const"
+#define WARMUP_FNAME "warmup"
 
 /** 'to_set' flags in setattr */
 #define EXPORT_SET_ATTR_MODE  (1 << 0)
@@ -574,6 +575,7 @@ int export_read_block(export_t *e, fid_t fid, bid_t bid, uint32_t n, dist_t * d)
  * @param site_number: siet number for geo-replication
  * @param geo_wr_start: write start offset
  * @param geo_wr_end: write end offset
+ * @param degraded: bitmap of the nominal storages that have missed the write
  * @param[out] attrs: updated attributes of the file
  *
  * @return: the written length on success or -1 otherwise (errno is set)
@@ -581,6 +583,7 @@ int export_read_block(export_t *e, fid_t fid, bid_t bid, uint32_t n, dist_t * d)
 int64_t export_write_block(export_t *e, fid_t fid, uint64_t bid, uint32_t n,
                            dist_t d, uint64_t off, uint32_t len,
 			   uint32_t site_number,uint64_t geo_wr_start,uint64_t geo_wr_end,
+			   uint16_t degraded,
 			   struct inode_internal_t *attrs);
 
 /** read a directory
@@ -0,0 +1,437 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include <rozofs/rozofs.h>
+#include <rozofs/rozofs_srv.h>
+#include <rozofs/common/log.h>
+#include <rozofs/common/xmalloc.h>
+#include <rozofs/core/ruc_timer_api.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include "config.h"
+#include "exportd.h"
+#include "export.h"
+#include "export_dirty_log_api.h"
+
+/*
+** The writes reported as degraded by the rozofsmounts are first recorded
+** in memory, where the writes of the same file toward the same logical
+** storage are merged. The records are appended to the dirty log files
+** every second.
+*/
+#define EXPORT_DIRTY_LOG_TICK_MS  1000
+#define EXPORT_DIRTY_LOG_MAX      4096  /**< max pending records per export */
+#define EXPORT_DIRTY_LOG_HASH     4096  /**< size of the merge hash table   */
+
+typedef struct _export_dirty_entry_t
+{
+  export_dirty_rec_t rec;
+  cid_t              cid;
+  sid_t              sid;
+} export_dirty_entry_t;
+
+/**
+* per export context
+*/
+typedef struct _export_dirty_ctx_t
+{
+  export_t             *e;
+  uint32_t              nb_entries;                       /**< pending records               */
+  uint16_t              hash[EXPORT_DIRTY_LOG_HASH];      /**< index+1 of the pending record */
+  export_dirty_entry_t  entry[EXPORT_DIRTY_LOG_MAX];
+  /*
+  ** statistics
+  */
+  uint64_t              inserted;      /**< degraded writes received              */
+  uint64_t              merged;        /**< writes merged in a pending record     */
+  uint64_t              flushed;       /**< records appended to the log files     */
+  uint64_t              busy;          /**< flush deferred since a log was locked */
+  uint64_t              lost;          /**< records that could not be logged      */
+} export_dirty_ctx_t;
+
+typedef struct _export_dirty_main_t
+{
+  export_dirty_ctx_t  *ctx[EXPGW_EID_MAX_IDX+1];
+  uint64_t             flush_err;      /**< write errors on the log files          */
+} export_dirty_main_t;
+
+static export_dirty_main_t export_dirty;
+/*
+**_________________________________________________
+*/
+static inline uint32_t export_dirty_log_hash(fid_t fid, cid_t cid, sid_t sid) {
+  uint32_t  h = 2166136261U;
+  uint8_t  *c = (uint8_t *) fid;
+  int       i;
+
+  for (i = 0; i < sizeof(fid_t); i++) {
+    h = (h ^ c[i]) * 16777619;
+  }
+  h = (h ^ cid) * 16777619;
+  h = (h ^ sid) * 16777619;
+  return h % EXPORT_DIRTY_LOG_HASH;
+}
+/*
+**_________________________________________________
+*/
+static int export_dirty_log_entry_cmp(const void *a, const void *b) {
+  const export_dirty_entry_t *pa = a;
+  const export_dirty_entry_t *pb = b;
+
+  if (pa->cid != pb->cid) return (int)pa->cid - (int)pb->cid;
+  return (int)pa->sid - (int)pb->sid;
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Open a file of the dirty log directory of an export, creating the
+   directory on the first use
+
+   @param e: the export
+   @param path: the file name
+
+   @retval the file descriptor or -1
+*/
+static int export_dirty_log_open(export_t *e, char * path) {
+  int fd;
+
+  fd = open(path,O_WRONLY|O_APPEND|O_CREAT,0644);
+  if ((fd < 0) && (errno == ENOENT)) {
+    /*
+    ** First dirty write on this export
+    */
+    char dir[PATH_MAX];
+    sprintf(dir,"%s/dirty_log",e->root);
+    if ((mkdir(dir,0755) < 0) && (errno != EEXIST)) {
+      severe("mkdir(%s) %s",dir,strerror(errno));
+    }
+    fd = open(path,O_WRONLY|O_APPEND|O_CREAT,0644);
+  }
+  if (fd < 0) {
+    severe("open(%s) %s",path,strerror(errno));
+  }
+  return fd;
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Mark the dirty log of a logical storage as incomplete: the next
+   incremental rebuild has to list every file of that logical storage
+
+   @param e: the export
+   @param cid: cluster identifier
+   @param sid: logical storage identifier
+*/
+static void export_dirty_log_overflow(export_t *e, cid_t cid, sid_t sid) {
+  char path[PATH_MAX];
+  int  fd;
+
+  export_dirty_log_overflow_path(e->root,cid,sid,path);
+  fd = export_dirty_log_open(e,path);
+  if (fd < 0) {
+    export_dirty.flush_err++;
+    return;
+  }
+  close(fd);
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Append the records of one logical storage to its dirty log
+
+   @param e: the export
+   @param entry_p: first record of the logical storage
+   @param count: number of records of this logical storage
+
+   @retval 0 on success
+   @retval -1 when the log is locked or on error
+*/
+static int export_dirty_log_append(export_t *e, export_dirty_entry_t *entry_p, int count) {
+  char                path[PATH_MAX];
+  export_dirty_rec_t  rec[256];
+  int                 fd;
+  int                 nb;
+  int                 i;
+  int                 ret = 0;
+
+  export_dirty_log_path(e->root,entry_p->cid,entry_p->sid,path);
+  fd = export_dirty_log_open(e,path);
+  if (fd < 0) {
+    export_dirty.flush_err++;
+    return -1;
+  }
+  /*
+  ** rozo_rbsList is reading the log: retry on next tick
+  */
+  if (flock(fd,LOCK_EX|LOCK_NB) < 0) {
+    close(fd);
+    return -1;
+  }
+
+  while (count > 0) {
+    nb = (count > 256) ? 256 : count;
+    for (i = 0; i < nb; i++) rec[i] = entry_p[i].rec;
+    if (write(fd,rec,nb*sizeof(export_dirty_rec_t)) != (nb*sizeof(export_dirty_rec_t))) {
+      severe("write(%s) %s",path,strerror(errno));
+      export_dirty.flush_err++;
+      ret = -1;
+      break;
+    }
+    count   -= nb;
+    entry_p += nb;
+  }
+  close(fd);
+  return ret;
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Append the pending records of an export to the dirty logs
+
+   The records that can not be written are kept for the next tick.
+
+   @param ctx_p: export context
+*/
+static void export_dirty_log_flush(export_dirty_ctx_t *ctx_p) {
+  export_dirty_entry_t *entry_p;
+  uint32_t  first;
+  uint32_t  last;
+  uint32_t  kept = 0;
+
+  if (ctx_p->nb_entries == 0) return;
+
+  memset(ctx_p->hash,0,sizeof(ctx_p->hash));
+  qsort(ctx_p->entry,ctx_p->nb_entries,sizeof(export_dirty_entry_t),export_dirty_log_entry_cmp);
+
+  first = 0;
+  while (first < ctx_p->nb_entries) {
+    for (last = first+1; last < ctx_p->nb_entries; last++) {
+      if (export_dirty_log_entry_cmp(&ctx_p->entry[first],&ctx_p->entry[last]) != 0) break;
+    }
+    if (export_dirty_log_append(ctx_p->e,&ctx_p->entry[first],last-first) == 0) {
+      ctx_p->flushed += (last-first);
+    }
+    else {
+      /*
+      ** keep these records for the next tick
+      */
+      ctx_p->busy++;
+      if (kept != first) {
+        memmove(&ctx_p->entry[kept],&ctx_p->entry[first],(last-first)*sizeof(export_dirty_entry_t));
+      }
+      kept += (last-first);
+    }
+    first = last;
+  }
+  ctx_p->nb_entries = kept;
+  /*
+  ** The kept records have moved: index them again for the merge
+  */
+  for (first = 0; first < kept; first++) {
+    entry_p = &ctx_p->entry[first];
+    ctx_p->hash[export_dirty_log_hash(entry_p->rec.fid,entry_p->cid,entry_p->sid)] = first+1;
+  }
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Log a write that some nominal storages have missed
+
+   @param e: the export managing the file
+   @param fid: fid of the written file
+   @param cid: cluster of the file
+   @param sids: distribution of the file
+   @param degraded: bitmap of the positions in the distribution of the
+                    nominal storages that have missed the write
+   @param off_start: first byte written
+   @param off_end: byte following the last written byte
+*/
+void export_dirty_log_insert(export_t *e, fid_t fid, cid_t cid, sid_t * sids, uint16_t degraded,
+                             uint64_t off_start, uint64_t off_end) {
+  export_dirty_ctx_t   *ctx_p;
+  export_dirty_entry_t *entry_p;
+  uint8_t               rozofs_forward;
+  uint8_t               rozofs_safe;
+  uint32_t              h;
+  int                   pos;
+
+  if ((e->eid == 0) || (e->eid > EXPGW_EID_MAX_IDX)) return;
+
+  ctx_p = export_dirty.ctx[e->eid];
+  if (ctx_p == NULL) {
+    /*
+    ** First degraded write on this export
+    */
+    ctx_p = xmalloc(sizeof(export_dirty_ctx_t));
+    memset(ctx_p,0,sizeof(export_dirty_ctx_t));
+    ctx_p->e = e;
+    export_dirty.ctx[e->eid] = ctx_p;
+  }
+  ctx_p->inserted++;
+
+  /*
+  ** Unknown write range
+  */
+  if (off_end <= off_start) {
+    off_start = 0;
+    off_end   = EXPORT_DIRTY_LOG_WHOLE_FILE;
+  }
+
+  rozofs_forward = rozofs_get_rozofs_forward(e->layout);
+  rozofs_safe    = rozofs_get_rozofs_safe(e->layout);
+
+  for (pos = 0; pos < rozofs_forward; pos++) {
+
+    if ((degraded & (1<<pos)) == 0) continue;
+    if (sids[pos] == 0) continue;
+
+    /*
+    ** Merge with a pending record of the same file and logical storage
+    */
+    h = export_dirty_log_hash(fid,cid,sids[pos]);
+    if (ctx_p->hash[h] != 0) {
+      entry_p = &ctx_p->entry[ctx_p->hash[h]-1];
+      if ((entry_p->cid == cid) && (entry_p->sid == sids[pos])
+      &&  (memcmp(entry_p->rec.fid,fid,sizeof(fid_t)) == 0)) {
+        if (entry_p->rec.off_start > off_start) entry_p->rec.off_start = off_start;
+        if (entry_p->rec.off_end   < off_end)   entry_p->rec.off_end   = off_end;
+        entry_p->rec.date = time(NULL);
+        ctx_p->merged++;
+        continue;
+      }
+    }
+
+    if (ctx_p->nb_entries >= EXPORT_DIRTY_LOG_MAX) {
+      export_dirty_log_flush(ctx_p);
+      if (ctx_p->nb_entries >= EXPORT_DIRTY_LOG_MAX) {
+        /*
+        ** The storage will need a full rebuild
+        */
+        if (ctx_p->lost == 0) {
+          severe("eid %d dirty log is full: cid %d sid %d needs a full rebuild",e->eid,cid,sids[pos]);
+        }
+        ctx_p->lost++;
+        export_dirty_log_overflow(e,cid,sids[pos]);
+        continue;
+      }
+      h = export_dirty_log_hash(fid,cid,sids[pos]);
+    }
+
+    entry_p = &ctx_p->entry[ctx_p->nb_entries++];
+    memset(entry_p,0,sizeof(export_dirty_entry_t));
+    memcpy(entry_p->rec.fid,fid,sizeof(fid_t));
+    entry_p->rec.off_start = off_start;
+    entry_p->rec.off_end   = off_end;
+    entry_p->rec.date      = time(NULL);
+    entry_p->rec.layout    = e->layout;
+    entry_p->rec.bsize     = e->bsize;
+    memcpy(entry_p->rec.dist_set,sids,rozofs_safe);
+    entry_p->cid = cid;
+    entry_p->sid = sids[pos];
+    ctx_p->hash[h] = ctx_p->nb_entries;
+  }
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Periodic flush of the pending records
+*/
+static void export_dirty_log_periodic_ticker(void *param) {
+  int eid;
+
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    if (export_dirty.ctx[eid] == NULL) continue;
+    export_dirty_log_flush(export_dirty.ctx[eid]);
+  }
+}
+/*
+*_______________________________________________________________________
+*/
+/**
+*  dirty log statistics
+*/
+static void show_dirty_log(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char *pChar = uma_dbg_get_buffer();
+  export_dirty_ctx_t *ctx_p;
+  int eid;
+
+  if ((argv[1] != NULL) && (strcmp(argv[1],"flush") == 0)) {
+    export_dirty_log_periodic_ticker(NULL);
+    pChar += sprintf(pChar,"flush done\n");
+  }
+  pChar += sprintf(pChar,"flush errors       : %llu\n",(unsigned long long)export_dirty.flush_err);
+  pChar += sprintf(pChar,"| eid  | pending  | inserted   | merged     | flushed    | busy     | lost     |\n");
+  pChar += sprintf(pChar,"+------+----------+------------+------------+------------+----------+----------+\n");
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_dirty.ctx[eid];
+    if (ctx_p == NULL) continue;
+    pChar += sprintf(pChar,"| %4d | %8u | %10llu | %10llu | %10llu | %8llu | %8llu |\n",
+                     eid, ctx_p->nb_entries,
+                     (unsigned long long)ctx_p->inserted,
+                     (unsigned long long)ctx_p->merged,
+                     (unsigned long long)ctx_p->flushed,
+                     (unsigned long long)ctx_p->busy,
+                     (unsigned long long)ctx_p->lost);
+  }
+  pChar += sprintf(pChar,"+------+----------+------------+------------+------------+----------+----------+\n");
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Init of the dirty log service
+
+   @param none
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int export_dirty_log_init() {
+  struct timer_cell *timer;
+
+  memset(&export_dirty,0,sizeof(export_dirty));
+  uma_dbg_addTopic("dirty_log",show_dirty_log);
+  /*
+  ** the master exportd does not serve the metadata
+  */
+  if (exportd_is_master()) return 0;
+
+  timer = ruc_timer_alloc(0,0);
+  if (timer == NULL) {
+    severe("export_dirty_log_init: no timer");
+    return -1;
+  }
+  ruc_periodic_timer_start(timer,EXPORT_DIRTY_LOG_TICK_MS,export_dirty_log_periodic_ticker,NULL);
+  return 0;
+}
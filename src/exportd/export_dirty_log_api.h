@@ -0,0 +1,123 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXPORT_DIRTY_LOG_API_H
+#define EXPORT_DIRTY_LOG_API_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <rozofs/rozofs.h>
+
+/*
+** The dirty log of a logical storage is the file
+** <export root>/dirty_log/cid<cid>_sid<sid>. It is a sequence of records
+** telling which byte range of which file has been written while that
+** logical storage was not reachable by the storcli. The exportd appends
+** to it under an exclusive flock, and rozo_rbsList --dirty reads and
+** truncates it under the same lock.
+**
+** When the exportd can not keep some records (the log stays locked or
+** can not be written while the pending records pile up), it creates the
+** overflow marker <export root>/dirty_log/cid<cid>_sid<sid>.overflow.
+** The dirty log is then incomplete, and rozo_rbsList --dirty lists
+** every file of that logical storage instead, and removes the marker.
+*/
+#define EXPORT_DIRTY_LOG_WHOLE_FILE 0xFFFFFFFFFFFFFFFFULL /**< off_end when the range is unknown */
+
+typedef struct _export_dirty_rec_t
+{
+  fid_t     fid;                                /**< fid of the written file                 */
+  uint64_t  off_start;                          /**< first byte written                      */
+  uint64_t  off_end;                            /**< byte following the last written byte    */
+  uint32_t  date;                               /**< date of the last degraded write         */
+  uint8_t   layout;                             /**< layout of the file                      */
+  uint8_t   bsize;                              /**< block size of the file                  */
+  uint8_t   dist_set[ROZOFS_SAFE_MAX_STORCLI];  /**< sids of the distribution of the file    */
+  uint16_t  filler;
+} export_dirty_rec_t;
+
+/*
+**_________________________________________________
+*/
+/**
+*  Get the name of the dirty log file of a logical storage
+
+   @param root: root path of the export
+   @param cid: cluster identifier
+   @param sid: logical storage identifier
+   @param path: where to format the file name
+
+   @retval path
+*/
+static inline char * export_dirty_log_path(char * root, int cid, int sid, char * path) {
+  sprintf(path,"%s/dirty_log/cid%d_sid%d",root,cid,sid);
+  return path;
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Get the name of the overflow marker of the dirty log of a logical storage
+
+   @param root: root path of the export
+   @param cid: cluster identifier
+   @param sid: logical storage identifier
+   @param path: where to format the file name
+
+   @retval path
+*/
+static inline char * export_dirty_log_overflow_path(char * root, int cid, int sid, char * path) {
+  sprintf(path,"%s/dirty_log/cid%d_sid%d.overflow",root,cid,sid);
+  return path;
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Init of the dirty log service
+
+   That function must be called by the non blocking thread once the
+   exports are configured.
+
+   @param none
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int export_dirty_log_init();
+/*
+**_________________________________________________
+*/
+/**
+*  Log a write that some nominal storages have missed
+
+   @param e: the export managing the file
+   @param fid: fid of the written file
+   @param cid: cluster of the file
+   @param sids: distribution of the file
+   @param degraded: bitmap of the positions in the distribution of the
+                    nominal storages that have missed the write
+   @param off_start: first byte written
+   @param off_end: byte following the last written byte
+*/
+struct export;
+void export_dirty_log_insert(struct export *e, fid_t fid, cid_t cid, sid_t * sids, uint16_t degraded,
+                             uint64_t off_start, uint64_t off_end);
+
+#endif
@@ -71,6 +71,8 @@
 #include "rozofs_quota_api.h"
 #include "export_quota_thread_api.h"
 #include "export_thin_prov_api.h"
+#include "export_warmup_api.h"
+#include "export_dirty_log_api.h"
 
 DECLARE_PROFILING(epp_profiler_t);
 
@@ -507,9 +509,34 @@ void uma_dbg_split_fid(char * argv[], uint32_t tcpRef, void *bufRef) {
 * dirent cache
 */
 char *dirent_cache_display(char *pChar);
+char *dirent_cache_display_mem_per_dir(char *pChar, fid_t fid, int count);
 
 void show_dirent_cache(char * argv[], uint32_t tcpRef, void *bufRef) {
     char *pChar = uma_dbg_get_buffer();
+
+    if ((argv[1] != NULL) && (strcmp(argv[1],"mem")==0)) {
+      /*
+      ** memory used per directory
+      */
+      fid_t fid;
+      int   count = 32;
+      if (argv[2] == NULL) {
+        pChar = dirent_cache_display_mem_per_dir(pChar,NULL,count);
+      }
+      else if (rozofs_uuid_parse(argv[2], fid) == 0) {
+        pChar = dirent_cache_display_mem_per_dir(pChar,fid,1);
+      }
+      else if (sscanf(argv[2],"%d",&count) == 1) {
+        pChar = dirent_cache_display_mem_per_dir(pChar,NULL,count);
+      }
+      else {
+        pChar += sprintf(pChar,"usage:\ndirent_cache                 : display statistics\n");
+        pChar += sprintf(pChar,"dirent_cache mem [<count>]   : display the directories that use the more memory\n");
+        pChar += sprintf(pChar,"dirent_cache mem <fid>       : display the memory used by a directory\n");
+      }
+      uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+      return;
+    }
     pChar = dirent_cache_display(pChar);
     pChar = dirent_disk_display_stats(pChar);
     pChar = dirent_wbcache_display_stats(pChar);
@@ -1169,6 +1196,7 @@ int expgwc_start_nb_blocking_th(void *args) {
 	    epgw_readdir_arg_t ep_readdir_1_arg;
 	    epgw_io_arg_t ep_read_block_1_arg;
 	    epgw_write_block_arg_t ep_write_block_1_arg;
+	    epgw_write_block2_arg_t ep_write_block2_1_arg;
 	    epgw_link_arg_t ep_link_1_arg;
 	    epgw_setxattr_arg_t ep_setxattr_1_arg;
 	    epgw_getxattr_arg_t ep_getxattr_1_arg;
@@ -1333,6 +1361,14 @@ int expgwc_start_nb_blocking_th(void *args) {
     while (export_non_blocking_thread_can_process_messages==0) {
       sleep(1);
     }
+    /*
+    ** start the warm-up of the caches from the last snapshot
+    */
+    export_warmup_init();
+    /*
+    ** start logging the writes missed by unreachable storages
+    */
+    export_dirty_log_init();
   /*
   **  change the priority of the main thread
   */
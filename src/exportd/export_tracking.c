@@ -58,6 +58,7 @@
 #include "rozofs_exp_mover.h"
 #include "export_thin_prov_api.h"
 #include "exportd.h"
+#include "export_dirty_log_api.h"
 
 #define ROZOFS_DIR_STATS 1
 #ifdef ROZOFS_DIR_STATS
@@ -83,6 +84,7 @@ uint64_t export_rm_bins_done_count    = 0; /**< Nb files actually deleted from s
 uint64_t export_rm_bins_reload_count  = 0; /**< Nb files dicovered in trash at startup  */
 uint64_t export_rm_bins_in_ram        = 0; /**< Nb files in RAM to be deleted */
 uint64_t export_rm_bins_in_flash      = 0; /**< Nb files in flash but not in RAM to be deleted */
+uint64_t export_rm_bins_bulk_count    = 0; /**< Nb bulk remove requests sent to the storages */
 
 uint64_t export_recycle_pending_count = 0; /**< recycle thread statistics  */
 uint64_t export_recycle_done_count = 0; /**< recycle thread statistics  */
@@ -1745,6 +1747,8 @@ int export_initialize(export_t * e, volume_t *volume, uint8_t layout, ROZOFS_BSI
 
     // Initialize the dirent level 0 cache
     dirent_cache_level0_initialize();
+    dirent_cache_level0_set_memory_budget((uint64_t)common_config.export_dirent_cache_size*1024*1024);
+    dirent_wbcache_entry_count = common_config.export_dirent_wbcache_entries;
     dirent_wbcache_init();
 
     if (strlen(md5) == 0) {
@@ -5282,6 +5286,7 @@ char *export_rm_bins_stats(char *pChar)
    pChar += sprintf(pChar,"  - done     = %llu\n", (unsigned long long int) export_rm_bins_done_count);
    pChar += sprintf(pChar,"  - pending  = %llu\n", 
         (unsigned long long int) (export_rm_bins_reload_count+export_rm_bins_trashed_count)-export_rm_bins_done_count);
+   pChar += sprintf(pChar,"  - bulk req = %llu\n", (unsigned long long int) export_rm_bins_bulk_count);
 
    if (common_config.fid_recycle) {
      pChar += sprintf(pChar,"recycle stats:\n");
@@ -5300,74 +5305,135 @@ char *export_rm_bins_stats(char *pChar)
 **_______________________________________________________________________________
 */
 
-static inline int export_rm_bucket(export_t * e, uint8_t * cnx_init, list_t * connexions, int bucket_idx, uint8_t safe, uint8_t forward, int * processed_files) {
-  int          sid_count = 0;
-  int          i = 0;
-  list_t       todo;
-  list_t       failed;
-  rmfentry_t * entry;
-//  cid_t        cid;
-  list_t      * p, *n;
-  time_t        now;
+/*
+** Max number of logical storages a group of files is dispatched to
+** in bulk remove requests. The files toward any other logical storage
+** are removed one by one.
+*/
+#define EXPORT_RM_BULK_MAX_STORAGES 32
 
-  /*
-  ** Initialize the working lists
-  */
-  list_init(&todo);
-  list_init(&failed);
+typedef struct _export_rm_bulk_t {
+  mstorage_client_t    * stor;                          /**< storaged client           */
+  rmfentry_t           * entry[MP_REMOVE_BULK_MAX];     /**< file of each request entry */
+  uint8_t                pos[MP_REMOVE_BULK_MAX];       /**< position in the distribution */
+  mp_remove_bulk_arg_t   args;                          /**< the bulk remove request   */
+} export_rm_bulk_t;
 
-  /* 
-  ** Move the whole bucket list to the working list
-  */
-  if ((errno = pthread_rwlock_wrlock(&e->trash_buckets[bucket_idx].rm_lock)) != 0) {
-    severe("pthread_rwlock_wrlock failed: %s", strerror(errno));
-    return -1;
-  }
-  list_move(&todo,&e->trash_buckets[bucket_idx].rmfiles);
-  if ((errno = pthread_rwlock_unlock(&e->trash_buckets[bucket_idx].rm_lock)) != 0) {
-    severe("pthread_rwlock_unlock failed: %s", strerror(errno));
+/*
+**_______________________________________________________________________________
+*/
+/**
+* Remove the bins files of a file on one storage with a single request
+
+   @param stor: the storaged client
+   @param entry: the file to remove
+   @param pos: position of the storage in the distribution of the file
+   @param forward: number of forward storages of the layout
+*/
+static inline void export_rm_bins_one(mstorage_client_t * stor, rmfentry_t * entry, int pos, uint8_t forward) {
+  int spare = (pos < forward) ? 0 : 1;
+
+  if (mstoraged_client_remove2(stor, entry->cid, entry->current_dist_set[pos], entry->fid, spare) != 0) {
+    warning("mclient_remove failed (cid: %u; sid: %u): %s",
+            entry->cid, entry->current_dist_set[pos], strerror(errno));
+    /*
+    ** Say this storage is down not to use it again 
+    ** during this run; this would fill up the log file.
+    */
+    stor->status = 0; 
+    return;
   }
+  // The bins file has been deleted successfully
+  entry->current_dist_set[pos] = 0;
+}
+/*
+**_______________________________________________________________________________
+*/
+/**
+* Send a bulk remove request to a storage
 
-  now = time(NULL);
+   When the storaged does not support the bulk remove, the files are
+   removed one by one.
 
-  /*
-  ** get every entry
-  */	
-  list_for_each_forward_safe(p, n, &todo) {
+   @param bulk: the bulk request to send
+   @param forward: number of forward storages of the layout
+*/
+static inline void export_rm_bulk_send(export_rm_bulk_t * bulk, uint8_t forward) {
+  mstorage_client_t * stor = bulk->stor;
+  uint64_t            failed;
+  int                 k;
 
-    entry = list_entry(p,rmfentry_t,list);
-    list_remove(&entry->list);
+  if (0 == stor->status) return; // This storage is down
 
-    // Nb. of bins files removed for this file
-    sid_count = 0;
-    
-    // Not yet time to delete this file
-    if ((entry->time) && (entry->time >= now)) {
-      /*
-      ** Put this entry in the failed list
-      */
-      list_push_back(&failed, &entry->list);
-      continue;
+  if (stor->no_bulk == 0) {
+  
+    if (mstoraged_client_remove_bulk(stor, &bulk->args, &failed) == 0) {
+      __atomic_fetch_add(&export_rm_bins_bulk_count, 1, __ATOMIC_SEQ_CST);
+      for (k = 0; k < bulk->args.nb; k++) {
+        if (failed & (1ULL<<k)) continue;
+        bulk->entry[k]->current_dist_set[bulk->pos[k]] = 0;
+      }
+      return;
     }
     
+    if (errno != EOPNOTSUPP) {
+      warning("mclient_remove_bulk failed (cid: %u; sid: %u): %s",
+              bulk->args.cid, bulk->args.sid, strerror(errno));
+      stor->status = 0; 
+      return;
+    }  
     /*
-    ** This entry needs to be processed
-    ** setup connections if not yet done
+    ** Older storaged. Do not try again during this run
     */
-    if (*cnx_init == 0) {
-      *cnx_init = 1;
-      if (mstoraged_setup_cnx(e->volume, connexions) != 0) {
-        goto out;
-      }
-    }
-    
+    stor->no_bulk = 1;
+  }
+
+  for (k = 0; k < bulk->args.nb; k++) {
+    if (0 == stor->status) return;
+    export_rm_bins_one(stor, bulk->entry[k], bulk->pos[k], forward);
+  }
+}
+/*
+**_______________________________________________________________________________
+*/
+/**
+* Remove the bins files of a group of files
+
+   The bins files are gathered per logical storage in bulk remove requests.
+   The files which bins files are all removed are deleted from the trash, 
+   the others are pushed in the failed list to be retried later.
+
+   @param e: the export
+   @param connexions: the list of storaged clients
+   @param group: the list of files to remove
+   @param failed: the list where to push the files not completly removed
+   @param safe: number of storages of the layout
+   @param forward: number of forward storages of the layout
+*/
+static void export_rm_group(export_t * e, list_t * connexions, list_t * group, list_t * failed, uint8_t safe, uint8_t forward) {
+  export_rm_bulk_t   * bulks;
+  export_rm_bulk_t   * bulk;
+  int                  nb_bulks = 0;
+  rmfentry_t         * entry;
+  list_t             * p, *n;
+  int                  i,b;
+  int                  sid_count;
+
+  bulks = xmalloc(EXPORT_RM_BULK_MAX_STORAGES*sizeof(export_rm_bulk_t));
+  
+  /*
+  ** Dispatch the bins files to remove on the storages
+  */
+  list_for_each_forward(p, group) {
+
+    entry = list_entry(p,rmfentry_t,list);
+
     // For each storage associated with this file
     for (i = 0; i < safe; i++) {
 
       mstorage_client_t * stor = NULL;
 
       if (0 == entry->current_dist_set[i]) {
-        sid_count++;
         continue; // The bins file has already been deleted for this server
       }
 
@@ -5390,39 +5456,66 @@ static inline int export_rm_bucket(export_t * e, uint8_t * cnx_init, list_t * co
 	/*
 	** Invalid cid/sid
 	*/
-	sid_count++;
+	entry->current_dist_set[i] = 0;
         continue;// lookup_cnx failed !!! 
       }
 
       if (0 == stor->status) {
         continue; // This storage is down
       }
-
-      // Send remove request
-      int spare;
-      if (i<forward) spare = 0;
-      else           spare = 1;
       
-      if (mstoraged_client_remove2(stor, entry->cid, entry->current_dist_set[i], entry->fid, spare) != 0) {
-        warning("mclient_remove failed (cid: %u; sid: %u): %s",
-                entry->cid, entry->current_dist_set[i], strerror(errno));
-	/*
-	** Say this storage is down not to use it again 
-	** during this run; this would fill up the log file.
-	*/
-	stor->status = 0; 
-        continue; // Go to the next storage
+      /*
+      ** Find out the bulk request of this cid/sid
+      */
+      bulk = NULL;
+      for (b = 0; b < nb_bulks; b++) {
+        if ((bulks[b].args.cid == entry->cid) && (bulks[b].args.sid == entry->current_dist_set[i])) {
+	  bulk = &bulks[b];
+	  break;
+	}
       }
-
-      // The bins file has been deleted successfully
-      // Update distribution and nb. of bins file deleted
-      entry->current_dist_set[i] = 0;
-      sid_count++;
+      if ((bulk == NULL) && (nb_bulks < EXPORT_RM_BULK_MAX_STORAGES)) {
+        bulk = &bulks[nb_bulks++];
+	bulk->stor    = stor;
+	bulk->args.cid = entry->cid;
+	bulk->args.sid = entry->current_dist_set[i];
+	bulk->args.nb  = 0;
+      }
+      
+      if ((bulk == NULL) || (stor->no_bulk)) {
+        export_rm_bins_one(stor, entry, i, forward);
+	continue;
+      }
+      
+      bulk->entry[bulk->args.nb] = entry;
+      bulk->pos[bulk->args.nb]   = i;
+      bulk->args.entries[bulk->args.nb].spare = (i < forward) ? 0 : 1;
+      memcpy(bulk->args.entries[bulk->args.nb].fid, entry->fid, sizeof(fid_t));
+      bulk->args.nb++;
     }
+  }
+  
+  /*
+  ** Send the bulk requests
+  */
+  for (b = 0; b < nb_bulks; b++) {
+    export_rm_bulk_send(&bulks[b], forward);
+  }
+  xfree(bulks);
+  
+  /*
+  ** Check which files are completly removed
+  */
+  list_for_each_forward_safe(p, n, group) {
 
-    // Update the nb. of files that have been tested to be deleted.
-    (*processed_files)++; 
+    entry = list_entry(p,rmfentry_t,list);
+    list_remove(&entry->list);
 
+    sid_count = 0;
+    for (i = 0; i < safe; i++) {
+      if (0 == entry->current_dist_set[i]) sid_count++;
+    }
+    
     if (sid_count == safe) {
       /*
       ** remove the entry from the trash file
@@ -5432,10 +5525,88 @@ static inline int export_rm_bucket(export_t * e, uint8_t * cnx_init, list_t * co
       xfree(entry);
     }
     else {
+      /*
+      ** Put this entry in the failed list
+      */
+      list_push_back(failed, &entry->list);
+    }
+  }
+}
+/*
+**_______________________________________________________________________________
+*/
+
+static inline int export_rm_bucket(export_t * e, uint8_t * cnx_init, list_t * connexions, int bucket_idx, uint8_t safe, uint8_t forward, int * processed_files) {
+  list_t       todo;
+  list_t       failed;
+  list_t       group;
+  int          nb_group = 0;
+  rmfentry_t * entry;
+  list_t      * p, *n;
+  time_t        now;
+
+  /*
+  ** Initialize the working lists
+  */
+  list_init(&todo);
+  list_init(&failed);
+  list_init(&group);
+
+  /* 
+  ** Move the whole bucket list to the working list
+  */
+  if ((errno = pthread_rwlock_wrlock(&e->trash_buckets[bucket_idx].rm_lock)) != 0) {
+    severe("pthread_rwlock_wrlock failed: %s", strerror(errno));
+    return -1;
+  }
+  list_move(&todo,&e->trash_buckets[bucket_idx].rmfiles);
+  if ((errno = pthread_rwlock_unlock(&e->trash_buckets[bucket_idx].rm_lock)) != 0) {
+    severe("pthread_rwlock_unlock failed: %s", strerror(errno));
+  }
+
+  now = time(NULL);
+
+  /*
+  ** get every entry
+  */	
+  list_for_each_forward_safe(p, n, &todo) {
+
+    entry = list_entry(p,rmfentry_t,list);
+    list_remove(&entry->list);
+
+    // Not yet time to delete this file
+    if ((entry->time) && (entry->time >= now)) {
       /*
       ** Put this entry in the failed list
       */
       list_push_back(&failed, &entry->list);
+      continue;
+    }
+    
+    /*
+    ** This entry needs to be processed
+    ** setup connections if not yet done
+    */
+    if (*cnx_init == 0) {
+      *cnx_init = 1;
+      if (mstoraged_setup_cnx(e->volume, connexions) != 0) {
+        list_push_back(&failed, &entry->list);
+        goto out;
+      }
+    }
+    
+    /*
+    ** Gather the files to send them in bulk remove requests
+    */
+    list_push_back(&group, &entry->list);
+    nb_group++;
+
+    // Update the nb. of files that have been tested to be deleted.
+    (*processed_files)++; 
+
+    if (nb_group == MP_REMOVE_BULK_MAX) {
+      export_rm_group(e, connexions, &group, &failed, safe, forward);
+      nb_group = 0;
     }
 
     /*
@@ -5446,6 +5617,10 @@ static inline int export_rm_bucket(export_t * e, uint8_t * cnx_init, list_t * co
   
 out:
 
+  if (nb_group) {
+    export_rm_group(e, connexions, &group, &failed, safe, forward);
+  }
+
   /*
   ** Bucket totaly processed successfully
   */
@@ -6855,6 +7030,7 @@ int64_t export_write(export_t *e, fid_t fid, uint64_t off, uint32_t len) {
  * @param site_number: siet number for geo-replication
  * @param geo_wr_start: write start offset
  * @param geo_wr_end: write end offset
+ * @param degraded: bitmap of the nominal storages that have missed the write
  * @param[out] attrs: updated attributes of the file
  *
  * @return: the written length on success or -1 otherwise (errno is set)
@@ -6862,6 +7038,7 @@ int64_t export_write(export_t *e, fid_t fid, uint64_t off, uint32_t len) {
 int64_t export_write_block(export_t *e, fid_t fid, uint64_t bid, uint32_t n,
                            dist_t d, uint64_t off, uint32_t len,
 			   uint32_t site_number,uint64_t geo_wr_start,uint64_t geo_wr_end,
+			   uint16_t degraded,
 	                   struct inode_internal_t *attrs) {
     int64_t length = -1;
     lv2_entry_t *lv2 = NULL;
@@ -6989,6 +7166,17 @@ int64_t export_write_block(export_t *e, fid_t fid, uint64_t bid, uint32_t n,
 			 lv2->attributes.s.attrs.cid,
 			 lv2->attributes.s.attrs.sids);
     }
+    if (degraded != 0)
+    {
+      /*
+      ** some nominal storages have missed the write: log it for the
+      ** incremental rebuild of these storages
+      */
+      export_dirty_log_insert(e,fid,
+                              lv2->attributes.s.attrs.cid,
+			      lv2->attributes.s.attrs.sids,
+			      degraded,geo_wr_start,geo_wr_end);
+    }
 out:
     STOP_PROFILING(export_write_block);
 
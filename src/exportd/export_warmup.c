@@ -0,0 +1,723 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <rozofs/rozofs.h>
+#include <rozofs/common/log.h>
+#include <rozofs/common/xmalloc.h>
+#include <rozofs/common/common_config.h>
+#include <rozofs/core/ruc_timer_api.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include "config.h"
+#include "exportd.h"
+#include "export.h"
+#include "mdir.h"
+#include "mdirent.h"
+#include "export_warmup_api.h"
+
+/*
+** The snapshot of an export is made of a header followed by the records
+** of the hot objects in priority order: directory attributes first, then
+** the directory root dirent files, then the attributes of the other objects.
+** Within each class, the records are in most recently used first order.
+*/
+#define EXPORT_WARMUP_MAGIC       0x57524D55 /**< "WRMU" */
+#define EXPORT_WARMUP_VERSION     1
+#define EXPORT_WARMUP_MAX_RECORDS (256*1024) /**< max records per export snapshot */
+#define EXPORT_WARMUP_TICK_MS     100        /**< warm-up/snapshot timer period */
+#define EXPORT_WARMUP_BATCH       512        /**< records loaded per timer tick */
+#define EXPORT_WARMUP_READAHEAD   8192       /**< max records read ahead of the loader */
+
+typedef enum
+{
+  EXPORT_WARMUP_REC_DIR=0,   /**< attributes of a directory               */
+  EXPORT_WARMUP_REC_DIRENT,  /**< root dirent file of a directory         */
+  EXPORT_WARMUP_REC_ATTR,    /**< attributes of a file or symbolic link   */
+  EXPORT_WARMUP_REC_MAX
+} export_warmup_rec_type_e;
+
+typedef struct _export_warmup_hdr_t
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t eid;
+  uint32_t nb_records;
+  uint64_t date;        /**< date of the snapshot */
+} export_warmup_hdr_t;
+
+typedef struct _export_warmup_rec_t
+{
+  fid_t    fid;         /**< fid of the object                             */
+  uint16_t root_idx;    /**< root dirent file index: EXPORT_WARMUP_REC_DIRENT */
+  uint8_t  type;        /**< see export_warmup_rec_type_e                  */
+  uint8_t  filler;
+} export_warmup_rec_t;
+
+typedef enum
+{
+  EXPORT_WARMUP_ST_IDLE=0,   /**< no snapshot to load                */
+  EXPORT_WARMUP_ST_RUNNING,  /**< warm-up in progress                */
+  EXPORT_WARMUP_ST_DONE,     /**< every record has been processed    */
+  EXPORT_WARMUP_ST_FULL,     /**< stopped: the lv2 cache is full     */
+  EXPORT_WARMUP_ST_STOPPED,  /**< stopped by rozodiag                */
+} export_warmup_state_e;
+
+/**
+* per export context
+*/
+typedef struct _export_warmup_ctx_t
+{
+  export_t            *e;             /**< export                                   */
+  export_warmup_rec_t *rec_p;         /**< records read from the snapshot           */
+  uint32_t             nb_records;    /**< number of records read from the snapshot */
+  uint32_t             next;          /**< next record to load in the caches        */
+  volatile uint32_t    readahead;     /**< next record to read ahead                */
+  uint64_t             loaded[EXPORT_WARMUP_REC_MAX]; /**< records loaded per type  */
+  uint64_t             failed;        /**< records that could not be loaded         */
+  /*
+  ** snapshot
+  */
+  export_warmup_rec_t *snap_p;        /**< records of the snapshot in progress      */
+  uint32_t             snap_records;  /**< number of records of that snapshot       */
+  uint32_t             last_records;  /**< number of records of the last snapshot   */
+  time_t               last_date;     /**< date of the last snapshot                */
+} export_warmup_ctx_t;
+
+typedef struct _export_warmup_main_t
+{
+  export_warmup_ctx_t  *ctx[EXPGW_EID_MAX_IDX+1];
+  int                   nb_ctx;
+  export_warmup_state_e state;
+  uint64_t              start_us;      /**< start of the warm-up                     */
+  uint64_t              end_us;        /**< end of the warm-up                       */
+  uint64_t              readahead_cnt; /**< files read ahead by the warm-up thread   */
+  volatile int          readahead_run; /**< warm-up thread is running                */
+  volatile int          snap_in_prg;   /**< snapshot write in progress               */
+  uint64_t              snap_cnt;      /**< number of snapshots written              */
+  uint64_t              snap_err;      /**< number of snapshots write failures       */
+  uint64_t              snap_build_us; /**< time to build the last snapshot          */
+  uint32_t              ticks;         /**< timer ticks since the last snapshot      */
+} export_warmup_main_t;
+
+static export_warmup_main_t export_warmup;
+
+int export_dir_load_root_idx_bitmap(export_t *e,fid_t fid,lv2_entry_t *lvl2);
+
+/*
+**__________________________________________________________________
+*/
+static inline uint64_t export_warmup_now_us() {
+  struct timeval tv;
+  gettimeofday(&tv,NULL);
+  return ((uint64_t)tv.tv_sec*1000000)+tv.tv_usec;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Build the pathname of the snapshot file of an export
+
+   @param e: export
+   @param path: output buffer
+   @param tmp: assert to 1 to get the pathname of the temporary file
+*/
+static inline void export_warmup_path(export_t *e, char *path, int tmp) {
+  sprintf(path, "%s/%s%s", e->root, WARMUP_FNAME, tmp?".tmp":"");
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Read the snapshot of an export
+
+   @param ctx_p: export warm-up context
+
+   @retval number of records read
+*/
+static uint32_t export_warmup_read_snapshot(export_warmup_ctx_t *ctx_p) {
+  char path[PATH_MAX];
+  export_warmup_hdr_t hdr;
+  struct stat st;
+  size_t size;
+  int fd;
+
+  export_warmup_path(ctx_p->e,path,0);
+  if ((fd = open(path, O_RDONLY | O_NOATIME)) < 0) {
+    if (errno != ENOENT) severe("open(%s) %s",path,strerror(errno));
+    return 0;
+  }
+  if (fstat(fd,&st) < 0) goto error;
+  if (pread(fd,&hdr,sizeof(hdr),0) != (ssize_t)sizeof(hdr)) goto bad;
+  if ((hdr.magic != EXPORT_WARMUP_MAGIC) || (hdr.version != EXPORT_WARMUP_VERSION)) goto bad;
+  if ((hdr.eid != ctx_p->e->eid) || (hdr.nb_records > EXPORT_WARMUP_MAX_RECORDS)) goto bad;
+  size = hdr.nb_records * sizeof(export_warmup_rec_t);
+  if (st.st_size != sizeof(hdr)+size) goto bad;
+  if (hdr.nb_records == 0) goto out;
+
+  ctx_p->rec_p = xmalloc(size);
+  if (pread(fd,ctx_p->rec_p,size,sizeof(hdr)) != (ssize_t)size) {
+    xfree(ctx_p->rec_p);
+    ctx_p->rec_p = NULL;
+    goto error;
+  }
+  ctx_p->nb_records   = hdr.nb_records;
+  ctx_p->last_records = hdr.nb_records;
+  ctx_p->last_date    = hdr.date;
+  goto out;
+
+bad:
+  warning("%s is not a valid warm-up snapshot",path);
+  goto out;
+error:
+  severe("%s %s",path,strerror(errno));
+out:
+  close(fd);
+  return ctx_p->nb_records;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Write the snapshot of an export: the temporary file is renamed once
+   complete, so a crash never leaves a truncated snapshot behind
+
+   @param ctx_p: export warm-up context
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+static int export_warmup_write_snapshot(export_warmup_ctx_t *ctx_p) {
+  char path[PATH_MAX];
+  char tmp_path[PATH_MAX];
+  export_warmup_hdr_t hdr;
+  size_t size;
+  int fd;
+
+  hdr.magic      = EXPORT_WARMUP_MAGIC;
+  hdr.version    = EXPORT_WARMUP_VERSION;
+  hdr.eid        = ctx_p->e->eid;
+  hdr.nb_records = ctx_p->snap_records;
+  hdr.date       = time(NULL);
+  size = hdr.nb_records * sizeof(export_warmup_rec_t);
+
+  export_warmup_path(ctx_p->e,tmp_path,1);
+  export_warmup_path(ctx_p->e,path,0);
+  if ((fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_NOATIME, S_IRUSR | S_IWUSR)) < 0) {
+    severe("open(%s) %s",tmp_path,strerror(errno));
+    return -1;
+  }
+  if ((pwrite(fd,&hdr,sizeof(hdr),0) != (ssize_t)sizeof(hdr))
+  ||  ((size != 0) && (pwrite(fd,ctx_p->snap_p,size,sizeof(hdr)) != (ssize_t)size))
+  ||  (fdatasync(fd) < 0)) {
+    severe("write(%s) %s",tmp_path,strerror(errno));
+    close(fd);
+    unlink(tmp_path);
+    return -1;
+  }
+  close(fd);
+  if (rename(tmp_path,path) < 0) {
+    severe("rename(%s) %s",tmp_path,strerror(errno));
+    unlink(tmp_path);
+    return -1;
+  }
+  ctx_p->last_records = hdr.nb_records;
+  ctx_p->last_date    = hdr.date;
+  return 0;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Snapshot writer thread: the snapshots have been built by the non
+   blocking thread, the disk writes are done here
+*/
+static void *export_warmup_snapshot_thread(void *arg) {
+  export_warmup_ctx_t *ctx_p;
+  int eid;
+
+  uma_dbg_thread_add_self("Warmup snap");
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_warmup.ctx[eid];
+    if ((ctx_p == NULL) || (ctx_p->snap_p == NULL)) continue;
+    if (export_warmup_write_snapshot(ctx_p) == 0) export_warmup.snap_cnt++;
+    else export_warmup.snap_err++;
+    xfree(ctx_p->snap_p);
+    ctx_p->snap_p = NULL;
+  }
+  export_warmup.snap_in_prg = 0;
+  return NULL;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Append a record to the snapshot in progress of the export owning the fid
+
+   @param fid: fid of the object
+   @param type: record type
+   @param root_idx: root dirent file index
+*/
+static inline void export_warmup_snapshot_add(fid_t fid, int type, int root_idx) {
+  export_warmup_ctx_t *ctx_p;
+  export_warmup_rec_t *rec_p;
+  eid_t eid;
+
+  eid = rozofs_get_eid_from_fid(fid);
+  if (eid > EXPGW_EID_MAX_IDX) return;
+  ctx_p = export_warmup.ctx[eid];
+  if ((ctx_p == NULL) || (ctx_p->snap_records >= EXPORT_WARMUP_MAX_RECORDS)) return;
+
+  rec_p = &ctx_p->snap_p[ctx_p->snap_records++];
+  memcpy(rec_p->fid,fid,sizeof(fid_t));
+  rec_p->root_idx = root_idx;
+  rec_p->type     = type;
+  rec_p->filler   = 0;
+}
+/*
+**__________________________________________________________________
+*/
+static int export_warmup_snapshot_dirent_cbk(fid_t fid, int root_idx, void *param) {
+  export_warmup_snapshot_add(fid,EXPORT_WARMUP_REC_DIRENT,root_idx);
+  return 0;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Append the lv2 entries of a list to the snapshots in progress
+
+   @param list: lv2 cache list (most recently used first)
+   @param dir: 1 for the directories, 0 for the other objects
+*/
+static void export_warmup_snapshot_lv2_list(list_t *list, int dir) {
+  lv2_entry_t *lv2;
+  list_t *p;
+
+  list_for_each_forward(p, list) {
+    lv2 = list_entry(p, lv2_entry_t, list);
+    if ((S_ISDIR(lv2->attributes.s.attrs.mode)?1:0) != dir) continue;
+    export_warmup_snapshot_add(lv2->attributes.s.attrs.fid,
+                               dir?EXPORT_WARMUP_REC_DIR:EXPORT_WARMUP_REC_ATTR,0);
+  }
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Build the snapshot of every export from the content of the caches and
+   hand it to the writer thread.
+
+   Called by the non blocking thread which owns the lv2 and dirent caches.
+
+   @retval 0 on success
+   @retval -1 when a snapshot is already in progress or on error
+*/
+static int export_warmup_snapshot() {
+  export_warmup_ctx_t *ctx_p;
+  pthread_attr_t attr;
+  pthread_t thrdId;
+  uint64_t start;
+  int eid;
+
+  if (export_warmup.snap_in_prg) return -1;
+  start = export_warmup_now_us();
+
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_warmup.ctx[eid];
+    if (ctx_p == NULL) continue;
+    ctx_p->snap_p = xmalloc(EXPORT_WARMUP_MAX_RECORDS*sizeof(export_warmup_rec_t));
+    ctx_p->snap_records = 0;
+  }
+  /*
+  ** directories first, then their root dirent files, then the other objects
+  */
+  export_warmup_snapshot_lv2_list(&cache.flock_list,1);
+  export_warmup_snapshot_lv2_list(&cache.lru,1);
+  dirent_cache_level0_foreach(export_warmup_snapshot_dirent_cbk,NULL);
+  export_warmup_snapshot_lv2_list(&cache.flock_list,0);
+  export_warmup_snapshot_lv2_list(&cache.lru,0);
+  /*
+  ** do not overwrite a previous snapshot with an empty one
+  */
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_warmup.ctx[eid];
+    if ((ctx_p == NULL) || (ctx_p->snap_records != 0)) continue;
+    xfree(ctx_p->snap_p);
+    ctx_p->snap_p = NULL;
+  }
+  export_warmup.snap_build_us = export_warmup_now_us() - start;
+
+  export_warmup.snap_in_prg = 1;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_DETACHED);
+  if ((errno = pthread_create(&thrdId,&attr,export_warmup_snapshot_thread,NULL)) != 0) {
+    severe("can't create warm-up snapshot thread %s",strerror(errno));
+    pthread_attr_destroy(&attr);
+    export_warmup.snap_err++;
+    for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+      ctx_p = export_warmup.ctx[eid];
+      if ((ctx_p == NULL) || (ctx_p->snap_p == NULL)) continue;
+      xfree(ctx_p->snap_p);
+      ctx_p->snap_p = NULL;
+    }
+    export_warmup.snap_in_prg = 0;
+    return -1;
+  }
+  pthread_attr_destroy(&attr);
+  return 0;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Read ahead thread: it runs in front of the non blocking thread and
+   pulls the metadata files of the snapshot in the page cache, so the
+   loads of the non blocking thread do not wait on the disk.
+*/
+static void *export_warmup_readahead_thread(void *arg) {
+  export_warmup_ctx_t *ctx_p;
+  export_warmup_rec_t *rec_p;
+  mdirents_header_new_t dirent_hdr;
+  char name[64];
+  char path[PATH_MAX];
+  int eid;
+  int fd;
+
+  uma_dbg_thread_add_self("Warmup");
+  /*
+  ** the exports are processed one after the other, as the loader does
+  */
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_warmup.ctx[eid];
+    if ((ctx_p == NULL) || (ctx_p->rec_p == NULL)) continue;
+
+    while (ctx_p->readahead < ctx_p->nb_records) {
+      if (export_warmup.state != EXPORT_WARMUP_ST_RUNNING) goto out;
+      /*
+      ** do not run too far ahead of the loader
+      */
+      if (ctx_p->readahead >= ctx_p->next + EXPORT_WARMUP_READAHEAD) {
+        usleep(10000);
+        continue;
+      }
+      rec_p = &ctx_p->rec_p[ctx_p->readahead];
+      switch (rec_p->type) {
+        case EXPORT_WARMUP_REC_DIR:
+          mdirent_resolve_path(rec_p->fid,MDIR_ATTRS_FNAME,path);
+          break;
+        case EXPORT_WARMUP_REC_DIRENT:
+          dirent_hdr.type = MDIRENT_CACHE_FILE_TYPE;
+          dirent_hdr.level_index = 0;
+          dirent_hdr.dirent_idx[0] = rec_p->root_idx;
+          dirent_hdr.dirent_idx[1] = 0;
+          dirent_build_filename(&dirent_hdr,name);
+          mdirent_resolve_path(rec_p->fid,name,path);
+          break;
+        default:
+          /*
+          ** attributes of the regular files are read from the tracking files
+          ** that are shared by many FIDs: the loader reads them
+          */
+          path[0] = 0;
+          break;
+      }
+      if ((path[0] != 0) && ((fd = open(path, O_RDONLY | O_NOATIME)) >= 0)) {
+        posix_fadvise(fd,0,0,POSIX_FADV_WILLNEED);
+        close(fd);
+        export_warmup.readahead_cnt++;
+      }
+      ctx_p->readahead++;
+    }
+  }
+out:
+  export_warmup.readahead_run = 0;
+  return NULL;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Load one snapshot record in the caches
+
+   @param ctx_p: export warm-up context
+   @param rec_p: record to load
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+static int export_warmup_load_record(export_warmup_ctx_t *ctx_p, export_warmup_rec_t *rec_p) {
+  export_t *e = ctx_p->e;
+  lv2_entry_t *lv2;
+
+  lv2 = EXPORT_LOOKUP_FID(e->trk_tb_p,e->lv2_cache,rec_p->fid);
+  if (lv2 == NULL) return -1;
+  if (rec_p->type == EXPORT_WARMUP_REC_ATTR) return 0;
+
+  if (!S_ISDIR(lv2->attributes.s.attrs.mode)) return -1;
+  if (export_dir_load_root_idx_bitmap(e,rec_p->fid,lv2) < 0) return -1;
+  if (rec_p->type == EXPORT_WARMUP_REC_DIR) return 0;
+
+  export_open_parent_directory(e,rec_p->fid);
+  if (dirent_cache_prefetch_root_entry(lv2->dirent_root_idx_p,-1,rec_p->fid,rec_p->root_idx) < 0) return -1;
+  return 0;
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Release the snapshot records once the warm-up is over
+*/
+static void export_warmup_end(export_warmup_state_e state) {
+  export_warmup_ctx_t *ctx_p;
+  int eid;
+
+  export_warmup.state  = state;
+  export_warmup.end_us = export_warmup_now_us();
+  /*
+  ** wait for the read ahead thread to see the state change
+  */
+  while (export_warmup.readahead_run) usleep(1000);
+
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_warmup.ctx[eid];
+    if ((ctx_p == NULL) || (ctx_p->rec_p == NULL)) continue;
+    xfree(ctx_p->rec_p);
+    ctx_p->rec_p = NULL;
+  }
+  info("exportd warm-up %s in %llu ms",(state==EXPORT_WARMUP_ST_DONE)?"done":"stopped",
+       (unsigned long long)(export_warmup.end_us-export_warmup.start_us)/1000);
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Load the next batch of records in the caches. The exports are warmed up
+   one after the other, each in the priority order of its snapshot.
+*/
+static void export_warmup_load_batch() {
+  export_warmup_ctx_t *ctx_p;
+  export_warmup_rec_t *rec_p;
+  int count = 0;
+  int eid;
+
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_warmup.ctx[eid];
+    if ((ctx_p == NULL) || (ctx_p->rec_p == NULL)) continue;
+
+    while (ctx_p->next < ctx_p->nb_records) {
+      if (count++ >= EXPORT_WARMUP_BATCH) return;
+      /*
+      ** stop before evicting entries that have been loaded by the clients
+      */
+      if (cache.size >= cache.max) {
+        export_warmup_end(EXPORT_WARMUP_ST_FULL);
+        return;
+      }
+      rec_p = &ctx_p->rec_p[ctx_p->next++];
+      if (export_warmup_load_record(ctx_p,rec_p) == 0) ctx_p->loaded[rec_p->type]++;
+      else ctx_p->failed++;
+    }
+  }
+  export_warmup_end(EXPORT_WARMUP_ST_DONE);
+}
+/*
+**__________________________________________________________________
+*/
+/**
+*  Periodic ticker of the warm-up service
+*/
+static void export_warmup_periodic_ticker(void * param) {
+
+  if (export_warmup.state == EXPORT_WARMUP_ST_RUNNING) {
+    export_warmup_load_batch();
+    /*
+    ** no snapshot while the previous one is being loaded
+    */
+    return;
+  }
+  if (common_config.export_warmup_snapshot_period == 0) {
+    export_warmup.ticks = 0;
+    return;
+  }
+  export_warmup.ticks++;
+  if (export_warmup.ticks < (common_config.export_warmup_snapshot_period*1000)/EXPORT_WARMUP_TICK_MS) return;
+  if (export_warmup_snapshot() == 0) export_warmup.ticks = 0;
+}
+/*
+*_______________________________________________________________________
+*/
+static char * show_warmup_usage(char * pChar) {
+  pChar += sprintf(pChar,"usage:\n");
+  pChar += sprintf(pChar,"warmup          : display the warm-up and snapshot statistics\n");
+  pChar += sprintf(pChar,"warmup snapshot : write a snapshot of the caches now\n");
+  pChar += sprintf(pChar,"warmup stop     : stop the warm-up in progress\n");
+  return pChar;
+}
+/*
+*_______________________________________________________________________
+*/
+static char *export_warmup_state2String(export_warmup_state_e state) {
+  switch (state) {
+    case EXPORT_WARMUP_ST_IDLE:    return "IDLE";
+    case EXPORT_WARMUP_ST_RUNNING: return "RUNNING";
+    case EXPORT_WARMUP_ST_DONE:    return "DONE";
+    case EXPORT_WARMUP_ST_FULL:    return "CACHE FULL";
+    case EXPORT_WARMUP_ST_STOPPED: return "STOPPED";
+  }
+  return "?";
+}
+/*
+*_______________________________________________________________________
+*/
+/**
+*  warm-up statistics
+*/
+void show_warmup(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char *pChar = uma_dbg_get_buffer();
+  export_warmup_ctx_t *ctx_p;
+  uint64_t elapsed;
+  int eid;
+
+  if (argv[1] != NULL) {
+    if (strcmp(argv[1],"snapshot")==0) {
+      if (export_warmup.state == EXPORT_WARMUP_ST_RUNNING) {
+        pChar += sprintf(pChar,"warm-up in progress, try later\n");
+      }
+      else if (export_warmup_snapshot() == 0) {
+        export_warmup.ticks = 0;
+        pChar += sprintf(pChar,"snapshot started\n");
+      }
+      else {
+        pChar += sprintf(pChar,"snapshot already in progress\n");
+      }
+      uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+      return;
+    }
+    if (strcmp(argv[1],"stop")==0) {
+      if (export_warmup.state == EXPORT_WARMUP_ST_RUNNING) {
+        export_warmup_end(EXPORT_WARMUP_ST_STOPPED);
+      }
+      pChar += sprintf(pChar,"warm-up %s\n",export_warmup_state2String(export_warmup.state));
+      uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+      return;
+    }
+    pChar = show_warmup_usage(pChar);
+    uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+    return;
+  }
+
+  if (export_warmup.state == EXPORT_WARMUP_ST_RUNNING) elapsed = export_warmup_now_us() - export_warmup.start_us;
+  else elapsed = export_warmup.end_us - export_warmup.start_us;
+
+  pChar += sprintf(pChar,"warm-up state      : %s\n",export_warmup_state2String(export_warmup.state));
+  pChar += sprintf(pChar,"elapsed            : %llu ms\n",(unsigned long long)elapsed/1000);
+  pChar += sprintf(pChar,"read ahead         : %llu files\n",(unsigned long long)export_warmup.readahead_cnt);
+  pChar += sprintf(pChar,"lv2 cache          : %d/%d\n",cache.size,cache.max);
+  pChar += sprintf(pChar,"snapshot period    : %d s\n",common_config.export_warmup_snapshot_period);
+  pChar += sprintf(pChar,"snapshot           : %s (ok %llu, failed %llu, last build %llu us)\n",
+                   export_warmup.snap_in_prg?"IN PROGRESS":"IDLE",
+                   (unsigned long long)export_warmup.snap_cnt,
+                   (unsigned long long)export_warmup.snap_err,
+                   (unsigned long long)export_warmup.snap_build_us);
+  pChar += sprintf(pChar,"| eid  | records  | processed|   dirs   |  dirents | attrs    |  failed  | snapshot records/age |\n");
+  pChar += sprintf(pChar,"+------+----------+----------+----------+----------+----------+----------+----------------------+\n");
+  for (eid = 0; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    ctx_p = export_warmup.ctx[eid];
+    if (ctx_p == NULL) continue;
+    pChar += sprintf(pChar,"| %4d | %8u | %8u | %8llu | %8llu | %8llu | %8llu | %8u %9llds |\n",
+                     eid, ctx_p->nb_records, ctx_p->next,
+                     (unsigned long long)ctx_p->loaded[EXPORT_WARMUP_REC_DIR],
+                     (unsigned long long)ctx_p->loaded[EXPORT_WARMUP_REC_DIRENT],
+                     (unsigned long long)ctx_p->loaded[EXPORT_WARMUP_REC_ATTR],
+                     (unsigned long long)ctx_p->failed,
+                     ctx_p->last_records,
+                     ctx_p->last_date?(long long)(time(NULL)-ctx_p->last_date):-1LL);
+  }
+  pChar += sprintf(pChar,"+------+----------+----------+----------+----------+----------+----------+----------------------+\n");
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**_________________________________________________
+*/
+/**
+*  Init of the warm-restart service of the exportd caches
+
+   @param none
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int export_warmup_init() {
+  export_warmup_ctx_t *ctx_p;
+  struct timer_cell *timer;
+  pthread_t thrdId;
+  uint32_t total = 0;
+  export_t *e;
+  int eid;
+
+  memset(&export_warmup,0,sizeof(export_warmup));
+  uma_dbg_addTopic("warmup",show_warmup);
+  /*
+  ** the master exportd does not serve the metadata
+  */
+  if (exportd_is_master()) return 0;
+
+  for (eid = 1; eid <= EXPGW_EID_MAX_IDX; eid++) {
+    if (exportd_is_eid_match_with_instance(eid) == 0) continue;
+    e = exports_lookup_export(eid);
+    if (e == NULL) continue;
+    ctx_p = xmalloc(sizeof(export_warmup_ctx_t));
+    memset(ctx_p,0,sizeof(export_warmup_ctx_t));
+    ctx_p->e = e;
+    export_warmup.ctx[eid] = ctx_p;
+    export_warmup.nb_ctx++;
+    total += export_warmup_read_snapshot(ctx_p);
+  }
+  errno = 0;
+
+  if (total != 0) {
+    info("exportd warm-up of %u records",total);
+    export_warmup.state = EXPORT_WARMUP_ST_RUNNING;
+    export_warmup.start_us = export_warmup_now_us();
+    export_warmup.readahead_run = 1;
+    if ((errno = pthread_create(&thrdId,NULL,export_warmup_readahead_thread,NULL)) != 0) {
+      severe("can't create warm-up thread %s",strerror(errno));
+      export_warmup.readahead_run = 0;
+    }
+    else pthread_detach(thrdId);
+  }
+
+  timer = ruc_timer_alloc(0,0);
+  if (timer == NULL) {
+    severe("export_warmup_init: no timer");
+    if (export_warmup.state == EXPORT_WARMUP_ST_RUNNING) export_warmup_end(EXPORT_WARMUP_ST_STOPPED);
+    return -1;
+  }
+  ruc_periodic_timer_start(timer,EXPORT_WARMUP_TICK_MS,export_warmup_periodic_ticker,NULL);
+  return 0;
+}
@@ -0,0 +1,54 @@
+/*
+  Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+  This file is part of Rozofs.
+
+  Rozofs is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation, version 2.
+
+  Rozofs is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see
+  <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXPORT_WARMUP_API_H
+#define EXPORT_WARMUP_API_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "export.h"
+
+/*
+**_________________________________________________
+*/
+/**
+*  Init of the warm-restart service of the exportd caches
+
+   The snapshot of each export served by the exportd is read and the
+   cache warm-up is started. The periodic snapshot of the hot FIDs and
+   directory roots is armed according to export_warmup_snapshot_period.
+
+   That function must be called by the non blocking thread once the
+   exports are configured.
+
+   @param none
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int export_warmup_init();
+/*
+*_______________________________________________________________________
+*/
+/**
+*  warm-up statistics
+*/
+void show_warmup(char * argv[], uint32_t tcpRef, void *bufRef);
+
+#endif
@@ -79,22 +79,82 @@
  dirent_mem_print_stats_per_size()\n
 
  */
+/**
+ *  Memory statistics
+ */
+#define DIRENT_MEM_BLOCK_SZ  64   /**< granularity of the memory blocks (statistics and slab classes) */
+#define DIRENT_MEM_MAX_IDX  34    /**< the biggest slab block (name chunk array + header) must fit */
+/**
+ *  Slab arena: the memory blocks that are not greater than a name chunk array
+ *  (the bulk of the dirent cache memory) are carved out of large slabs
+ *  and recycled through per slab free lists. It avoids the per block
+ *  overhead and the fragmentation of memalign() when entries are evicted
+ *  and re-loaded at high rate.
+ *
+ *  A slab is aligned on its size and starts with its descriptor, so the slab
+ *  of a block is found from the block address. A slab which blocks are all
+ *  free again is given back to the system, unless it is the only one of its
+ *  class that has free blocks.
+ */
+#define DIRENT_SLAB_SIZE       (256*1024) /**< size of a slab */
+#define DIRENT_SLAB_MAX_BLOCK  (2048+8) /**< a name chunk array (MDIRENTS_CACHE_CHUNK_ARRAY_SZ) and its header */
+#define DIRENT_SLAB_MAX_CLASS  ((DIRENT_SLAB_MAX_BLOCK-1)/DIRENT_MEM_BLOCK_SZ+1) /**< number of slab classes */
+
+typedef struct _dirent_slab_t {
+    list_t link;          /**< link in the list of the slabs of the class that have free blocks */
+    uint64_t *free_p;     /**< head of the free blocks list of the slab */
+    uint32_t inuse;       /**< number of allocated blocks               */
+    uint32_t cls;         /**< slab class                               */
+} dirent_slab_t;
+
+typedef struct _dirent_slab_class_t {
+    list_t partial;       /**< slabs that have free blocks     */
+    uint64_t slab_count;  /**< number of slabs of the class    */
+    uint64_t free_count;  /**< number of free blocks           */
+} dirent_slab_class_t;
+
+/**
+ *  Get the slab of a block
+ */
+#define DIRENT_SLAB_OF_BLOCK(p) ((dirent_slab_t*) ((uintptr_t)(p) & ~((uintptr_t) DIRENT_SLAB_SIZE - 1)))
+
 /**
  * @ingroup DIRENT_MALLOC
  */
 extern uint64_t malloc_size; /**< cumulative allocated bytes */
 extern uint32_t malloc_size_tb[]; /**< @ingroup DIRENT_MALLOC per memory block statistics */
+extern uint64_t dirent_slab_arena_size; /**< @ingroup DIRENT_MALLOC bytes reserved by the slabs */
+extern uint64_t dirent_large_size; /**< @ingroup DIRENT_MALLOC bytes allocated outside of the slabs */
+extern dirent_slab_class_t dirent_slab_class_tb[]; /**< @ingroup DIRENT_MALLOC slab classes */
 
 extern int dirent_current_eid;  /**< current eid: used by dirent writeback cache */
 extern char *dirent_export_root_path[] ;  /**< pointer to the root path of the export */
 
+/**
+ @ingroup DIRENT_MALLOC
+ *  Allocate a new slab for a class and push its blocks in the free list
+
+ @param cls : slab class
+
+ @retval 0 on success
+ @retval -1 out of memory
+ */
+int dirent_slab_grow(int cls);
+/**
+ @ingroup DIRENT_MALLOC
+ *  Give back to the system a slab which blocks are all free
+
+ @param slab_p : the slab
+ */
+void dirent_slab_release(dirent_slab_t *slab_p);
+
 /*
  *__________________________________________________
  */
 /** @ingroup DIRENT_MALLOC
  *   Dirent_malloc:
- *  That API uses malloc(), by it also tracks the amount of memory
- requested by the application by appending the allocated size on
+ *  That API uses a slab (or malloc() for big blocks), but it also tracks the amount
+ of memory requested by the application by appending the allocated size on
  top of the allocated memory block
 
  @param size : requested size
@@ -106,12 +166,33 @@ extern char *dirent_export_root_path[] ;  /**< pointer to the root path of the e
 static inline void *dirent_malloc(int size, int line) {
     uint64_t *p;
     int idx;
-
-    idx = (size - 1) / 64 + 1;
+    int cls;
+
+    cls = (size + 8 - 1) / DIRENT_MEM_BLOCK_SZ;
+    if (cls < DIRENT_SLAB_MAX_CLASS) {
+        dirent_slab_class_t *class_p = &dirent_slab_class_tb[cls];
+        dirent_slab_t *slab_p;
+        if ((class_p->free_count == 0) && (dirent_slab_grow(cls) < 0)) {
+            printf("Out of memory at line %d\n", line);
+            return NULL;
+        }
+        slab_p = list_first_entry(&class_p->partial, dirent_slab_t, link);
+        p = slab_p->free_p;
+        slab_p->free_p = (uint64_t*) (uintptr_t) p[0];
+        slab_p->inuse++;
+        if (slab_p->free_p == NULL) list_remove(&slab_p->link);
+        class_p->free_count--;
+    } else {
+        p = memalign(32, size + 8);
+        if (p == NULL) {
+            printf("Out of memory at line %d\n", line);
+            return NULL;
+        }
+        dirent_large_size += (uint64_t) size;
+    }
+    idx = (size - 1) / DIRENT_MEM_BLOCK_SZ + 1;
+    if (idx >= DIRENT_MEM_MAX_IDX) idx = DIRENT_MEM_MAX_IDX - 1;
     malloc_size_tb[idx] += 1;
-    p = memalign(32,size + 8);
-    if (p == NULL )
-        printf("Out of memory at line %d\n", line);
     malloc_size += (uint64_t) size;
     p[0] = (uint64_t) size;
     return p + 1;
@@ -121,9 +202,9 @@ static inline void *dirent_malloc(int size, int line) {
  */
 /** @ingroup DIRENT_MALLOC
  *   Dirent_free:
- *  That API uses free(), by it also tracks the amount of memory
- used by the application by checking the allocated size on
- top of the allocated memory block
+ *  That API gives back the block to its slab class (or uses free() for big blocks),
+ but it also tracks the amount of memory used by the application by checking the
+ allocated size on top of the allocated memory block
 
  @param p : pointer to the memory block to release
  @param line : source line number of caller
@@ -133,19 +214,44 @@ static inline void *dirent_malloc(int size, int line) {
 static inline void dirent_free(uint64_t *p, int line) {
     uint64_t size;
     int idx;
+    int cls;
 
     p -= 1;
     size = *p;
-    idx = (size - 1) / 64 + 1;
+    idx = (size - 1) / DIRENT_MEM_BLOCK_SZ + 1;
+    if (idx >= DIRENT_MEM_MAX_IDX) idx = DIRENT_MEM_MAX_IDX - 1;
     malloc_size_tb[idx] -= 1;
     malloc_size -= size;
+    cls = (size + 8 - 1) / DIRENT_MEM_BLOCK_SZ;
+    if (cls < DIRENT_SLAB_MAX_CLASS) {
+        dirent_slab_class_t *class_p = &dirent_slab_class_tb[cls];
+        dirent_slab_t *slab_p = DIRENT_SLAB_OF_BLOCK(p);
+        if (slab_p->free_p == NULL) list_push_front(&class_p->partial, &slab_p->link);
+        p[0] = (uint64_t) (uintptr_t) slab_p->free_p;
+        slab_p->free_p = p;
+        slab_p->inuse--;
+        class_p->free_count++;
+        if (slab_p->inuse == 0) dirent_slab_release(slab_p);
+        return;
+    }
+    dirent_large_size -= size;
     free(p);
 }
+/*
+ *__________________________________________________
+ */
+/** @ingroup DIRENT_MALLOC
+ *  Get the size requested for a block allocated with dirent_malloc()
 
-/**
- *  Memory statistics
+ @param p : pointer to the memory block
+
+ @retval size of the block in bytes
  */
-#define DIRENT_MEM_MAX_IDX  32
+static inline uint64_t dirent_mem_block_size(void *p) {
+    if (p == NULL) return 0;
+    return ((uint64_t*) p)[-1];
+}
+
 /*
  *__________________________________________________
  */
@@ -772,7 +878,11 @@ typedef struct _mdirents_cache_entry_t {
     uint8_t  *bucket_safe_bitmap_p; /**< only allocated for root entry */
     uint32_t hash_entry_full :1; /**< assert to 1 when all the entries of the parent have been allocated  */
     uint32_t root_updated_requested :1; /**< that bit is assert when root cache entry must be re-written */
-    uint32_t filler0 :30; /**< for future usage */
+    uint32_t cache_hot :1; /**< level 0 cache: assert to 1 when the entry is in the hot list */
+    uint32_t cache_referenced :1; /**< level 0 cache: assert to 1 when the entry has been re-used out of its correlated period */
+    uint32_t filler0 :28; /**< for future usage */
+    uint32_t cache_access_time; /**< level 0 cache: time of the last access in seconds */
+    uint64_t cache_access_stamp; /**< level 0 cache: logical clock value of the last access */
     uint8_t name_entry_array_btmap_presence[MDIRENTS_NAME_ARRAY_BITMAP_BYTE_MAX]; /**< bitmap of the name entry array presence: each array can contain up to 32 chunks  */
     uint8_t name_entry_array_btmap_wr_req[MDIRENTS_NAME_ARRAY_BITMAP_BYTE_MAX]; /**< bitmap of the name entry array that needs to be re-write on disk  */
 
@@ -3251,6 +3361,56 @@ mdirents_cache_entry_t *dirent_cache_print_bucket_list(
  @retval 0 on success
  */
 int dirent_cache_release_entry(mdirents_cache_entry_t *dirent_entry_p);
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Compute the memory used by a dirent cache entry including the memory of
+ *  its collision dirent cache entries
+
+ @param dirent_entry_p : pointer to the dirent cache entry
+
+ @retval memory size in bytes
+ */
+uint64_t dirent_cache_entry_mem_size(mdirents_cache_entry_t *dirent_entry_p);
+/*
+ **______________________________________________________________________________
+ */
+/**
+ *  Set the memory budget of the level 0 dirent cache
+
+ @param size : memory budget in bytes (0: no budget, only the number of entries is bounded)
+
+ @retval none
+ */
+void dirent_cache_level0_set_memory_budget(uint64_t size);
+/**
+ *  Start a new directory request: the entries of the level 0 cache accessed by
+ *  the request cannot be released before the next request starts
+
+ @retval none
+ */
+void dirent_cache_level0_request_start();
+/**
+ * Walk the root dirent files of the level 0 cache (hot entries first, most recently used first)
+ *
+ * @param cbk : callback called for each root dirent file (return != 0 to stop the walk)
+ * @param param : opaque parameter given to the callback
+ *
+ * @retval number of root dirent files walked through
+ */
+int dirent_cache_level0_foreach(int (*cbk)(fid_t fid, int root_idx, void *param), void *param);
+/**
+ * Load a root dirent file in the level 0 cache if it is not already there
+ *
+ * @param root_idx_bitmap_p : pointer to the root idx bitmap of the directory
+ * @param dir_fd : file descriptor of the directory
+ * @param fid_parent : fid of the directory
+ * @param root_idx : index of the root dirent file
+ *
+ * @retval 1 loaded, 0 already cached or not existing, -1 error
+ */
+int dirent_cache_prefetch_root_entry(void *root_idx_bitmap_p, int dir_fd, fid_t fid_parent, int root_idx);
 /**
  *___________________________________________________________________________
 
@@ -3574,6 +3734,12 @@ int list_mdirentries(void *root_idx_bitmap_p,int dir_fd, fid_t fid_parent, child
         uint64_t *cookie, uint8_t * eof);
 
 int list_mdirentries2(void *root_idx_bitmap_p,int dir_fd, fid_t fid_parent_in, char *buf_readdir_in, uint64_t *cookie, uint8_t * eof,ext_mattr_t *parent);
+/**
+ * Drop the readdir cursors of a directory (its content has changed)
+ *
+ * @param fid: fid of the directory
+ */
+void dirent_readdir_cursor_invalidate(fid_t fid);
 /*
  *___________________________________________________________________
  DIRENT CACHE  API
@@ -3840,10 +4006,12 @@ void dirent_file_repair_stats_print();
  **______________________________________________________________________________
 */    
 
-#define DIRENT_CACHE_MAX_ENTRY   4096
+#define DIRENT_CACHE_MAX_ENTRY   4096        /**< default number of entries (see export_dirent_wbcache_entries) */
+#define DIRENT_CACHE_MAX_ENTRY_LIMIT (1024*1024) /**< must remain below DIRENT_WBCACHE_FD_MASK */
 #define DIRENT_CACHE_MAX_CHUNK   16
 #define DIRENT_MAX_NAME 32
 #define DIRENT_WBCACHE_FD_MASK   0x4000000   /**< indicates that the fd comes from cache */
+#define DIRENT_WBCACHE_RD_FD_MASK 0x8000000  /**< indicates that the fd is a read through the cache */
 
 typedef struct _dirent_chunk_cache_t
 {
@@ -3873,6 +4041,10 @@ typedef struct _dirent_writeback_entry_t
      */
      uint32_t  wr_cpt;   /**< incremented on each write / clear when synced   */
      uint32_t  size;     /**< size of the block */
+     uint32_t  header_alloc_size; /**< allocated size of the header buffer */
+     uint32_t  dirty_bitmap;      /**< one bit per chunk with pending write */
+     int       rd_fd;    /**< file descriptor of a read through the cache (-1: none) */
+     int       rd_busy;  /**< a read through the cache is in progress */
      char *dirent_header;
      dirent_chunk_cache_t  chunk[DIRENT_CACHE_MAX_CHUNK];
 } dirent_writeback_entry_t;
@@ -3882,6 +4054,7 @@ typedef struct _dirent_writeback_entry_t
 ** pointer to the dirent write back cache
 */
 extern dirent_writeback_entry_t   *dirent_writeback_cache_p ;
+extern int dirent_wbcache_entry_count;
 extern int dirent_writeback_cache_enable;
 extern int dirent_writeback_cache_initialized;
 extern uint64_t dirent_wbcache_hit_counter;
@@ -3891,6 +4064,13 @@ extern uint64_t dirent_wb_write_count;
 extern uint64_t dirent_wb_write_chunk_count;  /**< incremented each time a chunk need to be flushed for making some room */
 extern uint64_t dirent_wbcache_flush_counter;
 extern uint64_t dirent_wbcache_invalidate_counter;
+extern uint64_t dirent_wbcache_read_hit_counter;
+extern uint64_t dirent_wbcache_read_flush_counter;
+extern uint64_t dirent_wb_flush_segment_count;
+extern uint64_t dirent_wb_flush_syscall_count;
+extern uint64_t dirent_wb_flush_count;
+extern uint64_t dirent_wb_flush_time_us;
+extern uint64_t dirent_wb_flush_max_time_us;
 
 /**
 *____________________________________________________________
@@ -3898,7 +4078,7 @@ extern uint64_t dirent_wbcache_invalidate_counter;
 static inline char *dirent_wbcache_display_stats(char *pChar) {
     pChar+=sprintf(pChar,"WriteBack cache statistics:\n");
     pChar+=sprintf(pChar,"state          :%s\n",(dirent_writeback_cache_enable==0)?"Disabled":"Enabled");
-    pChar+=sprintf(pChar,"NB entries     :%d\n",DIRENT_CACHE_MAX_ENTRY);
+    pChar+=sprintf(pChar,"NB entries     :%d\n",dirent_wbcache_entry_count);
     pChar+=sprintf(pChar,"hit/miss/flush : %llu/%llu/%llu\n",
             (long long unsigned int) dirent_wbcache_hit_counter,
             (long long unsigned int) dirent_wbcache_miss_counter,
@@ -3907,6 +4087,23 @@ static inline char *dirent_wbcache_display_stats(char *pChar) {
     pChar+=sprintf(pChar,"invalidate     : %llu\n",
             (long long unsigned int) dirent_wbcache_invalidate_counter
 	    );
+    pChar+=sprintf(pChar,"read (cache/flush) : %llu/%llu\n",
+            (long long unsigned int) dirent_wbcache_read_hit_counter,
+            (long long unsigned int) dirent_wbcache_read_flush_counter
+	    );
+    pChar+=sprintf(pChar,"flush (count/segments/writes) : %llu/%llu/%llu\n",
+            (long long unsigned int) dirent_wb_flush_count,
+            (long long unsigned int) dirent_wb_flush_segment_count,
+            (long long unsigned int) dirent_wb_flush_syscall_count
+	    );
+    pChar+=sprintf(pChar,"flush coalescing ratio : %llu.%02llu segments per write\n",
+            (long long unsigned int) (dirent_wb_flush_syscall_count?dirent_wb_flush_segment_count/dirent_wb_flush_syscall_count:0),
+            (long long unsigned int) (dirent_wb_flush_syscall_count?(dirent_wb_flush_segment_count*100/dirent_wb_flush_syscall_count)%100:0)
+	    );
+    pChar+=sprintf(pChar,"flush latency (avg/max) : %llu/%llu us\n",
+            (long long unsigned int) (dirent_wb_flush_count?dirent_wb_flush_time_us/dirent_wb_flush_count:0),
+            (long long unsigned int) dirent_wb_flush_max_time_us
+	    );
     pChar+=sprintf(pChar,"total Write : memory %llu MBytes (%llu Bytes) requests %llu ejected chunks %llu\n\n",
             (long long unsigned int) dirent_wb_cache_write_bytes_count / (1024*1024),
             (long long unsigned int) dirent_wb_cache_write_bytes_count,
@@ -3945,6 +4142,47 @@ int dirent_wbcache_open(int fd_dir,int fd,int eid,char *pathname,fid_t dir_fid,i
    @retval < 0 : error see errno for details
 */
 int dirent_wbcache_write(int fd,void *buf,size_t count,off_t offset);
+/**
+*____________________________________________________________
+*/
+/**
+*  open a dirent file for reading: when the file has some pending writes
+   in the write back cache the reads are served from the cache
+
+   @param eid : export identifier
+   @param pathname : local pathname of the dirent file
+   @param dir_fid : fid of the directory
+   @param flags : opening flags
+   @param mode : mode
+   
+   @retval >= 0 : file descriptor (DIRENT_WBCACHE_RD_FD_MASK set when read through the cache)
+   @retval < 0 : error see errno for details
+*/
+int dirent_wbcache_open_read(int eid,char *pathname,fid_t dir_fid,int flags,mode_t mode);
+/**
+*____________________________________________________________
+*/
+/**
+*  read a dirent file through the write back cache
+
+   @param idx : index of the cache entry
+   @param buf: buffer to fill
+   @param count : length to read
+   @param offset: offset within the file
+   
+   @retval >= 0 : number of bytes read
+   @retval < 0 : error see errno for details
+*/
+ssize_t dirent_wbcache_read(int idx,void *buf,size_t count,off_t offset);
+/**
+*____________________________________________________________
+*/
+/**
+*  end of a read through the write back cache
+
+   @param idx : index of the cache entry
+*/
+int dirent_wbcache_close_read(int idx);
 
 /**
 *____________________________________________________________
@@ -4045,6 +4283,13 @@ static inline ssize_t dirent_pread(int fd, void *buf, size_t count,
 #if DIRENT_NO_DISK
     return count;
 #else
+    /*
+    ** check if the fd is a read through the writeback cache
+    */
+    if (fd & DIRENT_WBCACHE_RD_FD_MASK)
+    {
+      return dirent_wbcache_read(fd &(~DIRENT_WBCACHE_RD_FD_MASK),buf, count, offset);
+    }
     return pread(fd, buf, count, offset);
 #endif
 }
@@ -4182,9 +4427,9 @@ static inline int dirent_openat_read(int dirfd, const char *pathname, int flags,
   if (dirent_writeback_cache_enable != 0)
   {
     /*
-    ** check if the write back cachemust be flushed
+    ** the pending writes of the write back cache are read from the cache
     */   
-    dirent_wbcache_check_flush_on_read(dirent_current_eid,(char *)pathname,root_idx,dir_fid);
+    return dirent_wbcache_open_read(dirent_current_eid,(char *)pathname,dir_fid,flags,mode);
   }
   mdirent_resolve_path(dir_fid,(char*)pathname,path);
   fd = open(path,flags,mode);
@@ -4213,6 +4458,11 @@ static inline int dirent_close(int fd)
       fd  = fd &(~DIRENT_WBCACHE_FD_MASK);
       return dirent_wbcache_close(fd);
     }
+    if (fd& DIRENT_WBCACHE_RD_FD_MASK)
+    {
+      fd  = fd &(~DIRENT_WBCACHE_RD_FD_MASK);
+      return dirent_wbcache_close_read(fd);
+    }
     /*
     ** the write back cache was not used
     */
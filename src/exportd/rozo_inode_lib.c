@@ -746,6 +746,7 @@ int list_mdirentries_internal(void *root_idx_bitmap_p,int dir_fd, fid_t fid_pare
    dirent_set_root_idx_bitmap_ptr(root_idx_bitmap_p);
 
     dirent_readdir_stats_call_count++;
+    dirent_cache_level0_request_start();
     /*
      ** load up the cookie to figure out where to start the read
      */
@@ -8,6 +8,7 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/file.h>
 #include <getopt.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -22,6 +23,7 @@
 #include "econfig.h"
 #include "rozofs/common/log.h"
 #include "rozofs/rozofs_srv.h"
+#include "export_dirty_log_api.h"
 
 #define ALLRIGHTS 0777
 static rbs_file_type_e   file_type = rbs_file_type_all;
@@ -68,6 +70,7 @@ typedef struct _sid_one_info_t {
 typedef struct _sid_info_t {
   sid_one_info_t nominal;
   sid_one_info_t spare;
+  int            dirty_overflow; /**< the dirty log is incomplete: list every file */
 } sid_info_t;
 
 /*
@@ -93,6 +96,7 @@ int     nb_requested_vid = 0;
 uint8_t requested_vid[256] = {0};
 
 int debug = 0;
+int dirty = 0;
 
 uint64_t total=0;
 int      entry_size;
@@ -248,6 +252,10 @@ int rozofs_visit(void *exportd,void *inode_attr_p,void *p) {
       sid = sid_tab[i]-1;
       pSid = (*pCid)[sid];
       if (pSid == NULL) continue;
+      /*
+      ** Incremental rebuild: only the storages which dirty log is incomplete
+      */
+      if ((dirty) && (pSid->dirty_overflow == 0)) continue;
 
       memset(&entry,0,entry_size);
       memcpy(entry.fid,inode_p->s.attrs.fid,sizeof(fid_t));
@@ -292,6 +300,194 @@ int rozofs_visit(void *exportd,void *inode_attr_p,void *p) {
   return 0;
 }
 
+/*
+**_______________________________________________________________________
+*/
+/**
+*   Compare 2 dirty log records on their FID and then their start offset
+*/
+static int rbs_dirty_rec_compare(const void * a, const void * b) {
+  const export_dirty_rec_t * ra = a;
+  const export_dirty_rec_t * rb = b;
+  int ret;
+
+  ret = memcmp(ra->fid, rb->fid, sizeof(fid_t));
+  if (ret != 0) return ret;
+  if (ra->off_start < rb->off_start) return -1;
+  if (ra->off_start > rb->off_start) return 1;
+  return 0;
+}
+/*
+**_______________________________________________________________________
+*/
+/**
+*   Write in the nominal job lists of a logical storage the files
+    recorded in its dirty log, and empty the dirty log.
+    
+    Several records of the same FID are merged in a single entry
+    covering all their ranges.
+
+    When the exportd has marked the dirty log as incomplete, the log is
+    emptied and the logical storage is flagged so that every one of its
+    files is listed. The marker is removed before the files are scanned,
+    so a later overflow sets it again.
+
+   @param root: root path of the export
+   @param cid: cluster identifier (starting from 0)
+   @param sid: logical storage identifier (starting from 0)
+   @param pSid: logical storage information
+   
+   @retval 1 when every file of the logical storage must be listed
+   @retval 0 otherwise
+*/
+static int rbs_dirty_list(char * root, int cid, int sid, sid_info_t * pSid) {
+  char                 path[ROZOFS_PATH_MAX];
+  int                  fd;
+  struct stat          st;
+  export_dirty_rec_t * recs = NULL;
+  int                  nb;
+  int                  i;
+  int                  j;
+  int                  job;
+  uint64_t             bbytes;
+  sid_one_info_t     * pOne = &pSid->nominal;
+
+  pSid->dirty_overflow = 0;
+  /*
+  ** Some records have been lost: the log is incomplete
+  */
+  export_dirty_log_overflow_path(root, cid+1, sid+1, path);
+  if (access(path, F_OK) == 0) {
+    warning("cid %d sid %d dirty log is incomplete: every file is listed",cid+1,sid+1);
+    pSid->dirty_overflow = 1;
+    if (unlink(path) < 0) {
+      severe("unlink(%s) %s",path,strerror(errno));
+    }
+  }
+
+  export_dirty_log_path(root, cid+1, sid+1, path);
+  
+  fd = open(path, O_RDWR);
+  if (fd < 0) {
+    if (errno != ENOENT) severe("open(%s) %s",path,strerror(errno));
+    return pSid->dirty_overflow;
+  }
+  /*
+  ** The exportd appends to the log under the same lock
+  */
+  if (flock(fd, LOCK_EX) < 0) {
+    severe("flock(%s) %s",path,strerror(errno));
+    close(fd);
+    return pSid->dirty_overflow;
+  }
+  /*
+  ** Every file is listed: the records are useless
+  */
+  if (pSid->dirty_overflow) goto truncate;
+
+  if (fstat(fd, &st) < 0) {
+    severe("fstat(%s) %s",path,strerror(errno));
+    goto out;
+  }
+  nb = st.st_size / sizeof(export_dirty_rec_t);
+  if (nb == 0) goto out;
+
+  recs = malloc(nb * sizeof(export_dirty_rec_t));
+  if (recs == NULL) {
+    severe("malloc(%d records) %s",nb,strerror(errno));
+    goto out;
+  }
+  if (pread(fd, recs, nb * sizeof(export_dirty_rec_t), 0) != nb * sizeof(export_dirty_rec_t)) {
+    severe("pread(%s) %s",path,strerror(errno));
+    goto out;
+  }
+  qsort(recs, nb, sizeof(export_dirty_rec_t), rbs_dirty_rec_compare);
+
+  i = 0;
+  while (i < nb) {
+    rozofs_rebuild_entry_file_t entry;
+    uint64_t                    off_end = recs[i].off_end;
+
+    /*
+    ** Merge the ranges of the same FID
+    */
+    for (j = i+1; j < nb; j++) {
+      if (memcmp(recs[i].fid, recs[j].fid, sizeof(fid_t)) != 0) break;
+      if (recs[j].off_end > off_end) off_end = recs[j].off_end;
+    }
+
+    memset(&entry,0,entry_size);
+    memcpy(entry.fid,recs[i].fid,sizeof(fid_t));
+    entry.todo        = 1;
+    entry.layout      = recs[i].layout;
+    entry.bsize       = recs[i].bsize;
+    bbytes            = ROZOFS_BSIZE_BYTES(entry.bsize);
+    entry.block_start = recs[i].off_start / bbytes;
+    if ((off_end == EXPORT_DIRTY_LOG_WHOLE_FILE) || (off_end == 0)) {
+      entry.block_end = -1;
+    }
+    else {
+      entry.block_end = (off_end - 1) / bbytes;
+    }
+    memcpy(entry.dist_set_current, recs[i].dist_set, rozofs_safe);
+
+    job = get_job_list_index(pOne);
+    if (write(pOne->job[job].fd,&entry,entry_size) < entry_size) {
+      severe("write(cid %d sid %d job %d) %s\n", cid+1, sid+1, job, strerror(errno));
+    }
+    else {
+      TRACE("-> dirty blocks %u..%u added to cid %d sid %d job %d\n",
+            entry.block_start, entry.block_end, cid+1, sid+1, job);
+      pOne->job[job].size += (off_end == EXPORT_DIRTY_LOG_WHOLE_FILE) ? bbytes : (off_end - recs[i].off_start);
+    }
+    pOne->count++;
+    pOne->size += (off_end == EXPORT_DIRTY_LOG_WHOLE_FILE) ? bbytes : (off_end - recs[i].off_start);
+    total++;
+    i = j;
+  }
+  
+  /*
+  ** The records are now in the job lists
+  */
+truncate:
+  if (ftruncate(fd, 0) < 0) {
+    severe("ftruncate(%s) %s",path,strerror(errno));
+  }
+
+out:
+  if (recs) free(recs);
+  flock(fd, LOCK_UN);
+  close(fd);
+  return pSid->dirty_overflow;
+}
+/*
+**_______________________________________________________________________
+*/
+/**
+*   Build the job lists of an export from the dirty logs of the
+    requested logical storages
+
+   @param root: root path of the export
+   
+   @retval the number of logical storages which every file must be listed
+*/
+static int rbs_dirty_list_export(char * root) {
+  int          cid;
+  int          sid;
+  sid_tbl_t  * pCid;
+  int          overflow = 0;
+
+  for (cid = 0; cid < ROZOFS_CLUSTERS_MAX; cid++) {
+    pCid = cid_tbl[cid];
+    if (pCid == NULL) continue;
+    for (sid = 0; sid < SID_MAX; sid++) {
+      if ((*pCid)[sid] == NULL) continue;
+      overflow += rbs_dirty_list(root, cid, sid, (*pCid)[sid]);
+    }
+  }
+  return overflow;
+}
+
 /*
 **_______________________________________________________________________
 */
@@ -574,6 +770,7 @@ void usage(char * fmt, ...) {
   printf("\t-c,--config     <cfgFile>    optionnal configuration file name.\n");
   printf("\t-s,--spare                   only list spare files.\n");
   printf("\t-n,--nominal                 only list nominal files.\n");
+  printf("\t-D,--dirty                   only list the files of the dirty logs.\n");
   printf("\t-d,--debug                   display debugging information.\n");
 
   if (fmt) exit(EXIT_FAILURE);
@@ -602,6 +799,7 @@ int main(int argc, char *argv[]) {
       {"spare", no_argument, 0, 's'},
       {"nominal", no_argument, 0, 'n'},
       {"debug", no_argument, 0, 'd'},
+      {"dirty", no_argument, 0, 'D'},
       {0, 0, 0, 0}
   };
 
@@ -615,7 +813,7 @@ int main(int argc, char *argv[]) {
   while (1) {
 
       int option_index = 0;
-      c = getopt_long(argc, argv, "hdv:i:p:r:c:E:sn", long_options, &option_index);
+      c = getopt_long(argc, argv, "hdDv:i:p:r:c:E:sn", long_options, &option_index);
 
       if (c == -1)
           break;
@@ -644,6 +842,10 @@ int main(int argc, char *argv[]) {
           debug = 1;
           break;		  			  			  
 
+        case 'D':
+          dirty = 1;
+          break;		  			  			  
+
         case 'r':
           if (sscanf(optarg,"%d",&rebuildRef)!= 1) {
             usage("Bad -r value %s\n",optarg);
@@ -777,6 +979,19 @@ int main(int argc, char *argv[]) {
     
     entry_size =  sizeof(rozofs_rebuild_entry_file_t) - ROZOFS_SAFE_MAX + rozofs_safe;
     
+    /*
+    ** Incremental rebuild : only the files written while the storages
+    ** were unreachable are listed. Spare files are not concerned.
+    ** Every file of the storages which dirty log is incomplete is listed.
+    */
+    if (dirty) {
+      if ((file_type == rbs_file_type_spare) || (rbs_dirty_list_export(econfig->root) == 0)) {
+        free(rozofs_export_p);
+        lv2_cache_release (&cache);
+        continue;
+      }
+    }
+
     rz_scan_all_inodes(rozofs_export_p,ROZOFS_REG,1,rozofs_visit,NULL,NULL,NULL);
     free(rozofs_export_p);
     
@@ -208,6 +208,10 @@ int georep_lbg_initialize(exportclt_t *exportclt ,unsigned long prog,
     client->lbg_id = north_lbg_create_af_inet("GEOREP",INADDR_ANY,0,my_list,ROZOFS_SOCK_FAMILY_EXPORT_NORTH,lbg_size,&af_inet_exportd_conf);
     if (client->lbg_id >= 0)
     {
+      /*
+      ** Compress the rpc messages toward the exportd when configured
+      */
+      if (common_config.geo_compress) north_lbg_set_compression(client->lbg_id,1);
       status = 0;
       if (port_num == 0) export_lbg_start_timer (exportclt);      
       return status;    
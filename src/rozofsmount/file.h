@@ -132,6 +132,7 @@ typedef struct file {
     int              file2create;     /**< assert to one on a write when the attributes indicates a file size of 0    */
     uint64_t         off_wr_start;    /**< geo replication :write offset start  */
     uint64_t         off_wr_end;      /**< geo replication :write offset end  */
+    uint16_t         wr_degraded;     /**< nominal storages that have missed a write since last write block */
     int              pending_read_count; 
     int              open_flags;     /**< flags given at opening time */
 } file_t;
@@ -158,6 +159,7 @@ static inline void rozofs_geo_write_reset(file_t *file)
 {
     file->off_wr_start = 0xFFFFFFFFFFFFFFFF;
     file->off_wr_end = 0;
+    file->wr_degraded = 0;
 }
 
 /**
@@ -22,6 +22,7 @@
 
 #include <rozofs/rpc/eproto.h>
 #include <rozofs/rpc/storcli_proto.h>
+#include <rozofs/rpc/rozofs_xdr_fast.h>
 
 #include "rozofs_fuse_api.h"
 #include "rozofs_sharedmem.h"
@@ -175,7 +176,7 @@ static int read_buf_nb(void *buffer_p,file_t * f, uint64_t off, char *buf, uint3
     */
     f->buf_read_pending++;
     ret = rozofs_storcli_send_common(NULL,ROZOFS_TMR_GET(TMR_STORCLI_PROGRAM),STORCLI_PROGRAM, STORCLI_VERSION,
-                              STORCLI_READ,(xdrproc_t) xdr_storcli_read_arg_t,(void *)&args,
+                              STORCLI_READ,(xdrproc_t) rozofs_xdr_fast_storcli_read_arg_t,(void *)&args,
                               rozofs_ll_read_cbk,buffer_p,storcli_idx,f->fid); 
     if (ret < 0) goto error;
     
@@ -774,7 +775,7 @@ static int read_resize(void *buffer_p, ientry_t *ie)
   ** now initiates the transaction towards the remote end
   */
   ret = rozofs_storcli_send_common(NULL,ROZOFS_TMR_GET(TMR_STORCLI_PROGRAM),STORCLI_PROGRAM, STORCLI_VERSION,
-                                   STORCLI_READ,(xdrproc_t) xdr_storcli_read_arg_t,(void *)&args,
+                                   STORCLI_READ,(xdrproc_t) rozofs_xdr_fast_storcli_read_arg_t,(void *)&args,
                                    rozofs_resize_cbk,buffer_p,storcli_idx,ie->fid); 
   return ret;
 }
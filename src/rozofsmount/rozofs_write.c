@@ -21,6 +21,7 @@
 
 #include <rozofs/rpc/eproto.h>
 #include <rozofs/rpc/storcli_proto.h>
+#include <rozofs/rpc/rozofs_xdr_fast.h>
 
 #include "rozofs_fuse_api.h"
 #include "rozofs_modeblock_cache.h"
@@ -53,6 +54,7 @@ typedef struct _WRITE_FLUSH_STAT_T {
   uint64_t synchroneous;
   uint64_t synchroneous_success;
   uint64_t synchroneous_error;
+  uint64_t degraded;            /**< writes missed by some nominal storages */
 } WRITE_FLUSH_STAT_T;
 
 static WRITE_FLUSH_STAT_T write_flush_stat;
@@ -119,6 +121,7 @@ static void display_write_flush_stat(char * argv[], uint32_t tcpRef, void *bufRe
   SHOW_STAT_WRITE_FLUSH(synchroneous);
   SHOW_STAT_WRITE_FLUSH(synchroneous_success);
   SHOW_STAT_WRITE_FLUSH(synchroneous_error);    
+  SHOW_STAT_WRITE_FLUSH(degraded);    
   uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());  
 }  
 
@@ -1051,7 +1054,7 @@ static int64_t write_buf_nb(void *buffer_p,file_t * f, uint64_t off, const char
     */
     if (use_write_thread)
     {
-      ret = rozofs_storcli_wr_thread_send(STORCLI_WRITE,(void *)&args,(xdrproc_t) xdr_storcli_write_arg_no_data_t,
+      ret = rozofs_storcli_wr_thread_send(STORCLI_WRITE,(void *)&args,(xdrproc_t) rozofs_xdr_fast_storcli_write_arg_no_data_t,
                                   callback,buffer_p,
 			          storcli_idx,f->fid);
     
@@ -1061,7 +1064,7 @@ static int64_t write_buf_nb(void *buffer_p,file_t * f, uint64_t off, const char
     {
       ret = rozofs_storcli_send_common(NULL,ROZOFS_TMR_GET(TMR_STORCLI_PROGRAM),STORCLI_PROGRAM, STORCLI_VERSION,
                         	STORCLI_WRITE,
-				(shared_buf_idx!=-1)?(xdrproc_t) xdr_storcli_write_arg_no_data_t: (xdrproc_t)xdr_storcli_write_arg_t,
+				(shared_buf_idx!=-1)?(xdrproc_t) rozofs_xdr_fast_storcli_write_arg_no_data_t: (xdrproc_t)xdr_storcli_write_arg_t,
 				(void *)&args,
                         	callback,buffer_p,storcli_idx,f->fid); 
     }
@@ -1319,6 +1322,38 @@ out:
 /*
 **__________________________________________________________________
 */
+/*
+**__________________________________________________________________
+*/
+/**
+*  Get the nominal storages that have missed a write
+
+   The storcli appends to a write response the bitmap of the positions in
+   the distribution of the nominal storages that have not received their
+   projection. It is cumulated in the file context with the written range
+   and reported to the exportd by the next write block.
+
+   @param xdrs : XDR stream of the response, after the status
+   @param bufsize : length of the response
+   @param param : fuse context of the write
+   @param file : file context
+*/
+static inline void rozofs_write_get_degraded(XDR *xdrs, int bufsize, void *param, file_t *file)
+{
+   uint32_t degraded;
+   uint64_t buf_flush_offset;
+   uint32_t buf_flush_len;
+
+   if ((xdr_getpos(xdrs) + sizeof(uint32_t)) > bufsize) return;
+   if (xdr_uint32_t(xdrs,&degraded) != TRUE) return;
+   if (degraded == 0) return;
+
+   RESTORE_FUSE_PARAM(param,buf_flush_offset);
+   RESTORE_FUSE_PARAM(param,buf_flush_len);
+   file->wr_degraded |= degraded;
+   rozofs_geo_write_update(file,buf_flush_offset,buf_flush_len);
+   write_flush_stat.degraded++;
+}
 /**
 *  Call back function call upon a success rpc, timeout or any other rpc failure
 *
@@ -1428,6 +1463,7 @@ void rozofs_ll_write_cbk(void *this,void *param)
         xdr_free((xdrproc_t) decode_proc, (char *) &ret);    
         goto error;
     }
+    rozofs_write_get_degraded(&xdrs,bufsize,param,file);
     
     /*
     ** When a fuse response is expected send it
@@ -1816,6 +1852,7 @@ void rozofs_asynchronous_flush_cbk(void *this,void *param)
         xdr_free((xdrproc_t) decode_proc, (char *) &ret);    
         goto error;
     }
+    rozofs_write_get_degraded(&xdrs,bufsize,param,file);
     /*
     ** no error, so get the length of the data part
     */
@@ -1964,6 +2001,7 @@ void rozofs_ll_flush_cbk(void *this,void *param)
         xdr_free((xdrproc_t) decode_proc, (char *) &ret);    
         goto error;
     }
+    rozofs_write_get_degraded(&xdrs,bufsize,param,file);
     /*
     ** no error, so get the length of the data part
     */
@@ -2322,6 +2360,7 @@ void rozofs_ll_release_cbk(void *this,void *param)
         xdr_free((xdrproc_t) decode_proc, (char *) &ret);    
         goto error;
     }
+    rozofs_write_get_degraded(&xdrs,bufsize,param,file);
     /*
     ** no error, so get the length of the data part
     */
@@ -2665,6 +2704,7 @@ int export_force_write_block_asynchrone(void *fuse_ctx_p,  ientry_t *ientry, uin
     arg.arg_gw.offset = to; //buf_flush_offset;
     arg.arg_gw.geo_wr_start = from;
     arg.arg_gw.geo_wr_end   = to;
+    arg.arg_gw.dist         = 0;
     /*
     ** now initiates the transaction towards the remote end
     */
@@ -2879,6 +2919,7 @@ int export_write_block_asynchrone_retry(void *fuse_ctx_p, ientry_t *ie)
     arg.arg_gw.offset = ie->attrs.attrs.size; //buf_flush_offset;
     arg.arg_gw.geo_wr_start = 0;
     arg.arg_gw.geo_wr_end   = 0;
+    arg.arg_gw.dist         = 0;
     /*
     ** now initiates the transaction towards the remote end
     */
@@ -3000,6 +3041,7 @@ void rozofs_export_write_block_list_process()
 int export_write_block_asynchrone(void *fuse_ctx_p, file_t *file_p, sys_recv_pf_t recv_cbk) 
 {
     epgw_write_block_arg_t arg;
+    epgw_write_block2_arg_t arg2;
     int    ret;        
     uint64_t buf_flush_offset ;
     uint32_t buf_flush_len ;
@@ -3049,14 +3091,31 @@ int export_write_block_asynchrone(void *fuse_ctx_p, file_t *file_p, sys_recv_pf_
     arg.arg_gw.offset = ie->attrs.attrs.size; //buf_flush_offset;
     arg.arg_gw.geo_wr_start = file_p->off_wr_start;
     arg.arg_gw.geo_wr_end = file_p->off_wr_end;
+    arg.arg_gw.dist = 0;
     /*
     ** now initiates the transaction towards the remote end
     */
     
 #if 1
-    ret = rozofs_expgateway_send_routing_common(arg.arg_gw.eid,file_p->fid,EXPORT_PROGRAM, EXPORT_VERSION,
+    if (file_p->wr_degraded != 0)
+    {
+      /*
+      ** some nominal storages have missed a write: report them to the
+      ** exportd with the write block that carries their bitmap
+      */
+      arg2.hdr      = arg.hdr;
+      arg2.arg_gw   = arg.arg_gw;
+      arg2.degraded = file_p->wr_degraded;
+      ret = rozofs_expgateway_send_routing_common(arg.arg_gw.eid,file_p->fid,EXPORT_PROGRAM, EXPORT_VERSION,
+                              EP_WRITE_BLOCK2,(xdrproc_t) xdr_epgw_write_block2_arg_t,(void *)&arg2,
+                              recv_cbk,fuse_ctx_p); 
+    }
+    else
+    {
+      ret = rozofs_expgateway_send_routing_common(arg.arg_gw.eid,file_p->fid,EXPORT_PROGRAM, EXPORT_VERSION,
                               EP_WRITE_BLOCK,(xdrproc_t) xdr_epgw_write_block_arg_t,(void *)&arg,
                               recv_cbk,fuse_ctx_p); 
+    }
 #else
     ret = rozofs_export_send_common(&exportclt,EXPORT_PROGRAM, EXPORT_VERSION,
                               EP_WRITE_BLOCK,(xdrproc_t) xdr_epgw_write_block_arg_t,(void *)&arg,
@@ -3122,9 +3181,10 @@ void export_write_block_nb(void *fuse_ctx_p, file_t *file_p)
       ie->file_extend_pending = 1;
     }
     /*
-    ** check if we need to push the new size on metadata server
+    ** check if we need to push the new size on metadata server,
+    ** or to report to it a write missed by some storages
     */
-    if (ie->file_extend_pending == 1)
+    if ((ie->file_extend_pending == 1) || (file_p->wr_degraded != 0))
     {
        if ((rozofs_get_ticker_us()-ie->timestamp_wr_block) > rozofs_tmr_get(TMR_WR_BLOCK)*1000)
        {
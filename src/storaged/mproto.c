@@ -255,6 +255,45 @@ error:
 
     STOP_PROFILING(remove);
 }
+void mp_subthread_remove_bulk(void * pt, rozorpc_srv_ctx_t *req_ctx_p) {
+    mp_remove_bulk_arg_t         * args = (mp_remove_bulk_arg_t*) pt;
+    storage_t                    * st = 0;
+    static    mp_remove_bulk_ret_t ret;
+    
+    START_PROFILING(remove);
+    
+    /*
+    ** Use received buffer for the response
+    */
+    req_ctx_p->xmitBuf  = req_ctx_p->recv_buf;
+    req_ctx_p->recv_buf = NULL;
+
+    if (args->nb > MP_REMOVE_BULK_MAX) {
+      errno = EINVAL;
+      goto error;
+    }
+
+    if ((st = get_storage(args->cid, args->sid, req_ctx_p->socketRef)) == 0) {
+      goto error;
+    }
+
+    if (storaged_sub_thread_intf_send_req(MP_REMOVE_BULK,req_ctx_p,st,tic)==0) { 
+      return;
+    }
+    
+
+error:    
+    ret.status                       = MP_FAILURE;            
+    ret.mp_remove_bulk_ret_t_u.error = errno;
+    
+    rozorpc_srv_forward_reply(req_ctx_p,(char*)&ret); 
+    /*
+    ** release the context
+    */
+    rozorpc_srv_release_context(req_ctx_p);
+
+    STOP_PROFILING(remove);
+}
 void mp_subthread_list_bins_files(void * pt, rozorpc_srv_ctx_t *req_ctx_p) {
     mp_list_bins_files_arg_t * args = (mp_list_bins_files_arg_t*) pt;
     storage_t                * st = 0;
@@ -63,6 +63,8 @@ void mp_subthread_remove2(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 
 void mp_subthread_remove(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
 
+void mp_subthread_remove_bulk(void * pt, rozorpc_srv_ctx_t *req_ctx_p);
+
 void mp_subthread_list_bins_files(void * pt, rozorpc_srv_ctx_t *req_ctx_p);			      
 
 void mp_subthread_size(void * pt, rozorpc_srv_ctx_t *req_ctx_p);			      
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <errno.h>
 #include <malloc.h>
+#include <sys/time.h>
  
 #include <rozofs/rozofs.h>
 #include <rozofs/common/log.h>
@@ -37,6 +38,12 @@
 #include "rbs_sclient.h"
 
 uint64_t totalReadSize = 0;
+/*
+** Cumulated latency and count of the projection read requests.
+** Used by the list rebuilder to adapt its load to the storage response time.
+*/
+uint64_t rbs_read_latency_us = 0;
+uint64_t rbs_read_latency_count = 0;
 
 
 /** Get one storage connection for a given SID and given random value
@@ -219,6 +226,7 @@ int rbs_read_proj(sclient_t *storage, cid_t cid, sid_t sid, uint8_t stor_idx,
     uint64_t size;
     uint16_t rozofs_max_psize_in_msg = rozofs_get_max_psize_in_msg(layout,bsize);
     bin_t * bins = NULL;
+    struct timeval tv_start,tv_stop;
     DEBUG_FUNCTION;
     
     proj_ctx_p->nbBlocks = 0;
@@ -249,8 +257,13 @@ int rbs_read_proj(sclient_t *storage, cid_t cid, sid_t sid, uint8_t stor_idx,
     }
 
     // Read request
+    gettimeofday(&tv_start,NULL);
     ret = sclient_read_rbs(storage, cid, sid, layout, bsize, spare, dist_set, fid,
             first_block_idx, nb_blocks_2_read, nb_blocks_read, bins);
+    gettimeofday(&tv_stop,NULL);
+    __sync_fetch_and_add(&rbs_read_latency_us,
+                         (tv_stop.tv_sec-tv_start.tv_sec)*1000000ULL+tv_stop.tv_usec-tv_start.tv_usec);
+    __sync_fetch_and_add(&rbs_read_latency_count,1);
     // Error
     if (ret != 0) {
         proj_ctx_p->prj_state = PRJ_READ_ERROR;
@@ -271,7 +284,7 @@ int rbs_read_proj(sclient_t *storage, cid_t cid, sid_t sid, uint8_t stor_idx,
     
     *size_read += (proj_ctx_p->nbBlocks * rozofs_max_psize_in_msg);
 
-    totalReadSize += (proj_ctx_p->nbBlocks * rozofs_max_psize_in_msg);
+    __sync_fetch_and_add(&totalReadSize,proj_ctx_p->nbBlocks * rozofs_max_psize_in_msg);
     status = 0;
 out:
     return status;
@@ -284,7 +297,7 @@ typedef struct rbs_blocks_recv_ctx {
     uint8_t count; /**< number of response with the same nb. of blocks */
 } rbs_blocks_recv_ctx_t;
 
-rbs_blocks_recv_ctx_t rbs_blocks_recv_tb[ROZOFS_SAFE_MAX];
+static __thread rbs_blocks_recv_ctx_t rbs_blocks_recv_tb[ROZOFS_SAFE_MAX];
 
 static int rbs_read_proj_set(sclient_t **storages, int local_idx, uint8_t layout, uint32_t bsize, cid_t cid,
         sid_t dist_set[ROZOFS_SAFE_MAX], fid_t fid, bid_t first_block_idx,
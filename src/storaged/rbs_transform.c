@@ -25,14 +25,14 @@
 #include <rozofs/rozofs_srv.h>
 #include "rbs_transform.h"
 
-// Local variables
-rbs_timestamp_ctx_t rbs_timestamp_tb[ROZOFS_SAFE_MAX];
-uint8_t rbs_timestamp_next_free_idx;
-
-projection_t rbs_projections[ROZOFS_SAFE_MAX];
-angle_t rbs_angles[ROZOFS_SAFE_MAX];
-uint16_t rbs_psizes[ROZOFS_SAFE_MAX];
-uint8_t rbs_prj_idx_table[ROZOFS_SAFE_MAX];
+// Local variables: per thread since the list rebuilder runs several rebuild threads
+__thread rbs_timestamp_ctx_t rbs_timestamp_tb[ROZOFS_SAFE_MAX];
+__thread uint8_t rbs_timestamp_next_free_idx;
+
+__thread projection_t rbs_projections[ROZOFS_SAFE_MAX];
+__thread angle_t rbs_angles[ROZOFS_SAFE_MAX];
+__thread uint16_t rbs_psizes[ROZOFS_SAFE_MAX];
+__thread uint8_t rbs_prj_idx_table[ROZOFS_SAFE_MAX];
 
 int rbs_check_timestamp_tb(rbs_projection_ctx_t *prj_ctx_p, uint8_t layout, uint32_t bsize,
         uint32_t block_idx, uint8_t *prj_idx_tb_p, uint64_t *timestamp_p,
@@ -29,6 +29,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/statfs.h>
+#include <sys/uio.h>
 #include <inttypes.h>
 #include <glob.h>
 #include <fnmatch.h>
@@ -49,6 +50,7 @@
 #include "storio_device_mapping.h"
 #include "storio_device_mapping.h"
 #include "storio_crc32.h"
+#include "storage_hdrcache.h"
 
 
 int      re_enumration_required=0; 
@@ -563,6 +565,31 @@ int storage_write_header_file(storage_t * st, int dev, char * path, rozofs_stor_
   close(fd);
   return 0;
 }  
+/*
+** Take the stamp of a header file for the header cache
+   
+  @param st    : storage we are looking on
+  @param dev   : the device of the header file
+  @param spare : whether this storage is spare for this FID
+  @param fid   : the FID
+  @param stamp : where to return the stamp
+  
+  @retval 0 on success, -1 when the header file can not be stat'ed
+*/
+static inline int storage_hdrcache_take_stamp(storage_t * st, int dev, uint8_t spare, fid_t fid, 
+                                              storage_hdrcache_stamp_t * stamp) {
+  char        path[FILENAME_MAX];
+  struct stat buf;
+
+  storage_build_hdr_file_path(path, st->root, dev, spare, rozofs_storage_fid_slice(fid), fid);
+  if (stat(path, &buf) < 0) return -1;
+
+  stamp->device = dev;
+  stamp->ino    = buf.st_ino;
+  stamp->size   = buf.st_size;
+  stamp->mtime  = buf.st_mtim;
+  return 0;
+}
 /*
  ** Write a header/mapper file on every device
     This function writes the header file of the given FID on every
@@ -582,6 +609,8 @@ int storage_write_all_header_files(storage_t * st, fid_t fid, uint8_t spare, roz
   int                       storage_slice;
   char                      path[FILENAME_MAX];
   int                       result=0;
+  int                       stampDevice=-1;
+  storage_hdrcache_stamp_t  stamp;
   
   storage_slice = rozofs_storage_fid_slice(fid);
   
@@ -598,9 +627,22 @@ int storage_write_all_header_files(storage_t * st, fid_t fid, uint8_t spare, roz
                  
     if (storage_write_header_file(st,hdrDevice,path, hdr) == 0) {    
       //dbg("Header written on storage %d/%d device %d", st->cid, st->sid, hdrDevice);
+      if (result == 0) stampDevice = hdrDevice;
       result++;
     }
   }  
+  
+  /*
+  ** Keep the header cache in line with the disk
+  */
+  if (storage_hdrcache_enabled) {
+    if ((result) && (storage_hdrcache_take_stamp(st, stampDevice, spare, fid, &stamp) == 0)) {
+      storage_hdrcache_insert(st->cid, st->sid, spare, hdr, &stamp);
+    }
+    else {
+      storage_hdrcache_invalidate(st->cid, st->sid, spare, fid);
+    }
+  }
   return result;
 } 
    
@@ -905,7 +947,21 @@ STORAGE_READ_HDR_RESULT_E storage_read_header_file(storage_t                   *
   rozofs_storage_dev_info_t     devinfo[STORAGE_MAX_DEVICE_NB];
   rozofs_storage_dev_info_t   * pdevinfo;
   char                        * error;
+  storage_hdrcache_stamp_t      stamp;
+  storage_hdrcache_stamp_t      current;
   
+  /*
+  ** Look in the header cache first. The cached header is only valid 
+  ** while no other process has rewritten the header file it comes from
+  */
+  if (storage_hdrcache_read(st->cid, st->sid, spare, fid, hdr, &stamp)) {
+    if ((storage_hdrcache_take_stamp(st, stamp.device, spare, fid, &current) == 0)
+    &&  (storage_hdrcache_same_stamp(&stamp, &current))) {
+      return STORAGE_READ_HDR_OK;
+    }
+    storage_hdrcache_stale(st->cid, st->sid, spare, fid);
+  }
+
   memset(orderedIdx,0,sizeof(orderedIdx));
   memset(devinfo,0,sizeof(devinfo));
 
@@ -1117,6 +1173,10 @@ STORAGE_READ_HDR_RESULT_E storage_read_header_file(storage_t                   *
       }
     }
   }
+  if ((storage_hdrcache_enabled) 
+  &&  (storage_hdrcache_take_stamp(st, devinfo[orderedIdx[idx]].absoluteIdx, spare, fid, &stamp) == 0)) {
+    storage_hdrcache_insert(st->cid, st->sid, spare, hdr, &stamp);
+  }
   return STORAGE_READ_HDR_OK;	
 }
 /*
@@ -1688,10 +1748,259 @@ int storage_restore_chunk(storage_t * st, storio_device_mapping_t * fidCtx, fid_
     if (result == 0) return -1;   
     return 0;
 }
-int storage_write_chunk(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t layout, uint32_t bsize, sid_t * dist_set,
-        uint8_t spare, fid_t fid, uint8_t chunk, bid_t bid, uint32_t nb_proj, uint8_t version,
-        uint64_t *file_size, const bin_t * bins, int * is_fid_faulty) {
+/*
+**______________________________________________________________________________
+**
+** Direct I/O on the bins files
+**
+** The projections are not aligned on the device blocks on disk, so the
+** direct I/O goes through a per thread aligned bounce buffer covering the
+** aligned range around the projections. A write first reads the partial
+** device blocks at both ends of the range, and restores the file size when
+** the aligned write has extended it.
+**______________________________________________________________________________
+*/
+#define STORAGE_DIRECT_IO_ALIGN     4096
+#define STORAGE_DIRECT_IO_MAX_BUF   (8*1024*1024)
+
+int                  storage_direct_io_mode = STORAGE_DIRECT_IO_OFF;
+__thread int         storage_io_is_rebuild = 0;
+static __thread char   * storage_direct_buf = NULL;
+static __thread size_t   storage_direct_buf_size = 0;
+
+storage_direct_io_stat_t storage_direct_io_stat = {0};
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Whether the current bins file I/O must bypass the page cache
+*/
+static inline int storage_use_direct_io(void) {
+  if (storage_direct_io_mode == STORAGE_DIRECT_IO_ALL) return 1;
+  if ((storage_direct_io_mode == STORAGE_DIRECT_IO_REBUILD) && (storage_io_is_rebuild)) return 1;
+  return 0;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Get the aligned bounce buffer of the thread
+
+   @param size: the needed size
+   
+   @retval the buffer or NULL when it can not be allocated
+*/
+static inline char * storage_direct_io_buffer(size_t size) {
+  void * buf;
+
+  if (size <= storage_direct_buf_size) return storage_direct_buf;
+  if (size > STORAGE_DIRECT_IO_MAX_BUF) return NULL;
+  
+  size = (size + (1024*1024) - 1) & ~((size_t)(1024*1024) - 1);
+  if (posix_memalign(&buf, STORAGE_DIRECT_IO_ALIGN, size) != 0) return NULL;
+  if (storage_direct_buf != NULL) free(storage_direct_buf);
+  storage_direct_buf      = buf;
+  storage_direct_buf_size = size;
+  return buf;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Open a bins file for direct I/O when required
+
+   When the file system does not support O_DIRECT, the file is opened
+   for buffered I/O.
+
+   @param path: the bins file path
+   @param flags: the open flags
+   @param mode: the creation mode
+   @param direct: returns whether the file has been opened for direct I/O
+   
+   @retval the file descriptor or -1
+*/
+static inline int storage_open_bins(char * path, int flags, mode_t mode, int * direct) {
+  int fd;
+
+  *direct = 0;
+  if (storage_use_direct_io()) {
+    fd = open(path, flags | O_DIRECT, mode);
+    if (fd >= 0) {
+      *direct = 1;
+      return fd;
+    }  
+    if (errno != EINVAL) return fd;
+    __sync_fetch_and_add(&storage_direct_io_stat.unsupported,1);
+  }
+  return open(path, flags, mode);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Buffered read or write of a vector on a file opened with O_DIRECT,
+   when the aligned bounce buffer can not be used. O_DIRECT is cleared
+   on the file for the duration of the I/O, since the vector is not
+   aligned. The file descriptor is private to the request.
+
+   @param fd: file opened with O_DIRECT
+   @param write: 1 for a write, 0 for a read
+   @param vector: the vector
+   @param count: number of vector entries
+   @param offset: offset in the file
+   
+   @retval the length read or written or -1
+*/
+static ssize_t storage_direct_fallback(int fd, int write, struct iovec * vector, int count, off_t offset) {
+  ssize_t  ret;
+  int      flags;
+  int      save_errno;
+
+  __sync_fetch_and_add(&storage_direct_io_stat.fallback,1);
+
+  flags = fcntl(fd, F_GETFL);
+  if (flags < 0) return -1;
+  if (fcntl(fd, F_SETFL, flags & ~O_DIRECT) < 0) return -1;
+
+  if (write) ret = pwritev(fd, vector, count, offset);
+  else       ret = preadv(fd, vector, count, offset);
+
+  save_errno = errno;
+  if (fcntl(fd, F_SETFL, flags) < 0) {
+    severe("fcntl(O_DIRECT) %s",strerror(errno));
+  }
+  errno = save_errno;
+  return ret;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Direct read of a range of a bins file into a vector
+
+   @param fd: file opened with O_DIRECT
+   @param vector: where to scatter the data
+   @param count: number of vector entries
+   @param offset: offset in the file
+   @param len: length to read (sum of the vector lengths)
+   
+   @retval the length read or -1
+*/
+static ssize_t storage_direct_preadv(int fd, struct iovec * vector, int count, off_t offset, size_t len) {
+  off_t    start = offset & ~((off_t)STORAGE_DIRECT_IO_ALIGN-1);
+  off_t    end   = (offset + len + STORAGE_DIRECT_IO_ALIGN - 1) & ~((off_t)STORAGE_DIRECT_IO_ALIGN-1);
+  char   * buf;
+  char   * pData;
+  ssize_t  nb_read;
+  size_t   left;
+  int      i;
+
+  buf = storage_direct_io_buffer(end-start);
+  if (buf == NULL) {
+    return storage_direct_fallback(fd, 0, vector, count, offset);
+  }  
+    
+  nb_read = pread(fd, buf, end-start, start);
+  if (nb_read < 0) return -1;
+  __sync_fetch_and_add(&storage_direct_io_stat.read,1);
+  
+  /*
+  ** Useful length
+  */
+  nb_read -= (offset - start);
+  if (nb_read <= 0) return 0;
+  if (nb_read > len) nb_read = len;
+  
+  pData = buf + (offset - start);
+  left  = nb_read;
+  for (i=0; (i<count) && (left>0); i++) {
+    size_t sz = (vector[i].iov_len < left) ? vector[i].iov_len : left;
+    memcpy(vector[i].iov_base, pData, sz);
+    pData += sz;
+    left  -= sz;
+  }
+  return nb_read;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Direct write of a vector in a range of a bins file
+
+   @param fd: file opened with O_DIRECT
+   @param vector: the data to write
+   @param count: number of vector entries
+   @param offset: offset in the file
+   @param len: length to write (sum of the vector lengths)
+   
+   @retval the length written or -1
+*/
+static ssize_t storage_direct_pwritev(int fd, struct iovec * vector, int count, off_t offset, size_t len) {
+  off_t        start = offset & ~((off_t)STORAGE_DIRECT_IO_ALIGN-1);
+  off_t        end   = (offset + len + STORAGE_DIRECT_IO_ALIGN - 1) & ~((off_t)STORAGE_DIRECT_IO_ALIGN-1);
+  char       * buf;
+  char       * pData;
+  struct stat  sb;
+  off_t        size;
+  ssize_t      ret;
+  int          i;
+
+  buf = storage_direct_io_buffer(end-start);
+  if ((buf == NULL) || (fstat(fd,&sb) < 0)) {
+    return storage_direct_fallback(fd, 1, vector, count, offset);
+  }  
+  
+  /*
+  ** Read the partial device blocks at both ends of the range
+  */
+  if (start != offset) {
+    memset(buf, 0, STORAGE_DIRECT_IO_ALIGN);
+    if (start < sb.st_size) {
+      if (pread(fd, buf, STORAGE_DIRECT_IO_ALIGN, start) < 0) return -1;
+    }  
+  }
+  if ((end != (offset+len)) && ((start == offset) || ((end - STORAGE_DIRECT_IO_ALIGN) > start))) {
+    memset(buf + (end - start - STORAGE_DIRECT_IO_ALIGN), 0, STORAGE_DIRECT_IO_ALIGN);
+    if ((end - STORAGE_DIRECT_IO_ALIGN) < sb.st_size) {
+      if (pread(fd, buf + (end - start - STORAGE_DIRECT_IO_ALIGN), STORAGE_DIRECT_IO_ALIGN, 
+                end - STORAGE_DIRECT_IO_ALIGN) < 0) return -1;
+    }  
+  }
+  
+  pData = buf + (offset - start);
+  for (i=0; i<count; i++) {
+    memcpy(pData, vector[i].iov_base, vector[i].iov_len);
+    pData += vector[i].iov_len;
+  }
+  
+  ret = pwrite(fd, buf, end-start, start);
+  if (ret < 0) return -1;
+  __sync_fetch_and_add(&storage_direct_io_stat.write,1);
+  if (ret < (offset + len - start)) {
+    ret -= (offset - start);
+    return (ret < 0) ? 0 : ret;
+  }
+  
+  /*
+  ** Do not let the padding extend the file
+  */
+  size = sb.st_size;
+  if (size < (offset+len)) size = offset+len;
+  if (end > size) {
+    if (ftruncate(fd, size) < 0) {
+      severe("ftruncate %s",strerror(errno));
+    }
+  }
+  return len;
+}
+
+int storage_write_chunk_vect(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t layout, uint32_t bsize, sid_t * dist_set,
+        uint8_t spare, fid_t fid, uint8_t chunk, bid_t bid, int nb_seg, storage_write_seg_t * seg, uint8_t version,
+        uint64_t *file_size, int * is_fid_faulty) {
     int status = -1;
+    uint32_t nb_proj = 0;
+    int      iseg;
     char path[FILENAME_MAX];
     int fd = -1;
     size_t nb_write = 0;
@@ -1702,13 +2011,19 @@ int storage_write_chunk(storage_t * st, storio_device_mapping_t * fidCtx, uint8_
     struct stat sb;
     int open_flags;
     int    device_id_is_given;
+    int    direct;
     rozofs_stor_bins_file_hdr_t file_hdr;
     storage_dev_map_distribution_write_ret_e map_result = MAP_FAILURE;
     uint8_t   dev = storio_get_dev(fidCtx, chunk);
+    struct iovec       vector[ROZOFS_MAX_BLOCK_PER_MSG*2]; 
 
     // No specific fault on this FID detected
     *is_fid_faulty = 0; 
 
+    for (iseg=0; iseg < nb_seg; iseg++) {
+      nb_proj += seg[iseg].nb_proj;
+    }
+
     dbg("%d/%d Write chunk %d : ", st->cid, st->sid, chunk);
    
   
@@ -1734,7 +2049,7 @@ open:
     }  
 
     // Open bins file
-    fd = open(path, open_flags, ROZOFS_ST_BINS_FILE_MODE);
+    fd = storage_open_bins(path, open_flags, ROZOFS_ST_BINS_FILE_MODE, &direct);
     if (fd < 0) {
     
         // Something definitively wrong on device
@@ -1777,25 +2092,39 @@ open:
     uint32_t crc32 = fid2crc32((uint32_t *)fid) + bid;
 
     /*
-    ** Writting the projection as received directly on disk
+    ** Writting the projections as received directly on disk
+    ** with one vector entry per segment
     */
     if (rozofs_msg_psize == rozofs_disk_psize) {
     
-      /*
-      ** generate the crc32c for each projection block
-      */
-      storio_gen_crc32((char*)bins,nb_proj,rozofs_disk_psize,crc32);
-
+      for (iseg=0; iseg < nb_seg; iseg++) {
+        vector[iseg].iov_base = (char *) seg[iseg].bins;
+        vector[iseg].iov_len  = seg[iseg].nb_proj * rozofs_disk_psize;
+        /*
+        ** generate the crc32c for each projection block
+        */
+        storio_gen_crc32(vector[iseg].iov_base,seg[iseg].nb_proj,rozofs_disk_psize,crc32);
+        crc32 += seg[iseg].nb_proj;
+      }
       errno = 0;
-      nb_write = pwrite(fd, bins, length_to_write, bins_file_offset);
+      if (direct) {
+        nb_write = storage_direct_pwritev(fd, vector, nb_seg, bins_file_offset, length_to_write);
+      }
+      else if (nb_seg == 1) {
+        nb_write = pwrite(fd, vector[0].iov_base, length_to_write, bins_file_offset);
+      }
+      else {
+        nb_write = pwritev(fd, vector, nb_seg, bins_file_offset);
+      }
     }
 
     /*
     ** Writing the projections on a different size on disk
+    ** with one vector entry per projection
     */
     else {
-      struct iovec       vector[ROZOFS_MAX_BLOCK_PER_MSG*2]; 
       int                i;
+      int                idx = 0;
       char *             pMsg;
       
       if (nb_proj > (ROZOFS_MAX_BLOCK_PER_MSG*2)) {  
@@ -1804,11 +2133,13 @@ open:
         errno = ESPIPE;	
         goto out;
       }
-      pMsg  = (char *) bins;
-      for (i=0; i< nb_proj; i++) {
-        vector[i].iov_base = pMsg;
-        vector[i].iov_len  = rozofs_disk_psize;
-	pMsg += rozofs_msg_psize;
+      for (iseg=0; iseg < nb_seg; iseg++) {
+        pMsg  = (char *) seg[iseg].bins;
+        for (i=0; i< seg[iseg].nb_proj; i++,idx++) {
+          vector[idx].iov_base = pMsg;
+          vector[idx].iov_len  = rozofs_disk_psize;
+	  pMsg += rozofs_msg_psize;
+        }
       }
       
       /*
@@ -1818,7 +2149,12 @@ open:
       storio_gen_crc32_vect(vector,nb_proj,rozofs_disk_psize,crc32);
       
       errno = 0;      
-      nb_write = pwritev(fd, vector, nb_proj, bins_file_offset);      
+      if (direct) {
+        nb_write = storage_direct_pwritev(fd, vector, nb_proj, bins_file_offset, length_to_write);
+      }
+      else {
+        nb_write = pwritev(fd, vector, nb_proj, bins_file_offset);      
+      }
     } 
 
     if (nb_write != length_to_write) {
@@ -1875,6 +2211,16 @@ out:
         
     return status;
 }
+int storage_write_chunk(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t layout, uint32_t bsize, sid_t * dist_set,
+        uint8_t spare, fid_t fid, uint8_t chunk, bid_t bid, uint32_t nb_proj, uint8_t version,
+        uint64_t *file_size, const bin_t * bins, int * is_fid_faulty) {
+    storage_write_seg_t seg;
+    
+    seg.bins    = bins;
+    seg.nb_proj = nb_proj;
+    return storage_write_chunk_vect(st, fidCtx, layout, bsize, dist_set, spare, fid, chunk, bid, 
+                                    1, &seg, version, file_size, is_fid_faulty);
+}
 char empty_block[16*1024] = { 0 };
 int storage_write_chunk_empty(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t layout, uint32_t bsize, sid_t * dist_set,
         uint8_t spare, fid_t fid, uint8_t chunk, bid_t bid, uint32_t nb_proj, uint8_t version,
@@ -2292,6 +2638,7 @@ int storage_read_chunk(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t
     uint64_t    crc32_errors[3]; 
     uint8_t     dev;
     int result;
+    int direct;
     
     dbg("%d/%d Read chunk %d : ", st->cid, st->sid, chunk);
 
@@ -2403,7 +2750,7 @@ retry:
     storage_build_chunk_full_path(path, st->root, dev, spare, storage_slice, fid,chunk);
 
     // Open bins file
-    fd = open(path, ROZOFS_ST_NO_CREATE_FILE_FLAG, ROZOFS_ST_BINS_FILE_MODE_RO);
+    fd = storage_open_bins(path, ROZOFS_ST_NO_CREATE_FILE_FLAG, ROZOFS_ST_BINS_FILE_MODE_RO, &direct);
     if (fd < 0) {
     
         // Something definitively wrong on device
@@ -2443,7 +2790,14 @@ retry:
     */
     if (rozofs_msg_psize == rozofs_disk_psize) {    
       // Read nb_proj * (projection + header)
-      nb_read = pread(fd, bins, length_to_read, bins_file_offset);       
+      if (direct) {
+        vector[0].iov_base = bins;
+        vector[0].iov_len  = length_to_read;
+        nb_read = storage_direct_preadv(fd, vector, 1, bins_file_offset, length_to_read);
+      }
+      else {
+        nb_read = pread(fd, bins, length_to_read, bins_file_offset);       
+      }
     }
     /*
     ** Projections are smaller on disk than in message
@@ -2464,7 +2818,12 @@ retry:
         vector[i].iov_len  = rozofs_disk_psize;
 	pMsg += rozofs_msg_psize;
       }
-      nb_read = preadv(fd, vector, nb_proj, bins_file_offset);      
+      if (direct) {
+        nb_read = storage_direct_preadv(fd, vector, nb_proj, bins_file_offset, length_to_read);      
+      }
+      else {
+        nb_read = preadv(fd, vector, nb_proj, bins_file_offset);      
+      }
     } 
     
     // Check error
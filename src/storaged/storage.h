@@ -40,6 +40,7 @@
 
 #include "storio_device_mapping.h"
 #include "storage_header.h"
+#include "storage_hdrcache.h"
 
 
 /*
@@ -816,6 +817,50 @@ void storage_release(storage_t * st);
 int storage_write_chunk(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t layout, uint32_t bsize, sid_t * dist_set,
         uint8_t spare, fid_t fid, uint8_t chunk, bid_t bid, uint32_t nb_proj, uint8_t version,
         uint64_t *file_size, const bin_t * bins, int * is_fid_faulty);
+
+/*
+** Direct I/O (O_DIRECT) mode of the bins files
+*/
+typedef enum _storage_direct_io_e {
+  STORAGE_DIRECT_IO_OFF = 0,  /**< every I/O goes through the page cache       */
+  STORAGE_DIRECT_IO_REBUILD,  /**< only rebuild and self healing writes bypass it */
+  STORAGE_DIRECT_IO_ALL       /**< every bins file read and write bypasses it  */
+} storage_direct_io_e;
+
+typedef struct _storage_direct_io_stat_t {
+  uint64_t   read;        /**< direct reads                                   */
+  uint64_t   write;       /**< direct writes                                  */
+  uint64_t   fallback;    /**< buffered I/O since the range was too big        */
+  uint64_t   unsupported; /**< buffered I/O since O_DIRECT is not supported    */
+} storage_direct_io_stat_t;
+
+extern int                      storage_direct_io_mode;
+extern __thread int             storage_io_is_rebuild; /**< set by the thread doing rebuild I/O */
+extern storage_direct_io_stat_t storage_direct_io_stat;
+
+/*
+** A segment of contiguous projections to write. Several segments
+** following each other in the chunk are written at once
+*/
+#define STORAGE_WRITE_MAX_SEG  16
+typedef struct _storage_write_seg_t {
+  const bin_t * bins;     /**< projections as received in the message */
+  uint32_t      nb_proj;  /**< number of projections of the segment    */
+} storage_write_seg_t;
+
+/** Write several segments of projections following each other in a chunk
+ *
+ * @param bid: first block idx of the first segment within the chunk
+ * @param nb_seg: number of segments (at most STORAGE_WRITE_MAX_SEG)
+ * @param seg: the segments, in block order
+ *
+ * The other parameters are the same as for storage_write_chunk
+ *
+ * @return: the size of the written projections in the messages, -1 on error (errno is set)
+ */
+int storage_write_chunk_vect(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t layout, uint32_t bsize, sid_t * dist_set,
+        uint8_t spare, fid_t fid, uint8_t chunk, bid_t bid, int nb_seg, storage_write_seg_t * seg, uint8_t version,
+        uint64_t *file_size, int * is_fid_faulty);
 int storage_write_chunk_empty(storage_t * st, storio_device_mapping_t * fidCtx, uint8_t layout, uint32_t bsize, sid_t * dist_set,
         uint8_t spare, fid_t fid, uint8_t chunk, bid_t bid, uint32_t nb_proj, uint8_t version,
         uint64_t *file_size, int * is_fid_faulty);	 
@@ -1378,6 +1423,11 @@ void static inline storage_dev_map_distribution_remove(storage_t * st, fid_t fid
 
     DEBUG_FUNCTION;
  
+    /*
+    ** Drop the cached header
+    */
+    storage_hdrcache_invalidate(st->cid, st->sid, spare, fid);
+
     /*
     ** Compute storage slice from FID
     */
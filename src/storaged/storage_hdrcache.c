@@ -0,0 +1,201 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <rozofs/rozofs.h>
+#include <rozofs/common/log.h>
+#include <rozofs/common/list.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include <rozofs/core/rozofs_string.h>
+
+#include "storage_lru_cache.h"
+#include "storage_hdrcache.h"
+
+#define STORAGE_HDRCACHE_BUCKETS  4096   /**< hash buckets per shard */
+
+/*
+** Cached header of a FID on a cid/sid
+*/
+typedef struct _storage_hdrcache_entry_t {
+  storage_lru_entry_t          lru;             /**< cache key and links          */
+  storage_hdrcache_stamp_t     stamp;           /**< stamp of a header file       */
+  rozofs_stor_bins_file_hdr_t  hdr;             /**< header file content          */
+} storage_hdrcache_entry_t;
+
+int                         storage_hdrcache_enabled = 0;
+static storage_lru_t        storage_hdrcache;
+
+/*
+**______________________________________________________________________________
+*/
+static void storage_hdrcache_free(storage_lru_entry_t * entry) {
+  free(entry);
+}
+/*
+**______________________________________________________________________________
+*/
+int storage_hdrcache_read(cid_t cid, sid_t sid, uint8_t spare, fid_t fid, 
+                          rozofs_stor_bins_file_hdr_t * hdr, storage_hdrcache_stamp_t * stamp) {
+  storage_lru_shard_t      * shard;
+  storage_hdrcache_entry_t * entry;
+  list_t                   * bucket;
+
+  if (!storage_hdrcache_enabled) return 0;
+
+  shard = storage_lru_lock(&storage_hdrcache, cid, sid, fid, &bucket);
+
+  entry = (storage_hdrcache_entry_t *) storage_lru_lookup(bucket, cid, sid, spare, fid, 0);
+  if (entry == NULL) {
+    shard->stats.miss++;
+    storage_lru_unlock(shard);
+    return 0;
+  }
+  
+  /*
+  ** Other recycling counter. Let the caller read the disk
+  ** and decide what to do
+  */
+  if (memcmp(entry->lru.fid, fid, sizeof(fid_t)) != 0) {
+    storage_lru_release(&storage_hdrcache, shard, &entry->lru);
+    shard->stats.invalidate++;
+    shard->stats.miss++;
+    storage_lru_unlock(shard);
+    return 0;
+  }
+
+  memcpy(hdr, &entry->hdr, sizeof(rozofs_stor_bins_file_hdr_t));
+  memcpy(stamp, &entry->stamp, sizeof(storage_hdrcache_stamp_t));
+  storage_lru_touch(shard, &entry->lru);
+  shard->stats.hit++;
+
+  storage_lru_unlock(shard);
+  return 1;
+}
+/*
+**______________________________________________________________________________
+*/
+void storage_hdrcache_insert(cid_t cid, sid_t sid, uint8_t spare, 
+                             rozofs_stor_bins_file_hdr_t * hdr, storage_hdrcache_stamp_t * stamp) {
+  storage_lru_shard_t      * shard;
+  storage_hdrcache_entry_t * entry;
+  list_t                   * bucket;
+
+  if (!storage_hdrcache_enabled) return;
+
+  shard = storage_lru_lock(&storage_hdrcache, cid, sid, hdr->fid, &bucket);
+
+  entry = (storage_hdrcache_entry_t *) storage_lru_lookup(bucket, cid, sid, spare, hdr->fid, 0);
+  if (entry == NULL) {
+    entry = malloc(sizeof(storage_hdrcache_entry_t));
+    if (entry == NULL) goto out;
+    entry->lru.cid   = cid;
+    entry->lru.sid   = sid;
+    entry->lru.spare = spare;
+    storage_lru_insert(shard, bucket, &entry->lru, sizeof(storage_hdrcache_entry_t));
+  }
+  else {
+    storage_lru_touch(shard, &entry->lru);
+  }
+  memcpy(entry->lru.fid, hdr->fid, sizeof(fid_t));
+  memcpy(&entry->hdr, hdr, sizeof(rozofs_stor_bins_file_hdr_t));
+  memcpy(&entry->stamp, stamp, sizeof(storage_hdrcache_stamp_t));
+
+  /*
+  ** Respect the memory budget of the shard
+  */
+  storage_lru_trim(&storage_hdrcache, shard);
+
+out:
+  storage_lru_unlock(shard);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Drop the cached header of a FID
+
+   @param stale: whether the header file has been rewritten by an other process
+*/
+static void storage_hdrcache_drop(cid_t cid, sid_t sid, uint8_t spare, fid_t fid, int stale) {
+  storage_lru_shard_t * shard;
+  storage_lru_entry_t * entry;
+  list_t              * bucket;
+
+  if (!storage_hdrcache_enabled) return;
+
+  shard = storage_lru_lock(&storage_hdrcache, cid, sid, fid, &bucket);
+
+  entry = storage_lru_lookup(bucket, cid, sid, spare, fid, 0);
+  if (entry != NULL) {
+    storage_lru_release(&storage_hdrcache, shard, entry);
+    if (stale) shard->stats.stale++;
+    else       shard->stats.invalidate++;
+  }
+
+  storage_lru_unlock(shard);
+}
+/*
+**______________________________________________________________________________
+*/
+void storage_hdrcache_stale(cid_t cid, sid_t sid, uint8_t spare, fid_t fid) {
+  storage_hdrcache_drop(cid, sid, spare, fid, 1);
+}
+/*
+**______________________________________________________________________________
+*/
+void storage_hdrcache_invalidate(cid_t cid, sid_t sid, uint8_t spare, fid_t fid) {
+  storage_hdrcache_drop(cid, sid, spare, fid, 0);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Header cache debug function
+*/
+static void storage_hdrcache_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char * p = uma_dbg_get_buffer();
+  int    doreset = 0;
+
+  if ((argv[1] != NULL) && (strcmp(argv[1],"reset")==0)) doreset = 1;
+
+  if (!storage_hdrcache_enabled) {
+    p += rozofs_string_append(p, "header cache is disabled (storio_hdrcache_size)\n");
+  }
+  else {
+    p = storage_lru_display(&storage_hdrcache, p, doreset);
+  }
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**______________________________________________________________________________
+*/
+int storage_hdrcache_init(uint32_t size_MB) {
+
+  uma_dbg_addTopic_option("hdrcache", storage_hdrcache_debug, UMA_DBG_OPTION_RESET);
+
+  if (storage_lru_init(&storage_hdrcache, size_MB, STORAGE_HDRCACHE_BUCKETS, storage_hdrcache_free) != 0) {
+    return -1;
+  }
+  storage_hdrcache_enabled = storage_hdrcache.enabled;
+  return 0;
+}
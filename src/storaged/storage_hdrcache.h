@@ -0,0 +1,157 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STORAGE_HDRCACHE_H
+#define STORAGE_HDRCACHE_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <rozofs/rozofs.h>
+#include "storage_header.h"
+
+/*
+** The header cache keeps in memory the content of the header files read
+** from or written to disk, so that a FID which context has been evicted
+** from the FID context pool is found again without reading its header
+** files on every mapper device.
+**
+** It is only enabled by the STORIO. The header files may still be
+** rewritten by other processes (STORAGED removal, stspare, rebuild), so
+** each entry records the stamp (inode, size and modification time) of
+** one of the header files it has been read from or written to. A cached
+** header is only used while that file has the same stamp on disk, which
+** costs a single stat instead of reading the header files on every
+** mapper device.
+**
+** The cache is a storage_lru_t: split in shards, each with its own lock,
+** LRU list and share of the memory budget.
+*/
+
+/*
+** What is checked on disk before using a cached header
+*/
+typedef struct _storage_hdrcache_stamp_t {
+  int              device;     /**< device of the header file the stamp is taken on */
+  ino_t            ino;
+  off_t            size;
+  struct timespec  mtime;
+} storage_hdrcache_stamp_t;
+
+extern int storage_hdrcache_enabled;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Compare 2 header file stamps
+
+   @retval 1 when the header file has not been rewritten
+   @retval 0 when it has
+*/
+static inline int storage_hdrcache_same_stamp(storage_hdrcache_stamp_t * s1, storage_hdrcache_stamp_t * s2) {
+  if (s1->device        != s2->device)        return 0;
+  if (s1->ino           != s2->ino)           return 0;
+  if (s1->size          != s2->size)          return 0;
+  if (s1->mtime.tv_sec  != s2->mtime.tv_sec)  return 0;
+  if (s1->mtime.tv_nsec != s2->mtime.tv_nsec) return 0;
+  return 1;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Initialize the header cache
+
+   @param size_MB: memory budget of the cache in MB. 0 disables the cache
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int storage_hdrcache_init(uint32_t size_MB);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Read a header file content from the cache
+
+   The caller has to check the stamp against the header file on disk,
+   and to call storage_hdrcache_stale() when it does not match
+
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param spare: whether the storage is spare for this FID
+   @param fid: the file, including its recycling counter
+   @param hdr: where to copy the header file content
+   @param stamp: where to copy the stamp of the header file
+
+   @retval 1 when the header has been read from the cache
+   @retval 0 when not
+*/
+int storage_hdrcache_read(cid_t cid, sid_t sid, uint8_t spare, fid_t fid, 
+                          rozofs_stor_bins_file_hdr_t * hdr, storage_hdrcache_stamp_t * stamp);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Insert or update a header file content in the cache
+
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param spare: whether the storage is spare for this FID
+   @param hdr: the header file content as it is on disk
+   @param stamp: the stamp of one of the header files holding this content
+*/
+void storage_hdrcache_insert(cid_t cid, sid_t sid, uint8_t spare, 
+                             rozofs_stor_bins_file_hdr_t * hdr, storage_hdrcache_stamp_t * stamp);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Drop the cached header of a FID which header file has been rewritten
+   by an other process
+
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param spare: whether the storage is spare for this FID
+   @param fid: the file
+*/
+void storage_hdrcache_stale(cid_t cid, sid_t sid, uint8_t spare, fid_t fid);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Drop the cached headers of a FID
+
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param spare: whether the storage is spare for this FID
+   @param fid: the file
+*/
+void storage_hdrcache_invalidate(cid_t cid, sid_t sid, uint8_t spare, fid_t fid);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -69,6 +69,9 @@
 static int rebuildRef = -1;     /* Rebuild process reference */
 static int instance   = -1;     /* List rebuilder instance within the rebuild process */
 static int throughput = 0;      /* Rebuild throughput limitation in MB/s */
+#define RBS_MAX_THREADS 32
+static int nb_threads = 1;      /* Number of rebuild threads within the process */
+static int target_latency = 0;  /* Target projection read latency in ms (0: no adaptation) */
 
 /*
 ** For enforcing throughput limitation
@@ -76,6 +79,12 @@ static int throughput = 0;      /* Rebuild throughput limitation in MB/s */
 extern uint64_t totalReadSize;
 static uint64_t startTime     = 0;
 
+/*
+** For adapting the rebuild load to the storage latency
+*/
+extern uint64_t rbs_read_latency_us;
+extern uint64_t rbs_read_latency_count;
+
 
 char        rebuild_directory_path[FILENAME_MAX]; 
 char        fid_list[FILENAME_MAX]; 
@@ -83,7 +92,7 @@ char        statFilename[FILENAME_MAX];
  
 static rbs_storage_config_t storage_config;
 
-uint8_t prj_id_present[ROZOFS_SAFE_MAX];
+__thread uint8_t prj_id_present[ROZOFS_SAFE_MAX];
 int         quiet=0;
 
 
@@ -98,7 +107,7 @@ static uint32_t retries = 10;
 // Rebuild storage variables
 
 int sigusr_received=0;
-rpcclt_t   rpcclt_export;
+__thread rpcclt_t   rpcclt_export;
   
 rbs_file_type_e ftype = rbs_file_type_all;
 
@@ -111,8 +120,11 @@ int nolog = 0;
 
 int relocate = 0;
 int resecure = 0;
-list_t     cluster_entries;
-char     * pExport_hostname = NULL;
+/*
+** Each rebuild thread has its own connections toward the exportd and the storages
+*/
+__thread list_t     cluster_entries;
+__thread char     * pExport_hostname = NULL;
 
 
 /*-----------------------------------------------------------------------------
@@ -147,9 +159,27 @@ typedef struct rbs_error_t {
 
 } RBS_ERROR_T;
 
-static RBS_ERROR_T rbs_error = {0};
+static __thread RBS_ERROR_T rbs_error = {0};
+static RBS_ERROR_T rbs_error_total = {0};
+static pthread_mutex_t rbs_error_lock = PTHREAD_MUTEX_INITIALIZER;
 
-#define RBS_DISPLAY_ERROR(x) {if (rbs_error.x) REBUILD_MSG("%20s = %llu", #x, (long long unsigned int) rbs_error.x);}
+#define RBS_DISPLAY_ERROR(x) {if (rbs_error_total.x) REBUILD_MSG("%20s = %llu", #x, (long long unsigned int) rbs_error_total.x);}
+
+/*
+** Add the error counters of the calling thread to the process counters
+*/
+void merge_rbs_errors() {
+  uint64_t * pTotal = (uint64_t *) &rbs_error_total;
+  uint64_t * pLocal = (uint64_t *) &rbs_error;
+  int        i;
+  
+  pthread_mutex_lock(&rbs_error_lock);
+  for (i=0; i < sizeof(RBS_ERROR_T)/sizeof(uint64_t); i++) {
+    pTotal[i] += pLocal[i];
+  }
+  pthread_mutex_unlock(&rbs_error_lock);
+  memset(&rbs_error,0,sizeof(rbs_error));
+}
 
 void display_rbs_errors() {
   RBS_DISPLAY_ERROR(spare_start);
@@ -243,6 +273,130 @@ static inline void enforce_throughput() {
 }
 /*-----------------------------------------------------------------------------
 **
+** Adapt the rebuild load to a target projection read latency
+**
+** The rebuild threads read the projections from the same storages as the
+** clients do, so the read latency they see reflects the load of these
+** storages. Every second the average read latency is compared to the target:
+** above it, the number of active rebuild threads is halved and, once a single
+** thread is left, a delay is inserted before each read. Below 3/4 of it, the
+** delay is first reduced and then the threads are re-activated one by one.
+**
+**----------------------------------------------------------------------------
+*/
+#define RBS_LATENCY_PERIOD_US    1000000
+#define RBS_LATENCY_MAX_DELAY_US 1000000
+typedef struct _rbs_latency_ctrl_t {
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+  int             active;        /* Number of rebuild threads allowed to run      */
+  uint64_t        delay_us;      /* Delay inserted before each projection read    */
+  uint64_t        last_us;       /* Date of the last adaptation                   */
+  uint64_t        last_latency;  /* Cumulated read latency at last adaptation     */
+  uint64_t        last_count;    /* Cumulated read count at last adaptation       */
+  uint64_t        average_us;    /* Average read latency of the last period       */
+} rbs_latency_ctrl_t;
+
+static rbs_latency_ctrl_t rbs_latency_ctrl = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .cond = PTHREAD_COND_INITIALIZER,
+};
+/*
+**____________________________________________________
+** Run the adaptation when the period is over. Lock must be held.
+*/
+static inline void rbs_latency_adapt() {
+  rbs_latency_ctrl_t * ctrl = &rbs_latency_ctrl;
+  uint64_t             now;
+  uint64_t             latency;
+  uint64_t             count;
+  uint64_t             target = target_latency * 1000;
+
+  now = get_us(0);
+  if ((now - ctrl->last_us) < RBS_LATENCY_PERIOD_US) return;
+  ctrl->last_us = now;
+  
+  latency = rbs_read_latency_us    - ctrl->last_latency;
+  count   = rbs_read_latency_count - ctrl->last_count;
+  ctrl->last_latency = rbs_read_latency_us;
+  ctrl->last_count   = rbs_read_latency_count;
+  if (count == 0) return;
+  ctrl->average_us = latency / count;
+   
+  if (ctrl->average_us > target) {
+    /*
+    ** Storages are too loaded. Slow down
+    */
+    if (ctrl->active > 1) {
+      ctrl->active /= 2;
+    }
+    else if (ctrl->delay_us == 0) {
+      ctrl->delay_us = 1000;
+    }
+    else if (ctrl->delay_us < RBS_LATENCY_MAX_DELAY_US) {
+      ctrl->delay_us *= 2;
+    }
+    return;
+  }
+  
+  if (ctrl->average_us < (target*3/4)) {
+    /*
+    ** Storages can take more. Speed up
+    */
+    if (ctrl->delay_us != 0) {
+      ctrl->delay_us /= 2;
+      if (ctrl->delay_us < 1000) ctrl->delay_us = 0;
+    }
+    else if (ctrl->active < nb_threads) {
+      ctrl->active++;
+      pthread_cond_broadcast(&ctrl->cond);
+    }
+  }
+}
+/*-----------------------------------------------------------------------------
+**
+** Wait until this rebuild thread is allowed to start a new file
+**
+** @param thread_idx  Index of the rebuild thread
+**
+**----------------------------------------------------------------------------
+*/
+static inline void rbs_latency_wait_active(int thread_idx) {
+  rbs_latency_ctrl_t * ctrl = &rbs_latency_ctrl;
+  struct timespec      ts;
+
+  if (target_latency == 0) return;
+  
+  pthread_mutex_lock(&ctrl->lock);
+  rbs_latency_adapt();
+  while ((thread_idx >= ctrl->active) && (sigusr_received == 0)) {
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += 1;
+    pthread_cond_timedwait(&ctrl->cond, &ctrl->lock, &ts);
+    rbs_latency_adapt();
+  }
+  pthread_mutex_unlock(&ctrl->lock);
+}
+/*-----------------------------------------------------------------------------
+**
+** Enforce the delay before a projection read computed from the target latency
+**
+**----------------------------------------------------------------------------
+*/
+static inline void enforce_latency() {
+  uint64_t delay;
+  
+  if (target_latency == 0) return;
+
+  pthread_mutex_lock(&rbs_latency_ctrl.lock);
+  rbs_latency_adapt();
+  delay = rbs_latency_ctrl.delay_us;
+  pthread_mutex_unlock(&rbs_latency_ctrl.lock);
+  
+  if (delay) usleep(delay);
+}
+/*-----------------------------------------------------------------------------
+**
 ** Data flush macro
 **
 ** Used to flush either a sequence of empty blocks at the time a non empty block 
@@ -442,6 +596,7 @@ RBS_EXE_CODE_E rbs_restore_one_spare_entry(cid_t             cid,
 	  ** Enforce throughput limitation
 	  */
           enforce_throughput();
+          enforce_latency();
 
           // Read every available bins
 	  ret = rbs_read_all_available_proj(re->storages, spare_idx, layout, bsize, cid,
@@ -837,6 +992,7 @@ RBS_EXE_CODE_E rbs_restore_one_rb_entry(cid_t             cid,
 	** Enforce throughput limitation
 	*/
         enforce_throughput();
+        enforce_latency();
 
         // Try to read blocks on others storages
         ret = rbs_read_blocks(re->storages, local_idx, layout, bsize, cid,
@@ -1040,23 +1196,198 @@ int check_fid_deleted_from_export(fid_t fid) {
 }
 /*-----------------------------------------------------------------------------
 **
-** Rebuild a list of FID 
+** Context of a job list shared by the rebuild threads
 **
-** @param   fid_list        File containing the list of FID to rebuild
-** @param   statFilename    File containing statistics related to this rebuild list
+**----------------------------------------------------------------------------
+*/
+typedef struct _rbs_list_ctx_t {
+  cid_t                  cid;
+  sid_t                  sid;
+  char                 * fid_list;
+  char                 * statFilename;
+  int                    fdlist;
+  int                    fdstat;
+  int                    error;        /* The list could not be opened */
+  uint64_t               next_offset;  /* Offset of the next job to take in the list */
+  int                    nbJobs;
+  int                    nbSuccess;
+  ROZOFS_RBS_COUNTERS_T  statistics;
+  pthread_mutex_t        lock;
+} rbs_list_ctx_t;
+
+typedef struct _rbs_list_thread_t {
+  int                    idx;
+  pthread_t              thrdId;
+  rbs_list_ctx_t       * ctx;
+  void                (* job)(struct _rbs_list_thread_t *);
+} rbs_list_thread_t;
+
+/*
+** Serializes the connection set up of the rebuild threads
+*/
+static pthread_mutex_t rbs_cnx_lock = PTHREAD_MUTEX_INITIALIZER;
+/*-----------------------------------------------------------------------------
 **
-** @retval 0 when rebuild is successfull / 1 when rebuild is not completed
+** Take the next job to process in the job list
+**
+** @param ctx          The job list context
+** @param file_entry   Where to return the job
+** @param offset       Where to return the job offset in the list
+**
+** @retval the job size in the list / 0 at the end of the list
 **
 **----------------------------------------------------------------------------
 */
-int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFilename) {
-  int        fdlist = -1;
-  int        fdstat = -1;  
-  int        nbJobs=0;
-  int        nbSuccess=0;
+static int rbs_list_get_next_job(rbs_list_ctx_t * ctx, rozofs_rebuild_entry_file_t * file_entry, uint64_t * offset) {
+  int entry_size = 0;
+  
+  pthread_mutex_lock(&ctx->lock);
+  *offset = ctx->next_offset;
+  if (pread(ctx->fdlist,file_entry,sizeof(*file_entry),*offset) > 0) {
+    entry_size = rbs_entry_size_from_layout(file_entry->layout);
+    ctx->next_offset += entry_size;
+  }
+  pthread_mutex_unlock(&ctx->lock);  
+  return entry_size;
+}
+/*-----------------------------------------------------------------------------
+**
+** Account for a job that has been processed
+**
+** @param ctx          The job list context
+** @param success      Whether the job has successfully been done
+** @param spare        Whether it is a spare file
+** @param deleted      Whether the file has been deleted
+** @param resecured    Whether the file has been resecured
+** @param size_written Written byte count
+** @param size_read    Read byte count
+**
+**----------------------------------------------------------------------------
+*/
+static void rbs_list_job_done(rbs_list_ctx_t * ctx, int success, int spare, int deleted, int resecured,
+                              uint64_t size_written, uint64_t size_read) {
+  pthread_mutex_lock(&ctx->lock);
+  
+  if (deleted)   ctx->statistics.deleted++;
+  if (resecured) ctx->statistics.resecured++;
+
+  if (success) {
+    ctx->nbSuccess++;
+    // Update counters in header file 
+    ctx->statistics.done_files++;
+    if (spare == 1) {
+      ctx->statistics.written_spare += size_written;
+      ctx->statistics.read_spare    += size_read;
+    }
+    ctx->statistics.written += size_written;
+    ctx->statistics.read    += size_read;       
+  }
+  
+  if (pwrite(ctx->fdstat, &ctx->statistics, sizeof(ctx->statistics), 0)!= sizeof(ctx->statistics)) {
+    severe("pwrite %s %s",ctx->statFilename,strerror(errno));
+  }          
+
+  if ((success) && ((ctx->nbSuccess % (16*1024)) == 0)) {
+    REBUILD_MSG("  ~ %s %d/%d",ctx->fid_list,ctx->nbSuccess,ctx->nbJobs);
+  } 
+  pthread_mutex_unlock(&ctx->lock);
+}
+/*-----------------------------------------------------------------------------
+**
+** Rebuild thread 
+**
+** Every thread has its own connections toward the exportd and the storages,
+** so the projection reads of the different threads are outstanding at the
+** same time on the storages, while the transforms run on the threads.
+**
+**----------------------------------------------------------------------------
+*/
+static void * rbs_list_thread(void * arg) {
+  rbs_list_thread_t * thread = (rbs_list_thread_t *) arg;
+
+  list_init(&cluster_entries);
+  memset(&rpcclt_export,0,sizeof(rpcclt_export));
+
+  pthread_mutex_lock(&rbs_cnx_lock);
+  pExport_hostname = rbs_get_cluster_list(&rpcclt_export, 
+                                          storage_config.export_hostname, 
+                                          storage_config.site,
+                                          storage_config.cid, 
+                                          &cluster_entries);
+  pthread_mutex_unlock(&rbs_cnx_lock);
+  
+  if (pExport_hostname == NULL) {			   
+    severe("rebuild thread %d can not get cluster %d from export %s: %s",
+           thread->idx, storage_config.cid, storage_config.export_hostname, strerror(errno));
+  }
+  else {
+    thread->job(thread);
+  }
+  
+  rbs_release_cluster_list(&cluster_entries);
+  rpcclt_release(&rpcclt_export);
+  merge_rbs_errors();
+  return NULL;
+}
+/*-----------------------------------------------------------------------------
+**
+** Process a job list with the requested number of rebuild threads
+**
+** @param ctx          The job list context
+** @param job          The job list processing function
+**
+**----------------------------------------------------------------------------
+*/
+static void rbs_list_run(rbs_list_ctx_t * ctx, void (* job)(rbs_list_thread_t *)) {
+  rbs_list_thread_t * threads;
+  int                 idx;
+  int                 started = 0;
+  
+  rbs_latency_ctrl.active = nb_threads;
+  rbs_latency_ctrl.last_us = get_us(0);
+
+  /*
+  ** Single thread: the main thread does the job with its own connections
+  */
+  if (nb_threads <= 1) {
+    rbs_list_thread_t thread;
+    thread.idx = 0;
+    thread.ctx = ctx;
+    thread.job = job;
+    job(&thread);
+    merge_rbs_errors();
+    return;
+  }
+  
+  threads = xmalloc(nb_threads * sizeof(rbs_list_thread_t));
+  for (idx=0; idx < nb_threads; idx++) {
+    threads[idx].idx = idx;
+    threads[idx].ctx = ctx;
+    threads[idx].job = job;
+    if ((errno = pthread_create(&threads[idx].thrdId, NULL, rbs_list_thread, &threads[idx])) != 0) {
+      severe("pthread_create rebuild thread %d %s",idx,strerror(errno));
+      break;
+    }
+    started++;
+  }
+  for (idx=0; idx < started; idx++) {
+    pthread_join(threads[idx].thrdId, NULL);
+  }
+  xfree(threads);
+}
+/*-----------------------------------------------------------------------------
+**
+** Rebuild job of a thread: rebuild the FIDs of the list until its end
+**
+** @param   thread          The rebuild thread
+**
+**----------------------------------------------------------------------------
+*/
+static void rbs_rebuild_list_job(rbs_list_thread_t * thread) {
+  rbs_list_ctx_t * ctx = thread->ctx;
+  cid_t      cid = ctx->cid;
+  sid_t      sid = ctx->sid;
   uint64_t   offset;
-  uint64_t   next_offset;
-  ROZOFS_RBS_COUNTERS_T         statistics;
   rozofs_rebuild_entry_file_t   file_entry;
   rozofs_rebuild_entry_file_t   file_entry_saved;
   int        ret;
@@ -1070,55 +1401,30 @@ int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFile
   uint64_t   size_written = 0;
   uint64_t   size_read    = 0;
   int        more_prj2rebuild;
+  int        entry_size;
         
-  fdlist = open(fid_list,O_RDWR);
-  if (fdlist < 0) {
-    if (errno == ENOENT) {
-      REBUILD_MSG("  <-> %s no file to rebuild",fid_list);    
-      return 0;
-    }
-    
-    severe("Can not open file %s %s",fid_list,strerror(errno));
-    goto error;
-  } 
-
-        
-  fdstat = open(statFilename,O_RDWR | O_CREAT, 0755);
-  if (fdstat < 0) {
-      severe("Can not open file %s %s",statFilename,strerror(errno));
-      goto error;
-  }
-  memset(&statistics,0,sizeof(statistics));
-  ret = pread(fdstat,&statistics,sizeof(statistics),0);  
-  if ((ret != 0) && (ret != sizeof(statistics))) {
-      severe("Can not read statistics in file %s %s",statFilename,strerror(errno));
-      goto error;
-  }  
-    
   // Get connections for this given cluster  
   rbs_init_cluster_cnts(&cluster_entries, cid, sid, &failed,&available);
-  
-  REBUILD_MSG("   -> %s rebuild start",fid_list);
-  
-  nbJobs    = 0;
-  nbSuccess = 0;
-  offset    = 0;
-
-  next_offset = 0;
     
   while (1) {
 
+    if (sigusr_received) {
+      break;
+    }    
     
-    offset = next_offset;
-    if (pread(fdlist,&file_entry,sizeof(file_entry),offset) <= 0) {
+    /*
+    ** Wait for the storages to be able to take more rebuild load
+    */
+    rbs_latency_wait_active(thread->idx);
+        
+    entry_size = rbs_list_get_next_job(ctx, &file_entry, &offset);
+    if (entry_size == 0) {
       break;
     } 
            
     /*
     ** Check that enough servers are available
     */
-    int entry_size = rbs_entry_size_from_layout(file_entry.layout);
-    next_offset = offset + entry_size; 
     if (file_entry.todo == 0) continue;
     if (memcmp(null_fid,file_entry.fid,sizeof(fid_t))==0) {
       severe("Null entry");
@@ -1127,14 +1433,14 @@ int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFile
  
     rozofs_get_rozofs_invers_forward_safe(file_entry.layout, &rozofs_inverse, &rozofs_forward, &rozofs_safe);
 
-    nbJobs++;
+    __sync_fetch_and_add(&ctx->nbJobs,1);
     
     if (available<rozofs_inverse) {
       /*
       ** Not possible to rebuild any thing
       */
       file_entry.error = rozofs_rbs_error_not_enough_storages_up;
-      if (pwrite(fdlist, &file_entry, entry_size, offset)!=entry_size) {
+      if (pwrite(ctx->fdlist, &file_entry, entry_size, offset)!=entry_size) {
 	severe("pwrite size %lu offset %llu %s",(unsigned long int)entry_size, 
                (unsigned long long int) offset-entry_size, strerror(errno));
       }
@@ -1149,11 +1455,6 @@ int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFile
     memcpy(re.dist_set_current,file_entry.dist_set_current, sizeof(re.dist_set_current));
     re.bsize  = file_entry.bsize;
     re.layout = file_entry.layout;
-  
-
-    if (sigusr_received) {
-      goto error;
-    }    
 
     local_index = rbs_get_rb_entry_cnts(&re, &cluster_entries, cid, sid, rozofs_inverse);  
     if (local_index == -1) {
@@ -1166,7 +1467,7 @@ int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFile
       /*
       ** Re write entry in input file
       */
-      if (pwrite(fdlist, &file_entry, entry_size, offset)!=entry_size) {
+      if (pwrite(ctx->fdlist, &file_entry, entry_size, offset)!=entry_size) {
 	severe("pwrite size %lu offset %llu %s",(unsigned long int)entry_size, 
                (unsigned long long int) offset-entry_size, strerror(errno));
       }                                
@@ -1236,28 +1537,11 @@ int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFile
 	
 	  if (ret == RBS_EXE_ENOENT) {
 	    file_entry.error = rozofs_rbs_error_file_deleted;
-	    statistics.deleted++;
 	  }  
 	  else {                      
 	    file_entry.error = rozofs_rbs_error_none;
 	  }
-	  nbSuccess++;
-	  // Update counters in header file 
-	  statistics.done_files++;
-	  if (spare == 1) {
-            statistics.written_spare += size_written;
-	    statistics.read_spare    += size_read;
-	  }
-	  statistics.written += size_written;
-	  statistics.read    += size_read;       
-
-	  if (pwrite(fdstat, &statistics, sizeof(statistics), 0)!= sizeof(statistics)) {
-            severe("pwrite %s %s",statFilename,strerror(errno));
-	  }          
-
-	  if ((nbSuccess % (16*1024)) == 0) {
-            REBUILD_MSG("  ~ %s %d/%d",fid_list,nbSuccess,nbJobs);
-	  } 
+	  rbs_list_job_done(ctx, 1, spare, (ret == RBS_EXE_ENOENT), 0, size_written, size_read);
 	  /*
 	  ** This file has been rebuilt so remove it from the job list
 	  */
@@ -1293,7 +1577,7 @@ int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFile
       ** Update input job file if any change
       */
       if (memcmp(&file_entry_saved,&file_entry, entry_size) != 0) {
-	if (pwrite(fdlist, &file_entry, entry_size, offset)!=entry_size) {
+	if (pwrite(ctx->fdlist, &file_entry, entry_size, offset)!=entry_size) {
 	  severe("pwrite size %lu offset %llu %s",(unsigned long int)entry_size, 
         	 (unsigned long long int) offset-entry_size, strerror(errno));
 	}
@@ -1305,40 +1589,96 @@ int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFile
     
     /* Next file to rebuild */     
   }
+}
+/*-----------------------------------------------------------------------------
+**
+** Open the job list and its statistics file
+**
+** @param   ctx             The job list context to initialize
+** @param   fid_list        File containing the list of FID to rebuild
+** @param   statFilename    File containing statistics related to this rebuild list
+**
+** @retval 0 on success / -1 on error / 1 when the list does not exist
+**
+**----------------------------------------------------------------------------
+*/
+static int rbs_list_open(rbs_list_ctx_t * ctx, cid_t cid, sid_t sid, char * fid_list, char * statFilename) {
+  int ret;
   
-  if (nbSuccess == nbJobs) {
-    close(fdlist);
-    unlink(fid_list);
-    close(fdstat);	
-    REBUILD_MSG("  <- %s rebuild success of %d files",fid_list,nbSuccess);    
+  memset(ctx,0,sizeof(rbs_list_ctx_t));
+  ctx->cid          = cid;
+  ctx->sid          = sid;
+  ctx->fid_list     = fid_list;
+  ctx->statFilename = statFilename;
+  ctx->fdstat       = -1;
+  pthread_mutex_init(&ctx->lock,NULL);
+        
+  ctx->fdlist = open(fid_list,O_RDWR);
+  if (ctx->fdlist < 0) {
+    if (errno == ENOENT) {
+      return 1;
+    }
+    severe("Can not open file %s %s",fid_list,strerror(errno));
+    ctx->error = 1;
+    return -1;
+  } 
+        
+  ctx->fdstat = open(statFilename,O_RDWR | O_CREAT, 0755);
+  if (ctx->fdstat < 0) {
+      severe("Can not open file %s %s",statFilename,strerror(errno));
+      ctx->error = 1;
+      return -1;
+  }
+  ret = pread(ctx->fdstat,&ctx->statistics,sizeof(ctx->statistics),0);  
+  if ((ret != 0) && (ret != sizeof(ctx->statistics))) {
+      severe("Can not read statistics in file %s %s",statFilename,strerror(errno));
+      ctx->error = 1;
+      return -1;
+  }  
+  return 0;
+}
+/*-----------------------------------------------------------------------------
+**
+** Close the job list and its statistics file
+**
+** @param   ctx             The job list context
+** @param   what            rebuild or resecure, for the messages
+**
+** @retval 0 when every job has been done / 1 else
+**
+**----------------------------------------------------------------------------
+*/
+static int rbs_list_close(rbs_list_ctx_t * ctx, char * what) {
+
+  if ((ctx->error == 0) && (sigusr_received == 0) && (ctx->nbSuccess == ctx->nbJobs)) {
+    close(ctx->fdlist);
+    unlink(ctx->fid_list);
+    close(ctx->fdstat);	
+    pthread_mutex_destroy(&ctx->lock);
+    REBUILD_MSG("  <- %s %s success of %d files",ctx->fid_list,what,ctx->nbSuccess);    
     return 0;
   }
   
   /*
   ** Truncate the file after the last failed entry
   */
-  if (nbSuccess!=0) {
-    storaged_rebuild_compact_list(fid_list, fdlist);
+  if ((ctx->error == 0) && (ctx->nbSuccess!=0)) {
+    storaged_rebuild_compact_list(ctx->fid_list, ctx->fdlist);
   }
    
-error:
- 
-  if (fdlist != -1) close(fdlist);
-  if (fdstat != -1) close(fdstat);	
+  if (ctx->fdlist != -1) close(ctx->fdlist);
+  if (ctx->fdstat != -1) close(ctx->fdstat);	
+  pthread_mutex_destroy(&ctx->lock);
     
   if (sigusr_received) {
-    REBUILD_MSG("  <- %s rebuild paused. %d done.",fid_list,nbSuccess);    
+    REBUILD_MSG("  <- %s %s paused. %d done.",ctx->fid_list,what,ctx->nbSuccess);    
   }
   else {
-    REBUILD_MSG("  <- %s rebuild failed. %d failed /%d.",fid_list,nbJobs-nbSuccess,nbJobs);
+    REBUILD_MSG("  <- %s %s failed. %d failed /%d.",ctx->fid_list,what,ctx->nbJobs-ctx->nbSuccess,ctx->nbJobs);
     display_rbs_errors();
   }
-  
-	
   return 1;
 }
-   
-      
 /*-----------------------------------------------------------------------------
 **
 ** Rebuild a list of FID 
@@ -1350,14 +1690,36 @@ error:
 **
 **----------------------------------------------------------------------------
 */
-int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFilename) {
-  int        fdlist = -1;
-  int        fdstat = -1;  
-  int        nbJobs=0;
-  int        nbSuccess=0;
+int storaged_rebuild_list(cid_t cid, sid_t sid, char * fid_list, char * statFilename) {
+  rbs_list_ctx_t ctx;
+  int            ret;
+  
+  ret = rbs_list_open(&ctx, cid, sid, fid_list, statFilename);
+  if (ret == 1) {
+    REBUILD_MSG("  <-> %s no file to rebuild",fid_list);    
+    return 0;
+  }
+  if (ret < 0) {
+    return rbs_list_close(&ctx, "rebuild");
+  }  
+  
+  REBUILD_MSG("   -> %s rebuild start",fid_list);
+  rbs_list_run(&ctx, rbs_rebuild_list_job);
+  return rbs_list_close(&ctx, "rebuild");
+}
+/*-----------------------------------------------------------------------------
+**
+** Resecure job of a thread: resecure the FIDs of the list until its end
+**
+** @param   thread          The rebuild thread
+**
+**----------------------------------------------------------------------------
+*/
+static void rbs_resecure_list_job(rbs_list_thread_t * thread) {
+  rbs_list_ctx_t * ctx = thread->ctx;
+  cid_t      cid = ctx->cid;
+  sid_t      sid = ctx->sid;
   uint64_t   offset;
-  uint64_t   next_offset;
-  ROZOFS_RBS_COUNTERS_T         statistics;
   rozofs_rebuild_entry_file_t   file_entry;
   rozofs_rebuild_entry_file_t   file_entry_saved;
   int        ret;
@@ -1374,56 +1736,31 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
   int        result[16];
   uint8_t    sidIdx;
   int        nbSid2rebuild;
-        
-  fdlist = open(fid_list,O_RDWR);
-  if (fdlist < 0) {
-    if (errno == ENOENT) {
-      REBUILD_MSG("  <-> %s no file to resecure",fid_list);    
-      return 0;
-    }
-    
-    severe("Can not open file %s %s",fid_list,strerror(errno));
-    goto error;
-  } 
-
-        
-  fdstat = open(statFilename,O_RDWR | O_CREAT, 0755);
-  if (fdstat < 0) {
-      severe("Can not open file %s %s",statFilename,strerror(errno));
-      goto error;
-  }
-  memset(&statistics,0,sizeof(statistics));
-  ret = pread(fdstat,&statistics,sizeof(statistics),0);  
-  if ((ret != 0) && (ret != sizeof(statistics))) {
-      severe("Can not read statistics in file %s %s",statFilename,strerror(errno));
-      goto error;
-  }  
-
+  int        entry_size;
+  int        deleted;
     
   // Get connections for this given cluster  
   rbs_init_cluster_cnts(&cluster_entries, cid, sid, &failed,&available);
-  
-  REBUILD_MSG("   -> %s resecure start",fid_list);
-  
-  nbJobs    = 0;
-  nbSuccess = 0;
-  offset    = 0;
-
-  next_offset = 0;
     
   while (1) {
 
+    if (sigusr_received) {
+      break;
+    }    
     
-    offset = next_offset;
-    if (pread(fdlist,&file_entry,sizeof(file_entry),offset) <= 0) {
+    /*
+    ** Wait for the storages to be able to take more rebuild load
+    */
+    rbs_latency_wait_active(thread->idx);
+        
+    entry_size = rbs_list_get_next_job(ctx, &file_entry, &offset);
+    if (entry_size == 0) {
       break;
     } 
            
     /*
     ** Check that enough servers are available
     */
-    int entry_size = rbs_entry_size_from_layout(file_entry.layout);
-    next_offset = offset + entry_size; 
     if (file_entry.todo == 0) continue;
     if (memcmp(null_fid,file_entry.fid,sizeof(fid_t))==0) {
       severe("Null entry");
@@ -1432,14 +1769,14 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
  
     rozofs_get_rozofs_invers_forward_safe(file_entry.layout, &rozofs_inverse, &rozofs_forward, &rozofs_safe);
 
-    nbJobs++;
+    __sync_fetch_and_add(&ctx->nbJobs,1);
     
     if (available<rozofs_inverse) {
       /*
       ** Not possible to rebuild any thing
       */
       file_entry.error = rozofs_rbs_error_not_enough_storages_up;
-      if (pwrite(fdlist, &file_entry, entry_size, offset)!=entry_size) {
+      if (pwrite(ctx->fdlist, &file_entry, entry_size, offset)!=entry_size) {
 	severe("pwrite size %lu offset %llu %s",(unsigned long int)entry_size, 
                (unsigned long long int) offset-entry_size, strerror(errno));
       }
@@ -1454,11 +1791,6 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
     memcpy(re.dist_set_current,file_entry.dist_set_current, sizeof(re.dist_set_current));
     re.bsize  = file_entry.bsize;
     re.layout = file_entry.layout;
-  
-
-    if (sigusr_received) {
-      goto error;
-    }   
      
     /*
     ** Find out the spare sids that have to be used for resecuring
@@ -1482,6 +1814,7 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
     ** if it is found out that all projections are present
     */ 
     more_prj2rebuild = 1;
+    deleted          = 0;
 
     size_written = 0;
     size_read    = 0;
@@ -1513,7 +1846,7 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
         /*
         ** Re write entry in input file
         */
-        if (pwrite(fdlist, &file_entry, entry_size, offset)!=entry_size) {
+        if (pwrite(ctx->fdlist, &file_entry, entry_size, offset)!=entry_size) {
 	  severe("pwrite size %lu offset %llu %s",(unsigned long int)entry_size, 
                  (unsigned long long int) offset-entry_size, strerror(errno));
         }  
@@ -1542,7 +1875,7 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
       if (ret == RBS_EXE_FAILED) {
         if (check_fid_deleted_from_export(file_entry.fid)) {  
           file_entry.error = rozofs_rbs_error_file_deleted;
-          statistics.deleted++;
+          deleted = 1;
           more_prj2rebuild = 0;
 	  ret = RBS_EXE_ENOENT;
           break;
@@ -1561,12 +1894,10 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
       result[sidIdx]   = ret;        
     }
 
-    if (more_prj2rebuild == 0) {
-      statistics.resecured++;
-    }
     /*
     ** File is not resecured 
     */
+    int resecured = (more_prj2rebuild == 0);
     if (more_prj2rebuild == 1) {
       for (sidIdx = 0; sidIdx < nbSid2rebuild; sidIdx++) { 
         if (result[sidIdx] == RBS_EXE_SUCCESS) {
@@ -1578,65 +1909,48 @@ int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFil
     }
     
     if (more_prj2rebuild == 0) {
-      nbSuccess++;
-      // Update counters in header file 
-      statistics.done_files++;
-      statistics.written_spare += size_written;
-      statistics.read_spare    += size_read;
-      statistics.written       += size_written;
-      statistics.read          += size_read;       
       file_entry.todo = 0;
     }      
-    if (pwrite(fdstat, &statistics, sizeof(statistics), 0)!= sizeof(statistics)) {
-      severe("pwrite %s %s",statFilename,strerror(errno));
-    }          
+    rbs_list_job_done(ctx, (more_prj2rebuild == 0), 1, deleted, resecured, size_written, size_read);
 
     /*
     ** Update input job file if any change
     */
     if (memcmp(&file_entry_saved,&file_entry, entry_size) != 0) {
-      if (pwrite(fdlist, &file_entry, entry_size, offset)!=entry_size) {
+      if (pwrite(ctx->fdlist, &file_entry, entry_size, offset)!=entry_size) {
 	severe("pwrite size %lu offset %llu %s",(unsigned long int)entry_size, 
                (unsigned long long int) offset-entry_size, strerror(errno));
       }
     }
-      
-    if ((nbSuccess % (16*1024)) == 0) {
-      REBUILD_MSG("  ~ %s %d/%d",fid_list,nbSuccess,nbJobs);
-    } 
-   
   }
+}
+/*-----------------------------------------------------------------------------
+**
+** Resecure a list of FID 
+**
+** @param   fid_list        File containing the list of FID to resecure
+** @param   statFilename    File containing statistics related to this rebuild list
+**
+** @retval 0 when resecure is successfull / 1 when resecure is not completed
+**
+**----------------------------------------------------------------------------
+*/
+int storaged_resecure_list(cid_t cid, sid_t sid, char * fid_list, char * statFilename) {
+  rbs_list_ctx_t ctx;
+  int            ret;
   
-    
-  if (nbSuccess == nbJobs) {
-    close(fdlist);
-    unlink(fid_list);
-    close(fdstat);	
-    REBUILD_MSG("  <- %s resecure success of %d files",fid_list,nbSuccess);    
+  ret = rbs_list_open(&ctx, cid, sid, fid_list, statFilename);
+  if (ret == 1) {
+    REBUILD_MSG("  <-> %s no file to resecure",fid_list);    
     return 0;
   }
+  if (ret < 0) {
+    return rbs_list_close(&ctx, "resecure");
+  }  
   
-  /*
-  ** Truncate the file after the last failed entry
-  */
-  if (nbSuccess!=0) {
-    storaged_rebuild_compact_list(fid_list, fdlist);
-  }
-   
-error:
- 
-  if (fdlist != -1) close(fdlist);
-  if (fdstat != -1) close(fdstat);	
-    
-  if (sigusr_received) {
-    REBUILD_MSG("  <- %s resecure paused. %d done.",fid_list,nbSuccess);    
-  }
-  else {
-    REBUILD_MSG("  <- %s resecure failed. %d failed /%d.",fid_list,nbJobs-nbSuccess,nbJobs);
-    display_rbs_errors();
-  }
-	
-  return 1;
+  REBUILD_MSG("   -> %s resecure start",fid_list);
+  rbs_list_run(&ctx, rbs_resecure_list_job);
+  return rbs_list_close(&ctx, "resecure");
 }
 /*-----------------------------------------------------------------------------
 **
@@ -1681,6 +1995,8 @@ void usage(char * fmt, ...) {
     printf("   -i, --instance\trebuild instance number.\n");    
     printf("   -q, --quiet \tDo not print.\n");    
     printf("   -t, --throughput\tThroughput limitation in MB/s.\n");    
+    printf("   -T, --threads\tNumber of rebuild threads (1 to %d).\n",RBS_MAX_THREADS);    
+    printf("   -L, --latency\tTarget projection read latency in ms the rebuild load adapts to.\n");    
     printf("   -R  --relocate\tFor relocating files on other devices of the same SID\n");    
     printf("   -S  --reSecure\tFor a resecuring files on their spare storage\n");    
 
@@ -1714,6 +2030,8 @@ int main(int argc, char *argv[]) {
         { "quiet", no_argument, 0, 'q'},
         { "instance", required_argument, 0, 'i'},	
         { "throughput", required_argument, 0, 't'},
+        { "threads", required_argument, 0, 'T'},
+        { "latency", required_argument, 0, 'L'},
         { "nolog", no_argument, 0, 'N'},	
         { "relocate", no_argument, 0, 'R'},	
         { "reSecure", no_argument, 0, 'S'},	
@@ -1729,7 +2047,7 @@ int main(int argc, char *argv[]) {
     while (1) {
 
       int option_index = 0;
-      c = getopt_long(argc, argv, "NhH:c:s:r:i:q:f:t:SR", long_options, &option_index);
+      c = getopt_long(argc, argv, "NhH:c:s:r:i:q:f:t:T:L:SR", long_options, &option_index);
 
       if (c == -1)
           break;
@@ -1792,6 +2110,17 @@ int main(int argc, char *argv[]) {
 	    usage("Bad throughput value \"%s\"",optarg);
 	  }
 	  break;
+	case 'T':  				  
+	  if ((sscanf(optarg,"%d",&nb_threads)!=1) 
+	  ||  (nb_threads < 1) || (nb_threads > RBS_MAX_THREADS)) {
+	    usage("Bad number of threads \"%s\"",optarg);
+	  }
+	  break;
+	case 'L':  				  
+	  if ((sscanf(optarg,"%d",&target_latency)!=1) || (target_latency < 0)) {
+	    usage("Bad latency value \"%s\"",optarg);
+	  }
+	  break;
         case 'N':
           nolog = 1;
           quiet = 1;
@@ -0,0 +1,198 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <rozofs/rozofs.h>
+#include <rozofs/common/log.h>
+#include <rozofs/common/list.h>
+#include <rozofs/core/rozofs_string.h>
+
+#include "storage_lru_cache.h"
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Hash of the cache key. Neither the spare flag nor the recycling counter
+   are in the hash, so that every entry of a file is in the same bucket
+*/
+static inline uint32_t storage_lru_hash(cid_t cid, sid_t sid, fid_t fid) {
+  unsigned char * d;
+  uint32_t        h = 2166136261U;
+  fid_t           key;
+
+  memcpy(key, fid, sizeof(fid_t));
+  rozofs_reset_recycle_on_fid(key);
+  for (d = (unsigned char *)key; d != (unsigned char *)key + sizeof(fid_t); d++) {
+    h = (h * 16777619)^ *d;
+  }
+  h = (h * 16777619)^ cid;
+  h = (h * 16777619)^ sid;
+  return h;
+}
+/*
+**______________________________________________________________________________
+*/
+storage_lru_shard_t * storage_lru_lock(storage_lru_t * lru, cid_t cid, sid_t sid, fid_t fid, list_t ** bucket) {
+  storage_lru_shard_t * shard;
+  uint32_t              hash;
+
+  hash    = storage_lru_hash(cid, sid, fid);
+  shard   = &lru->shard[hash % STORAGE_LRU_SHARDS];
+  *bucket = &shard->bucket[(hash / STORAGE_LRU_SHARDS) % lru->nb_buckets];
+
+  pthread_mutex_lock(&shard->lock);
+  return shard;
+}
+/*
+**______________________________________________________________________________
+*/
+void storage_lru_release(storage_lru_t * lru, storage_lru_shard_t * shard, storage_lru_entry_t * entry) {
+  list_remove(&entry->hash_link);
+  list_remove(&entry->lru_link);
+  shard->size -= entry->size;
+  shard->entries--;
+  lru->free_entry(entry);
+}
+/*
+**______________________________________________________________________________
+*/
+void storage_lru_trim(storage_lru_t * lru, storage_lru_shard_t * shard) {
+  storage_lru_entry_t * old;
+
+  while ((shard->size > lru->shard_budget) && (!list_empty(&shard->lru))) {
+    old = list_entry(shard->lru.prev, storage_lru_entry_t, lru_link);
+    storage_lru_release(lru, shard, old);
+    shard->stats.evict++;
+  }
+}
+/*
+**______________________________________________________________________________
+*/
+void storage_lru_invalidate(storage_lru_t * lru, cid_t cid, sid_t sid, fid_t fid) {
+  storage_lru_shard_t * shard;
+  storage_lru_entry_t * entry;
+  list_t              * bucket;
+  list_t              * p;
+  list_t              * q;
+
+  if (!lru->enabled) return;
+
+  shard = storage_lru_lock(lru, cid, sid, fid, &bucket);
+
+  list_for_each_forward_safe(p, q, bucket) {
+    entry = list_entry(p, storage_lru_entry_t, hash_link);
+    if (entry->cid != cid) continue;
+    if (entry->sid != sid) continue;
+    if (!storage_lru_same_file(entry->fid, fid)) continue;
+    storage_lru_release(lru, shard, entry);
+    shard->stats.invalidate++;
+  }
+
+  storage_lru_unlock(shard);
+}
+/*
+**______________________________________________________________________________
+*/
+char * storage_lru_display(storage_lru_t * lru, char * p, int reset) {
+  storage_lru_stats_t   total;
+  uint64_t              size = 0;
+  uint64_t              entries = 0;
+  uint64_t              hit;
+  int                   i;
+
+  memset(&total, 0, sizeof(total));
+  for (i = 0; i < STORAGE_LRU_SHARDS; i++) {
+    storage_lru_shard_t * shard = &lru->shard[i];
+
+    pthread_mutex_lock(&shard->lock);
+    total.hit        += shard->stats.hit;
+    total.miss       += shard->stats.miss;
+    total.stale      += shard->stats.stale;
+    total.insert     += shard->stats.insert;
+    total.evict      += shard->stats.evict;
+    total.invalidate += shard->stats.invalidate;
+    size             += shard->size;
+    entries          += shard->entries;
+    if (reset) memset(&shard->stats, 0, sizeof(shard->stats));
+    pthread_mutex_unlock(&shard->lock);
+  }
+  hit = (total.hit > total.stale) ? total.hit - total.stale : 0;
+
+  p += rozofs_string_append(p, "budget     : ");
+  p += rozofs_u64_append(p, lru->shard_budget * STORAGE_LRU_SHARDS);
+  p += rozofs_string_append(p, "\nsize       : ");
+  p += rozofs_u64_append(p, size);
+  p += rozofs_string_append(p, "\nentries    : ");
+  p += rozofs_u64_append(p, entries);
+  p += rozofs_string_append(p, "\nhit        : ");
+  p += rozofs_u64_append(p, total.hit);
+  p += rozofs_string_append(p, "\nmiss       : ");
+  p += rozofs_u64_append(p, total.miss);
+  p += rozofs_string_append(p, "\nstale      : ");
+  p += rozofs_u64_append(p, total.stale);
+  p += rozofs_string_append(p, "\nhit ratio  : ");
+  p += rozofs_u64_append(p, (total.hit+total.miss) ? (hit*100)/(total.hit+total.miss) : 0);
+  p += rozofs_string_append(p, "%\ninsert     : ");
+  p += rozofs_u64_append(p, total.insert);
+  p += rozofs_string_append(p, "\nevict      : ");
+  p += rozofs_u64_append(p, total.evict);
+  p += rozofs_string_append(p, "\ninvalidate : ");
+  p += rozofs_u64_append(p, total.invalidate);
+  p += rozofs_eol(p);
+  if (reset) {
+    p += rozofs_string_append(p, "Reset Done\n");
+  }
+  return p;
+}
+/*
+**______________________________________________________________________________
+*/
+int storage_lru_init(storage_lru_t * lru, uint32_t size_MB, uint32_t nb_buckets, storage_lru_free_fct free_entry) {
+  int i;
+  int j;
+
+  memset(lru, 0, sizeof(storage_lru_t));
+  if (size_MB == 0) return 0;
+
+  lru->nb_buckets = nb_buckets;
+  lru->free_entry = free_entry;
+
+  for (i = 0; i < STORAGE_LRU_SHARDS; i++) {
+    storage_lru_shard_t * shard = &lru->shard[i];
+
+    shard->bucket = malloc(nb_buckets * sizeof(list_t));
+    if (shard->bucket == NULL) {
+      severe("storage_lru_init(%u MB) %s", size_MB, strerror(errno));
+      return -1;
+    }
+    pthread_mutex_init(&shard->lock, NULL);
+    list_init(&shard->lru);
+    for (j = 0; j < nb_buckets; j++) {
+      list_init(&shard->bucket[j]);
+    }
+  }
+  lru->shard_budget = ((uint64_t)size_MB * 1024 * 1024) / STORAGE_LRU_SHARDS;
+  lru->enabled      = 1;
+  return 0;
+}
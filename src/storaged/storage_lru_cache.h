@@ -0,0 +1,263 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STORAGE_LRU_CACHE_H
+#define STORAGE_LRU_CACHE_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <rozofs/rozofs.h>
+#include <rozofs/common/list.h>
+
+/*
+** Memory budgeted cache of per FID entries, used by the header cache
+** and the projection cache.
+**
+** The cache is split in shards, each with its own lock, LRU list, hash
+** buckets and share of the memory budget, so that the disk threads
+** hardly ever compete for the same lock. The key of an entry is the
+** cid/sid/spare and the FID. The recycling counter of the FID is not
+** in the hash, so that every entry of a file is found in the same
+** bucket whatever its recycling counter.
+**
+** Each cache embeds a storage_lru_entry_t at the beginning of its own
+** entries, and gives the function that frees them.
+*/
+#define STORAGE_LRU_SHARDS       64
+
+typedef struct _storage_lru_entry_t {
+  list_t      hash_link;                 /**< link in the hash bucket        */
+  list_t      lru_link;                  /**< link in the shard LRU          */
+  fid_t       fid;
+  cid_t       cid;
+  sid_t       sid;
+  uint8_t     spare;
+  uint32_t    size;                      /**< memory accounted for the entry */
+} storage_lru_entry_t;
+
+typedef struct _storage_lru_stats_t {
+  uint64_t    hit;
+  uint64_t    miss;
+  uint64_t    stale;                     /**< hit found out of date on disk  */
+  uint64_t    insert;
+  uint64_t    evict;
+  uint64_t    invalidate;
+} storage_lru_stats_t;
+
+typedef struct _storage_lru_shard_t {
+  pthread_mutex_t       lock;
+  list_t                lru;             /**< most recently used first       */
+  uint64_t              size;            /**< memory used by the shard       */
+  uint64_t              entries;
+  storage_lru_stats_t   stats;
+  list_t              * bucket;
+} storage_lru_shard_t;
+
+typedef void (*storage_lru_free_fct)(storage_lru_entry_t * entry);
+
+typedef struct _storage_lru_t {
+  int                   enabled;
+  uint32_t              nb_buckets;      /**< hash buckets per shard         */
+  uint64_t              shard_budget;    /**< memory budget of a shard       */
+  storage_lru_free_fct  free_entry;
+  storage_lru_shard_t   shard[STORAGE_LRU_SHARDS];
+} storage_lru_t;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Compare 2 FIDs without their recycling counter
+*/
+static inline int storage_lru_same_file(fid_t fid1, fid_t fid2) {
+  fid_t f1;
+  fid_t f2;
+
+  memcpy(f1, fid1, sizeof(fid_t));
+  memcpy(f2, fid2, sizeof(fid_t));
+  rozofs_reset_recycle_on_fid(f1);
+  rozofs_reset_recycle_on_fid(f2);
+  return (memcmp(f1, f2, sizeof(fid_t)) == 0);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Lock the shard of a file and get its hash bucket
+
+   @param lru: the cache
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param fid: the file
+   @param bucket: where to return the hash bucket of the file
+
+   @retval the locked shard
+*/
+storage_lru_shard_t * storage_lru_lock(storage_lru_t * lru, cid_t cid, sid_t sid, fid_t fid, list_t ** bucket);
+/*
+**______________________________________________________________________________
+*/
+static inline void storage_lru_unlock(storage_lru_shard_t * shard) {
+  pthread_mutex_unlock(&shard->lock);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Look for the entry of a file in a bucket. The shard must be locked
+
+   @param bucket: the hash bucket of the file
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param spare: whether the storage is spare for this FID
+   @param fid: the file
+   @param recycle: whether the recycling counter must match too
+
+   @retval the entry or NULL
+*/
+static inline storage_lru_entry_t * storage_lru_lookup(list_t * bucket, cid_t cid, sid_t sid,
+                                                       uint8_t spare, fid_t fid, int recycle) {
+  list_t              * p;
+  storage_lru_entry_t * entry;
+
+  list_for_each_forward(p, bucket) {
+    entry = list_entry(p, storage_lru_entry_t, hash_link);
+    if (entry->cid   != cid)   continue;
+    if (entry->sid   != sid)   continue;
+    if (entry->spare != spare) continue;
+    if (recycle) {
+      if (memcmp(entry->fid, fid, sizeof(fid_t)) != 0) continue;
+    }
+    else {
+      if (!storage_lru_same_file(entry->fid, fid)) continue;
+    }
+    return entry;
+  }
+  return NULL;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Insert a new entry, which key is already set, in a bucket and at the
+   head of the LRU. The shard must be locked
+
+   @param shard: the locked shard
+   @param bucket: the hash bucket of the entry
+   @param entry: the entry
+   @param size: memory size of the entry
+*/
+static inline void storage_lru_insert(storage_lru_shard_t * shard, list_t * bucket,
+                                      storage_lru_entry_t * entry, uint32_t size) {
+  list_init(&entry->hash_link);
+  list_init(&entry->lru_link);
+  list_push_front(bucket, &entry->hash_link);
+  list_push_front(&shard->lru, &entry->lru_link);
+  entry->size   = size;
+  shard->size  += size;
+  shard->entries++;
+  shard->stats.insert++;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Move an entry at the head of the LRU. The shard must be locked
+*/
+static inline void storage_lru_touch(storage_lru_shard_t * shard, storage_lru_entry_t * entry) {
+  list_remove(&entry->lru_link);
+  list_push_front(&shard->lru, &entry->lru_link);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Account some more memory for an entry. The shard must be locked
+*/
+static inline void storage_lru_grow(storage_lru_shard_t * shard, storage_lru_entry_t * entry, int32_t size) {
+  entry->size += size;
+  shard->size += size;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Remove an entry from the cache and free it. The shard must be locked
+*/
+void storage_lru_release(storage_lru_t * lru, storage_lru_shard_t * shard, storage_lru_entry_t * entry);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Evict the least recently used entries of a shard until it respects
+   its memory budget. The shard must be locked
+*/
+void storage_lru_trim(storage_lru_t * lru, storage_lru_shard_t * shard);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Drop every entry of a file on a cid/sid, nominal as well as spare,
+   whatever its recycling counter
+
+   @param lru: the cache
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param fid: the file
+*/
+void storage_lru_invalidate(storage_lru_t * lru, cid_t cid, sid_t sid, fid_t fid);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Format the statistics of a cache for rozodiag
+
+   @param lru: the cache
+   @param p: where to format
+   @param reset: whether to reset the statistics
+
+   @retval the end of the formatted text
+*/
+char * storage_lru_display(storage_lru_t * lru, char * p, int reset);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Initialize a cache
+
+   @param lru: the cache
+   @param size_MB: memory budget of the cache in MB. 0 disables the cache
+   @param nb_buckets: number of hash buckets per shard
+   @param free_entry: function that frees an entry
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int storage_lru_init(storage_lru_t * lru, uint32_t size_MB, uint32_t nb_buckets, storage_lru_free_fct free_entry);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
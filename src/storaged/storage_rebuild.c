@@ -204,6 +204,9 @@ typedef struct _rbs_parameter_t {
   int      chunk;  // Chunk to rebuild when FID is given 
   rbs_file_type_e filetype; // spare/nominal/all 
   int      throughput; // spare/nominal/all 
+  int      threads;    // Number of rebuild threads per rebuild process
+  int      latency;    // Target projection read latency in ms
+  int      incremental;// Only rebuild what the exportd dirty logs tell
 } rbs_parameter_t;
 
 rbs_parameter_t parameter;
@@ -243,6 +246,7 @@ static inline char * format_status_file(char * pJSON) {
     JSON_string("started",initial_date);
     JSON_string("command",command);
     JSON_u32("parallel",parameter.parallel);   
+    JSON_u32("threads",parameter.threads);   
     JSON_u32("loop",run_loop);
     if (parameter.type == rbs_rebuild_type_fid) {
       JSON_string("mode","FID");
@@ -259,7 +263,10 @@ static inline char * format_status_file(char * pJSON) {
       }	
     }
     else {
-      if (parameter.cid == -1) {
+      if (parameter.incremental) {
+        JSON_string("mode","incremental");     
+      }
+      else if (parameter.cid == -1) {
         JSON_string("mode","node");     
       }
       else {
@@ -478,6 +485,9 @@ void rbs_conf_init(rbs_parameter_t * par) {
   par->chunk                = -1;
   par->filetype             = rbs_file_type_all;
   par->throughput           = 0;
+  par->threads              = 1;
+  par->latency              = 0;
+  par->incremental          = 0;
   
   
   par->storaged_geosite = rozofs_get_local_site();
@@ -524,8 +534,11 @@ void usage(char * fmt, ...) {
     printf("                             \t(default is %d, maximum is %d)\n",
            common_config.device_self_healing_process,MAXIMUM_PARALLEL_REBUILD_PER_SID);   
     printf("   -t, --throughput          \tThroughput limitation in MB/s per rebuild process in parallel.\n");    
+    printf("   -T, --threads=<val>       \tNumber of rebuild threads per rebuild process (default 1)\n");    
+    printf("   -L, --latency=<ms>        \tTarget projection read latency the rebuild load adapts to.\n");    
     printf("       --spare               \tTo rebuild only spare files on node or sid rebuild.\n");
     printf("       --nominal             \tTo rebuild only nominal files on node or sid rebuild.\n");
+    printf("       --incremental         \tTo rebuild only the writes missed while the storages were unreachable.\n");
     printf("   -g, --geosite             \tTo force site number in case of geo-replication\n");
     printf("   -R, --relocate            \tTo rebuild a device by relocating files\n");
     printf("   -S, --reSecure            \tTo resecure files of a failed device on their spare location\n");
@@ -632,6 +645,16 @@ void parse_command(int argc, char *argv[], rbs_parameter_t * par) {
       GET_INT_PARAM(-t,par->throughput);
       continue;
     }  	
+
+    if (IS_ARG(-T) || IS_ARG(--threads)) {
+      GET_INT_PARAM(-T,par->threads);
+      continue;
+    }  	
+
+    if (IS_ARG(-L) || IS_ARG(--latency)) {
+      GET_INT_PARAM(-L,par->latency);
+      continue;
+    }  	
        
     if IS_ARG(-resume) {
       par->resume = 1;
@@ -688,6 +711,11 @@ void parse_command(int argc, char *argv[], rbs_parameter_t * par) {
       par->filetype = rbs_file_type_nominal;     
       continue;
     }  
+
+    if (IS_ARG(--incremental)) {
+      par->incremental = 1;     
+      continue;
+    }  
         
     if (IS_ARG(-K) || IS_ARG(--clearOnly)) {
       par->clear = 2;     
@@ -884,6 +912,18 @@ void parse_command(int argc, char *argv[], rbs_parameter_t * par) {
     }
   }
   /*
+  ** Incremental rebuild only applies to node or sid rebuild of nominal files
+  */
+  if (par->incremental) {
+    if (par->type != rbs_rebuild_type_storage) {
+      usage("--incremental option is incompatible with --device and --fid options.");
+    }
+    if (par->filetype == rbs_file_type_spare) {
+      usage("--incremental and --spare options are incompatible.");
+    }
+    par->filetype = rbs_file_type_nominal;
+  }
+  /*
   ** When resecure is set, cid/sid and device are mandatory 
   */
   if (par->resecure) {
@@ -1873,6 +1913,12 @@ int rbs_build_job_list_from_export() {
   else if (parameter.filetype == rbs_file_type_nominal) {
     pChar += sprintf(pChar,"--nominal ");
   }      
+  /*
+  ** Incremental rebuild : list only the files of the dirty logs
+  */                 
+  if (parameter.incremental) {
+    pChar += sprintf(pChar,"--dirty ");
+  }      
                    
   /* 
   ** In case of local test simulation, provide export.conf full path
@@ -2221,6 +2267,14 @@ int rbs_do_list_rebuild(int cid, int sid, rbs_file_type_e ftype) {
         pChar += rozofs_string_append(pChar," -t ");
         pChar += rozofs_u32_append(pChar,parameter.throughput);
       }
+      if (parameter.threads > 1) {
+        pChar += rozofs_string_append(pChar," -T ");
+        pChar += rozofs_u32_append(pChar,parameter.threads);
+      }
+      if (parameter.latency) {
+        pChar += rozofs_string_append(pChar," -L ");
+        pChar += rozofs_u32_append(pChar,parameter.latency);
+      }
       if (nolog) {
 	pChar += rozofs_string_append(pChar," --nolog");
       }
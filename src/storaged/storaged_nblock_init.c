@@ -628,6 +628,7 @@ int storaged_start_nb_th(void *args) {
     if (size < sizeof(mp_remove_arg_t)) size = sizeof(mp_remove_arg_t);  
     if (size < sizeof(mp_list_bins_files_arg_t)) size = sizeof(mp_list_bins_files_arg_t);
     if (size < sizeof(mp_size_arg_t)) size = sizeof(mp_size_arg_t);
+    if (size < sizeof(mp_remove_bulk_arg_t)) size = sizeof(mp_remove_bulk_arg_t);
     
     storaged_decoded_rpc_buffer_pool = ruc_buf_poolCreate(STORAGED_BUF_RECV_CNT,size);
     if (storaged_decoded_rpc_buffer_pool == NULL) {
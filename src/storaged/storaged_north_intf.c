@@ -116,6 +116,13 @@ void mproto_sub_thread(rozorpc_srv_ctx_t *rozorpc_srv_ctx_p, rozofs_rpc_call_hdr
       local = mp_subthread_size;
       size = sizeof(mp_size_arg_t);
       break;
+
+    case MP_REMOVE_BULK:
+      rozorpc_srv_ctx_p->arg_decoder = (xdrproc_t) xdr_mp_remove_bulk_arg_t;
+      rozorpc_srv_ctx_p->xdr_result  = (xdrproc_t) xdr_mp_remove_bulk_ret_t;
+      local = mp_subthread_remove_bulk;
+      size = sizeof(mp_remove_bulk_arg_t);
+      break;
     
 
     default:
@@ -329,6 +336,7 @@ void storaged_req_rcv_cbk(void *userRef,uint32_t  socket_ctx_idx, void *recv_buf
 	  case MP_REMOVE:
 	  case MP_LIST_BINS_FILES:
 	  case MP_SIZE:
+	  case MP_REMOVE_BULK:
 	    mproto_sub_thread(rozorpc_srv_ctx_p, &hdr);
 	    break;
 	    
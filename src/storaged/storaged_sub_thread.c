@@ -265,6 +265,121 @@ out:
 /*__________________________________________________________________________
 */
 /**
+*  Perform the removal of a set of files
+
+   The files are processed by slice directory rather than in the order of
+   the request, so that the successive unlinks hit the same directories.
+   When a rate is configured, the thread sleeps between the files not to
+   compete with the foreground I/O on the devices.
+
+  @param thread_ctx_p: pointer to the thread context
+  @param msg         : address of the message received
+  
+  @retval: none
+*/
+static inline void storaged_sub_thread_remove_bulk(storaged_sub_thread_ctx_t *thread_ctx_p,storaged_sub_thread_msg_t * msg) {
+  struct timeval                 timeDay;
+  unsigned long long             timeBefore, timeAfter;
+  rozorpc_srv_ctx_t            * rpcCtx;
+  mp_remove_bulk_arg_t         * args;  
+  mp_remove_bulk_ret_t           ret;
+  int                            status=-1;
+  uint8_t                        order[MP_REMOVE_BULK_MAX];
+  uint32_t                       key[MP_REMOVE_BULK_MAX];
+  uint32_t                       rate;
+  unsigned long long             deadline;
+  unsigned long long             budget;
+  int                            max;
+  int                            idx,j;
+      
+  gettimeofday(&timeDay,(struct timezone *)0);  
+  timeBefore = MICROLONG(timeDay);  
+
+  /*
+  ** update statistics
+  */
+  thread_ctx_p->stat.remove_bulk_count++; 
+  
+  rpcCtx = msg->rpcCtx;
+  args   = (mp_remove_bulk_arg_t*) ruc_buf_getPayload(rpcCtx->decoded_arg);
+
+  ret.status = MP_SUCCESS;          
+  ret.mp_remove_bulk_ret_t_u.failed = 0;
+
+  /*
+  ** Sort the files on spare/slice
+  */
+  for (idx=0; idx<args->nb; idx++) {
+    uint32_t k = (args->entries[idx].spare << 16) | rozofs_storage_fid_slice(args->entries[idx].fid);
+    for (j=idx; (j>0) && (key[j-1] > k); j--) {
+      key[j]   = key[j-1];
+      order[j] = order[j-1];
+    }
+    key[j]   = k;
+    order[j] = idx;
+  }
+  
+  rate     = common_config.remove_bulk_rate;
+  deadline = timeBefore;
+  /*
+  ** The exportd waits for the response at most mproto_timeout seconds.
+  ** Only spend half of it, and process no more files than the pacing
+  ** allows during that time. The remaining files are reported as failed,
+  ** so the exportd sends them again later on.
+  */
+  budget   = (unsigned long long)common_config.mproto_timeout * 1000000 / 2;
+  max      = args->nb;
+  if (rate != 0) {
+    max = (rate * common_config.mproto_timeout) / 2;
+    if (max == 0) max = 1;
+  }
+  
+  for (j=0; j<args->nb; j++) {
+  
+    idx = order[j];
+
+    if (j != 0) {
+      gettimeofday(&timeDay,(struct timezone *)0);  
+      timeAfter = MICROLONG(timeDay);
+      if ((j >= max) || ((timeAfter-timeBefore) >= budget)) {
+        for (; j<args->nb; j++) {
+          ret.mp_remove_bulk_ret_t_u.failed |= (1ULL<<order[j]);
+          thread_ctx_p->stat.remove_bulk_deferred++;
+        }
+        break;
+      }
+    }
+    thread_ctx_p->stat.remove_bulk_files++;
+    
+    if (storage_rm2_file(msg->st, (unsigned char *) args->entries[idx].fid, args->entries[idx].spare) != 0) {
+      ret.mp_remove_bulk_ret_t_u.failed |= (1ULL<<idx);
+      thread_ctx_p->stat.remove_bulk_errors++ ;   
+    }
+
+    /*
+    ** Pace the removals
+    */
+    if (rate == 0) continue;
+    if ((j+1) >= max) continue;
+    deadline += (1000000/rate);
+    gettimeofday(&timeDay,(struct timezone *)0);  
+    timeAfter = MICROLONG(timeDay);
+    if (timeAfter < deadline) {
+      usleep(deadline-timeAfter);
+      thread_ctx_p->stat.remove_bulk_paced_us += (deadline-timeAfter);
+    }   
+  }    
+  
+  storaged_sub_thread_encode_rpc_response(rpcCtx,(char*)&ret);  
+
+  gettimeofday(&timeDay,(struct timezone *)0);  
+  timeAfter = MICROLONG(timeDay);
+  thread_ctx_p->stat.remove_bulk_time +=(timeAfter-timeBefore);  
+  storaged_sub_thread_intf_send_response(thread_ctx_p,msg,status);
+}  
+/*__________________________________________________________________________
+*/
+/**
 *  Compute file size and allocated sectors
 
   @param thread_ctx_p: pointer to the thread context
@@ -459,6 +574,9 @@ void *storaged_sub_thread(void *arg) {
       case MP_SIZE:
         storaged_sub_thread_size(ctx_p,&msg);
         break;
+      case MP_REMOVE_BULK:
+        storaged_sub_thread_remove_bulk(ctx_p,&msg);
+        break;
        	
       default:
         fatal(" unexpected opcode : %d\n",msg.opcode);
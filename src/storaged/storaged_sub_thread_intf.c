@@ -136,6 +136,15 @@ void storaged_sub_thread_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
   display_line_val_and_sum("   Cumulative Time (us)",remove_time);
   display_line_div_and_sum("   Average Time (us)",remove_time,remove_count);
 
+  display_line_topic("Remove bulk");  
+  display_line_val_and_sum("   number", remove_bulk_count);
+  display_line_val_and_sum("   files", remove_bulk_files);
+  display_line_val_and_sum("   errors", remove_bulk_errors);
+  display_line_val_and_sum("   Cumulative Time (us)",remove_bulk_time);
+  display_line_div_and_sum("   Average Time (us)",remove_bulk_time,remove_bulk_count);
+  display_line_val_and_sum("   Paced Time (us)",remove_bulk_paced_us);
+  display_line_val_and_sum("   deferred", remove_bulk_deferred);
+
   display_line_topic("List bins");  
   display_line_val_and_sum("   number", list_bins_count);
   display_line_val_and_sum("   errors", list_bins_errors);
@@ -279,6 +288,7 @@ void storaged_sub_thread_read_response(storaged_sub_thread_msg_t *msg)
   switch (opcode) {
     case MP_REMOVE2:
     case MP_REMOVE:
+    case MP_REMOVE_BULK:
        STOP_PROFILING(remove);
        break;
     case MP_LIST_BINS_FILES:
@@ -39,6 +39,13 @@ typedef struct _storaged_sub_thread_stat_t {
   uint64_t            remove_count;
   uint64_t            remove_errors;
   uint64_t            remove_time;
+
+  uint64_t            remove_bulk_count;
+  uint64_t            remove_bulk_files;
+  uint64_t            remove_bulk_errors;
+  uint64_t            remove_bulk_time;
+  uint64_t            remove_bulk_paced_us;
+  uint64_t            remove_bulk_deferred;
   
   uint64_t            list_bins_count;
   uint64_t            list_bins_errors;
@@ -235,6 +235,61 @@ static void on_start(void) {
 }
 
 
+/*
+**____________________________________________________
+*/
+/**
+*  Find out the NUMA node the devices and the network interfaces of
+*  the storio are attached to
+*
+*  Every device directory and every IO address votes for the node it
+*  is attached to. The whole storio process is then pinned on that
+*  node: there is no per node group of disk threads.
+
+   @retval the node that has the majority of the votes
+   @retval -1 when no node has the majority
+*/
+static int storio_numa_locality_node(void) {
+  list_t  * p;
+  char      path[PATH_MAX];
+  int       votes[64];
+  int       total = 0;
+  int       node;
+  int       dev;
+  int       i;
+
+  memset(votes,0,sizeof(votes));
+
+  /*
+  ** Vote of the devices
+  */
+  list_for_each_forward(p, &storaged_config.storages) {
+    storage_config_t *sc = list_entry(p, storage_config_t, list);
+
+    for (dev=0; dev < sc->device.total; dev++) {
+      snprintf(path,sizeof(path),"%s/%d",sc->root,dev);
+      node = rozofs_numa_node_of_path(path);
+      if ((node < 0)||(node >= 64)) continue;
+      votes[node]++;
+      total++;
+    }
+  }  
+  /*
+  ** Vote of the network interfaces
+  */
+  for (i=0; i < storaged_config.io_addr_nb; i++) {
+    if (storaged_config.io_addr[i].ipv4 == INADDR_ANY) continue;
+    node = rozofs_numa_node_of_ipv4(storaged_config.io_addr[i].ipv4);
+    if ((node < 0)||(node >= 64)) continue;
+    votes[node]++;
+    total++;
+  }
+  
+  for (node=0; node < 64; node++) {
+    if (2*votes[node] > total) return node;
+  }
+  return -1;
+}
 void usage() {
 
     printf("Rozofs storage daemon - %s\n", VERSION);
@@ -363,7 +418,17 @@ int main(int argc, char *argv[]) {
       /*
       ** No node identifier set in storage.conf 
       */ 
-      if (pHostArray[0] != NULL) {
+      int locality_node = -1;
+      if (common_config.numa_aware) {
+        locality_node = storio_numa_locality_node();
+      }	
+      if (locality_node >= 0) {
+         /*
+         ** Run close to the devices and the network interfaces
+         */
+         rozofs_numa_allocate_node(locality_node,"device locality");
+      }
+      else if (pHostArray[0] != NULL) {
          /*
          ** Use hostname to dispatch the storios on the nodes
          ** This is a one node configuration
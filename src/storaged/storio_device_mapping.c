@@ -183,7 +183,7 @@ char * storio_display_one_mapping_ctx(char * pChar, storio_device_mapping_t * p)
   pChar += rozofs_string_append(pChar,", \"FID\" : \"");
   pChar += rozofs_fid_append(pChar,p->key.fid);
   pChar += rozofs_string_append(pChar,"\", \"running\" : ");
-  if (p->serial_is_running) {    
+  if (storio_serial_is_running(p)) {    
     pChar += rozofs_string_append(pChar,"\"YES\",\n");
   }
   else {  
@@ -127,9 +127,8 @@ typedef union _storio_device_u {
 typedef struct _storio_device_mapping_t
 {
   list_t               link;  
-//  uint32_t             padding:3;
+//  uint32_t             padding:4;
   uint32_t             recycle_cpt:2;
-  uint32_t             serial_is_running:1;     /**< assert to one when a disk thread is processing the requests         */
   uint32_t             small_device_array:1;    // how to read device union
   uint32_t             device_unknown:1;        // Set to 1 when device distr. is unknown
   uint32_t             index:24;
@@ -138,8 +137,12 @@ typedef struct _storio_device_mapping_t
   /*
   ** storio serialise
   */
-  list_t               serial_pending_request;  /**< list the pending request for the FID   */
-  pthread_rwlock_t     serial_lock;             /**< lock associated with serial_pending_request list & running flag     */
+  void               * serial_head;             /**< serialization state word (see storio_serialization.c) */
+  /*
+  ** storio disk scheduler (see storio_disk_sched.c)
+  */
+  list_t               sched_link;              /**< link in the device queue while waiting for a disk thread */
+  uint64_t             sched_time;              /**< time the FID context has been queued */
     
   STORIO_REBUILD_REF_U storio_rebuild_ref;
 } storio_device_mapping_t;
@@ -404,6 +407,19 @@ static inline uint32_t storio_device_mapping_hash32bits_compute(storio_device_ma
   return h;
 }
 
+/*
+**______________________________________________________________________________
+*/
+/**
+* Tells whether requests are pending or being processed on a FID context
+
+  @param p the device_mapping context
+  
+  @retval 1 when a disk thread owns the FID context
+*/
+static inline int storio_serial_is_running(storio_device_mapping_t * p) {
+  return (__atomic_load_n(&p->serial_head,__ATOMIC_ACQUIRE) != NULL);
+}
 /*
 **______________________________________________________________________________
 */
@@ -421,8 +437,7 @@ static inline void storio_device_mapping_ctx_reset(storio_device_mapping_t * p)
   p->small_device_array = 1;
   p->device.ptr         = NULL;
 //  p->consistency   = storio_device_mapping_stat.consistency;
-  list_init(&p->serial_pending_request);
-  p->serial_is_running = 0;
+  p->serial_head = NULL;
 
   p->storio_rebuild_ref.u64 = 0xFFFFFFFFFFFFFFFF;
 }
@@ -461,7 +476,7 @@ static inline void storio_device_mapping_release_entry(storio_device_mapping_t *
   }
      
 
-  if ((p->serial_is_running)||(!list_empty(&p->serial_pending_request)))
+  if (storio_serial_is_running(p))
   {
     severe("storio_device_mapping_ctx_free but ctx is running");
   }
@@ -576,7 +591,6 @@ static inline void storio_device_mapping_ctx_distributor_init(int nbCtx) {
   
   for (idx=0; idx<STORIO_DEVICE_MAPPING_MAX_ENTRIES; idx++) {
     p = storio_device_mapping_ctx_retrieve(idx);
-    pthread_rwlock_init(&p->serial_lock, NULL);
     p->index  = idx;
     storio_device_mapping_ctx_reset(p);
   }  
@@ -0,0 +1,386 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <rozofs/rozofs.h>
+#include <rozofs/common/log.h>
+#include <rozofs/common/list.h>
+#include <rozofs/common/common_config.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include <rozofs/core/rozofs_string.h>
+#include <rozofs/core/ruc_sockCtl_api.h>
+
+#include "storage.h"
+#include "storio_disk_thread_intf.h"
+#include "storio_disk_sched.h"
+
+/*
+** One queue per device of each cid/sid, plus one for the FID
+** contexts which device is not known yet
+*/
+#define STORIO_DISK_SCHED_QUEUE_PER_STORAGE   (STORAGE_MAX_DEVICE_NB+1)
+#define STORIO_DISK_SCHED_UNKNOWN_DEVICE      STORAGE_MAX_DEVICE_NB
+
+typedef struct _storio_disk_sched_queue_t {
+  list_t      ready_link;                           /**< link in the ready queue list      */
+  int         ready;                                /**< whether in the ready queue list   */
+  uint32_t    inflight;                             /**< FID contexts being processed      */
+  uint32_t    max_inflight;                         /**< 0 when not limited                */
+  list_t      fifo[STORIO_DISK_SCHED_CLASS_MAX];    /**< queued FID contexts per class     */
+  uint32_t    depth[STORIO_DISK_SCHED_CLASS_MAX];   /**< number of queued FID contexts     */
+  int         current[STORIO_DISK_SCHED_CLASS_MAX]; /**< weighted round robin state        */
+  /*
+  ** statistics
+  */
+  uint32_t    max_depth;
+  uint64_t    dispatched[STORIO_DISK_SCHED_CLASS_MAX];
+  uint64_t    wait_us[STORIO_DISK_SCHED_CLASS_MAX];
+  uint64_t    max_wait_us;
+  uint64_t    throttled;                            /**< times work was held by the limit  */
+} storio_disk_sched_queue_t;
+
+int                          storio_disk_sched_enabled = 0;
+static int                   storio_disk_sched_weight[STORIO_DISK_SCHED_CLASS_MAX];
+static storio_disk_sched_queue_t * storio_disk_sched_queue = NULL;
+static int                   storio_disk_sched_queue_nb = 0;
+static list_t                storio_disk_sched_ready;
+static pthread_mutex_t       storio_disk_sched_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t        storio_disk_sched_cond = PTHREAD_COND_INITIALIZER;
+
+static char * storio_disk_sched_class_name[STORIO_DISK_SCHED_CLASS_MAX] = {
+  "read", "write", "repair", "rebuild"
+};
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Get the priority class of a FID context activation
+
+   @param fidCtx: the FID context
+   @param opcode: opcode of the request that activates the FID context
+
+   @retval the class
+*/
+static inline int storio_disk_sched_class(storio_device_mapping_t * fidCtx, int opcode) {
+
+  if (fidCtx->storio_rebuild_ref.u64 != 0xFFFFFFFFFFFFFFFF) return STORIO_DISK_SCHED_REBUILD;
+
+  switch (opcode) {
+    case STORIO_DISK_THREAD_READ:
+    case STORIO_DISK_THREAD_RESIZE:
+      return STORIO_DISK_SCHED_READ;
+    case STORIO_DISK_THREAD_WRITE_REPAIR3:
+      return STORIO_DISK_SCHED_REPAIR;
+    case STORIO_DISK_THREAD_REBUILD_START:
+    case STORIO_DISK_THREAD_REBUILD_STOP:
+      return STORIO_DISK_SCHED_REBUILD;
+    default:
+      return STORIO_DISK_SCHED_WRITE;
+  }
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Get the queue of a FID context
+
+   @param fidCtx: the FID context
+
+   @retval the queue index
+*/
+static inline int storio_disk_sched_queue_idx(storio_device_mapping_t * fidCtx) {
+  storage_t * st;
+  int         dev;
+
+  st = storaged_lookup(fidCtx->key.cid, fidCtx->key.sid);
+  if (st == NULL) st = storaged_storages;
+
+  dev = storio_get_dev(fidCtx, 0);
+  if (dev >= STORAGE_MAX_DEVICE_NB) dev = STORIO_DISK_SCHED_UNKNOWN_DEVICE;
+
+  return (st - storaged_storages) * STORIO_DISK_SCHED_QUEUE_PER_STORAGE + dev;
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Put a queue in the ready list when it has work and may run some more
+*
+*  Called under the scheduler lock
+
+   @param q: the queue
+*/
+static inline void storio_disk_sched_check_ready(storio_disk_sched_queue_t * q) {
+  int cls;
+  int pending = 0;
+
+  if (q->ready) return;
+
+  for (cls = 0; cls < STORIO_DISK_SCHED_CLASS_MAX; cls++) pending += q->depth[cls];
+  if (pending == 0) return;
+
+  if ((q->max_inflight != 0) && (q->inflight >= q->max_inflight)) {
+    q->throttled++;
+    return;
+  }
+
+  q->ready = 1;
+  list_push_back(&storio_disk_sched_ready, &q->ready_link);
+  pthread_cond_signal(&storio_disk_sched_cond);
+}
+/*
+**______________________________________________________________________________
+*/
+void storio_disk_sched_push(storio_device_mapping_t * fidCtx, int opcode) {
+  storio_disk_sched_queue_t * q;
+  int                         cls;
+  uint32_t                    depth;
+
+  cls = storio_disk_sched_class(fidCtx, opcode);
+  fidCtx->sched_time = rozofs_get_ticker_us();
+
+  pthread_mutex_lock(&storio_disk_sched_lock);
+
+  q = &storio_disk_sched_queue[storio_disk_sched_queue_idx(fidCtx)];
+  list_push_back(&q->fifo[cls], &fidCtx->sched_link);
+  q->depth[cls]++;
+
+  depth = q->depth[0]+q->depth[1]+q->depth[2]+q->depth[3];
+  if (depth > q->max_depth) q->max_depth = depth;
+
+  storio_disk_sched_check_ready(q);
+
+  pthread_mutex_unlock(&storio_disk_sched_lock);
+}
+/*
+**______________________________________________________________________________
+*/
+storio_device_mapping_t * storio_disk_sched_get(int * queue, uint64_t * timeStart) {
+  storio_disk_sched_queue_t * q;
+  storio_device_mapping_t   * fidCtx;
+  int                         cls;
+  int                         best;
+  int                         total;
+  uint64_t                    wait;
+
+  pthread_mutex_lock(&storio_disk_sched_lock);
+
+  while (list_empty(&storio_disk_sched_ready)) {
+    pthread_cond_wait(&storio_disk_sched_cond, &storio_disk_sched_lock);
+  }
+  q = list_first_entry(&storio_disk_sched_ready, storio_disk_sched_queue_t, ready_link);
+  list_remove(&q->ready_link);
+  q->ready = 0;
+
+  /*
+  ** Smooth weighted round robin between the classes that have work
+  */
+  best  = -1;
+  total = 0;
+  for (cls = 0; cls < STORIO_DISK_SCHED_CLASS_MAX; cls++) {
+    if (q->depth[cls] == 0) continue;
+    q->current[cls] += storio_disk_sched_weight[cls];
+    total           += storio_disk_sched_weight[cls];
+    if ((best < 0) || (q->current[cls] > q->current[best])) best = cls;
+  }
+  q->current[best] -= total;
+
+  fidCtx = list_first_entry(&q->fifo[best], storio_device_mapping_t, sched_link);
+  list_remove(&fidCtx->sched_link);
+  q->depth[best]--;
+  q->inflight++;
+
+  wait = rozofs_get_ticker_us();
+  wait = (wait > fidCtx->sched_time) ? wait - fidCtx->sched_time : 0;
+  q->dispatched[best]++;
+  q->wait_us[best] += wait;
+  if (wait > q->max_wait_us) q->max_wait_us = wait;
+
+  /*
+  ** Go back at the end of the ready list so that the devices are served
+  ** in turn, and wake up an other thread for it
+  */
+  storio_disk_sched_check_ready(q);
+
+  pthread_mutex_unlock(&storio_disk_sched_lock);
+
+  *queue     = q - storio_disk_sched_queue;
+  *timeStart = fidCtx->sched_time;
+  return fidCtx;
+}
+/*
+**______________________________________________________________________________
+*/
+void storio_disk_sched_done(int queue) {
+  storio_disk_sched_queue_t * q = &storio_disk_sched_queue[queue];
+
+  pthread_mutex_lock(&storio_disk_sched_lock);
+  q->inflight--;
+  storio_disk_sched_check_ready(q);
+  pthread_mutex_unlock(&storio_disk_sched_lock);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Disk scheduler debug function
+*/
+static void storio_disk_sched_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char                      * p = uma_dbg_get_buffer();
+  storio_disk_sched_queue_t * q;
+  int                         doreset = 0;
+  int                         idx;
+  int                         cls;
+  int                         dev;
+  storage_t                 * st;
+
+  if ((argv[1] != NULL) && (strcmp(argv[1],"reset")==0)) doreset = 1;
+
+  if (!storio_disk_sched_enabled) {
+    p += rozofs_string_append(p, "disk scheduler is disabled (storio_device_max_inflight)\n");
+    uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+    return;
+  }
+
+  p += rozofs_string_append(p, "weights :");
+  for (cls = 0; cls < STORIO_DISK_SCHED_CLASS_MAX; cls++) {
+    *p++ = ' ';
+    p += rozofs_string_append(p, storio_disk_sched_class_name[cls]);
+    *p++ = '=';
+    p += rozofs_u32_append(p, storio_disk_sched_weight[cls]);
+  }
+  p += rozofs_eol(p);
+  p += rozofs_string_append(p, "+-----+-----+-----+----------+-----------+---------+------------+------------+------------+\n");
+  p += rozofs_string_append(p, "| cid | sid | dev | inflight | max depth |  class  |   depth    | dispatched | avg wait us|\n");
+  p += rozofs_string_append(p, "+-----+-----+-----+----------+-----------+---------+------------+------------+------------+\n");
+
+  pthread_mutex_lock(&storio_disk_sched_lock);
+  for (idx = 0; idx < storio_disk_sched_queue_nb; idx++) {
+    q   = &storio_disk_sched_queue[idx];
+    if ((q->max_depth == 0) && (q->inflight == 0)) continue;
+
+    st  = &storaged_storages[idx / STORIO_DISK_SCHED_QUEUE_PER_STORAGE];
+    dev = idx % STORIO_DISK_SCHED_QUEUE_PER_STORAGE;
+
+    for (cls = 0; cls < STORIO_DISK_SCHED_CLASS_MAX; cls++) {
+      if (cls == 0) {
+        p += rozofs_string_append(p, "| ");
+        p += rozofs_u32_padded_append(p, 3, rozofs_right_alignment, st->cid);
+        p += rozofs_string_append(p, " | ");
+        p += rozofs_u32_padded_append(p, 3, rozofs_right_alignment, st->sid);
+        p += rozofs_string_append(p, " | ");
+        if (dev == STORIO_DISK_SCHED_UNKNOWN_DEVICE) {
+          p += rozofs_string_append(p, "  ?");
+        }
+        else {
+          p += rozofs_u32_padded_append(p, 3, rozofs_right_alignment, dev);
+        }
+        p += rozofs_string_append(p, " | ");
+        p += rozofs_u32_padded_append(p, 8, rozofs_right_alignment, q->inflight);
+        p += rozofs_string_append(p, " | ");
+        p += rozofs_u32_padded_append(p, 9, rozofs_right_alignment, q->max_depth);
+      }
+      else {
+        p += rozofs_string_append(p, "|     |     |     |          |          ");
+      }
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_string_padded_append(p, 7, rozofs_left_alignment, storio_disk_sched_class_name[cls]);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u32_padded_append(p, 10, rozofs_right_alignment, q->depth[cls]);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, q->dispatched[cls]);
+      p += rozofs_string_append(p, " | ");
+      p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment,
+                                    q->dispatched[cls] ? q->wait_us[cls]/q->dispatched[cls] : 0);
+      p += rozofs_string_append(p, " |\n");
+    }
+    p += rozofs_string_append(p, "|     |     |     | max wait us ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, q->max_wait_us);
+    p += rozofs_string_append(p, " | throttled ");
+    p += rozofs_u64_padded_append(p, 10, rozofs_right_alignment, q->throttled);
+    p += rozofs_eol(p);
+    p += rozofs_string_append(p, "+-----+-----+-----+----------+-----------+---------+------------+------------+------------+\n");
+
+    if (doreset) {
+      q->max_depth   = 0;
+      q->max_wait_us = 0;
+      q->throttled   = 0;
+      memset(q->dispatched, 0, sizeof(q->dispatched));
+      memset(q->wait_us, 0, sizeof(q->wait_us));
+    }
+    /*
+    ** Do not overflow the debug buffer
+    */
+    if ((p - uma_dbg_get_buffer()) > (uma_dbg_get_buffer_len() - 2048)) {
+      p += rozofs_string_append(p, "...\n");
+      break;
+    }
+  }
+  pthread_mutex_unlock(&storio_disk_sched_lock);
+
+  if (doreset) {
+    p += rozofs_string_append(p, "Reset Done\n");
+  }
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**______________________________________________________________________________
+*/
+int storio_disk_sched_init(int max_inflight) {
+  int idx;
+  int cls;
+
+  uma_dbg_addTopic_option("diskSched", storio_disk_sched_debug, UMA_DBG_OPTION_RESET);
+
+  if (max_inflight == 0) return 0;
+
+  storio_disk_sched_weight[STORIO_DISK_SCHED_READ]    = common_config.storio_sched_read_weight;
+  storio_disk_sched_weight[STORIO_DISK_SCHED_WRITE]   = common_config.storio_sched_write_weight;
+  storio_disk_sched_weight[STORIO_DISK_SCHED_REPAIR]  = common_config.storio_sched_repair_weight;
+  storio_disk_sched_weight[STORIO_DISK_SCHED_REBUILD] = common_config.storio_sched_rebuild_weight;
+
+  storio_disk_sched_queue_nb = storaged_nrstorages * STORIO_DISK_SCHED_QUEUE_PER_STORAGE;
+  if (storio_disk_sched_queue_nb == 0) storio_disk_sched_queue_nb = STORIO_DISK_SCHED_QUEUE_PER_STORAGE;
+
+  storio_disk_sched_queue = malloc(storio_disk_sched_queue_nb * sizeof(storio_disk_sched_queue_t));
+  if (storio_disk_sched_queue == NULL) {
+    severe("storio_disk_sched_init(%d) %s", max_inflight, strerror(errno));
+    return -1;
+  }
+  memset(storio_disk_sched_queue, 0, storio_disk_sched_queue_nb * sizeof(storio_disk_sched_queue_t));
+
+  list_init(&storio_disk_sched_ready);
+  for (idx = 0; idx < storio_disk_sched_queue_nb; idx++) {
+    storio_disk_sched_queue_t * q = &storio_disk_sched_queue[idx];
+
+    list_init(&q->ready_link);
+    for (cls = 0; cls < STORIO_DISK_SCHED_CLASS_MAX; cls++) {
+      list_init(&q->fifo[cls]);
+    }
+    if ((idx % STORIO_DISK_SCHED_QUEUE_PER_STORAGE) != STORIO_DISK_SCHED_UNKNOWN_DEVICE) {
+      q->max_inflight = max_inflight;
+    }
+  }
+  storio_disk_sched_enabled = 1;
+  return 0;
+}
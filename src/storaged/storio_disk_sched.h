@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STORIO_DISK_SCHED_H
+#define STORIO_DISK_SCHED_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <stdint.h>
+#include <rozofs/rozofs.h>
+#include "storio_device_mapping.h"
+
+/*
+** The disk scheduler replaces the shared disk request socket when
+** storio_device_max_inflight is not 0.
+**
+** The FID contexts to process are queued per device of a cid/sid, and
+** within a device per priority class. A device has at most
+** storio_device_max_inflight FID contexts processed at the same time,
+** so a slow or failing device can not hold every disk thread. Any idle
+** disk thread takes work from the next device that has some, and
+** within that device the class is chosen by a smooth weighted round
+** robin on the class weights.
+**
+** The FID contexts which device is not known yet go to a per cid/sid
+** queue that has no in-flight limit.
+*/
+typedef enum _storio_disk_sched_class_e {
+  STORIO_DISK_SCHED_READ=0,       /**< foreground reads                       */
+  STORIO_DISK_SCHED_WRITE,        /**< foreground writes, truncates, removes  */
+  STORIO_DISK_SCHED_REPAIR,       /**< block repairs                          */
+  STORIO_DISK_SCHED_REBUILD,      /**< FID under rebuild                      */
+  STORIO_DISK_SCHED_CLASS_MAX
+} storio_disk_sched_class_e;
+
+extern int storio_disk_sched_enabled;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Initialize the disk scheduler
+*
+*  To be called once the storages are configured
+
+   @param max_inflight: max number of FID contexts processed in parallel
+                        per device. 0 disables the scheduler
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int storio_disk_sched_init(int max_inflight);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Queue a FID context that has some requests to process
+*
+*  Called by the main thread when the FID context gets active
+
+   @param fidCtx: the FID context
+   @param opcode: opcode of the request that activates the FID context
+*/
+void storio_disk_sched_push(storio_device_mapping_t * fidCtx, int opcode);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Get the next FID context to process
+*
+*  Called by the disk threads. Blocks until some work is allowed to run
+
+   @param queue: where to return the reference of the queue, to be given
+                 back to storio_disk_sched_done()
+   @param timeStart: where to return the time the FID context has been queued
+
+   @retval the FID context to process
+*/
+storio_device_mapping_t * storio_disk_sched_get(int * queue, uint64_t * timeStart);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Tell the processing of a FID context got from the scheduler is over
+
+   @param queue: the queue reference returned by storio_disk_sched_get()
+*/
+void storio_disk_sched_done(int queue);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -39,6 +39,8 @@
 #include "storio_north_intf.h"
 #include <rozofs/core/ruc_buffer_debug.h>
 #include "storio_serialization.h"
+#include "storio_prjcache.h"
+#include "storio_disk_sched.h"
 
 int af_unix_disk_socket_ref = -1;
  
@@ -387,6 +389,19 @@ static inline void storio_disk_read(rozofs_disk_thread_ctx_t *thread_ctx_p,stori
 #endif   
 
 
+  /*
+  ** Try the projection cache first
+  */
+  uint16_t psize     = rozofs_get_max_psize_in_msg(args->layout,args->bsize);
+  uint64_t crc_error = st->crc_error;
+  if (storio_prjcache_read(args->cid, args->sid, args->spare, (unsigned char *) args->fid, 
+                           args->bid, args->nb_proj, psize, pbuf)) {
+    ret.sp_read_ret_t_u.rsp.bins.bins_len  = args->nb_proj * psize;
+    ret.sp_read_ret_t_u.rsp.file_size      = 0;
+    thread_ctx_p->stat.read_cache_hit++;
+    goto success;
+  }
+
   // Lookup for the device id for this FID
   // Read projections
   if (storage_read(st, fidCtx, args->layout, args->bsize,(sid_t *) args->dist_set, args->spare,
@@ -409,7 +424,16 @@ static inline void storio_disk_read(rozofs_disk_thread_ctx_t *thread_ctx_p,stori
     storio_send_response(thread_ctx_p,msg,-1);
     return;
   }  
+  
+  /*
+  ** Cache the blocks when they have all been read without any CRC32 error
+  */
+  if ((ret.sp_read_ret_t_u.rsp.bins.bins_len == (args->nb_proj * psize)) && (st->crc_error == crc_error)) {
+    storio_prjcache_insert(args->cid, args->sid, args->spare, (unsigned char *) args->fid, 
+                           args->bid, args->nb_proj, psize, pbuf);
+  }
  
+success: 
   ret.status = SP_SUCCESS;  
   msg->size = ret.sp_read_ret_t_u.rsp.bins.bins_len;        
   storio_encode_rpc_response(rpcCtx,(char*)&ret);  
@@ -641,9 +665,11 @@ static inline void storio_disk_write(rozofs_disk_thread_ctx_t *thread_ctx_p,stor
   
   
   // Write projections
+  storage_io_is_rebuild = (args->rebuild_ref != 0);
   size =  storage_write(st, fidCtx, args->layout, args->bsize, (sid_t *) args->dist_set, args->spare,
           (unsigned char *) args->fid, args->bid, args->nb_proj, version,
           &ret.sp_write_ret_t_u.file_size,(bin_t *) pbuf, &is_fid_faulty);
+  storage_io_is_rebuild = 0;
   if (size <= 0)  {
     ret.sp_write_ret_t_u.error = errno;
     if (errno == ENOSPC)
@@ -679,6 +705,195 @@ static inline void storio_disk_write(rozofs_disk_thread_ctx_t *thread_ctx_p,stor
 /*__________________________________________________________________________
 */
 /**
+*  Check that a write request can be written along with other ones: its
+   bins length is consistent and its blocks are within one chunk of the file.
+   Inconsistent requests are processed alone to get their own error
+
+  @param args        : the arguments of the request
+  @param rpcCtx      : the RPC context of the request
+  
+  @retval 1 when the request is consistent, 0 otherwise
+*/
+static inline int storio_disk_write_consistent(sp_write_arg_no_bins_t * args,
+                                               rozorpc_srv_ctx_t      * rpcCtx) {
+  int                      block_per_chunk;
+  int                      size;
+
+  if (args->nb_proj == 0) return 0;
+  size = ruc_buf_getPayloadLen(rpcCtx->xmitBuf) - rpcCtx->position;
+  if (size != args->len) return 0;
+  if ((args->nb_proj * rozofs_get_max_psize_in_msg(args->layout,args->bsize)) > args->len) return 0;
+
+  block_per_chunk = ROZOFS_STORAGE_NB_BLOCK_PER_CHUNK(args->bsize);
+  if ((args->bid / block_per_chunk) >= ROZOFS_STORAGE_MAX_CHUNK_PER_FILE) return 0;
+  if (((args->bid + args->nb_proj - 1) / block_per_chunk) != (args->bid / block_per_chunk)) return 0;
+  return 1;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  Check whether a pending write request can be merged with the previous
+   write requests of the same FID
+
+  @param first       : arguments of the first write request to merge
+  @param next_bid    : block following the last block of the previous requests
+  @param rpcCtx      : the pending request to check
+  
+  @retval the arguments of the request when it can be merged, NULL otherwise
+*/
+static inline sp_write_arg_no_bins_t * storio_disk_write_mergeable(sp_write_arg_no_bins_t * first,
+                                                                   uint64_t                 next_bid,
+                                                                   rozorpc_srv_ctx_t      * rpcCtx) {
+  sp_write_arg_no_bins_t * args;
+  int                      block_per_chunk;
+
+  if (rpcCtx->opcode != STORIO_DISK_THREAD_WRITE) return NULL;
+  
+  args = (sp_write_arg_no_bins_t*) ruc_buf_getPayload(rpcCtx->decoded_arg);
+  
+  /*
+  ** Contiguous blocks of the same file on the same storage
+  */
+  if (args->bid != next_bid) return NULL;
+  if ((args->cid != first->cid) || (args->sid != first->sid)) return NULL;
+  if ((args->layout != first->layout) || (args->bsize != first->bsize)) return NULL;
+  if (args->spare != first->spare) return NULL;
+  if (args->rebuild_ref != first->rebuild_ref) return NULL;
+  if (memcmp(args->fid, first->fid, sizeof(sp_uuid_t)) != 0) return NULL;
+  if (memcmp(args->dist_set, first->dist_set, sizeof(args->dist_set)) != 0) return NULL;
+  
+  /*
+  ** All in the same chunk as the first request
+  */
+  block_per_chunk = ROZOFS_STORAGE_NB_BLOCK_PER_CHUNK(args->bsize);
+  if ((args->bid / block_per_chunk) != (first->bid / block_per_chunk)) return NULL;
+  
+  if (storio_disk_write_consistent(args, rpcCtx) == 0) return NULL;
+  return args;
+}
+/*__________________________________________________________________________
+*/
+/**
+*  Write at once several contiguous write requests of a FID
+
+  @param thread_ctx_p: pointer to the thread context
+  @param msg         : the messages of the requests, in block order
+  @param nb          : number of requests
+  
+  @retval: none
+*/
+static inline void storio_disk_write_coalesced(rozofs_disk_thread_ctx_t *thread_ctx_p,storio_disk_thread_msg_t * msg, int nb) {
+  struct timeval            timeDay;
+  unsigned long long        timeBefore, timeAfter;
+  storage_t               * st = 0;
+  sp_write_arg_no_bins_t  * first;
+  sp_write_arg_no_bins_t  * args;
+  rozorpc_srv_ctx_t       * rpcCtx;
+  sp_write_ret_t            ret;
+  uint8_t                   version = 0;
+  int                       size;
+  int                       is_fid_faulty;
+  storio_device_mapping_t * fidCtx;
+  storage_write_seg_t       seg[STORAGE_WRITE_MAX_SEG];
+  uint32_t                  nb_proj = 0;
+  int                       block_per_chunk;
+  int                       i;
+  int                       status = -1;
+
+  gettimeofday(&timeDay,(struct timezone *)0);  
+  timeBefore = MICROLONG(timeDay);
+
+  ret.status = SP_FAILURE;          
+  
+  /*
+  ** update statistics
+  */
+  thread_ctx_p->stat.write_count += nb;
+  thread_ctx_p->stat.write_coalesced++;
+  thread_ctx_p->stat.write_coalesced_req += nb;
+  
+  first  = (sp_write_arg_no_bins_t*) ruc_buf_getPayload(msg[0].rpcCtx->decoded_arg);
+
+  fidCtx = storio_device_mapping_ctx_retrieve(msg[0].fidIdx);
+  if (fidCtx == NULL) {
+    ret.sp_write_ret_t_u.error = EIO;
+    severe("Bad FID ctx index %d",msg[0].fidIdx); 
+    thread_ctx_p->stat.write_error += nb;   
+    goto response;
+  }  
+
+  // Get the storage for the couple (cid;sid)
+  if ((st = storaged_lookup(first->cid, first->sid)) == 0) {
+    ret.sp_write_ret_t_u.error = errno;
+    thread_ctx_p->stat.write_badCidSid += nb;   
+    goto response;
+  }
+
+  /*
+  ** One segment per request. The bins are in the xmit buffers
+  */
+  block_per_chunk = ROZOFS_STORAGE_NB_BLOCK_PER_CHUNK(first->bsize);
+  for (i=0; i<nb; i++) {
+    rpcCtx          = msg[i].rpcCtx;
+    args            = (sp_write_arg_no_bins_t*) ruc_buf_getPayload(rpcCtx->decoded_arg);
+    if ((args->bid / block_per_chunk) >= ROZOFS_STORAGE_MAX_CHUNK_PER_FILE) {
+      ret.sp_write_ret_t_u.error = EFBIG;
+      thread_ctx_p->stat.write_error += nb; 
+      goto response;
+    }
+    seg[i].bins     = (bin_t *) ((char*)ruc_buf_getPayload(rpcCtx->xmitBuf) + rpcCtx->position);
+    seg[i].nb_proj  = args->nb_proj;
+    nb_proj        += args->nb_proj;
+  }
+  
+  // Write projections
+  storage_io_is_rebuild = (first->rebuild_ref != 0);
+  size = storage_write_chunk_vect(st, fidCtx, first->layout, first->bsize, (sid_t *) first->dist_set, first->spare,
+                                  (unsigned char *) first->fid, first->bid / block_per_chunk, first->bid % block_per_chunk, 
+                                  nb, seg, version, &ret.sp_write_ret_t_u.file_size, &is_fid_faulty);
+  storage_io_is_rebuild = 0;
+  if (size <= 0)  {
+    ret.sp_write_ret_t_u.error = errno;
+    if (errno == ENOSPC)
+      thread_ctx_p->stat.write_nospace += nb;
+    else   
+      thread_ctx_p->stat.write_error += nb; 
+    if (is_fid_faulty) {
+      storio_register_faulty_fid(thread_ctx_p->thread_idx,
+				 first->cid,
+				 first->sid,
+				 (uint8_t*)first->fid);
+    }       
+    goto response;
+  }
+  
+  ret.status = SP_SUCCESS;  
+  ret.sp_write_ret_t_u.file_size = 0;
+  status = 0;
+  thread_ctx_p->stat.write_Byte_count += size;
+
+response:
+  /*
+  ** Fan the responses out
+  */
+  for (i=0; i<nb; i++) {
+    if (status == 0) {
+      msg[i].size = (uint64_t)size * seg[i].nb_proj / nb_proj;
+    }  
+    storio_encode_rpc_response(msg[i].rpcCtx,(char*)&ret);  
+    storio_send_response(thread_ctx_p,&msg[i],status);
+  }
+
+  /*
+  ** Update statistics
+  */
+  gettimeofday(&timeDay,(struct timezone *)0);  
+  timeAfter = MICROLONG(timeDay);
+  thread_ctx_p->stat.write_time +=(timeAfter-timeBefore);  
+} 
+/*__________________________________________________________________________
+*/
+/**
 *  Write data to a file
 
   @param thread_ctx_p: pointer to the thread context
@@ -1261,6 +1476,7 @@ void *storio_disk_thread(void *arg) {
   rozofs_disk_thread_ctx_t * ctx_p = (rozofs_disk_thread_ctx_t*)arg;
   int                        bytesRcvd;
   uint64_t                   newval;
+  int                        sched_queue = -1;
 
   uma_dbg_thread_add_self("Disk thread");
 
@@ -1299,19 +1515,35 @@ void *storio_disk_thread(void *arg) {
   
   while(1) {
   
-    /*
-    ** read the north disk socket
-    */
-    bytesRcvd = recvfrom(af_unix_disk_socket_ref,
-			 &msg,sizeof(msg), 
-			 0,(struct sockaddr *)NULL,NULL);
-    if (bytesRcvd == -1) {
-      fatal("Disk Thread %d recvfrom %s !!\n",ctx_p->thread_idx,strerror(errno));
-      exit(0);
+    if (storio_disk_sched_enabled) {
+      /*
+      ** Get the next FID context to process from the disk scheduler
+      */
+      storio_device_mapping_t * fidCtx;
+
+      fidCtx = storio_disk_sched_get(&sched_queue, &msg.timeStart);
+      msg.msg_len        = sizeof(storio_disk_thread_msg_t)-sizeof(msg.msg_len);
+      msg.opcode         = STORIO_DISK_THREAD_FID;
+      msg.status         = 0;
+      msg.transaction_id = 0;
+      msg.fidIdx         = fidCtx->index;
+      msg.rpcCtx         = NULL;
     }
-    if (bytesRcvd != sizeof(msg)) {
-      fatal("Disk Thread %d socket is dead (%d/%d) %s !!\n",ctx_p->thread_idx,bytesRcvd,(int)sizeof(msg),strerror(errno));
-      exit(0);    
+    else {
+      /*
+      ** read the north disk socket
+      */
+      bytesRcvd = recvfrom(af_unix_disk_socket_ref,
+			   &msg,sizeof(msg), 
+			   0,(struct sockaddr *)NULL,NULL);
+      if (bytesRcvd == -1) {
+	fatal("Disk Thread %d recvfrom %s !!\n",ctx_p->thread_idx,strerror(errno));
+	exit(0);
+      }
+      if (bytesRcvd != sizeof(msg)) {
+	fatal("Disk Thread %d socket is dead (%d/%d) %s !!\n",ctx_p->thread_idx,bytesRcvd,(int)sizeof(msg),strerror(errno));
+	exit(0);    
+      }
     }
       
     newval = __atomic_fetch_add(&af_unix_disk_parallel_req,1,__ATOMIC_SEQ_CST);
@@ -1320,6 +1552,17 @@ void *storio_disk_thread(void *arg) {
         
     msg.size = 0;
     
+    /*
+    ** Any other request than a read may modify the file on disk
+    */
+    if ((msg.opcode != STORIO_DISK_THREAD_READ) && (msg.opcode != STORIO_DISK_THREAD_RESIZE)
+    &&  (msg.opcode != STORIO_DISK_THREAD_FID)) {
+      storio_device_mapping_t * fidCtx = storio_device_mapping_ctx_retrieve(msg.fidIdx);
+      if (fidCtx != NULL) {
+        storio_prjcache_invalidate(fidCtx->key.cid, fidCtx->key.sid, fidCtx->key.fid);
+      }
+    }
+    
     switch (msg.opcode) {
     
       case STORIO_DISK_THREAD_READ:
@@ -1371,6 +1614,14 @@ void *storio_disk_thread(void *arg) {
         exit(0);       
     }
     newval = __atomic_fetch_sub(&af_unix_disk_parallel_req,1,__ATOMIC_SEQ_CST)-1;
+
+    /*
+    ** Let the disk scheduler run an other FID context on that device
+    */
+    if (sched_queue >= 0) {
+      storio_disk_sched_done(sched_queue);
+      sched_queue = -1;
+    }
 //    sched_yield();
   }
 }
@@ -1454,7 +1705,7 @@ int storio_disk_thread_create(char * hostname, int nb_threads, int instance_id)
 /*__________________________________________________________________________
 */
 /**
-*  Process requests found in the serial_pending_request list of a FID
+*  Process the requests queued on a FID
 
   @param thread_ctx_p: pointer to the thread context
   @param msg         : address of the message received
@@ -1468,7 +1719,9 @@ void storio_disk_serial(rozofs_disk_thread_ctx_t *ctx_p,storio_disk_thread_msg_t
   int empty;
   rozorpc_srv_ctx_t      * rpcCtx;
   storio_disk_thread_msg_t   msg;  
+  storio_disk_thread_msg_t   wr_msg[STORAGE_WRITE_MAX_SEG];  
   int fdl_count = 0;
+  int nb;
   
   memcpy(&msg,msg_in,sizeof(storio_disk_thread_msg_t));
   /*
@@ -1501,6 +1754,13 @@ void storio_disk_serial(rozofs_disk_thread_ctx_t *ctx_p,storio_disk_thread_msg_t
      msg.rpcCtx = rpcCtx;
      msg.timeStart = rpcCtx->profiler_time;
      
+     /*
+     ** Any other request than a read may modify the file on disk
+     */
+     if ((msg.opcode != STORIO_DISK_THREAD_READ) && (msg.opcode != STORIO_DISK_THREAD_RESIZE)) {
+       storio_prjcache_invalidate(fidCtx->key.cid, fidCtx->key.sid, fidCtx->key.fid);
+     }
+     
      switch (msg.opcode) {
 
        case STORIO_DISK_THREAD_READ:
@@ -1512,7 +1772,42 @@ void storio_disk_serial(rozofs_disk_thread_ctx_t *ctx_p,storio_disk_thread_msg_t
          break;	
 
        case STORIO_DISK_THREAD_WRITE:
-         storio_disk_write(ctx_p,&msg);
+         /*
+         ** Merge the following contiguous writes of the FID
+         */
+         nb = 1;
+         if (common_config.storio_write_coalescing) {
+           sp_write_arg_no_bins_t * first;
+           sp_write_arg_no_bins_t * args;
+           uint64_t                 next_bid;
+           int                      max_nb;
+           
+           first    = (sp_write_arg_no_bins_t*) ruc_buf_getPayload(rpcCtx->decoded_arg);
+           next_bid = first->bid + first->nb_proj;
+           memcpy(&wr_msg[0],&msg,sizeof(msg));
+           /*
+           ** An inconsistent first request is written alone to get its own error
+           */
+           max_nb   = storio_disk_write_consistent(first, rpcCtx) ? STORAGE_WRITE_MAX_SEG : 1;
+           while ((nb < max_nb) && (!list_empty(&diskthread_list))) {
+             rozorpc_srv_ctx_t * nextCtx = list_first_entry(&diskthread_list,rozorpc_srv_ctx_t,list);
+             args = storio_disk_write_mergeable(first, next_bid, nextCtx);
+             if (args == NULL) break;
+             if ((next_bid + args->nb_proj - first->bid) > (ROZOFS_MAX_BLOCK_PER_MSG*2)) break;
+             list_remove(&nextCtx->list);
+             memcpy(&wr_msg[nb],&msg,sizeof(msg));
+             wr_msg[nb].rpcCtx    = nextCtx;
+             wr_msg[nb].timeStart = nextCtx->profiler_time;
+             next_bid += args->nb_proj;
+             nb++;
+           }
+         }  
+         if (nb == 1) {
+           storio_disk_write(ctx_p,&msg);
+         }
+         else {
+           storio_disk_write_coalesced(ctx_p,wr_msg,nb);
+         }
          break;
 
        case STORIO_DISK_THREAD_WRITE_EMPTY:
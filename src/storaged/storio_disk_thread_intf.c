@@ -36,6 +36,7 @@
 #include "config.h"
 #include "storio_device_mapping.h"
 #include "storio_serialization.h"
+#include "storio_disk_sched.h"
 
 DECLARE_PROFILING(spp_profiler_t); 
  
@@ -365,6 +366,21 @@ void disk_thread_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
     if ((i%8)==0) pChar += rozofs_string_append(pChar,"\n                         ");
   }    
   pChar += rozofs_string_append(pChar,"\n");
+  
+  if (storage_direct_io_mode != STORAGE_DIRECT_IO_OFF) {
+    pChar += rozofs_string_append(pChar,"direct I/O (");
+    pChar += rozofs_string_append(pChar,(storage_direct_io_mode==STORAGE_DIRECT_IO_ALL)?"all":"rebuild");
+    pChar += rozofs_string_append(pChar,") read ");
+    pChar += rozofs_u64_append(pChar,storage_direct_io_stat.read);
+    pChar += rozofs_string_append(pChar," write ");
+    pChar += rozofs_u64_append(pChar,storage_direct_io_stat.write);
+    pChar += rozofs_string_append(pChar," fallback ");
+    pChar += rozofs_u64_append(pChar,storage_direct_io_stat.fallback);
+    pChar += rozofs_string_append(pChar," unsupported ");
+    pChar += rozofs_u64_append(pChar,storage_direct_io_stat.unsupported);
+    pChar += rozofs_string_append(pChar,"\n");
+    if (doreset) memset(&storage_direct_io_stat,0,sizeof(storage_direct_io_stat));
+  }
      
   
   memset(&sum, 0, sizeof(sum));
@@ -397,6 +413,7 @@ void disk_thread_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
     display_line_val("!! error spare",read_error_spare);  
     display_line_val("!! error",read_error);  
     display_line_val("   Bytes",read_Byte_count);      
+    display_line_val("   Projection cache hits",read_cache_hit);      
     display_line_val("   Cumulative Time (us)",read_time);
     display_line_div("   Average Bytes",read_Byte_count,read_count);  
     display_line_div("   Average Time (us)",read_time,read_count);
@@ -412,6 +429,9 @@ void disk_thread_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
     display_line_div("   Average Bytes",write_Byte_count,write_count); 
     display_line_div("   Average Time (us)",write_time,write_count);
     display_line_div("   Throughput (MBytes/s)",write_Byte_count,write_time);  
+    display_line_val("   Coalesced writes",write_coalesced);      
+    display_line_val("   Coalesced requests",write_coalesced_req);      
+    display_line_div("   Requests per coalesced write",write_coalesced_req,write_coalesced);  
 
     display_line_topic("Truncate Requests");  
     display_line_val("   number", truncate_count);
@@ -903,16 +923,26 @@ int storio_disk_thread_intf_send(storio_device_mapping_t      * fidCtx,
    associated with a FID
 *
 * @param fidCtx     FID context
+* @param opcode     opcode of the request that activates the FID context
 * @param timeStart  time stamp when the request has been decoded
 *
 * @retval 0 on success -1 in case of error
 *  
 */
 int storio_disk_thread_intf_serial_send(storio_device_mapping_t      * fidCtx,
+                                         int            opcode,
 				         uint64_t       timeStart) 
 {
   int                         ret;
   storio_disk_thread_msg_t    msg;
+
+  /*
+  ** Queue the FID context on its device when the disk scheduler is enabled
+  */
+  if (storio_disk_sched_enabled) {
+    storio_disk_sched_push(fidCtx, opcode);
+    return 0;
+  }
  
   /* Fill the message */
   msg.msg_len          = sizeof(storio_disk_thread_msg_t)-sizeof(msg.msg_len);
@@ -41,6 +41,7 @@ typedef struct _rozofs_disk_thread_stat_t {
   uint64_t            read_nosuchfile;
   uint64_t            read_badCidSid;
   uint64_t            read_time;
+  uint64_t            read_cache_hit;      /**< reads served by the projection cache */
   
   uint64_t            write_count;
   uint64_t            write_Byte_count;
@@ -48,6 +49,8 @@ typedef struct _rozofs_disk_thread_stat_t {
   uint64_t            write_badCidSid; 
   uint64_t            write_nospace; 
   uint64_t            write_time;
+  uint64_t            write_coalesced;     /**< disk writes merging several requests */
+  uint64_t            write_coalesced_req; /**< requests merged in these disk writes */
 
   uint64_t            truncate_count;
   uint64_t            truncate_error;
@@ -178,11 +181,13 @@ void storio_send_response (rozofs_disk_thread_ctx_t *thread_ctx_p, storio_disk_t
    associated with a FID
 *
 * @param fidCtx     FID context
+* @param opcode     opcode of the request that activates the FID context
 * @param timeStart  time stamp when the request has been decoded
 *
 * @retval 0 on success -1 in case of error
 *  
 */
 int storio_disk_thread_intf_serial_send(storio_device_mapping_t      * fidCtx,
+                                         int            opcode,
 				         uint64_t       timeStart);
 #endif
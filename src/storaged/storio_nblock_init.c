@@ -72,6 +72,8 @@
 #include "storage.h"
 #include "storio_crc32.h"
 #include "storio_device_mapping.h"
+#include "storio_prjcache.h"
+#include "storio_disk_sched.h"
 
 extern sconfig_t storaged_config;
 extern char * pHostArray[];
@@ -387,6 +389,11 @@ int storio_start_nb_th(void *args) {
   }
   ruc_buffer_debug_register_pool("rpcDecodedRequest",decoded_rpc_buffer_pool);
 
+  /*
+  ** Per device disk request queues
+  */
+  storio_disk_sched_init(common_config.storio_device_max_inflight);
+
   /*
   ** Initialize the disk thread interface and start the disk threads
   */	
@@ -422,6 +429,18 @@ int storio_start_nb_th(void *args) {
   detailed_counters_init();
   serialization_counters_init();
   /*
+  ** Projection cache of the disk threads
+  */
+  storio_prjcache_init(common_config.storio_prjcache_size);
+  /*
+  ** Header file cache
+  */
+  storage_hdrcache_init(common_config.storio_hdrcache_size);
+  /*
+  ** Page cache bypass mode of the bins files
+  */
+  storage_direct_io_mode = common_config.storio_direct_io;
+  /*
   ** init of the fd cache
   */
   storage_fd_cache_init(48,16);
@@ -0,0 +1,197 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <rozofs/rozofs.h>
+#include <rozofs/common/log.h>
+#include <rozofs/common/list.h>
+#include <rozofs/core/uma_dbg_api.h>
+#include <rozofs/core/rozofs_string.h>
+
+#include "storage_lru_cache.h"
+#include "storio_prjcache.h"
+
+#define STORIO_PRJCACHE_BUCKETS  1024   /**< hash buckets per shard */
+
+/*
+** Cached blocks of a FID on a cid/sid
+*/
+typedef struct _storio_prjcache_entry_t {
+  storage_lru_entry_t lru;                       /**< cache key and links          */
+  uint16_t    psize;                             /**< size of a cached block       */
+  uint64_t    valid;                             /**< bitmap of the cached blocks  */
+  char      * blk[STORIO_PRJCACHE_MAX_BLOCKS];
+} storio_prjcache_entry_t;
+
+int                        storio_prjcache_enabled = 0;
+static storage_lru_t       storio_prjcache;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Free an entry and its blocks
+*/
+static void storio_prjcache_free(storage_lru_entry_t * lru_entry) {
+  storio_prjcache_entry_t * entry = (storio_prjcache_entry_t *) lru_entry;
+  int                       i;
+
+  for (i = 0; i < STORIO_PRJCACHE_MAX_BLOCKS; i++) {
+    if (entry->blk[i] != NULL) free(entry->blk[i]);
+  }
+  free(entry);
+}
+/*
+**______________________________________________________________________________
+*/
+int storio_prjcache_read(cid_t cid, sid_t sid, uint8_t spare, fid_t fid,
+                         uint64_t bid, uint32_t nb_proj, uint16_t psize, char * bins) {
+  storage_lru_shard_t     * shard;
+  storio_prjcache_entry_t * entry;
+  list_t                  * bucket;
+  uint64_t                  mask;
+  int                       i;
+
+  if (!storio_prjcache_enabled) return 0;
+  if ((nb_proj == 0) || ((bid + nb_proj) > STORIO_PRJCACHE_MAX_BLOCKS)) return 0;
+
+  mask  = (nb_proj == 64) ? -1ULL : ((1ULL << nb_proj) - 1);
+  mask <<= bid;
+
+  shard = storage_lru_lock(&storio_prjcache, cid, sid, fid, &bucket);
+
+  entry = (storio_prjcache_entry_t *) storage_lru_lookup(bucket, cid, sid, spare, fid, 1);
+  if ((entry == NULL) || (entry->psize != psize) || ((entry->valid & mask) != mask)) {
+    shard->stats.miss++;
+    storage_lru_unlock(shard);
+    return 0;
+  }
+
+  for (i = 0; i < nb_proj; i++) {
+    memcpy(bins, entry->blk[bid+i], psize);
+    bins += psize;
+  }
+  storage_lru_touch(shard, &entry->lru);
+  shard->stats.hit++;
+
+  storage_lru_unlock(shard);
+  return 1;
+}
+/*
+**______________________________________________________________________________
+*/
+void storio_prjcache_insert(cid_t cid, sid_t sid, uint8_t spare, fid_t fid,
+                            uint64_t bid, uint32_t nb_proj, uint16_t psize, char * bins) {
+  storage_lru_shard_t     * shard;
+  storio_prjcache_entry_t * entry;
+  list_t                  * bucket;
+  int                       i;
+
+  if (!storio_prjcache_enabled) return;
+  if (bid >= STORIO_PRJCACHE_MAX_BLOCKS) return;
+  if ((bid + nb_proj) > STORIO_PRJCACHE_MAX_BLOCKS) nb_proj = STORIO_PRJCACHE_MAX_BLOCKS - bid;
+
+  shard = storage_lru_lock(&storio_prjcache, cid, sid, fid, &bucket);
+
+  entry = (storio_prjcache_entry_t *) storage_lru_lookup(bucket, cid, sid, spare, fid, 1);
+  if ((entry != NULL) && (entry->psize != psize)) {
+    storage_lru_release(&storio_prjcache, shard, &entry->lru);
+    entry = NULL;
+  }
+  if (entry == NULL) {
+    entry = calloc(1, sizeof(storio_prjcache_entry_t));
+    if (entry == NULL) goto out;
+    memcpy(entry->lru.fid, fid, sizeof(fid_t));
+    entry->lru.cid   = cid;
+    entry->lru.sid   = sid;
+    entry->lru.spare = spare;
+    entry->psize     = psize;
+    storage_lru_insert(shard, bucket, &entry->lru, sizeof(storio_prjcache_entry_t));
+  }
+  else {
+    storage_lru_touch(shard, &entry->lru);
+  }
+
+  for (i = 0; i < nb_proj; i++, bins += psize) {
+    if (entry->blk[bid+i] == NULL) {
+      entry->blk[bid+i] = malloc(psize);
+      if (entry->blk[bid+i] == NULL) break;
+      storage_lru_grow(shard, &entry->lru, psize);
+    }
+    memcpy(entry->blk[bid+i], bins, psize);
+    entry->valid |= (1ULL << (bid+i));
+  }
+
+  /*
+  ** Respect the memory budget of the shard
+  */
+  storage_lru_trim(&storio_prjcache, shard);
+
+out:
+  storage_lru_unlock(shard);
+}
+/*
+**______________________________________________________________________________
+*/
+void storio_prjcache_invalidate(cid_t cid, sid_t sid, fid_t fid) {
+
+  if (!storio_prjcache_enabled) return;
+
+  /*
+  ** Drop the nominal as well as the spare entry, whatever the recycling counter
+  */
+  storage_lru_invalidate(&storio_prjcache, cid, sid, fid);
+}
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Projection cache debug function
+*/
+static void storio_prjcache_debug(char * argv[], uint32_t tcpRef, void *bufRef) {
+  char * p = uma_dbg_get_buffer();
+  int    doreset = 0;
+
+  if ((argv[1] != NULL) && (strcmp(argv[1],"reset")==0)) doreset = 1;
+
+  if (!storio_prjcache_enabled) {
+    p += rozofs_string_append(p, "projection cache is disabled (storio_prjcache_size)\n");
+  }
+  else {
+    p = storage_lru_display(&storio_prjcache, p, doreset);
+  }
+  uma_dbg_send(tcpRef, bufRef, TRUE, uma_dbg_get_buffer());
+}
+/*
+**______________________________________________________________________________
+*/
+int storio_prjcache_init(uint32_t size_MB) {
+
+  uma_dbg_addTopic_option("prjcache", storio_prjcache_debug, UMA_DBG_OPTION_RESET);
+
+  if (storage_lru_init(&storio_prjcache, size_MB, STORIO_PRJCACHE_BUCKETS, storio_prjcache_free) != 0) {
+    return -1;
+  }
+  storio_prjcache_enabled = storio_prjcache.enabled;
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ Copyright (c) 2010 Fizians SAS. <http://www.fizians.com>
+ This file is part of Rozofs.
+
+ Rozofs is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published
+ by the Free Software Foundation, version 2.
+
+ Rozofs is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see
+ <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STORIO_PRJCACHE_H
+#define STORIO_PRJCACHE_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+#include <stdint.h>
+#include <rozofs/rozofs.h>
+
+/*
+** The projection cache keeps the projection blocks read from disk,
+** once their CRC32 has been checked, exactly as they are sent in the
+** read responses. Only the first STORIO_PRJCACHE_MAX_BLOCKS blocks of
+** a file are cached, which covers the small files as well as the
+** first blocks of the big ones.
+**
+** Every FID has at most one cache entry per cid/sid/spare that holds
+** its cached blocks. The cache is a storage_lru_t: split in shards,
+** each with its own lock, LRU list and share of the memory budget, so
+** that the disk threads hardly ever compete for the same lock.
+*/
+#define STORIO_PRJCACHE_MAX_BLOCKS   64
+
+extern int storio_prjcache_enabled;
+
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Initialize the projection cache
+
+   @param size_MB: memory budget of the cache in MB. 0 disables the cache
+
+   @retval 0 on success
+   @retval -1 on error
+*/
+int storio_prjcache_init(uint32_t size_MB);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Read projection blocks from the cache
+
+   The read succeeds only when every requested block is in the cache
+
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param spare: whether the storage is spare for this FID
+   @param fid: the file
+   @param bid: first block to read
+   @param nb_proj: number of blocks to read
+   @param psize: size of a projection block in the message
+   @param bins: where to copy the blocks
+
+   @retval 1 when the blocks have been read from the cache
+   @retval 0 when not
+*/
+int storio_prjcache_read(cid_t cid, sid_t sid, uint8_t spare, fid_t fid,
+                         uint64_t bid, uint32_t nb_proj, uint16_t psize, char * bins);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Insert in the cache projection blocks which CRC32 has been checked
+
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param spare: whether the storage is spare for this FID
+   @param fid: the file
+   @param bid: first block read
+   @param nb_proj: number of blocks read
+   @param psize: size of a projection block in the message
+   @param bins: the blocks
+*/
+void storio_prjcache_insert(cid_t cid, sid_t sid, uint8_t spare, fid_t fid,
+                            uint64_t bid, uint32_t nb_proj, uint16_t psize, char * bins);
+/*
+**______________________________________________________________________________
+*/
+/**
+*  Drop every cached block of a FID on a cid/sid
+
+   To be called before any modification of the FID on disk
+
+   @param cid: cluster identifier
+   @param sid: storage identifier
+   @param fid: the file
+*/
+void storio_prjcache_invalidate(cid_t cid, sid_t sid, fid_t fid);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif
@@ -40,6 +40,45 @@ uint64_t   storage_unqueued_req[STORIO_DISK_THREAD_MAX_OPCODE]={0};
 uint64_t   storage_queued_req[STORIO_DISK_THREAD_MAX_OPCODE]={0};
 uint64_t   storage_direct_req[STORIO_DISK_THREAD_MAX_OPCODE]={0};
 
+#define STORIO_SERIAL_RUNNING ((void *) 1)
+
+/*
+** Serialization statistics
+*/
+typedef struct _storio_serial_stats_t {
+  uint64_t   push_retry;   /**< CAS retries of the main thread when queuing    */
+  uint64_t   handoff;      /**< chains taken by the disk threads               */
+  uint64_t   handoff_req;  /**< requests in the chains taken                   */
+  uint64_t   release;      /**< FID released by the disk threads               */
+} storio_serial_stats_t;
+
+storio_serial_stats_t storio_serial_stats = {0};
+
+#define SERIAL_STATS_INC(field,val) __atomic_fetch_add(&storio_serial_stats.field,val,__ATOMIC_RELAXED)
+/*
+**_______________________________________________________
+*/
+/**
+*  Display the handoff statistics in the serialization debug output
+
+  @param p: where to format the output
+  
+  @retval the end of the output
+*/
+static char * display_serialization_handoff(char * p) {
+  uint64_t handoff = storio_serial_stats.handoff;
+
+  p += rozofs_string_append(p, "queuing CAS retries : ");
+  p += rozofs_u64_append(p, storio_serial_stats.push_retry);
+  p += rozofs_string_append(p, "\nhandoffs            : ");
+  p += rozofs_u64_append(p, handoff);
+  p += rozofs_string_append(p, " (");
+  p += rozofs_u64_append(p, handoff ? storio_serial_stats.handoff_req/handoff : 0);
+  p += rozofs_string_append(p, " req/handoff)\nreleases            : ");
+  p += rozofs_u64_append(p, storio_serial_stats.release);
+  p += rozofs_eol(p);
+  return p;
+}
 
 /*_______________________________________________________________________
 * Display serialization counter debug help
@@ -55,6 +94,7 @@ static inline void reset_serialization_counters(void) {
   memset(storage_queued_req,0, sizeof(storage_queued_req));
   memset(storage_unqueued_req,0, sizeof(storage_unqueued_req));
   memset(storage_direct_req,0, sizeof(storage_direct_req));
+  memset(&storio_serial_stats,0, sizeof(storio_serial_stats));
 }
 
 /*_______________________________________________________________________
@@ -93,6 +133,7 @@ void display_serialization_counters (char * argv[], uint32_t tcpRef, void *bufRe
     p += rozofs_eol(p);;      
   }
   p += rozofs_string_append(p, sep);
+  p = display_serialization_handoff(p);
     
   if (doreset) {
     reset_serialization_counters();
@@ -140,7 +181,7 @@ int storio_serialization_begin(storio_device_mapping_t * dev_map_p, rozorpc_srv_
   if (storio_insert_pending_request_list(dev_map_p,&req_ctx_p->list))
   {
      storage_direct_req[req_ctx_p->opcode]++; 
-    storio_disk_thread_intf_serial_send(dev_map_p,0);
+    storio_disk_thread_intf_serial_send(dev_map_p,req_ctx_p->opcode,0);
   }
   else
   {
@@ -169,32 +210,24 @@ void storio_serialization_end(storio_device_mapping_t * dev_map_p, rozorpc_srv_c
 /*
 **_________________________________________________________________________________
 **_________________________________________________________________________________
+**
+** The requests of a FID are serialized without any lock through the
+** serial_head state word of the FID context:
+**
+** - NULL                  : no request, no disk thread owns the FID.
+** - STORIO_SERIAL_RUNNING : a disk thread owns the FID, no new request.
+** - any other value       : a disk thread owns the FID or is being activated,
+**                           and the value is the last queued request. The
+**                           requests are chained in LIFO order through
+**                           their list.next field up to a NULL pointer.
+**
+** The main thread pushes the requests with a CAS. The one that makes
+** the word leave NULL activates a disk thread. That disk thread takes
+** the whole chain at once with an exchange, puts it back in FIFO order
+** and processes it. It releases the FID by a CAS from STORIO_SERIAL_RUNNING
+** to NULL, which fails when new requests have been pushed meanwhile.
+**_________________________________________________________________________________
 */
-/*
-**_______________________________________________________
-*/
-int storio_active_delay(int loop)
-{
-    int val = 0;
-    while(val < loop)
-    {
-       val++;
-    }
-    return val;
-}
-/*
-**_______________________________________________________
-*/
-void storio_get_serial_lock(pthread_rwlock_t *lock)
-{
-    while (pthread_rwlock_trywrlock(lock)!=0)
-    {
-       storio_active_delay(200);
-    }
-    return;
-
-}
-
 /*
 **_______________________________________________________
 */
@@ -210,71 +243,58 @@ void storio_get_serial_lock(pthread_rwlock_t *lock)
 */
 int storio_get_pending_request_list(storio_device_mapping_t *p,list_t *diskthread_list)
 {
+   list_t * chain;
+   list_t * next;
+   list_t * fifo;
+   void   * expected;
+   int      count;
+
    /*
-   ** check if the serial_pending_request list is empty
-   */
-   if (list_empty(&p->serial_pending_request))
-   {
-      /*
-      ** check if it is the end of processing: this true with the
-      ** diskthread list is empty
-      */
-      if (list_empty(diskthread_list))
-      {
-        /* LOCK */
-        storio_get_serial_lock(&p->serial_lock);
-	if (list_empty(&p->serial_pending_request))
-	{
-	  /*
-	  ** no more request to process-> go the IDLE state for that context
-	  */
-	  p->serial_is_running=0;
-          /* UNLOCK */
-	  pthread_rwlock_unlock(&p->serial_lock);
-	  
-	  return 1;	
-	}
-	/*
-	** there is some more request to process
-	*/
-        list_move_nocheck(diskthread_list,&p->serial_pending_request);
-        /* UNLOCK */
-	pthread_rwlock_unlock(&p->serial_lock);	
-	/*
-	** need to re-order the diskthread_list
-	*/
-	goto reorder;
-      }
-      /*
-      ** the disk thread list is not empty: nothing to re-order
-      */
-      return 0;
-   }
-   /*
-   ** there are new requests pending
-   */
-   /* LOCK */
-   storio_get_serial_lock(&p->serial_lock);
-   /*
-   ** append the pending list to the disk thread list
-   */
-   list_move_nocheck(diskthread_list,&p->serial_pending_request);
-   /* UNLOCK */
-   pthread_rwlock_unlock(&p->serial_lock);	
-   /*
-   ** need to re-order the diskthread_list
+   ** Process first the requests already taken
    */
-   goto reorder;
+   if (!list_empty(diskthread_list)) return 0;
+
+   while (1) {
    
-   /*
-   ** re-ordering of the requests 
-   */
-reorder:
-#warning reorder of requests not needed->done at rozofsmount level by doing serialisation at FID level by marking the READ opcode
-   return 0;
+     /*
+     ** Try to release the FID when no request has been queued
+     */
+     expected = STORIO_SERIAL_RUNNING;
+     if (__atomic_compare_exchange_n(&p->serial_head, &expected, NULL, 0, 
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+       SERIAL_STATS_INC(release,1);
+       return 1;
+     }
+     
+     /*
+     ** Take the whole chain of queued requests
+     */
+     chain = __atomic_exchange_n(&p->serial_head, STORIO_SERIAL_RUNNING, __ATOMIC_ACQ_REL);
+     if (chain == STORIO_SERIAL_RUNNING) continue;
+     
+     /*
+     ** Put it back in FIFO order
+     */
+     fifo  = NULL;
+     count = 0;
+     while (chain != NULL) {
+       next        = chain->next;
+       chain->next = fifo;
+       fifo        = chain;
+       count++;
+       chain       = next;
+     }
+     while (fifo != NULL) {
+       next = fifo->next;
+       list_init(fifo);
+       list_push_back(diskthread_list,fifo);
+       fifo = next;
+     }
+     SERIAL_STATS_INC(handoff,1);
+     SERIAL_STATS_INC(handoff_req,count);
+     return 0;
+   }   
 }
-
-
 /*
 **_______________________________________________________
 */
@@ -290,19 +310,18 @@ reorder:
 */
 int storio_insert_pending_request_list(storio_device_mapping_t *p,list_t *request)
 {
-   int need2activate = 0;
-   list_init(request);
-    /* LOCK */
-    storio_get_serial_lock(&p->serial_lock);
-    if (p->serial_is_running==0)
-    {
-      p->serial_is_running=1;
-      need2activate = 1;
-    }
-    list_push_back(&p->serial_pending_request,request);
-    pthread_rwlock_unlock(&p->serial_lock);
-
-    return need2activate;
+   void * old;
+   
+   old = __atomic_load_n(&p->serial_head, __ATOMIC_ACQUIRE);
+   while (1) {
+     request->next = (old == STORIO_SERIAL_RUNNING) ? NULL : old;
+     request->prev = NULL;
+     if (__atomic_compare_exchange_n(&p->serial_head, &old, request, 0, 
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) break;
+     /*
+     ** The disk thread has taken the chain or released the FID meanwhile
+     */
+     SERIAL_STATS_INC(push_retry,1);
+   }
+   return (old == NULL);
 }
-
-
@@ -975,6 +975,12 @@ uint32_t rozofs_storcli_module_init()
 	 break;
       }
       ruc_buffer_debug_register_pool("SouthLarge",rozofs_storcli_pool[_ROZOFS_STORCLI_SOUTH_LARGE_POOL]);      
+      /*
+      ** The Mojette threads release the projection buffers of the south pools
+      ** in their magazines
+      */
+      ruc_buf_mag_enable(rozofs_storcli_pool[_ROZOFS_STORCLI_SOUTH_SMALL_POOL],"SouthSmall",0);
+      ruc_buf_mag_enable(rozofs_storcli_pool[_ROZOFS_STORCLI_SOUTH_LARGE_POOL],"SouthLarge",0);
    break;
    }
    return ret;
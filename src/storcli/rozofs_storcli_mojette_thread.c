@@ -31,6 +31,7 @@
 #include <rozofs/core/af_unix_socket_generic.h>
 #include <rozofs/core/rozofs_socket_family.h>
 #include <rozofs/core/uma_dbg_api.h>
+#include <rozofs/core/ruc_buffer_mag.h>
 #include "rozofs_storcli_mojette_thread_intf.h" 
 #include "rozofs_storcli.h"
 #include "storcli_main.h"
@@ -170,6 +171,23 @@ static inline void storcli_mojette_inverse(rozofs_mojette_thread_ctx_t *thread_c
   thread_ctx_p->stat.MojetteInverse_cycle +=(cycleAfter-cycleBefore);  
   thread_ctx_p->stat.MojetteInverse_time +=(timeAfter-timeBefore);  
   /*
+  ** release the projection buffers here rather than in the main thread.
+  ** The ones that can not be released by this thread are left to the 
+  ** main thread
+  */
+  {
+    rozofs_storcli_projection_ctx_t * prj_p = working_ctx_p->prj_ctx;
+    uint8_t rozofs_safe = rozofs_get_rozofs_safe(layout);
+    int     prj_id;
+    
+    for (prj_id = 0; prj_id < rozofs_safe; prj_id++,prj_p++) {
+      if (prj_p->prj_buf == NULL) continue;
+      if (ruc_buf_mag_free(prj_p->prj_buf) == RUC_OK) prj_p->prj_buf = NULL;
+    }
+    ruc_buf_mag_flush(ROZOFS_STORCLI_SOUTH_SMALL_POOL);
+    ruc_buf_mag_flush(ROZOFS_STORCLI_SOUTH_LARGE_POOL);
+  }
+  /*
   ** send the response
   */
   storio_send_response(thread_ctx_p,msg,0);
@@ -47,6 +47,7 @@
 #include <rozofs/rozofs_srv.h>
 #include "rozofs_storcli_rpc.h"
 #include <rozofs/rpc/sproto.h>
+#include <rozofs/rpc/rozofs_xdr_fast.h>
 #include "storcli_main.h"
 #include <rozofs/rozofs_timer_conf.h>
 #include "rozofs_storcli_mojette_thread_intf.h"
@@ -297,7 +298,7 @@ void rozofs_storcli_read_req_init(uint32_t  socket_ctx_idx,
    /*
    ** decode the RPC message of the read request
    */
-   if (xdr_storcli_read_arg_t(&xdrs,storcli_read_rq_p) == FALSE)
+   if (rozofs_xdr_fast_storcli_read_arg_t(&xdrs,storcli_read_rq_p) == FALSE)
    {
       /*
       ** decoding error
@@ -735,7 +736,7 @@ retry:
      ruc_buf_inuse_increment(xmit_buf);
      
      ret =  rozofs_sorcli_send_rq_common(lbg_id,ROZOFS_TMR_GET(TMR_STORAGE_PROGRAM),STORAGE_PROGRAM,STORAGE_VERSION,SP_READ,
-                                         (xdrproc_t) xdr_sp_read_arg_t, (caddr_t) request,
+                                         (xdrproc_t) rozofs_xdr_fast_sp_read_arg_t, (caddr_t) request,
                                           xmit_buf,
                                           working_ctx_p->read_seqnum,
                                          (uint32_t)projection_id,
@@ -1004,7 +1005,7 @@ int rozofs_storcli_read_projection_retry(rozofs_storcli_ctx_t *working_ctx_p,uin
      prj_cxt_p[projection_id].prj_state = ROZOFS_PRJ_READ_IN_PRG;
      
      ret =  rozofs_sorcli_send_rq_common(lbg_id,ROZOFS_TMR_GET(TMR_STORAGE_PROGRAM),STORAGE_PROGRAM,STORAGE_VERSION,SP_READ,
-                                         (xdrproc_t) xdr_sp_read_arg_t, (caddr_t) request,
+                                         (xdrproc_t) rozofs_xdr_fast_sp_read_arg_t, (caddr_t) request,
                                           xmit_buf,
                                           working_ctx_p->read_seqnum,
                                          (uint32_t)projection_id,
@@ -249,9 +249,16 @@ int rozofs_sorcli_send_rq_common(uint32_t lbg_id,uint32_t timeout_sec, uint32_t
     }
 
     /*
-    ** OK, so now finish by starting the guard timer
+    ** OK, so now finish by starting the guard timer. The time-out
+    ** of the storio requests adapts to the RTT of the lbg, while the 
+    ** null procedure polling keeps the configured one
     */
-    rozofs_tx_start_timer(rozofs_tx_ctx_p,timeout_sec);  
+    if (opcode == SP_NULL) {
+      rozofs_tx_start_timer(rozofs_tx_ctx_p,timeout_sec);  
+    }
+    else {
+      rozofs_tx_start_timer_lbg(rozofs_tx_ctx_p,lbg_id,timeout_sec);  
+    }
     return 0;  
     
   error:
@@ -598,6 +605,41 @@ error:
 }
 
 
+/*
+**__________________________________________________________________________
+*/
+/**
+* Get the nominal storages that miss the projections of a write
+
+  A nominal storage misses the write when its projection has been
+  re-directed toward a spare storage or has failed. Projections still in
+  progress (write acknowledged on inverse) are not reported.
+  
+  @param p : pointer to the root transaction context used for the write
+  
+  @retval bitmap of the missing positions in the distribution
+
+*/
+static inline uint32_t rozofs_storcli_write_degraded_bitmap(rozofs_storcli_ctx_t *p)
+{
+   storcli_write_arg_no_data_t *storcli_write_rq_p = (storcli_write_arg_no_data_t*)&p->storcli_write_arg;
+   rozofs_storcli_projection_ctx_t *prj_cxt_p = p->prj_ctx;
+   uint8_t  rozofs_forward = rozofs_get_rozofs_forward(storcli_write_rq_p->layout);
+   uint32_t degraded = 0;
+   int      projection_id;
+   
+   for (projection_id = 0; projection_id < rozofs_forward; projection_id++)
+   {
+     if ((prj_cxt_p[projection_id].valid_stor_idx == 0)
+     ||  (prj_cxt_p[projection_id].stor_idx != projection_id)
+     ||  (prj_cxt_p[projection_id].prj_state == ROZOFS_PRJ_WR_ERROR)
+     ||  (prj_cxt_p[projection_id].prj_state == ROZOFS_PRJ_WR_IDLE))
+     {
+       degraded |= (1<<projection_id);
+     }
+   }
+   return degraded;
+}
 /*
 **__________________________________________________________________________
 */
@@ -624,6 +666,7 @@ void rozofs_storcli_write_reply_success(rozofs_storcli_ctx_t *p)
    int len;
    storcli_status_ret_t status;
    storcli_write_arg_no_data_t *storcli_write_rq_p = NULL;
+   uint32_t degraded;
    
    /*
    ** check if reply has already been done
@@ -649,6 +692,20 @@ void rozofs_storcli_write_reply_success(rozofs_storcli_ctx_t *p)
       goto error;     
     }       
     /*
+    ** When some nominal storages miss the write, append the bitmap of their
+    ** positions in the distribution, so that rozofsmount reports it to the exportd
+    */
+    degraded = rozofs_storcli_write_degraded_bitmap(p);
+    if (degraded != 0)
+    {
+      STORCLI_ERR_PROF(write_degraded);
+      if (xdr_uint32_t(&xdrs,&degraded) != TRUE)
+      {
+        severe("rpc reply encoding error");
+        goto error;     
+      }
+    }
+    /*
     ** compute the total length of the message for the rpc header and add 4 bytes more bytes for
     ** the ruc buffer to take care of the header length of the rpc message.
     */
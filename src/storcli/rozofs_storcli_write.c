@@ -43,6 +43,7 @@
 #include <rozofs/rozofs_srv.h>
 #include "rozofs_storcli_rpc.h"
 #include <rozofs/rpc/sproto.h>
+#include <rozofs/rpc/rozofs_xdr_fast.h>
 #include "storcli_main.h"
 #include <rozofs/rozofs_timer_conf.h>
 #include "rozofs_storcli_mojette_thread_intf.h"
@@ -760,7 +761,7 @@ void rozofs_storcli_write_req_init(uint32_t  socket_ctx_idx, void *recv_buf,rozo
    /*
    ** decode the RPC message of the read request
    */
-   if (xdr_storcli_write_arg_no_data_t(&xdrs,storcli_write_rq_p) == FALSE)
+   if (rozofs_xdr_fast_storcli_write_arg_no_data_t(&xdrs,storcli_write_rq_p) == FALSE)
    {
       /*
       ** decoding error
@@ -1131,7 +1132,7 @@ retry:
      }
 #endif
      ret =  rozofs_sorcli_send_rq_common(lbg_id,ROZOFS_TMR_GET(TMR_STORAGE_PROGRAM),STORAGE_PROGRAM,STORAGE_VERSION,SP_WRITE,
-                                         (xdrproc_t) xdr_sp_write_arg_no_bins_t, (caddr_t) request,
+                                         (xdrproc_t) rozofs_xdr_fast_sp_write_arg_no_bins_t, (caddr_t) request,
                                           xmit_buf,
                                           working_ctx_p->read_seqnum,
                                           (uint32_t) projection_id,
@@ -1402,7 +1403,7 @@ retry:
         
      STORCLI_START_NORTH_PROF((&working_ctx_p->prj_ctx[projection_id]),write_prj,bins_len);
      ret =  rozofs_sorcli_send_rq_common(lbg_id,ROZOFS_TMR_GET(TMR_STORAGE_PROGRAM),STORAGE_PROGRAM,STORAGE_VERSION,SP_WRITE,
-                                         (xdrproc_t) xdr_sp_write_arg_no_bins_t, (caddr_t) request,
+                                         (xdrproc_t) rozofs_xdr_fast_sp_write_arg_no_bins_t, (caddr_t) request,
                                           xmit_buf,
                                           working_ctx_p->read_seqnum,
                                           (uint32_t) projection_id,
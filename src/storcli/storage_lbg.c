@@ -174,6 +174,14 @@ int storaged_lbg_initialize(mstorage_t *s, int index) {
      storcli_lbg_cnx_supervision_tab[s->lbg_id[index]].storage = 1;
      
      north_lbg_set_next_global_entry_idx_p(s->lbg_id[index],&storcli_next_storio_global_index);
+     north_lbg_set_policy(s->lbg_id[index],common_config.storio_lbg_policy);
+     /*
+     ** Compress the rpc messages toward the remote storio when configured
+     */
+     if ((common_config.storio_compress) && (local == 0))
+     {
+       north_lbg_set_compression(s->lbg_id[index],1);
+     }
      return  0;
 }     
 
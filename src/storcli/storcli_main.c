@@ -249,6 +249,7 @@ void show_profiler(char * argv[], uint32_t tcpRef, void *bufRef) {
     SHOW_PROFILER_PROBE_BYTE(write)
     SHOW_PROFILER_KPI_BYTE(Mojette Fwd,storcli_kpi_transform_forward);
     SHOW_PROFILER_PROBE_COUNT(write_sid_miss)    
+    SHOW_PROFILER_PROBE_COUNT(write_degraded);
     SHOW_PROFILER_PROBE_BYTE(write_prj);
     SHOW_PROFILER_PROBE_COUNT(write_prj_tmo);
     SHOW_PROFILER_PROBE_COUNT(write_prj_err);
@@ -288,6 +289,7 @@ void show_profiler(char * argv[], uint32_t tcpRef, void *bufRef) {
 	RESET_PROFILER_PROBE_BYTE(write)
 	RESET_PROFILER_KPI_BYTE(Mojette Fwd,storcli_kpi_transform_forward);;
 	RESET_PROFILER_PROBE(write_sid_miss);		
+	RESET_PROFILER_PROBE(write_degraded);
 	RESET_PROFILER_PROBE_BYTE(write_prj);
 	RESET_PROFILER_PROBE(write_prj_tmo);
 	RESET_PROFILER_PROBE(write_prj_err);    
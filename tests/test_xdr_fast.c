@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <rozofs/rpc/rozofs_xdr_fast.h>
+
+/*
+** Differential test of the hand written XDR codecs against the rpcgen ones.
+**
+** Random arguments must be encoded into the same bytes, and random bytes
+** must be decoded into the same arguments, whatever the length of the
+** buffer (the hand written codecs must fail when the rpcgen ones do).
+*/
+#define XDR_FAST_BUF_SZ 1024
+
+typedef struct _xdr_fast_codec_t {
+    char     *name;
+    xdrproc_t generic;
+    xdrproc_t fast;
+    size_t    size;
+} xdr_fast_codec_t;
+
+static xdr_fast_codec_t codecs[] = {
+    {"sp_read_arg_t", (xdrproc_t) xdr_sp_read_arg_t,
+     (xdrproc_t) rozofs_xdr_fast_sp_read_arg_t, sizeof (sp_read_arg_t)},
+    {"sp_write_arg_no_bins_t", (xdrproc_t) xdr_sp_write_arg_no_bins_t,
+     (xdrproc_t) rozofs_xdr_fast_sp_write_arg_no_bins_t, sizeof (sp_write_arg_no_bins_t)},
+    {"storcli_read_arg_t", (xdrproc_t) xdr_storcli_read_arg_t,
+     (xdrproc_t) rozofs_xdr_fast_storcli_read_arg_t, sizeof (storcli_read_arg_t)},
+    {"storcli_write_arg_no_data_t", (xdrproc_t) xdr_storcli_write_arg_no_data_t,
+     (xdrproc_t) rozofs_xdr_fast_storcli_write_arg_no_data_t, sizeof (storcli_write_arg_no_data_t)},
+};
+#define NB_CODECS (sizeof (codecs) / sizeof (codecs[0]))
+
+/* 4 bytes aligned buffers, as the RPC buffers are */
+static uint32_t obj_generic[XDR_FAST_BUF_SZ / 4];
+static uint32_t obj_fast[XDR_FAST_BUF_SZ / 4];
+static uint32_t buf_generic[XDR_FAST_BUF_SZ / 4];
+static uint32_t buf_fast[XDR_FAST_BUF_SZ / 4];
+
+static void random_fill(void *p, size_t len) {
+    unsigned char *c = p;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        c[i] = rand();
+}
+
+static int encode(xdrproc_t proc, void *obj, void *buf, u_int len, u_int *pos) {
+    XDR xdrs;
+    int ok;
+
+    xdrmem_create(&xdrs, buf, len, XDR_ENCODE);
+    ok = proc(&xdrs, obj);
+    *pos = xdr_getpos(&xdrs);
+    return ok;
+}
+
+static int decode(xdrproc_t proc, void *obj, void *buf, u_int len, u_int *pos) {
+    XDR xdrs;
+    int ok;
+
+    xdrmem_create(&xdrs, buf, len, XDR_DECODE);
+    ok = proc(&xdrs, obj);
+    *pos = xdr_getpos(&xdrs);
+    return ok;
+}
+
+/*
+** Encode a random argument with both codecs
+*/
+int test_xdr_fast_encode(xdr_fast_codec_t *c) {
+    u_int pos_generic, pos_fast;
+    int ok_generic, ok_fast;
+
+    random_fill(obj_generic, c->size);
+    memset(buf_generic, 0, sizeof (buf_generic));
+    memset(buf_fast, 0, sizeof (buf_fast));
+
+    ok_generic = encode(c->generic, obj_generic, buf_generic, sizeof (buf_generic), &pos_generic);
+    ok_fast = encode(c->fast, obj_generic, buf_fast, sizeof (buf_fast), &pos_fast);
+
+    if ((ok_generic != ok_fast) || (pos_generic != pos_fast)
+        || (memcmp(buf_generic, buf_fast, pos_generic) != 0)) {
+        fprintf(stderr, "%s: encoding differs\n", c->name);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+** Decode random bytes of a random length with both codecs
+*/
+int test_xdr_fast_decode(xdr_fast_codec_t *c) {
+    u_int pos_generic, pos_fast;
+    int ok_generic, ok_fast;
+    u_int len;
+
+    random_fill(buf_generic, sizeof (buf_generic));
+    len = (rand() % 128) * 4;
+
+    memset(obj_generic, 0, sizeof (obj_generic));
+    memset(obj_fast, 0, sizeof (obj_fast));
+
+    ok_generic = decode(c->generic, obj_generic, buf_generic, len, &pos_generic);
+    ok_fast = decode(c->fast, obj_fast, buf_generic, len, &pos_fast);
+
+    if (ok_generic != ok_fast) {
+        fprintf(stderr, "%s: decoding status differs for %u bytes\n", c->name, len);
+        return -1;
+    }
+    if (!ok_generic)
+        return 0;
+    if ((pos_generic != pos_fast) || (memcmp(obj_generic, obj_fast, c->size) != 0)) {
+        fprintf(stderr, "%s: decoding differs\n", c->name);
+        return -1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int nrloop = 10000;
+    int loop;
+    int i;
+    int status = 0;
+
+    if (argc > 1)
+        nrloop = atoi(argv[1]);
+    srand(time(NULL));
+
+    for (i = 0; i < NB_CODECS; i++) {
+        for (loop = 0; loop < nrloop; loop++) {
+            if ((test_xdr_fast_encode(&codecs[i]) != 0)
+                || (test_xdr_fast_decode(&codecs[i]) != 0)) {
+                status = -1;
+                break;
+            }
+        }
+        printf("%-32s : %s\n", codecs[i].name, (loop == nrloop) ? "OK" : "FAILED");
+    }
+    return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
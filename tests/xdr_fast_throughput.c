@@ -0,0 +1,74 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <rozofs/rpc/rozofs_xdr_fast.h>
+
+/*
+** Messages per second of the rpcgen and hand written XDR codecs of the
+** read and write arguments
+*/
+typedef struct _xdr_fast_codec_t {
+    char     *name;
+    xdrproc_t generic;
+    xdrproc_t fast;
+} xdr_fast_codec_t;
+
+static xdr_fast_codec_t codecs[] = {
+    {"sp_read_arg_t", (xdrproc_t) xdr_sp_read_arg_t,
+     (xdrproc_t) rozofs_xdr_fast_sp_read_arg_t},
+    {"sp_write_arg_no_bins_t", (xdrproc_t) xdr_sp_write_arg_no_bins_t,
+     (xdrproc_t) rozofs_xdr_fast_sp_write_arg_no_bins_t},
+    {"storcli_read_arg_t", (xdrproc_t) xdr_storcli_read_arg_t,
+     (xdrproc_t) rozofs_xdr_fast_storcli_read_arg_t},
+    {"storcli_write_arg_no_data_t", (xdrproc_t) xdr_storcli_write_arg_no_data_t,
+     (xdrproc_t) rozofs_xdr_fast_storcli_write_arg_no_data_t},
+};
+#define NB_CODECS (sizeof (codecs) / sizeof (codecs[0]))
+
+static uint32_t obj[256];
+static uint32_t buf[256];
+
+static double run(xdrproc_t proc, enum xdr_op op, int nrloop) {
+    struct timeval tic, toc;
+    XDR xdrs;
+    int done;
+    double us;
+
+    gettimeofday(&tic, NULL);
+    for (done = 0; done < nrloop; done++) {
+        xdrmem_create(&xdrs, (char *) buf, sizeof (buf), op);
+        if (!proc(&xdrs, obj)) {
+            printf("codec failure\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    gettimeofday(&toc, NULL);
+    us = (toc.tv_sec - tic.tv_sec) * 1000000.0 + (toc.tv_usec - tic.tv_usec);
+    return (us == 0) ? 0 : nrloop * 1000000.0 / us;
+}
+
+int main(int argc, char **argv) {
+    int nrloop;
+    int i;
+
+    if (argc < 2) {
+        printf("%s : nr loop\n", argv[0]);
+        return -1;
+    }
+    nrloop = atoi(argv[1]);
+    memset(obj, 0x5A, sizeof (obj));
+
+    printf("%-28s %16s %16s %16s %16s\n", "msg/s", "rpcgen encode",
+           "fast encode", "rpcgen decode", "fast decode");
+    for (i = 0; i < NB_CODECS; i++) {
+        double genc = run(codecs[i].generic, XDR_ENCODE, nrloop);
+        double fenc = run(codecs[i].fast, XDR_ENCODE, nrloop);
+        double gdec = run(codecs[i].generic, XDR_DECODE, nrloop);
+        double fdec = run(codecs[i].fast, XDR_DECODE, nrloop);
+        printf("%-28s %16.0f %16.0f %16.0f %16.0f\n", codecs[i].name,
+               genc, fenc, gdec, fdec);
+    }
+    return 0;
+}